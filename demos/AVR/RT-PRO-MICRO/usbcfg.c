@@ -397,5 +397,6 @@ const SerialUSBConfig serusbcfg = {
   &USBD1,
   USBD1_DATA_REQUEST_EP,
   USBD1_DATA_AVAILABLE_EP,
-  USBD1_INTERRUPT_REQUEST_EP
+  USBD1_INTERRUPT_REQUEST_EP,
+  NULL
 };
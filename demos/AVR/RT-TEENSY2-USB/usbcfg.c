@@ -363,5 +363,6 @@ const SerialUSBConfig serusbcfg = {
   &USBD1,
   USBD_DATA_REQUEST_EP,
   USBD_DATA_AVAILABLE_EP,
-  USBD_INTERRUPT_REQUEST_EP
+  USBD_INTERRUPT_REQUEST_EP,
+  NULL
 };
@@ -190,6 +190,18 @@
 #define CH_CFG_USE_TIMESTAMP                TRUE
 #endif
 
+/**
+ * @brief   Deferred virtual timer callbacks.
+ * @details If enabled then timers can be armed with their callback deferred
+ *          to a timers thread instead of being invoked from the system
+ *          timer interrupt.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_VT_DEFERRED)
+#define CH_CFG_USE_VT_DEFERRED              FALSE
+#endif
+
 /**
  * @brief   Threads registry APIs.
  * @details If enabled then the registry APIs are included in the kernel.
@@ -200,6 +212,19 @@
 #define CH_CFG_USE_REGISTRY                 TRUE
 #endif
 
+/**
+ * @brief   Registry hash index size.
+ * @details Number of buckets of the registry hash index, if greater than
+ *          zero then threads lookups by name, pointer and handle do not
+ *          walk the whole registry.
+ *
+ * @note    The default is zero.
+ * @note    Requires @p CH_CFG_USE_REGISTRY.
+ */
+#if !defined(CH_CFG_REGISTRY_HASH_SIZE)
+#define CH_CFG_REGISTRY_HASH_SIZE           0
+#endif
+
 /**
  * @brief   Threads synchronization APIs.
  * @details If enabled then the @p chThdWait() function is included in
@@ -256,6 +281,56 @@
 #define CH_CFG_USE_MUTEXES_RECURSIVE        FALSE
 #endif
 
+/**
+ * @brief   Uncontended mutexes fast path.
+ * @details If enabled then locking a free mutex and unlocking a mutex with
+ *          no waiting threads are performed with a single atomic
+ *          compare-and-swap on the mutex owner, the kernel is only entered
+ *          on contention.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MUTEXES and a port supporting atomic
+ *          compare-and-swap.
+ */
+#if !defined(CH_CFG_USE_MUTEXES_FASTPATH)
+#define CH_CFG_USE_MUTEXES_FASTPATH         FALSE
+#endif
+
+/**
+ * @brief   Readers-Writer Locks APIs.
+ * @details If enabled then the readers-writer locks APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MUTEXES.
+ */
+#if !defined(CH_CFG_USE_RWLOCKS)
+#define CH_CFG_USE_RWLOCKS                  FALSE
+#endif
+
+/**
+ * @brief   Priority Ceiling Mutexes APIs.
+ * @details If enabled then the priority ceiling mutexes APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MUTEXES.
+ */
+#if !defined(CH_CFG_USE_PCMUTEXES)
+#define CH_CFG_USE_PCMUTEXES                FALSE
+#endif
+
+/**
+ * @brief   EDF scheduling APIs.
+ * @details If enabled then threads can be scheduled by earliest deadline
+ *          within their priority level.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_EDF)
+#define CH_CFG_USE_EDF                      FALSE
+#endif
+
 /**
  * @brief   Conditional Variables APIs.
  * @details If enabled then the conditional variables APIs are included
@@ -302,6 +377,19 @@
 #define CH_CFG_USE_EVENTS_TIMEOUT           TRUE
 #endif
 
+/**
+ * @brief   Events poll sets APIs.
+ * @details If enabled then event listeners can be grouped in poll sets, a
+ *          thread waiting on a poll set retrieves only the listeners whose
+ *          sources have been broadcasted.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_EVENTS.
+ */
+#if !defined(CH_CFG_USE_EVENTS_POLL)
+#define CH_CFG_USE_EVENTS_POLL              FALSE
+#endif
+
 /**
  * @brief   Synchronous Messages APIs.
  * @details If enabled then the synchronous messages APIs are included
@@ -326,6 +414,18 @@
 #define CH_CFG_USE_MESSAGES_PRIORITY        FALSE
 #endif
 
+/**
+ * @brief   Asynchronous Messages APIs.
+ * @details If enabled then a thread can send a message and collect the
+ *          answer later.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MESSAGES.
+ */
+#if !defined(CH_CFG_USE_MESSAGES_ASYNC)
+#define CH_CFG_USE_MESSAGES_ASYNC           FALSE
+#endif
+
 /**
  * @brief   Dynamic Threads APIs.
  * @details If enabled then the dynamic threads creation APIs are included
@@ -466,6 +566,41 @@
 #define CH_CFG_USE_JOBS                     TRUE
 #endif
 
+/**
+ * @brief   Delayed and periodic jobs APIs.
+ * @details If enabled then jobs can be scheduled for posting at a future
+ *          time using a jobs timer object.
+ *
+ * @note    The default is @p TRUE.
+ * @note    Requires @p CH_CFG_USE_JOBS.
+ */
+#if !defined(CH_CFG_USE_DELAYED_JOBS)
+#define CH_CFG_USE_DELAYED_JOBS             TRUE
+#endif
+
+/**
+ * @brief   Publish/Subscribe Topics APIs.
+ * @details If enabled then the zero-copy publish/subscribe topics APIs are
+ *          included in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS.
+ */
+#if !defined(CH_CFG_USE_TOPICS)
+#define CH_CFG_USE_TOPICS                   FALSE
+#endif
+
+/**
+ * @brief   Stackless Tasks APIs.
+ * @details If enabled then the cooperative stackless tasks APIs are
+ *          included in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_TASKS)
+#define CH_CFG_USE_TASKS                    FALSE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -647,6 +782,42 @@
 #define CH_DBG_THREADS_PROFILING            TRUE
 #endif
 
+/**
+ * @brief   Debug option, stack profiler.
+ * @details If enabled then the peak stack usage of the threads is measured
+ *          incrementally at runtime.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_DBG_FILL_THREADS.
+ */
+#if !defined(CH_DBG_STACK_PROFILER)
+#define CH_DBG_STACK_PROFILER               FALSE
+#endif
+
+/**
+ * @brief   Debug option, flight recorder.
+ * @details If enabled then kernel and user events are recorded in a memory
+ *          area not initialized on reset, the history of the previous run
+ *          can be examined after a crash.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_DBG_RECORDER)
+#define CH_DBG_RECORDER                     FALSE
+#endif
+
+/**
+ * @brief   Debug option, critical zones profiler.
+ * @details If enabled then the duration of the critical zones is measured
+ *          and attributed to the code entering them.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires a port supporting the realtime counter.
+ */
+#if !defined(CH_DBG_CS_PROFILER)
+#define CH_DBG_CS_PROFILER                  FALSE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
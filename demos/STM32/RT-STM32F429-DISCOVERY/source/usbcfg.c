@@ -338,5 +338,6 @@ const SerialUSBConfig serusbcfg = {
   &USBD2,
   USBD2_DATA_REQUEST_EP,
   USBD2_DATA_AVAILABLE_EP,
-  USBD2_INTERRUPT_REQUEST_EP
+  USBD2_INTERRUPT_REQUEST_EP,
+  NULL
 };
@@ -283,6 +283,37 @@
 #define CH_CFG_USE_JOBS                     TRUE
 #endif
 
+/**
+ * @brief   Delayed and periodic jobs APIs.
+ * @note    Not available on NIL, it must be set to @p FALSE.
+ */
+#if !defined(CH_CFG_USE_DELAYED_JOBS)
+#define CH_CFG_USE_DELAYED_JOBS             FALSE
+#endif
+
+/**
+ * @brief   Publish/Subscribe Topics APIs.
+ * @details If enabled then the zero-copy publish/subscribe topics APIs are
+ *          included in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS.
+ */
+#if !defined(CH_CFG_USE_TOPICS)
+#define CH_CFG_USE_TOPICS                   FALSE
+#endif
+
+/**
+ * @brief   Stackless Tasks APIs.
+ * @details If enabled then the cooperative stackless tasks APIs are
+ *          included in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_TASKS)
+#define CH_CFG_USE_TASKS                    FALSE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
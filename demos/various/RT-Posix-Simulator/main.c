@@ -18,6 +18,7 @@
 #include "hal.h"
 #include "shell.h"
 #include "chprintf.h"
+#include "hal_hrt.h"
 
 #define SHELL_WA_SIZE       THD_WORKING_AREA_SIZE(4096)
 #define CONSOLE_WA_SIZE     THD_WORKING_AREA_SIZE(4096)
@@ -29,7 +30,114 @@ static thread_t *cdtp;
 static thread_t *shelltp1;
 static thread_t *shelltp2;
 
+/*
+ * High resolution timers on the simulated GPT, clocked at 1MHz.
+ */
+static HRTDriver HRTD1;
+
+static void gpt1cb(GPTDriver *gptp) {
+
+  (void)gptp;
+  hrtServeInterrupt(&HRTD1);
+}
+
+static const GPTConfig gpt1cfg = {
+  1000000U,
+  gpt1cb
+};
+
+static const HRTConfig hrt1cfg = {
+  &GPTD1,
+  &gpt1cfg
+};
+
+/*
+ * HRT jitter benchmark, continuous timers measure the latency of their
+ * callbacks against their ideal expiration times.
+ */
+typedef struct {
+  hrt_timer_t           timer;
+  hrtcnt_t              period;
+  hrtcnt_t              expected;
+  hrtcnt_t              best;
+  hrtcnt_t              worst;
+  uint32_t              n;
+  uint64_t              cumulative;
+} hrt_bmk_t;
+
+static hrt_bmk_t hrt_bmk[3];
+static const hrtcnt_t hrt_bmk_periods[3] = {100U, 250U, 1000U};
+
+static void hrt_bmk_cb(hrt_timer_t *htp, void *p) {
+  hrt_bmk_t *bp = (hrt_bmk_t *)p;
+  hrtcnt_t lat;
+
+  (void)htp;
+
+  chSysLockFromISR();
+  lat = hrtGetTimeI(&HRTD1) - bp->expected;
+  chSysUnlockFromISR();
+
+  bp->expected += bp->period;
+  if (lat < bp->best) {
+    bp->best = lat;
+  }
+  if (lat > bp->worst) {
+    bp->worst = lat;
+  }
+  bp->n++;
+  bp->cumulative += (uint64_t)lat;
+}
+
+static void cmd_hrt(BaseSequentialStream *chp, int argc, char *argv[]) {
+  unsigned i;
+
+  (void)argv;
+  if (argc > 0) {
+    shellUsage(chp, "hrt");
+    return;
+  }
+
+  chprintf(chp, "Running HRT benchmark for one second..." SHELL_NEWLINE_STR);
+
+  chSysLock();
+  for (i = 0; i < 3; i++) {
+    hrt_bmk_t *bp = &hrt_bmk[i];
+
+    bp->period     = hrt_bmk_periods[i];
+    bp->expected   = hrtGetTimeI(&HRTD1) + bp->period;
+    bp->best       = (hrtcnt_t)-1;
+    bp->worst      = (hrtcnt_t)0;
+    bp->n          = 0U;
+    bp->cumulative = 0U;
+    hrtSetContinuousI(&HRTD1, &bp->timer, bp->period, hrt_bmk_cb, bp);
+  }
+  chSysUnlock();
+
+  chThdSleepMilliseconds(1000);
+
+  for (i = 0; i < 3; i++) {
+    hrtReset(&hrt_bmk[i].timer);
+  }
+
+  for (i = 0; i < 3; i++) {
+    hrt_bmk_t *bp = &hrt_bmk[i];
+
+    if (bp->n == 0U) {
+      chprintf(chp, "%5luuS: no events" SHELL_NEWLINE_STR,
+               (unsigned long)bp->period);
+      continue;
+    }
+    chprintf(chp, "%5luuS: %6lu events, latency best %luuS worst %luuS "
+             "average %luuS" SHELL_NEWLINE_STR,
+             (unsigned long)bp->period, (unsigned long)bp->n,
+             (unsigned long)bp->best, (unsigned long)bp->worst,
+             (unsigned long)(bp->cumulative / bp->n));
+  }
+}
+
 static const ShellCommand commands[] = {
+  {"hrt", cmd_hrt},
   {NULL, NULL}
 };
 
@@ -169,6 +277,12 @@ int main(void) {
   sdStart(&SD1, NULL);
   sdStart(&SD2, NULL);
 
+  /*
+   * High resolution timers (simulated GPT) initialization.
+   */
+  hrtObjectInit(&HRTD1);
+  hrtStart(&HRTD1, &hrt1cfg);
+
   /*
    * Shell manager initialization.
    */
@@ -253,6 +253,11 @@
  */
 #define PORT_SUPPORTS_RT                TRUE
 
+/**
+ * @brief   This port supports atomic compare-and-swap.
+ */
+#define PORT_SUPPORTS_ATOMIC_CAS        TRUE
+
 /**
  * @brief   Natural alignment constant.
  * @note    It is the minimum alignment for pointer-size variables.
@@ -798,6 +803,31 @@ __STATIC_FORCEINLINE bool port_is_isr_context(void) {
   return (bool)((__get_IPSR() & 0x1FFU) != 0U);
 }
 
+/**
+ * @brief   Atomic compare-and-swap of a pointer variable.
+ * @details The operation is performed using exclusive load and store
+ *          instructions.
+ *
+ * @param[in,out] p     pointer to the variable to be updated
+ * @param[in] cmp       expected current value
+ * @param[in] val       new value
+ * @return              The operation result.
+ * @retval false        if the current value did not match.
+ * @retval true         if the variable has been updated.
+ */
+__STATIC_FORCEINLINE bool port_atomic_cas_ptr(void * volatile *p,
+                                              void *cmp, void *val) {
+
+  do {
+    if (__LDREXW((volatile uint32_t *)p) != (uint32_t)cmp) {
+      __CLREX();
+      return false;
+    }
+  } while (__STREXW((uint32_t)val, (volatile uint32_t *)p) != 0U);
+
+  return true;
+}
+
 /**
  * @brief   Kernel-lock action.
  * @details In this port this function raises the base priority to kernel
@@ -41,6 +41,11 @@
  */
 #define PORT_SUPPORTS_RT                TRUE
 
+/**
+ * @brief   This port supports atomic compare-and-swap.
+ */
+#define PORT_SUPPORTS_ATOMIC_CAS        TRUE
+
 /**
  * @brief   Natural alignment constant.
  * @note    It is the minimum alignment for pointer-size variables.
@@ -365,6 +370,30 @@ static inline bool port_is_isr_context(void) {
   return port_isr_context_flag;
 }
 
+/**
+ * @brief   Atomic compare-and-swap of a pointer variable.
+ * @note    In the simulator interrupts are only served when explicitly
+ *          polled so a plain compare and store sequence is atomic, a
+ *          locked host instruction would only add overhead.
+ *
+ * @param[in,out] p     pointer to the variable to be updated
+ * @param[in] cmp       expected current value
+ * @param[in] val       new value
+ * @return              The operation result.
+ * @retval false        if the current value did not match.
+ * @retval true         if the variable has been updated.
+ */
+static inline bool port_atomic_cas_ptr(void * volatile *p,
+                                       void *cmp, void *val) {
+
+  if (*p != cmp) {
+    return false;
+  }
+  *p = val;
+
+  return true;
+}
+
 /**
  * @brief   Kernel-lock action.
  * @details In this port this function disables interrupts globally.
@@ -298,6 +298,7 @@ static inline halfreq_t halClockGetPointX(halclkpt_t clkpt) {
 #include "hal_flash.h"
 
 /* Shared headers.*/
+#include "hal_iochains.h"
 #include "hal_buffers.h"
 #include "hal_queues.h"
 #include "hal_buffered_serial.h"
@@ -318,6 +318,11 @@ extern "C" {
   msg_t ibqGetTimeout(input_buffers_queue_t *ibqp, sysinterval_t timeout);
   size_t ibqReadTimeout(input_buffers_queue_t *ibqp, uint8_t *bp,
                         size_t n, sysinterval_t timeout);
+  void ibqPostFullChainI(input_buffers_queue_t *ibqp, iob_t *iobp);
+  msg_t ibqGetChainTimeout(input_buffers_queue_t *ibqp, iob_t **iobpp,
+                           sysinterval_t timeout);
+  msg_t ibqGetChainTimeoutS(input_buffers_queue_t *ibqp, iob_t **iobpp,
+                            sysinterval_t timeout);
   void obqObjectInit(output_buffers_queue_t *obqp, bool suspended, uint8_t *bp,
                      size_t size, size_t n, bqnotify_t onfy, void *link);
   void obqResetI(output_buffers_queue_t *obqp);
@@ -334,6 +339,8 @@ extern "C" {
                       sysinterval_t timeout);
   size_t obqWriteTimeout(output_buffers_queue_t *obqp, const uint8_t *bp,
                          size_t n, sysinterval_t timeout);
+  size_t obqPostChainTimeout(output_buffers_queue_t *obqp, iob_t *iobp,
+                             sysinterval_t timeout);
   bool obqTryFlushI(output_buffers_queue_t *obqp);
   void obqFlush(output_buffers_queue_t *obqp);
 #ifdef __cplusplus
@@ -0,0 +1,262 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_iochains.h
+ * @brief   I/O Buffer Chains macros and structures.
+ *
+ * @addtogroup HAL_IOCHAINS
+ * @{
+ */
+
+#ifndef HAL_IOCHAINS_H
+#define HAL_IOCHAINS_H
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of an I/O buffers pool.
+ */
+typedef struct iob_pool iob_pool_t;
+
+/**
+ * @brief   Type of an I/O buffer.
+ * @details An I/O buffer is a segment of a chain, a chain is referred by
+ *          a pointer to its first buffer.
+ */
+typedef struct iob iob_t;
+
+/**
+ * @brief   Structure of an I/O buffer.
+ * @details The buffer data area follows the header.
+ * @note    The @p next link owns a reference to the next buffer, releasing
+ *          the last reference to a buffer releases a reference to the rest
+ *          of the chain.
+ */
+struct iob {
+  /**
+   * @brief   Next buffer in the chain or @p NULL.
+   */
+  iob_t                 *next;
+  /**
+   * @brief   Pool owning the buffer.
+   */
+  iob_pool_t            *pool;
+  /**
+   * @brief   References counter.
+   */
+  size_t                refs;
+  /**
+   * @brief   Offset of the valid data within the data area.
+   */
+  size_t                offset;
+  /**
+   * @brief   Size of the valid data.
+   */
+  size_t                len;
+};
+
+/**
+ * @brief   Structure of an I/O buffers pool.
+ */
+struct iob_pool {
+  /**
+   * @brief   Queue of threads waiting for a free buffer.
+   */
+  threads_queue_t       waiting;
+  /**
+   * @brief   List of the free buffers.
+   */
+  iob_t                 *free;
+  /**
+   * @brief   Size of the buffers data area.
+   */
+  size_t                size;
+  /**
+   * @brief   Number of free buffers.
+   */
+  size_t                nfree;
+};
+
+/**
+ * @brief   Structure of a queue of I/O buffer chains.
+ * @details The queue holds references to chains, posting a chain passes
+ *          the caller reference to the queue, fetching a chain passes the
+ *          queue reference to the caller.
+ */
+typedef struct {
+  /**
+   * @brief   Queue of threads waiting for a chain.
+   */
+  threads_queue_t       qr;
+  /**
+   * @brief   Queue of threads waiting for space.
+   */
+  threads_queue_t       qw;
+  /**
+   * @brief   Pointer to the queue buffer.
+   */
+  iob_t                 **buffer;
+  /**
+   * @brief   Pointer to the location after the queue buffer.
+   */
+  iob_t                 **top;
+  /**
+   * @brief   Write pointer.
+   */
+  iob_t                 **wrptr;
+  /**
+   * @brief   Read pointer.
+   */
+  iob_t                 **rdptr;
+  /**
+   * @brief   Chains in queue.
+   */
+  size_t                cnt;
+} iob_queue_t;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Computes the size of an I/O buffer including its header.
+ * @details This macro can be used to size the memory area passed to
+ *          @p iobPoolObjectInit().
+ *
+ * @param[in] size      size of the buffer data area
+ */
+#define IOB_BUFFER_SIZE(size)                                               \
+  ((((sizeof (iob_t) + (size_t)(size)) + (sizeof (void *) - 1U)) /          \
+    sizeof (void *)) * sizeof (void *))
+
+/**
+ * @name    Macro Functions
+ * @{
+ */
+/**
+ * @brief   Returns a pointer to the buffer valid data.
+ *
+ * @param[in] iobp      pointer to an @p iob_t object
+ * @return              Pointer to the first valid data byte.
+ *
+ * @xclass
+ */
+#define iobGetDataX(iobp) ((uint8_t *)((iobp) + 1) + (iobp)->offset)
+
+/**
+ * @brief   Returns the size of the buffer valid data.
+ * @note    This is the size of this single buffer, not of the whole chain.
+ *
+ * @param[in] iobp      pointer to an @p iob_t object
+ * @return              The size of the valid data.
+ *
+ * @xclass
+ */
+#define iobGetLengthX(iobp) ((iobp)->len)
+
+/**
+ * @brief   Sets the size of the buffer valid data.
+ * @details This macro is meant for drivers writing data directly into the
+ *          buffer data area, for example using DMA.
+ * @pre     The buffer must not be shared.
+ *
+ * @param[in] iobp      pointer to an @p iob_t object
+ * @param[in] n         size of the valid data
+ *
+ * @xclass
+ */
+#define iobSetLengthX(iobp, n) ((iobp)->len = (size_t)(n))
+
+/**
+ * @brief   Returns the next buffer of a chain.
+ *
+ * @param[in] iobp      pointer to an @p iob_t object
+ * @return              The next buffer or @p NULL.
+ *
+ * @xclass
+ */
+#define iobGetNextX(iobp) ((iobp)->next)
+
+/**
+ * @brief   Returns the number of free buffers in a pool.
+ *
+ * @param[in] pp        pointer to an @p iob_pool_t object
+ * @return              The number of free buffers.
+ *
+ * @iclass
+ */
+#define iobPoolGetFreeCountI(pp) ((pp)->nfree)
+
+/**
+ * @brief   Returns the number of chains in a queue.
+ *
+ * @param[in] qp        pointer to an @p iob_queue_t object
+ * @return              The number of queued chains.
+ *
+ * @iclass
+ */
+#define iobqGetUsedCountI(qp) ((qp)->cnt)
+/** @} */
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void iobPoolObjectInit(iob_pool_t *pp, size_t size, void *p, size_t n);
+  iob_t *iobAllocI(iob_pool_t *pp);
+  iob_t *iobAllocTimeout(iob_pool_t *pp, sysinterval_t timeout);
+  void iobAddRefI(iob_t *iobp);
+  void iobAddRef(iob_t *iobp);
+  void iobReleaseI(iob_t *iobp);
+  void iobRelease(iob_t *iobp);
+  void iobCat(iob_t *head, iob_t *tail);
+  size_t iobGetChainLength(const iob_t *iobp);
+  bool iobAdvance(iob_t *iobp, size_t n);
+  size_t iobRead(const iob_t *iobp, size_t offset, uint8_t *bp, size_t n);
+  size_t iobAppend(iob_t *iobp, const uint8_t *bp, size_t n);
+  size_t iobStreamWrite(BaseSequentialStream *stp, const iob_t *iobp);
+  void iobqObjectInit(iob_queue_t *qp, iob_t **buf, size_t n);
+  void iobqResetI(iob_queue_t *qp);
+  msg_t iobqPostI(iob_queue_t *qp, iob_t *iobp);
+  msg_t iobqPostTimeout(iob_queue_t *qp, iob_t *iobp, sysinterval_t timeout);
+  msg_t iobqFetchI(iob_queue_t *qp, iob_t **iobpp);
+  msg_t iobqFetchTimeout(iob_queue_t *qp, iob_t **iobpp,
+                         sysinterval_t timeout);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_IOCHAINS_H */
+
+/** @} */
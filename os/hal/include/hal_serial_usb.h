@@ -111,6 +111,14 @@ typedef struct {
    *          present, USB descriptors must be changed accordingly.
    */
   usbep_t                   int_in;
+  /**
+   * @brief   I/O buffers pool for incoming data.
+   * @note    If not @p NULL then incoming data is received directly into
+   *          I/O buffers allocated from this pool and can be fetched by
+   *          reference using @p sduReceiveChainTimeout(). The pool buffers
+   *          size must be not lower than @p SERIAL_USB_BUFFERS_SIZE.
+   */
+  iob_pool_t                *pool;
 } SerialUSBConfig;
 
 /**
@@ -132,7 +140,9 @@ typedef struct {
                                               SERIAL_USB_BUFFERS_SIZE)];    \
   /* End of the mandatory fields.*/                                         \
   /* Current configuration data.*/                                          \
-  const SerialUSBConfig     *config;
+  const SerialUSBConfig     *config;                                        \
+  /* I/O buffer of the ongoing receive transaction or NULL.*/               \
+  iob_t                     *rxiobp;
 
 /**
  * @brief   @p SerialUSBDriver specific methods.
@@ -186,6 +196,10 @@ extern "C" {
   void sduDataReceived(USBDriver *usbp, usbep_t ep);
   void sduInterruptTransmitted(USBDriver *usbp, usbep_t ep);
   msg_t sduControl(USBDriver *usbp, unsigned int operation, void *arg);
+  size_t sduSendChainTimeout(SerialUSBDriver *sdup, iob_t *iobp,
+                             sysinterval_t timeout);
+  msg_t sduReceiveChainTimeout(SerialUSBDriver *sdup, iob_t **iobpp,
+                               sysinterval_t timeout);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,439 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_hrt.c
+ * @brief   High Resolution Timers code.
+ * @details This module multiplexes any number of one-shot and continuous
+ *          timers on a single GPT unit, the resolution is the GPT clock
+ *          period instead of the system tick.<br>
+ *          The GPT unit runs in continuous mode and is the time base of
+ *          the driver, the time is the sum of the completed GPT cycles
+ *          plus the GPT counter. Each cycle is programmed to end on the
+ *          nearest deadline, a cycle that already ends on the next deadline
+ *          is not restarted so periodic timers do not accumulate drift.
+ * @pre     The GPT counter must count upward from zero since the start of
+ *          the cycle and must not wrap while the period event is pending.
+ *
+ * @addtogroup HAL_HRT
+ * @{
+ */
+
+#include "hal.h"
+
+#include "hal_hrt.h"
+
+#if (HAL_USE_GPT == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Checks if a deadline is not after the specified time.
+ *
+ * @param[in] deadline  deadline to be checked
+ * @param[in] time      reference time
+ * @return              The check result.
+ *
+ * @notapi
+ */
+static inline bool hrt_is_reached(hrtcnt_t deadline, hrtcnt_t time) {
+
+  return (bool)((hrtcnt_t)(time - deadline) <= HRT_MAX_DELAY);
+}
+
+/**
+ * @brief   Inserts a timer in the queue ordered by deadline.
+ * @note    Timers with the same deadline are served in insertion order.
+ *
+ * @param[in] hrtp      pointer to the @p HRTDriver object
+ * @param[in] htp       pointer to the @p hrt_timer_t object
+ *
+ * @notapi
+ */
+static void hrt_enqueue(HRTDriver *hrtp, hrt_timer_t *htp) {
+  hrt_timer_t *prev = NULL;
+  hrt_timer_t *next = hrtp->first;
+
+  while ((next != NULL) && hrt_is_reached(next->deadline, htp->deadline)) {
+    prev = next;
+    next = next->next;
+  }
+
+  htp->prev = prev;
+  htp->next = next;
+  if (prev == NULL) {
+    hrtp->first = htp;
+  }
+  else {
+    prev->next = htp;
+  }
+  if (next != NULL) {
+    next->prev = htp;
+  }
+}
+
+/**
+ * @brief   Removes a timer from the queue.
+ *
+ * @param[in] hrtp      pointer to the @p HRTDriver object
+ * @param[in] htp       pointer to the @p hrt_timer_t object
+ *
+ * @notapi
+ */
+static void hrt_dequeue(HRTDriver *hrtp, hrt_timer_t *htp) {
+
+  if (htp->prev == NULL) {
+    hrtp->first = htp->next;
+  }
+  else {
+    htp->prev->next = htp->next;
+  }
+  if (htp->next != NULL) {
+    htp->next->prev = htp->prev;
+  }
+}
+
+/**
+ * @brief   Interval from the specified time to the next GPT event.
+ *
+ * @param[in] hrtp      pointer to the @p HRTDriver object
+ * @param[in] time      start time of the cycle
+ * @return              The cycle length in GPT ticks.
+ *
+ * @notapi
+ */
+static hrtcnt_t hrt_next_interval(HRTDriver *hrtp, hrtcnt_t time) {
+  hrtcnt_t delta;
+
+  if (hrtp->first == NULL) {
+    return (hrtcnt_t)HRT_CFG_MAX_INTERVAL;
+  }
+
+  delta = (hrtcnt_t)(hrtp->first->deadline - time);
+  if ((delta > HRT_MAX_DELAY) || (delta < (hrtcnt_t)HRT_CFG_MIN_INTERVAL)) {
+    /* Already reached or too close.*/
+    return (hrtcnt_t)HRT_CFG_MIN_INTERVAL;
+  }
+  if (delta > (hrtcnt_t)HRT_CFG_MAX_INTERVAL) {
+    return (hrtcnt_t)HRT_CFG_MAX_INTERVAL;
+  }
+
+  return delta;
+}
+
+/**
+ * @brief   Makes the current GPT cycle end on the nearest deadline.
+ * @details The running cycle is left untouched if it already ends on the
+ *          nearest deadline, else the GPT is restarted from the current
+ *          time.
+ *
+ * @param[in] hrtp      pointer to the @p HRTDriver object
+ *
+ * @notapi
+ */
+static void hrt_program(HRTDriver *hrtp) {
+  GPTDriver *gptp = hrtp->config->gptp;
+  hrtcnt_t interval;
+
+  if (hrt_next_interval(hrtp, hrtp->base) == hrtp->interval) {
+    return;
+  }
+
+  /* Restarting the cycle from the current time, the ticks elapsed between
+     the counter read and the restart are lost.*/
+  hrtp->base    += (hrtcnt_t)gptGetCounterX(gptp);
+  interval       = hrt_next_interval(hrtp, hrtp->base);
+  hrtp->interval = interval;
+  gptStopTimerI(gptp);
+  gptStartContinuousI(gptp, (gptcnt_t)interval);
+}
+
+/**
+ * @brief   Arms a timer.
+ *
+ * @param[in] hrtp      pointer to the @p HRTDriver object
+ * @param[in] htp       pointer to the @p hrt_timer_t object
+ * @param[in] delay     delay in GPT ticks
+ * @param[in] reload    reload interval, zero for one-shot timers
+ * @param[in] hrtfunc   the timer callback function
+ * @param[in] par       the callback function parameter
+ *
+ * @notapi
+ */
+static void hrt_set(HRTDriver *hrtp, hrt_timer_t *htp, hrtcnt_t delay,
+                    hrtcnt_t reload, hrtfunc_t hrtfunc, void *par) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((hrtp != NULL) && (htp != NULL) && (hrtfunc != NULL) &&
+               (delay > (hrtcnt_t)0) && (delay <= HRT_MAX_DELAY));
+  osalDbgAssert(hrtp->state == HRT_READY, "not ready");
+
+  if (htp->hrtp != NULL) {
+    hrtResetI(htp);
+  }
+
+  htp->hrtp     = hrtp;
+  htp->deadline = hrtGetTimeI(hrtp) + delay;
+  htp->reload   = reload;
+  htp->func     = hrtfunc;
+  htp->par      = par;
+  hrt_enqueue(hrtp, htp);
+
+  /* A new nearest deadline requires the GPT to be reprogrammed.*/
+  if (hrtp->first == htp) {
+    hrt_program(hrtp);
+  }
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] hrtp     pointer to the @p HRTDriver object
+ *
+ * @init
+ */
+void hrtObjectInit(HRTDriver *hrtp) {
+
+  osalDbgCheck(hrtp != NULL);
+
+  hrtp->state    = HRT_STOP;
+  hrtp->config   = NULL;
+  hrtp->first    = NULL;
+  hrtp->base     = (hrtcnt_t)0;
+  hrtp->interval = (hrtcnt_t)0;
+}
+
+/**
+ * @brief   Configures and activates a HRT driver.
+ * @details The GPT unit is started and its time base begins counting.
+ *
+ * @param[in] hrtp      pointer to the @p HRTDriver object
+ * @param[in] config    pointer to the configuration
+ *
+ * @api
+ */
+void hrtStart(HRTDriver *hrtp, const HRTConfig *config) {
+
+  osalDbgCheck((hrtp != NULL) && (config != NULL));
+  osalDbgAssert((hrtp->state == HRT_STOP) || (hrtp->state == HRT_READY),
+                "invalid state");
+
+  if (hrtp->state == HRT_READY) {
+    hrtStop(hrtp);
+  }
+
+  hrtp->config = config;
+  (void) gptStart(config->gptp, config->gptconfig);
+
+  osalSysLock();
+  hrtp->first    = NULL;
+  hrtp->base     = (hrtcnt_t)0;
+  hrtp->interval = (hrtcnt_t)HRT_CFG_MAX_INTERVAL;
+  hrtp->state    = HRT_READY;
+  gptStartContinuousI(config->gptp, (gptcnt_t)HRT_CFG_MAX_INTERVAL);
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Deactivates a HRT driver.
+ * @note    Timers still armed are disarmed without invoking their
+ *          callbacks.
+ *
+ * @param[in] hrtp      pointer to the @p HRTDriver object
+ *
+ * @api
+ */
+void hrtStop(HRTDriver *hrtp) {
+
+  osalDbgCheck(hrtp != NULL);
+  osalDbgAssert((hrtp->state == HRT_STOP) || (hrtp->state == HRT_READY),
+                "invalid state");
+
+  if (hrtp->state == HRT_READY) {
+    osalSysLock();
+    gptStopTimerI(hrtp->config->gptp);
+    while (hrtp->first != NULL) {
+      hrtp->first->hrtp = NULL;
+      hrtp->first = hrtp->first->next;
+    }
+    hrtp->state = HRT_STOP;
+    osalSysUnlock();
+
+    gptStop(hrtp->config->gptp);
+  }
+}
+
+/**
+ * @brief   Returns the current high resolution time.
+ * @note    The time starts from zero when the driver is started and wraps
+ *          around at the end of the @p hrtcnt_t range.
+ *
+ * @param[in] hrtp      pointer to the @p HRTDriver object
+ * @return              The current time in GPT ticks.
+ *
+ * @iclass
+ */
+hrtcnt_t hrtGetTimeI(HRTDriver *hrtp) {
+
+  osalDbgCheckClassI();
+  osalDbgAssert(hrtp->state == HRT_READY, "not ready");
+
+  return hrtp->base + (hrtcnt_t)gptGetCounterX(hrtp->config->gptp);
+}
+
+/**
+ * @brief   Enables a one-shot high resolution timer.
+ * @details The timer is enabled and programmed to trigger after the delay
+ *          specified as parameter.
+ * @note    The timer is disabled first if already armed.
+ * @note    The associated function is invoked from interrupt context.
+ *
+ * @param[in] hrtp      pointer to the @p HRTDriver object
+ * @param[out] htp      the @p hrt_timer_t structure pointer
+ * @param[in] delay     the number of GPT ticks before the operation
+ *                      timeouts, it must be greater than zero and not
+ *                      greater than @p HRT_MAX_DELAY
+ * @param[in] hrtfunc   the timer callback function. After invoking the
+ *                      callback the timer is disabled and the structure can
+ *                      be disposed or reused.
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @iclass
+ */
+void hrtSetI(HRTDriver *hrtp, hrt_timer_t *htp, hrtcnt_t delay,
+             hrtfunc_t hrtfunc, void *par) {
+
+  hrt_set(hrtp, htp, delay, (hrtcnt_t)0, hrtfunc, par);
+}
+
+/**
+ * @brief   Enables a continuous high resolution timer.
+ * @details The timer is enabled and programmed to trigger after the delay
+ *          specified as parameter, then periodically with the same delay.
+ *          Deadlines are computed from the previous deadline so the period
+ *          does not drift with the interrupt latency.
+ * @note    The timer is disabled first if already armed.
+ * @note    The associated function is invoked from interrupt context.
+ *
+ * @param[in] hrtp      pointer to the @p HRTDriver object
+ * @param[out] htp      the @p hrt_timer_t structure pointer
+ * @param[in] delay     the number of GPT ticks before the operation
+ *                      timeouts, it must be greater than zero and not
+ *                      greater than @p HRT_MAX_DELAY
+ * @param[in] hrtfunc   the timer callback function. After invoking the
+ *                      callback the timer is restarted.
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @iclass
+ */
+void hrtSetContinuousI(HRTDriver *hrtp, hrt_timer_t *htp, hrtcnt_t delay,
+                       hrtfunc_t hrtfunc, void *par) {
+
+  hrt_set(hrtp, htp, delay, delay, hrtfunc, par);
+}
+
+/**
+ * @brief   Disables a high resolution timer.
+ * @note    The timer is first checked and disabled only if armed.
+ * @note    The GPT is not reprogrammed, a cycle programmed for the removed
+ *          timer ends without invoking callbacks.
+ *
+ * @param[in] htp       the @p hrt_timer_t structure pointer
+ *
+ * @iclass
+ */
+void hrtResetI(hrt_timer_t *htp) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck(htp != NULL);
+
+  if (htp->hrtp != NULL) {
+    hrt_dequeue(htp->hrtp, htp);
+    htp->hrtp = NULL;
+  }
+}
+
+/**
+ * @brief   HRT GPT events handler.
+ * @details Invokes the callbacks of the expired timers then programs the
+ *          GPT cycle ending on the next deadline.
+ * @note    This function must be called from the callback of the GPT
+ *          unit associated to the driver.
+ *
+ * @param[in] hrtp      pointer to the @p HRTDriver object
+ *
+ * @special
+ */
+void hrtServeInterrupt(HRTDriver *hrtp) {
+  hrt_timer_t *htp;
+
+  osalSysLockFromISR();
+
+  /* The GPT cycle is completed, the counter now counts from the end
+     of the cycle.*/
+  hrtp->base += hrtp->interval;
+
+  while ((hrtp->first != NULL) &&
+         hrt_is_reached(hrtp->first->deadline, hrtGetTimeI(hrtp))) {
+    hrtfunc_t fn;
+
+    htp = hrtp->first;
+    hrt_dequeue(hrtp, htp);
+
+    /* Continuous timers are re-armed relative to their previous deadline
+       before invoking the callback, the callback can reset them.*/
+    if (htp->reload > (hrtcnt_t)0) {
+      htp->deadline += htp->reload;
+      hrt_enqueue(hrtp, htp);
+    }
+    else {
+      htp->hrtp = NULL;
+    }
+
+    fn = htp->func;
+    osalSysUnlockFromISR();
+    fn(htp, htp->par);
+    osalSysLockFromISR();
+  }
+
+  hrt_program(hrtp);
+
+  osalSysUnlockFromISR();
+}
+
+#endif /* HAL_USE_GPT == TRUE */
+
+/** @} */
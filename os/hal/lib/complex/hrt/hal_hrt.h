@@ -0,0 +1,359 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_hrt.h
+ * @brief   High Resolution Timers macros and structures.
+ *
+ * @addtogroup HAL_HRT
+ * @{
+ */
+
+#ifndef HAL_HRT_H
+#define HAL_HRT_H
+
+#include "hal.h"
+
+#if (HAL_USE_GPT == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum delay that can be specified for a timer.
+ * @note    Deadlines are compared using modular arithmetic, a deadline
+ *          must never be more than half the counter range in the future.
+ */
+#define HRT_MAX_DELAY                       ((hrtcnt_t)0x7FFFFFFFU)
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum interval programmed in the GPT unit.
+ * @details Longer delays are split in multiple GPT cycles, the value must
+ *          fit the @p gptcnt_t type of the used GPT unit.
+ */
+#if !defined(HRT_CFG_MAX_INTERVAL) || defined(__DOXYGEN__)
+#define HRT_CFG_MAX_INTERVAL                0xFFFFU
+#endif
+
+/**
+ * @brief   Minimum interval programmed in the GPT unit.
+ * @details Deadlines closer than this value are served after this
+ *          interval, it should cover the GPT interrupt servicing time.
+ */
+#if !defined(HRT_CFG_MIN_INTERVAL) || defined(__DOXYGEN__)
+#define HRT_CFG_MIN_INTERVAL                2U
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (HRT_CFG_MIN_INTERVAL < 1U) ||                                          \
+    (HRT_CFG_MIN_INTERVAL >= HRT_CFG_MAX_INTERVAL)
+#error "invalid HRT_CFG_MIN_INTERVAL value"
+#endif
+
+#if HRT_CFG_MAX_INTERVAL > 0x7FFFFFFFU
+#error "invalid HRT_CFG_MAX_INTERVAL value"
+#endif
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of an high resolution time or interval in GPT ticks.
+ */
+typedef uint32_t hrtcnt_t;
+
+/**
+ * @brief   Type of a structure representing an HRT driver.
+ */
+typedef struct hal_hrt_driver HRTDriver;
+
+/**
+ * @brief   Type of a structure representing an high resolution timer.
+ */
+typedef struct hal_hrt_timer hrt_timer_t;
+
+/**
+ * @brief   Type of an high resolution timer callback function.
+ *
+ * @param[in] htp       pointer to the expired timer
+ * @param[in] p         parameter passed to @p hrtSetI()
+ */
+typedef void (*hrtfunc_t)(hrt_timer_t *htp, void *p);
+
+/**
+ * @brief   Type of driver state machine states.
+ */
+typedef enum {
+  HRT_UNINIT = 0,
+  HRT_STOP = 1,
+  HRT_READY = 2
+} hrtstate_t;
+
+/**
+ * @brief   Type of an HRT driver configuration.
+ */
+typedef struct {
+  /**
+   * @brief   GPT unit multiplexed by the driver.
+   */
+  GPTDriver                 *gptp;
+  /**
+   * @brief   GPT unit configuration.
+   * @note    The callback must invoke @p hrtServeInterrupt() on the
+   *          associated HRT driver.
+   */
+  const GPTConfig           *gptconfig;
+} HRTConfig;
+
+/**
+ * @brief   Structure representing an high resolution timer.
+ */
+struct hal_hrt_timer {
+  /**
+   * @brief   Next timer in the driver queue.
+   */
+  hrt_timer_t               *next;
+  /**
+   * @brief   Previous timer in the driver queue.
+   */
+  hrt_timer_t               *prev;
+  /**
+   * @brief   Driver owning the timer while armed, @p NULL if not armed.
+   */
+  HRTDriver                 *hrtp;
+  /**
+   * @brief   Absolute deadline.
+   */
+  hrtcnt_t                  deadline;
+  /**
+   * @brief   Reload interval, zero for one-shot timers.
+   */
+  hrtcnt_t                  reload;
+  /**
+   * @brief   Timer callback.
+   */
+  hrtfunc_t                 func;
+  /**
+   * @brief   Callback parameter.
+   */
+  void                      *par;
+};
+
+/**
+ * @brief   Structure representing an HRT driver.
+ */
+struct hal_hrt_driver {
+  /**
+   * @brief   Driver state.
+   */
+  hrtstate_t                state;
+  /**
+   * @brief   Current configuration data.
+   */
+  const HRTConfig           *config;
+  /**
+   * @brief   Armed timers ordered by deadline.
+   */
+  hrt_timer_t               *first;
+  /**
+   * @brief   Time at the start of the current GPT cycle.
+   */
+  hrtcnt_t                  base;
+  /**
+   * @brief   Length of the current GPT cycle.
+   */
+  hrtcnt_t                  interval;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void hrtObjectInit(HRTDriver *hrtp);
+  void hrtStart(HRTDriver *hrtp, const HRTConfig *config);
+  void hrtStop(HRTDriver *hrtp);
+  hrtcnt_t hrtGetTimeI(HRTDriver *hrtp);
+  void hrtSetI(HRTDriver *hrtp, hrt_timer_t *htp, hrtcnt_t delay,
+               hrtfunc_t hrtfunc, void *par);
+  void hrtSetContinuousI(HRTDriver *hrtp, hrt_timer_t *htp, hrtcnt_t delay,
+                         hrtfunc_t hrtfunc, void *par);
+  void hrtResetI(hrt_timer_t *htp);
+  void hrtServeInterrupt(HRTDriver *hrtp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Driver inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an @p hrt_timer_t object.
+ * @note    Initializing a timer object is not strictly required because
+ *          the function @p hrtSetI() initializes the object too. This
+ *          function is only useful if you need to perform a @p hrtIsArmed()
+ *          check before calling @p hrtSetI().
+ *
+ * @param[out] htp      the @p hrt_timer_t structure pointer
+ *
+ * @init
+ */
+static inline void hrtTimerObjectInit(hrt_timer_t *htp) {
+
+  htp->hrtp = NULL;
+}
+
+/**
+ * @brief   Returns @p true if the specified timer is armed.
+ *
+ * @param[in] htp       the @p hrt_timer_t structure pointer
+ * @return              true if the timer is armed.
+ *
+ * @iclass
+ */
+static inline bool hrtIsArmedI(const hrt_timer_t *htp) {
+
+  osalDbgCheckClassI();
+
+  return (bool)(htp->hrtp != NULL);
+}
+
+/**
+ * @brief   Returns @p true if the specified timer is armed.
+ *
+ * @param[in] htp       the @p hrt_timer_t structure pointer
+ * @return              true if the timer is armed.
+ *
+ * @api
+ */
+static inline bool hrtIsArmed(const hrt_timer_t *htp) {
+  bool b;
+
+  osalSysLock();
+  b = hrtIsArmedI(htp);
+  osalSysUnlock();
+
+  return b;
+}
+
+/**
+ * @brief   Returns the current high resolution time.
+ *
+ * @param[in] hrtp      pointer to the @p HRTDriver object
+ * @return              The current time in GPT ticks.
+ *
+ * @api
+ */
+static inline hrtcnt_t hrtGetTime(HRTDriver *hrtp) {
+  hrtcnt_t t;
+
+  osalSysLock();
+  t = hrtGetTimeI(hrtp);
+  osalSysUnlock();
+
+  return t;
+}
+
+/**
+ * @brief   Enables a one-shot high resolution timer.
+ * @details The timer is enabled and programmed to trigger after the delay
+ *          specified as parameter.
+ * @note    The associated function is invoked from interrupt context.
+ *
+ * @param[in] hrtp      pointer to the @p HRTDriver object
+ * @param[out] htp      the @p hrt_timer_t structure pointer
+ * @param[in] delay     the number of GPT ticks before the operation
+ *                      timeouts, it must be greater than zero and not
+ *                      greater than @p HRT_MAX_DELAY
+ * @param[in] hrtfunc   the timer callback function. After invoking the
+ *                      callback the timer is disabled and the structure can
+ *                      be disposed or reused.
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @api
+ */
+static inline void hrtSet(HRTDriver *hrtp, hrt_timer_t *htp, hrtcnt_t delay,
+                          hrtfunc_t hrtfunc, void *par) {
+
+  osalSysLock();
+  hrtSetI(hrtp, htp, delay, hrtfunc, par);
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Enables a continuous high resolution timer.
+ * @details The timer is enabled and programmed to trigger after the delay
+ *          specified as parameter, then periodically with the same delay.
+ * @note    The associated function is invoked from interrupt context.
+ *
+ * @param[in] hrtp      pointer to the @p HRTDriver object
+ * @param[out] htp      the @p hrt_timer_t structure pointer
+ * @param[in] delay     the number of GPT ticks before the operation
+ *                      timeouts, it must be greater than zero and not
+ *                      greater than @p HRT_MAX_DELAY
+ * @param[in] hrtfunc   the timer callback function. After invoking the
+ *                      callback the timer is restarted.
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @api
+ */
+static inline void hrtSetContinuous(HRTDriver *hrtp, hrt_timer_t *htp,
+                                    hrtcnt_t delay, hrtfunc_t hrtfunc,
+                                    void *par) {
+
+  osalSysLock();
+  hrtSetContinuousI(hrtp, htp, delay, hrtfunc, par);
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Disables a high resolution timer.
+ * @note    The timer is first checked and disabled only if armed.
+ *
+ * @param[in] htp       the @p hrt_timer_t structure pointer
+ *
+ * @api
+ */
+static inline void hrtReset(hrt_timer_t *htp) {
+
+  osalSysLock();
+  hrtResetI(htp);
+  osalSysUnlock();
+}
+
+#endif /* HAL_USE_GPT == TRUE */
+
+#endif /* HAL_HRT_H */
+
+/** @} */
@@ -0,0 +1,9 @@
+# List of all the HRT subsystem files.
+HRTSRC := $(CHIBIOS)/os/hal/lib/complex/hrt/hal_hrt.c
+
+# Required include directories
+HRTINC := $(CHIBIOS)/os/hal/lib/complex/hrt
+
+# Shared variables
+ALLCSRC += $(HRTSRC)
+ALLINC  += $(HRTINC)
@@ -0,0 +1,246 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/hal_gpt_lld.c
+ * @brief   Posix simulator low level GPT driver code.
+ * @details The simulated timers are clocked by the host monotonic clock,
+ *          the period events are served by @p _sim_check_for_interrupts()
+ *          so the measured jitter includes the simulator polling latency.
+ *
+ * @addtogroup POSIX_GPT
+ * @{
+ */
+
+#include <time.h>
+
+#include "hal.h"
+
+#if HAL_USE_GPT || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/** @brief GPT driver 1 identifier.*/
+#if USE_SIM_GPT1 || defined(__DOXYGEN__)
+GPTDriver GPTD1;
+#endif
+
+/** @brief GPT driver 2 identifier.*/
+#if USE_SIM_GPT2 || defined(__DOXYGEN__)
+GPTDriver GPTD2;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static uint64_t host_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* Timer ticks elapsed since the timer start.*/
+static uint64_t elapsed_ticks(GPTDriver *gptp) {
+
+  return ((host_ns() - gptp->origin) * (uint64_t)gptp->config->frequency) /
+         1000000000ULL;
+}
+
+static bool gptint(GPTDriver *gptp) {
+
+  if (gptp->interval == (gptcnt_t)0) {
+    return false;
+  }
+
+  if (elapsed_ticks(gptp) - gptp->consumed < (uint64_t)gptp->interval) {
+    return false;
+  }
+
+  /* Cycle completed, the next one starts from the exact cycle end.*/
+  gptp->consumed += (uint64_t)gptp->interval;
+  if (gptp->state == GPT_CONTINUOUS) {
+    gptp->interval = gptp->next;
+  }
+
+  /* In one-shot mode the timer is stopped by the common ISR code.*/
+  _gpt_isr_invoke_cb(gptp);
+
+  return true;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level GPT driver initialization.
+ *
+ * @notapi
+ */
+void gpt_lld_init(void) {
+
+#if USE_SIM_GPT1
+  gptObjectInit(&GPTD1);
+  GPTD1.interval = (gptcnt_t)0;
+#endif
+
+#if USE_SIM_GPT2
+  gptObjectInit(&GPTD2);
+  GPTD2.interval = (gptcnt_t)0;
+#endif
+}
+
+/**
+ * @brief   Configures and activates the GPT peripheral.
+ *
+ * @param[in] gptp      pointer to the @p GPTDriver object
+ *
+ * @notapi
+ */
+void gpt_lld_start(GPTDriver *gptp) {
+
+  osalDbgAssert((gptp->config->frequency > 0U) &&
+                (gptp->config->frequency <= 1000000000U),
+                "invalid frequency");
+
+  gptp->interval = (gptcnt_t)0;
+}
+
+/**
+ * @brief   Deactivates the GPT peripheral.
+ *
+ * @param[in] gptp      pointer to the @p GPTDriver object
+ *
+ * @notapi
+ */
+void gpt_lld_stop(GPTDriver *gptp) {
+
+  gptp->interval = (gptcnt_t)0;
+}
+
+/**
+ * @brief   Starts the timer in continuous mode.
+ *
+ * @param[in] gptp      pointer to the @p GPTDriver object
+ * @param[in] interval  period in ticks
+ *
+ * @notapi
+ */
+void gpt_lld_start_timer(GPTDriver *gptp, gptcnt_t interval) {
+
+  gptp->origin   = host_ns();
+  gptp->consumed = 0ULL;
+  gptp->interval = interval;
+  gptp->next     = interval;
+}
+
+/**
+ * @brief   Stops the timer.
+ * @note    A pending period event is discarded.
+ *
+ * @param[in] gptp      pointer to the @p GPTDriver object
+ *
+ * @notapi
+ */
+void gpt_lld_stop_timer(GPTDriver *gptp) {
+
+  gptp->interval = (gptcnt_t)0;
+}
+
+/**
+ * @brief   Starts the timer in one shot mode and waits for completion.
+ * @details This function specifically polls the timer waiting for completion
+ *          in order to not have extra delays caused by interrupt servicing,
+ *          this function is only recommended for short delays.
+ *
+ * @param[in] gptp      pointer to the @p GPTDriver object
+ * @param[in] interval  time interval in ticks
+ *
+ * @notapi
+ */
+void gpt_lld_polled_delay(GPTDriver *gptp, gptcnt_t interval) {
+
+  gptp->origin = host_ns();
+  while (elapsed_ticks(gptp) < (uint64_t)interval) {
+  }
+}
+
+/**
+ * @brief   Returns the counter value of GPT peripheral.
+ * @details The counter is the number of ticks elapsed since the start of
+ *          the cycle or since the last served period event, it exceeds
+ *          the interval while a period event is pending.
+ *
+ * @param[in] gptp      pointer to the @p GPTDriver object
+ * @return              The current counter value.
+ *
+ * @notapi
+ */
+gptcnt_t gpt_lld_get_counter_x(GPTDriver *gptp) {
+  uint64_t cnt;
+
+  if (gptp->interval == (gptcnt_t)0) {
+    return (gptcnt_t)0;
+  }
+
+  /* Relative to the last served cycle end, a pending event does not wrap
+     the counter.*/
+  cnt = elapsed_ticks(gptp) - gptp->consumed;
+
+  return (gptcnt_t)cnt;
+}
+
+/**
+ * @brief   GPT interrupt simulation.
+ *
+ * @return              The interrupt condition.
+ * @retval false        if no period event occurred.
+ * @retval true         if at least one period event has been served.
+ *
+ * @notapi
+ */
+bool gpt_lld_interrupt_pending(void) {
+  bool b = false;
+
+  OSAL_IRQ_PROLOGUE();
+
+#if USE_SIM_GPT1
+  b = gptint(&GPTD1) || b;
+#endif
+#if USE_SIM_GPT2
+  b = gptint(&GPTD2) || b;
+#endif
+
+  OSAL_IRQ_EPILOGUE();
+
+  return b;
+}
+
+#endif /* HAL_USE_GPT */
+
+/** @} */
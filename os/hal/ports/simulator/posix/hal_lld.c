@@ -78,6 +78,12 @@ void _sim_check_for_interrupts(void) {
   }
 #endif
 
+#if HAL_USE_GPT
+  if (gpt_lld_interrupt_pending()) {
+    int_occurred = true;
+  }
+#endif
+
   gettimeofday(&tv, NULL);
   if (timercmp(&tv, &nextcnt, >=)) {
     int_occurred = true;
@@ -33,6 +33,10 @@
  *            are implemented by pairing an input queue and an output queue
  *            together.
  *          .
+ *          A buffer can also hold a reference to an I/O buffer chain
+ *          segment instead of data, this way chains are passed between
+ *          the thread side and the ISR side without copying the data.
+ *          Buffers holding a reference are marked by a zero size field.
  * @{
  */
 
@@ -56,6 +60,90 @@
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Returns the chain referenced by a buffer.
+ *
+ * @param[in] bp        pointer to the buffer, size field included
+ * @return              The pointer to the referenced @p iob_t.
+ * @retval NULL         if the buffer holds data.
+ *
+ * @notapi
+ */
+static iob_t *bq_get_chain(uint8_t *bp) {
+
+  if (*((size_t *)(void *)bp) > 0U) {
+    return NULL;
+  }
+
+  return *((iob_t **)(void *)(bp + sizeof (size_t)));
+}
+
+/**
+ * @brief   Makes a buffer hold a reference to a chain.
+ *
+ * @param[in] bp        pointer to the buffer, size field included
+ * @param[in] iobp      pointer to the referenced @p iob_t
+ *
+ * @notapi
+ */
+static void bq_set_chain(uint8_t *bp, iob_t *iobp) {
+
+  *((size_t *)(void *)bp) = 0U;
+  *((iob_t **)(void *)(bp + sizeof (size_t))) = iobp;
+}
+
+/**
+ * @brief   Releases the chains referenced by the filled buffers.
+ *
+ * @param[in] bqp       pointer to the @p io_buffers_queue_t object
+ * @param[in] n         number of filled buffers starting from the read
+ *                      pointer
+ *
+ * @notapi
+ */
+static void bq_release_chains(io_buffers_queue_t *bqp, size_t n) {
+  uint8_t *bp = bqp->brdptr;
+
+  while (n > 0U) {
+    iob_t *iobp = bq_get_chain(bp);
+
+    if (iobp != NULL) {
+      iobReleaseI(iobp);
+    }
+    bp += bqp->bsize;
+    if (bp >= bqp->btop) {
+      bp = bqp->buffers;
+    }
+    n--;
+  }
+}
+
+/**
+ * @brief   Posts the current buffer, its size field is already written.
+ * @note    The object callback is called after posting the buffer.
+ *
+ * @param[in] obqp      pointer to the @p output_buffers_queue_t object
+ *
+ * @notapi
+ */
+static void obq_post_buffer(output_buffers_queue_t *obqp) {
+
+  /* Posting the buffer in the queue.*/
+  obqp->bcounter--;
+  obqp->bwrptr += obqp->bsize;
+  if (obqp->bwrptr >= obqp->btop) {
+    obqp->bwrptr = obqp->buffers;
+  }
+
+  /* No "current" buffer.*/
+  obqp->ptr = NULL;
+
+  /* Notifying the buffer release.*/
+  if (obqp->notify != NULL) {
+    obqp->notify(obqp);
+  }
+}
+
 /*===========================================================================*/
 /* Driver exported functions.                                                */
 /*===========================================================================*/
@@ -96,7 +184,8 @@ void ibqObjectInit(input_buffers_queue_t *ibqp, bool suspended, uint8_t *bp,
 /**
  * @brief   Resets an input buffers queue.
  * @details All the data in the input buffers queue is erased and lost, any
- *          waiting thread is resumed with status @p MSG_RESET.
+ *          waiting thread is resumed with status @p MSG_RESET. Referenced
+ *          chains are released.
  * @note    A reset operation can be used by a low level driver in order to
  *          obtain immediate attention from the high level layers.
  *
@@ -108,6 +197,7 @@ void ibqResetI(input_buffers_queue_t *ibqp) {
 
   osalDbgCheckClassI();
 
+  bq_release_chains(ibqp, ibqp->bcounter);
   ibqp->bcounter  = 0;
   ibqp->brdptr    = ibqp->buffers;
   ibqp->bwrptr    = ibqp->buffers;
@@ -166,6 +256,41 @@ void ibqPostFullBufferI(input_buffers_queue_t *ibqp, size_t size) {
   osalThreadDequeueNextI(&ibqp->waiting, MSG_OK);
 }
 
+/**
+ * @brief   Posts a filled I/O buffer to the queue.
+ * @details The next empty buffer of the queue takes a reference to the
+ *          I/O buffer instead of its data, this is meant for drivers
+ *          receiving data directly into I/O buffers.
+ * @note    The caller reference to the I/O buffer is passed to the queue.
+ *
+ * @param[in] ibqp      pointer to the @p input_buffers_queue_t object
+ * @param[in] iobp      pointer to a single @p iob_t holding data
+ *
+ * @iclass
+ */
+void ibqPostFullChainI(input_buffers_queue_t *ibqp, iob_t *iobp) {
+
+  osalDbgCheckClassI();
+
+  osalDbgCheck((iobp != NULL) && (iobGetLengthX(iobp) > 0U) &&
+               (iobGetNextX(iobp) == NULL));
+  osalDbgCheck(ibqp->bsize >= (sizeof (size_t) + sizeof (iob_t *)));
+  osalDbgAssert(!ibqIsFullI(ibqp), "buffers queue full");
+
+  /* Writing the reference in the buffer.*/
+  bq_set_chain(ibqp->bwrptr, iobp);
+
+  /* Posting the buffer in the queue.*/
+  ibqp->bcounter++;
+  ibqp->bwrptr += ibqp->bsize;
+  if (ibqp->bwrptr >= ibqp->btop) {
+    ibqp->bwrptr = ibqp->buffers;
+  }
+
+  /* Waking up one waiting thread, if any.*/
+  osalThreadDequeueNextI(&ibqp->waiting, MSG_OK);
+}
+
 /**
  * @brief   Gets the next filled buffer from the queue.
  * @note    The function always acquires the same buffer if called repeatedly.
@@ -221,6 +346,7 @@ msg_t ibqGetFullBufferTimeout(input_buffers_queue_t *ibqp,
    */
   msg_t ibqGetFullBufferTimeoutS(input_buffers_queue_t *ibqp,
                                  sysinterval_t timeout) {
+  iob_t *iobp;
 
   osalDbgCheckClassS();
 
@@ -236,9 +362,17 @@ msg_t ibqGetFullBufferTimeout(input_buffers_queue_t *ibqp,
 
   osalDbgAssert(!ibqIsEmptyI(ibqp), "still empty");
 
-  /* Setting up the "current" buffer and its boundary.*/
-  ibqp->ptr = ibqp->brdptr + sizeof (size_t);
-  ibqp->top = ibqp->ptr + *((size_t *)(void *)ibqp->brdptr);
+  /* Setting up the "current" buffer and its boundary, the data can be
+     in a referenced I/O buffer.*/
+  iobp = bq_get_chain(ibqp->brdptr);
+  if (iobp != NULL) {
+    ibqp->ptr = iobGetDataX(iobp);
+    ibqp->top = ibqp->ptr + iobGetLengthX(iobp);
+  }
+  else {
+    ibqp->ptr = ibqp->brdptr + sizeof (size_t);
+    ibqp->top = ibqp->ptr + *((size_t *)(void *)ibqp->brdptr);
+  }
 
   return MSG_OK;
 }
@@ -261,16 +395,24 @@ void ibqReleaseEmptyBuffer(input_buffers_queue_t *ibqp) {
   /**
    * @brief   Releases the buffer back in the queue.
    * @note    The object callback is called after releasing the buffer.
+   * @note    A referenced I/O buffer is released.
    *
    * @param[in] ibqp      pointer to the @p input_buffers_queue_t object
    *
    * @sclass
    */
   void ibqReleaseEmptyBufferS(input_buffers_queue_t *ibqp) {
+  iob_t *iobp;
 
   osalDbgCheckClassS();
   osalDbgAssert(!ibqIsEmptyI(ibqp), "buffers queue empty");
 
+  /* Releasing the referenced I/O buffer, if any.*/
+  iobp = bq_get_chain(ibqp->brdptr);
+  if (iobp != NULL) {
+    iobReleaseI(iobp);
+  }
+
   /* Freeing a buffer slot in the queue.*/
   ibqp->bcounter--;
   ibqp->brdptr += ibqp->bsize;
@@ -416,6 +558,89 @@ size_t ibqReadTimeout(input_buffers_queue_t *ibqp, uint8_t *bp,
   }
 }
 
+/**
+ * @brief   Input queue chain fetch with timeout.
+ * @details The function takes the next filled buffer from the queue and
+ *          returns the I/O buffer referenced by it, the data is not copied.
+ * @pre     The buffers must have been posted using @p ibqPostFullChainI()
+ *          and no buffer must be partially read.
+ *
+ * @param[in] ibqp      pointer to the @p input_buffers_queue_t object
+ * @param[out] iobpp    pointer to the fetched @p iob_t pointer, the
+ *                      reference is passed to the caller
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if an I/O buffer has been fetched.
+ * @retval MSG_TIMEOUT  if the specified time expired.
+ * @retval MSG_RESET    if the queue has been reset or has been put in
+ *                      suspended state.
+ *
+ * @api
+ */
+msg_t ibqGetChainTimeout(input_buffers_queue_t *ibqp, iob_t **iobpp,
+                         sysinterval_t timeout) {
+  msg_t msg;
+
+  osalSysLock();
+  msg = ibqGetChainTimeoutS(ibqp, iobpp, timeout);
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Input queue chain fetch with timeout.
+ * @details The function takes the next filled buffer from the queue and
+ *          returns the I/O buffer referenced by it, the data is not copied.
+ * @pre     The buffers must have been posted using @p ibqPostFullChainI()
+ *          and no buffer must be partially read.
+ *
+ * @param[in] ibqp      pointer to the @p input_buffers_queue_t object
+ * @param[out] iobpp    pointer to the fetched @p iob_t pointer, the
+ *                      reference is passed to the caller
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if an I/O buffer has been fetched.
+ * @retval MSG_TIMEOUT  if the specified time expired.
+ * @retval MSG_RESET    if the queue has been reset or has been put in
+ *                      suspended state.
+ *
+ * @sclass
+ */
+msg_t ibqGetChainTimeoutS(input_buffers_queue_t *ibqp, iob_t **iobpp,
+                          sysinterval_t timeout) {
+  iob_t *iobp;
+  msg_t msg;
+
+  osalDbgCheckClassS();
+  osalDbgCheck(iobpp != NULL);
+  osalDbgAssert(ibqp->ptr == NULL, "buffer partially read");
+
+  msg = ibqGetFullBufferTimeoutS(ibqp, timeout);
+  if (msg != MSG_OK) {
+    return msg;
+  }
+
+  iobp = bq_get_chain(ibqp->brdptr);
+  osalDbgAssert(iobp != NULL, "not a chain");
+
+  /* The reference held by the buffer is released with the buffer, the
+     caller gets a new one.*/
+  iobAddRefI(iobp);
+  ibqReleaseEmptyBufferS(ibqp);
+  *iobpp = iobp;
+
+  return MSG_OK;
+}
+
 /**
  * @brief   Initializes an output buffers queue object.
  *
@@ -452,7 +677,8 @@ void obqObjectInit(output_buffers_queue_t *obqp, bool suspended, uint8_t *bp,
 /**
  * @brief   Resets an output buffers queue.
  * @details All the data in the output buffers queue is erased and lost, any
- *          waiting thread is resumed with status @p MSG_RESET.
+ *          waiting thread is resumed with status @p MSG_RESET. Referenced
+ *          chains are released.
  * @note    A reset operation can be used by a low level driver in order to
  *          obtain immediate attention from the high level layers.
  *
@@ -464,6 +690,7 @@ void obqResetI(output_buffers_queue_t *obqp) {
 
   osalDbgCheckClassI();
 
+  bq_release_chains(obqp, bqSizeX(obqp) - obqp->bcounter);
   obqp->bcounter  = bqSizeX(obqp);
   obqp->brdptr    = obqp->buffers;
   obqp->bwrptr    = obqp->buffers;
@@ -475,6 +702,8 @@ void obqResetI(output_buffers_queue_t *obqp) {
 /**
  * @brief   Gets the next filled buffer from the queue.
  * @note    The function always returns the same buffer if called repeatedly.
+ * @note    If the buffer references an I/O buffer then its data is
+ *          returned.
  *
  * @param[in] obqp      pointer to the @p output_buffers_queue_t object
  * @param[out] sizep    pointer to the filled buffer size
@@ -485,6 +714,7 @@ void obqResetI(output_buffers_queue_t *obqp) {
  */
 uint8_t *obqGetFullBufferI(output_buffers_queue_t *obqp,
                            size_t *sizep) {
+  iob_t *iobp;
 
   osalDbgCheckClassI();
 
@@ -493,6 +723,13 @@ uint8_t *obqGetFullBufferI(output_buffers_queue_t *obqp,
     return NULL;
   }
 
+  /* The data can be in a referenced I/O buffer.*/
+  iobp = bq_get_chain(obqp->brdptr);
+  if (iobp != NULL) {
+    *sizep = iobGetLengthX(iobp);
+    return iobGetDataX(iobp);
+  }
+
   /* Buffer size.*/
   *sizep = *((size_t *)(void *)obqp->brdptr);
 
@@ -501,16 +738,24 @@ uint8_t *obqGetFullBufferI(output_buffers_queue_t *obqp,
 
 /**
  * @brief   Releases the next filled buffer back in the queue.
+ * @note    A referenced I/O buffer is released.
  *
  * @param[in] obqp      pointer to the @p output_buffers_queue_t object
  *
  * @iclass
  */
 void obqReleaseEmptyBufferI(output_buffers_queue_t *obqp) {
+  iob_t *iobp;
 
   osalDbgCheckClassI();
   osalDbgAssert(!obqIsEmptyI(obqp), "buffers queue empty");
 
+  /* Releasing the referenced I/O buffer, if any.*/
+  iobp = bq_get_chain(obqp->brdptr);
+  if (iobp != NULL) {
+    iobReleaseI(iobp);
+  }
+
   /* Freeing a buffer slot in the queue.*/
   obqp->bcounter++;
   obqp->brdptr += obqp->bsize;
@@ -634,19 +879,7 @@ void obqPostFullBufferS(output_buffers_queue_t *obqp, size_t size) {
   *((size_t *)(void *)obqp->bwrptr) = size;
 
   /* Posting the buffer in the queue.*/
-  obqp->bcounter--;
-  obqp->bwrptr += obqp->bsize;
-  if (obqp->bwrptr >= obqp->btop) {
-    obqp->bwrptr = obqp->buffers;
-  }
-
-  /* No "current" buffer.*/
-  obqp->ptr = NULL;
-
-  /* Notifying the buffer release.*/
-  if (obqp->notify != NULL) {
-    obqp->notify(obqp);
-  }
+  obq_post_buffer(obqp);
 }
 
 /**
@@ -780,6 +1013,79 @@ size_t obqWriteTimeout(output_buffers_queue_t *obqp, const uint8_t *bp,
   }
 }
 
+/**
+ * @brief   Output queue chain write with timeout.
+ * @details The function posts a buffer referencing each segment of a
+ *          chain, the data is not copied and is transmitted from the chain
+ *          buffers. A partially filled buffer is posted first in order to
+ *          preserve the data order. The operation completes when all the
+ *          segments have been posted or after the specified timeout or if
+ *          the queue has been reset.
+ * @note    The queue takes its own references to the segments, the caller
+ *          still owns its reference and can release it after the call.
+ * @note    The chain must not be modified until its segments have been
+ *          released by the queue.
+ *
+ * @param[in] obqp      pointer to the @p output_buffers_queue_t object
+ * @param[in] iobp      pointer to the first @p iob_t of the chain
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes effectively posted.
+ * @retval 0            if a timeout occurred.
+ *
+ * @api
+ */
+size_t obqPostChainTimeout(output_buffers_queue_t *obqp, iob_t *iobp,
+                           sysinterval_t timeout) {
+  size_t w = 0;
+
+  osalDbgCheck(iobp != NULL);
+  osalDbgCheck(obqp->bsize >= (sizeof (size_t) + sizeof (iob_t *)));
+
+  osalSysLock();
+
+  /* Data already written in the current buffer goes first.*/
+  if (obqp->ptr != NULL) {
+    size_t size = ((size_t)obqp->ptr - (size_t)obqp->bwrptr) - sizeof (size_t);
+
+    if (size > 0U) {
+      obqPostFullBufferS(obqp, size);
+    }
+  }
+
+  while (iobp != NULL) {
+    if (iobGetLengthX(iobp) > 0U) {
+      msg_t msg;
+
+      /* Getting an empty buffer using the specified timeout.*/
+      msg = obqGetEmptyBufferTimeoutS(obqp, timeout);
+
+      /* Anything except MSG_OK interrupts the operation.*/
+      if (msg != MSG_OK) {
+        break;
+      }
+
+      /* The buffer takes a reference to the segment.*/
+      iobAddRefI(iobp);
+      bq_set_chain(obqp->bwrptr, iobp);
+      obq_post_buffer(obqp);
+      w += iobGetLengthX(iobp);
+
+      /* Giving a preemption chance.*/
+      osalSysUnlock();
+      osalSysLock();
+    }
+    iobp = iobGetNextX(iobp);
+  }
+
+  osalSysUnlock();
+
+  return w;
+}
+
 /**
  * @brief   Flushes the current, partially filled, buffer to the queue.
  * @note    The notification callback is not invoked because the function
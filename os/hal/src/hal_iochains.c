@@ -0,0 +1,630 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_iochains.c
+ * @brief   I/O Buffer Chains code.
+ *
+ * @addtogroup HAL_IOCHAINS
+ * @details I/O buffer chains allow application protocol layers and
+ *          threads to pass frames by reference instead of copying them.<br>
+ *          Buffers are allocated from fixed size pools and are reference
+ *          counted, a frame larger than a single buffer is represented as
+ *          a chain of buffers. Each buffer link owns a reference to the
+ *          rest of the chain so a whole chain can be shared by adding a
+ *          single reference to its first buffer.<br>
+ *          Chains can be exchanged between ISRs and threads using chains
+ *          queues, posting or fetching a chain moves a reference, data is
+ *          never copied.<br>
+ *          Buffers queues can also hold references to chain segments, see
+ *          @p obqPostChainTimeout(), @p ibqPostFullChainI() and
+ *          @p ibqGetChainTimeout(), this way drivers based on buffers
+ *          queues like the Serial over USB driver transmit and receive
+ *          chains without copying.
+ * @note    Streams are not chains aware, data is copied when a chain is
+ *          written to a stream using @p iobStreamWrite().
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Takes the oldest chain from a chains queue.
+ * @pre     The queue must not be empty.
+ *
+ * @param[in] qp        pointer to the @p iob_queue_t object
+ * @return              The chain pointer.
+ */
+static iob_t *iobq_get(iob_queue_t *qp) {
+  iob_t *iobp;
+
+  iobp = *qp->rdptr++;
+  if (qp->rdptr >= qp->top) {
+    qp->rdptr = qp->buffer;
+  }
+  qp->cnt--;
+
+  return iobp;
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an I/O buffers pool.
+ *
+ * @param[out] pp       pointer to the @p iob_pool_t object
+ * @param[in] size      size of the buffers data area
+ * @param[in] p         pointer to a memory area for @p n buffers of
+ *                      @p IOB_BUFFER_SIZE(size) bytes each, the area must
+ *                      be aligned as a pointer
+ * @param[in] n         number of buffers
+ *
+ * @init
+ */
+void iobPoolObjectInit(iob_pool_t *pp, size_t size, void *p, size_t n) {
+  uint8_t *bp = (uint8_t *)p;
+
+  osalDbgCheck((pp != NULL) && (size > 0U) && (p != NULL));
+
+  osalThreadQueueObjectInit(&pp->waiting);
+  pp->free  = NULL;
+  pp->size  = size;
+  pp->nfree = n;
+  while (n > 0U) {
+    iob_t *iobp = (iob_t *)(void *)bp;
+
+    iobp->next = pp->free;
+    iobp->pool = pp;
+    pp->free   = iobp;
+    bp += IOB_BUFFER_SIZE(size);
+    n--;
+  }
+}
+
+/**
+ * @brief   Allocates a buffer from a pool.
+ * @details The buffer is returned with a single reference, no valid data
+ *          and no successor.
+ *
+ * @param[in] pp        pointer to the @p iob_pool_t object
+ * @return              The pointer to the allocated buffer.
+ * @retval NULL         if the pool is empty.
+ *
+ * @iclass
+ */
+iob_t *iobAllocI(iob_pool_t *pp) {
+  iob_t *iobp;
+
+  osalDbgCheckClassI();
+  osalDbgCheck(pp != NULL);
+
+  iobp = pp->free;
+  if (iobp != NULL) {
+    pp->free     = iobp->next;
+    pp->nfree--;
+    iobp->next   = NULL;
+    iobp->refs   = 1U;
+    iobp->offset = 0U;
+    iobp->len    = 0U;
+  }
+
+  return iobp;
+}
+
+/**
+ * @brief   Allocates a buffer from a pool.
+ * @details The buffer is returned with a single reference, no valid data
+ *          and no successor. If the pool is empty then the function waits
+ *          for a buffer to be released.
+ *
+ * @param[in] pp        pointer to the @p iob_pool_t object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the allocated buffer.
+ * @retval NULL         if the specified time expired.
+ *
+ * @api
+ */
+iob_t *iobAllocTimeout(iob_pool_t *pp, sysinterval_t timeout) {
+  iob_t *iobp;
+
+  osalSysLock();
+  while (true) {
+    iobp = iobAllocI(pp);
+    if (iobp != NULL) {
+      break;
+    }
+    if (osalThreadEnqueueTimeoutS(&pp->waiting, timeout) != MSG_OK) {
+      break;
+    }
+  }
+  osalSysUnlock();
+
+  return iobp;
+}
+
+/**
+ * @brief   Adds a reference to a chain.
+ *
+ * @param[in] iobp      pointer to the first @p iob_t of the chain
+ *
+ * @iclass
+ */
+void iobAddRefI(iob_t *iobp) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck(iobp != NULL);
+  osalDbgAssert(iobp->refs > 0U, "not referenced");
+
+  iobp->refs++;
+}
+
+/**
+ * @brief   Adds a reference to a chain.
+ *
+ * @param[in] iobp      pointer to the first @p iob_t of the chain
+ *
+ * @api
+ */
+void iobAddRef(iob_t *iobp) {
+
+  osalSysLock();
+  iobAddRefI(iobp);
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Releases a reference to a chain.
+ * @details Buffers whose last reference is released are returned to their
+ *          pools, releasing a buffer releases its reference to the rest of
+ *          the chain.
+ *
+ * @param[in] iobp      pointer to the first @p iob_t of the chain
+ *
+ * @iclass
+ */
+void iobReleaseI(iob_t *iobp) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck(iobp != NULL);
+
+  while (iobp != NULL) {
+    iob_pool_t *pp = iobp->pool;
+    iob_t *next;
+
+    osalDbgAssert(iobp->refs > 0U, "not referenced");
+
+    if (--iobp->refs > 0U) {
+      break;
+    }
+
+    next = iobp->next;
+    iobp->next = pp->free;
+    pp->free = iobp;
+    pp->nfree++;
+    osalThreadDequeueNextI(&pp->waiting, MSG_OK);
+    iobp = next;
+  }
+}
+
+/**
+ * @brief   Releases a reference to a chain.
+ * @details Buffers whose last reference is released are returned to their
+ *          pools, releasing a buffer releases its reference to the rest of
+ *          the chain.
+ *
+ * @param[in] iobp      pointer to the first @p iob_t of the chain
+ *
+ * @api
+ */
+void iobRelease(iob_t *iobp) {
+
+  osalSysLock();
+  iobReleaseI(iobp);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Concatenates two chains.
+ * @details The @p tail chain is linked after the last buffer of the
+ *          @p head chain, the caller reference to @p tail is passed to
+ *          the @p head chain.
+ * @pre     The @p head chain must not be shared.
+ *
+ * @param[in] head      pointer to the first @p iob_t of the head chain
+ * @param[in] tail      pointer to the first @p iob_t of the tail chain
+ *
+ * @xclass
+ */
+void iobCat(iob_t *head, iob_t *tail) {
+
+  osalDbgCheck((head != NULL) && (tail != NULL));
+
+  while (head->next != NULL) {
+    osalDbgAssert(head->refs == 1U, "shared chain");
+    head = head->next;
+  }
+  osalDbgAssert(head->refs == 1U, "shared chain");
+  head->next = tail;
+}
+
+/**
+ * @brief   Returns the total size of the valid data in a chain.
+ *
+ * @param[in] iobp      pointer to the first @p iob_t of the chain
+ * @return              The size of the chain data.
+ *
+ * @xclass
+ */
+size_t iobGetChainLength(const iob_t *iobp) {
+  size_t n = 0U;
+
+  while (iobp != NULL) {
+    n += iobp->len;
+    iobp = iobp->next;
+  }
+
+  return n;
+}
+
+/**
+ * @brief   Removes data from the head of a buffer.
+ * @details This function is meant to be used by protocol layers in order
+ *          to strip their header before passing the chain to the upper
+ *          layer.
+ * @pre     The buffer must not be shared.
+ *
+ * @param[in] iobp      pointer to an @p iob_t object
+ * @param[in] n         number of bytes to be removed
+ * @return              The operation status.
+ * @retval false        if the data has been removed.
+ * @retval true         if the buffer holds less than @p n bytes.
+ *
+ * @xclass
+ */
+bool iobAdvance(iob_t *iobp, size_t n) {
+
+  osalDbgCheck(iobp != NULL);
+
+  if (n > iobp->len) {
+    return true;
+  }
+
+  iobp->offset += n;
+  iobp->len    -= n;
+
+  return false;
+}
+
+/**
+ * @brief   Copies data out of a chain.
+ * @details This function is meant to be used by parsers in order to access
+ *          headers spanning multiple buffers.
+ *
+ * @param[in] iobp      pointer to the first @p iob_t of the chain
+ * @param[in] offset    offset of the data within the chain
+ * @param[out] bp       pointer to the destination buffer
+ * @param[in] n         maximum number of bytes to be copied
+ * @return              The number of bytes effectively copied.
+ *
+ * @xclass
+ */
+size_t iobRead(const iob_t *iobp, size_t offset, uint8_t *bp, size_t n) {
+  size_t r = 0U;
+
+  osalDbgCheck(bp != NULL);
+
+  while ((iobp != NULL) && (r < n)) {
+    if (offset >= iobp->len) {
+      offset -= iobp->len;
+    }
+    else {
+      size_t size = iobp->len - offset;
+      if (size > (n - r)) {
+        size = n - r;
+      }
+      memcpy(bp + r, iobGetDataX(iobp) + offset, size);
+      r += size;
+      offset = 0U;
+    }
+    iobp = iobp->next;
+  }
+
+  return r;
+}
+
+/**
+ * @brief   Appends data to a chain.
+ * @details Data is appended after the valid data of the last buffer of the
+ *          chain, up to the buffer capacity.
+ * @note    Nothing is appended if the last buffer is shared, either
+ *          directly or through a shared buffer preceding it in the chain,
+ *          because the data would become visible to the other owners.
+ *
+ * @param[in] iobp      pointer to the first @p iob_t of the chain
+ * @param[in] bp        pointer to the source buffer
+ * @param[in] n         maximum number of bytes to be appended
+ * @return              The number of bytes effectively appended.
+ * @retval 0            if the last buffer is full or shared.
+ *
+ * @xclass
+ */
+size_t iobAppend(iob_t *iobp, const uint8_t *bp, size_t n) {
+  size_t size;
+
+  osalDbgCheck((iobp != NULL) && (bp != NULL));
+
+  while (true) {
+    if (iobp->refs > 1U) {
+      return 0U;
+    }
+    if (iobp->next == NULL) {
+      break;
+    }
+    iobp = iobp->next;
+  }
+
+  size = iobp->pool->size - (iobp->offset + iobp->len);
+  if (size > n) {
+    size = n;
+  }
+  memcpy(iobGetDataX(iobp) + iobp->len, bp, size);
+  iobp->len += size;
+
+  return size;
+}
+
+/**
+ * @brief   Writes a chain on a stream.
+ * @details Each buffer of the chain is written on the stream in place, the
+ *          chain is never linearized.
+ * @note    The stream copies the data, the chain can be released after
+ *          the function returns.
+ *
+ * @param[in] stp       pointer to a @p BaseSequentialStream object
+ * @param[in] iobp      pointer to the first @p iob_t of the chain
+ * @return              The number of bytes effectively written.
+ *
+ * @api
+ */
+size_t iobStreamWrite(BaseSequentialStream *stp, const iob_t *iobp) {
+  size_t w = 0U;
+
+  osalDbgCheck(stp != NULL);
+
+  while (iobp != NULL) {
+    if (iobp->len > 0U) {
+      size_t n = streamWrite(stp, iobGetDataX(iobp), iobp->len);
+      w += n;
+      if (n < iobp->len) {
+        break;
+      }
+    }
+    iobp = iobp->next;
+  }
+
+  return w;
+}
+
+/**
+ * @brief   Initializes a chains queue.
+ *
+ * @param[out] qp       pointer to the @p iob_queue_t object
+ * @param[in] buf       pointer to the queue buffer
+ * @param[in] n         number of elements in the queue buffer
+ *
+ * @init
+ */
+void iobqObjectInit(iob_queue_t *qp, iob_t **buf, size_t n) {
+
+  osalDbgCheck((qp != NULL) && (buf != NULL) && (n > 0U));
+
+  osalThreadQueueObjectInit(&qp->qr);
+  osalThreadQueueObjectInit(&qp->qw);
+  qp->buffer = buf;
+  qp->top    = buf + n;
+  qp->wrptr  = buf;
+  qp->rdptr  = buf;
+  qp->cnt    = 0U;
+}
+
+/**
+ * @brief   Resets a chains queue.
+ * @details All the queued chains are released, any waiting thread is
+ *          resumed with status @p MSG_RESET.
+ *
+ * @param[in] qp        pointer to the @p iob_queue_t object
+ *
+ * @iclass
+ */
+void iobqResetI(iob_queue_t *qp) {
+
+  osalDbgCheckClassI();
+
+  while (qp->cnt > 0U) {
+    iobReleaseI(iobq_get(qp));
+  }
+  qp->wrptr = qp->buffer;
+  qp->rdptr = qp->buffer;
+  osalThreadDequeueAllI(&qp->qr, MSG_RESET);
+  osalThreadDequeueAllI(&qp->qw, MSG_RESET);
+}
+
+/**
+ * @brief   Posts a chain into a chains queue.
+ * @details The caller reference to the chain is passed to the queue.
+ *
+ * @param[in] qp        pointer to the @p iob_queue_t object
+ * @param[in] iobp      pointer to the first @p iob_t of the chain
+ * @return              The operation status.
+ * @retval MSG_OK       if the chain has been posted.
+ * @retval MSG_TIMEOUT  if the queue is full, the caller still owns the
+ *                      chain reference.
+ *
+ * @iclass
+ */
+msg_t iobqPostI(iob_queue_t *qp, iob_t *iobp) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((qp != NULL) && (iobp != NULL));
+
+  if (qp->cnt >= (size_t)(qp->top - qp->buffer)) {
+    return MSG_TIMEOUT;
+  }
+
+  *qp->wrptr++ = iobp;
+  if (qp->wrptr >= qp->top) {
+    qp->wrptr = qp->buffer;
+  }
+  qp->cnt++;
+  osalThreadDequeueNextI(&qp->qr, MSG_OK);
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Posts a chain into a chains queue.
+ * @details The caller reference to the chain is passed to the queue. If
+ *          the queue is full then the function waits for a free slot.
+ *
+ * @param[in] qp        pointer to the @p iob_queue_t object
+ * @param[in] iobp      pointer to the first @p iob_t of the chain
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the chain has been posted.
+ * @retval MSG_TIMEOUT  if the specified time expired, the caller still owns
+ *                      the chain reference.
+ * @retval MSG_RESET    if the queue has been reset, the caller still owns
+ *                      the chain reference.
+ *
+ * @api
+ */
+msg_t iobqPostTimeout(iob_queue_t *qp, iob_t *iobp, sysinterval_t timeout) {
+  msg_t msg;
+
+  osalSysLock();
+  while (true) {
+    msg = iobqPostI(qp, iobp);
+    if (msg == MSG_OK) {
+      osalOsRescheduleS();
+      break;
+    }
+    msg = osalThreadEnqueueTimeoutS(&qp->qw, timeout);
+    if (msg != MSG_OK) {
+      break;
+    }
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Fetches a chain from a chains queue.
+ * @details The queue reference to the chain is passed to the caller.
+ *
+ * @param[in] qp        pointer to the @p iob_queue_t object
+ * @param[out] iobpp    pointer to the fetched chain pointer
+ * @return              The operation status.
+ * @retval MSG_OK       if a chain has been fetched.
+ * @retval MSG_TIMEOUT  if the queue is empty.
+ *
+ * @iclass
+ */
+msg_t iobqFetchI(iob_queue_t *qp, iob_t **iobpp) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((qp != NULL) && (iobpp != NULL));
+
+  if (qp->cnt == 0U) {
+    return MSG_TIMEOUT;
+  }
+
+  *iobpp = iobq_get(qp);
+  osalThreadDequeueNextI(&qp->qw, MSG_OK);
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Fetches a chain from a chains queue.
+ * @details The queue reference to the chain is passed to the caller. If
+ *          the queue is empty then the function waits for a chain.
+ *
+ * @param[in] qp        pointer to the @p iob_queue_t object
+ * @param[out] iobpp    pointer to the fetched chain pointer
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a chain has been fetched.
+ * @retval MSG_TIMEOUT  if the specified time expired.
+ * @retval MSG_RESET    if the queue has been reset.
+ *
+ * @api
+ */
+msg_t iobqFetchTimeout(iob_queue_t *qp, iob_t **iobpp,
+                       sysinterval_t timeout) {
+  msg_t msg;
+
+  osalSysLock();
+  while (true) {
+    msg = iobqFetchI(qp, iobpp);
+    if (msg == MSG_OK) {
+      osalOsRescheduleS();
+      break;
+    }
+    msg = osalThreadEnqueueTimeoutS(&qp->qr, timeout);
+    if (msg != MSG_OK) {
+      break;
+    }
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+/** @} */
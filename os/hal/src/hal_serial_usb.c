@@ -71,6 +71,18 @@ static bool sdu_start_receive(SerialUSBDriver *sdup) {
     return true;
   }
 
+  /* If a pool is configured then data is received into an I/O buffer,
+     the buffer of an interrupted transaction is reused.*/
+  if (sdup->config->pool != NULL) {
+    if (sdup->rxiobp == NULL) {
+      sdup->rxiobp = iobAllocI(sdup->config->pool);
+      if (sdup->rxiobp == NULL) {
+        return true;
+      }
+    }
+    buf = iobGetDataX(sdup->rxiobp);
+  }
+
   /* Buffer found, starting a new transaction.*/
   usbStartReceiveI(sdup->config->usbp, sdup->config->bulk_out,
                    buf, SERIAL_USB_BUFFERS_SIZE);
@@ -224,6 +236,7 @@ void sduObjectInit(SerialUSBDriver *sdup) {
   sdup->vmt = &vmt;
   osalEventObjectInit(&sdup->event);
   sdup->state = SDU_STOP;
+  sdup->rxiobp = NULL;
   ibqObjectInit(&sdup->ibqueue, true, sdup->ib,
                 SERIAL_USB_BUFFERS_SIZE, SERIAL_USB_BUFFERS_NUMBER,
                 ibnotify, sdup);
@@ -245,6 +258,8 @@ msg_t sduStart(SerialUSBDriver *sdup, const SerialUSBConfig *config) {
   USBDriver *usbp = config->usbp;
 
   osalDbgCheck(sdup != NULL);
+  osalDbgCheck((config->pool == NULL) ||
+               (config->pool->size >= SERIAL_USB_BUFFERS_SIZE));
 
   osalSysLock();
   osalDbgAssert((sdup->state == SDU_STOP) || (sdup->state == SDU_READY),
@@ -291,6 +306,12 @@ void sduStop(SerialUSBDriver *sdup) {
   sdup->config = NULL;
   sdup->state  = SDU_STOP;
 
+  /* Releasing the I/O buffer of an interrupted receive transaction.*/
+  if (sdup->rxiobp != NULL) {
+    iobReleaseI(sdup->rxiobp);
+    sdup->rxiobp = NULL;
+  }
+
   /* Enforces a disconnection.*/
   chnAddFlagsI(sdup, CHN_DISCONNECTED);
   ibqResetI(&sdup->ibqueue);
@@ -508,8 +529,16 @@ void sduDataReceived(USBDriver *usbp, usbep_t ep) {
     /* Signaling that data is available in the input queue.*/
     chnAddFlagsI(sdup, CHN_INPUT_AVAILABLE);
 
-    /* Posting the filled buffer in the queue.*/
-    ibqPostFullBufferI(&sdup->ibqueue, size);
+    /* Posting the filled buffer in the queue, an I/O buffer is posted
+       by reference.*/
+    if (sdup->rxiobp != NULL) {
+      iobSetLengthX(sdup->rxiobp, size);
+      ibqPostFullChainI(&sdup->ibqueue, sdup->rxiobp);
+      sdup->rxiobp = NULL;
+    }
+    else {
+      ibqPostFullBufferI(&sdup->ibqueue, size);
+    }
   }
 
   /* The endpoint cannot be busy, we are in the context of the callback,
@@ -553,6 +582,73 @@ msg_t sduControl(USBDriver *usbp, unsigned int operation, void *arg) {
   return _ctl((void *)usbp, operation, arg);
 }
 
+/**
+ * @brief   Sends a chain by reference.
+ * @details The chain segments are transmitted directly from the chain
+ *          buffers, the data is not copied.
+ * @note    The driver takes its own references to the segments, the caller
+ *          still owns its reference and can release it after the call.
+ *
+ * @param[in] sdup      pointer to a @p SerialUSBDriver object
+ * @param[in] iobp      pointer to the first @p iob_t of the chain
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of bytes effectively queued.
+ * @retval 0            if a timeout occurred.
+ *
+ * @api
+ */
+size_t sduSendChainTimeout(SerialUSBDriver *sdup, iob_t *iobp,
+                           sysinterval_t timeout) {
+
+  osalDbgCheck(sdup != NULL);
+
+  return obqPostChainTimeout(&sdup->obqueue, iobp, timeout);
+}
+
+/**
+ * @brief   Receives a buffer by reference.
+ * @details The function returns the I/O buffer the data has been received
+ *          into, the data is not copied.
+ * @pre     The driver must have been configured with an I/O buffers pool
+ *          and the input data must not be read using the stream functions.
+ * @note    If the pool was empty when a receive transaction had to be
+ *          started then the transaction is started again by this function.
+ *
+ * @param[in] sdup      pointer to a @p SerialUSBDriver object
+ * @param[out] iobpp    pointer to the received @p iob_t pointer, the
+ *                      reference is passed to the caller
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if an I/O buffer has been received.
+ * @retval MSG_TIMEOUT  if the specified time expired.
+ * @retval MSG_RESET    if the driver has been stopped or disconnected.
+ *
+ * @api
+ */
+msg_t sduReceiveChainTimeout(SerialUSBDriver *sdup, iob_t **iobpp,
+                             sysinterval_t timeout) {
+  msg_t msg;
+
+  osalDbgCheck(sdup != NULL);
+
+  osalSysLock();
+  osalDbgAssert((sdup->config != NULL) && (sdup->config->pool != NULL),
+                "no pool");
+  (void) sdu_start_receive(sdup);
+  msg = ibqGetChainTimeoutS(&sdup->ibqueue, iobpp, timeout);
+  osalSysUnlock();
+
+  return msg;
+}
+
 #endif /* HAL_USE_SERIAL_USB == TRUE */
 
 /** @} */
@@ -183,6 +183,31 @@
 #include "chconf.h"
 #include "chlicense.h"
 
+/**
+ * @brief   Threads bitmaps.
+ * @details If enabled then the ready threads and the threads waiting on
+ *          threads queues and semaphores are tracked using bitmaps, the
+ *          highest priority thread is found with a single count leading
+ *          zeros operation instead of scanning the threads array.
+ * @note    The default is @p FALSE.
+ * @note    Threads queues and semaphores require an extra bitmap field.
+ */
+#if !defined(CH_CFG_USE_THREADS_BITMAPS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_THREADS_BITMAPS          FALSE
+#endif
+
+/**
+ * @brief   Timeouts heap.
+ * @details If enabled then the threads waiting with a timeout are kept in
+ *          a min-heap ordered by deadline, the system timer handler only
+ *          processes the expired threads instead of scanning the threads
+ *          array.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_TIMEOUTS_HEAP) || defined(__DOXYGEN__)
+#define CH_CFG_USE_TIMEOUTS_HEAP            FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -477,6 +502,14 @@ typedef thread_t * thread_reference_t;
  */
 typedef struct nil_threads_queue threads_queue_t;
 
+#if (CH_CFG_USE_THREADS_BITMAPS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a threads bitmap.
+ * @note    The thread in priority slot zero is associated to the MSB.
+ */
+typedef uint16_t threads_map_t;
+#endif
+
 #if (CH_CFG_USE_SEMAPHORES == TRUE) || defined(__DOXYGEN__)
 /**
  * @brief   Type of a structure representing a semaphore.
@@ -494,6 +527,9 @@ typedef threads_queue_t semaphore_t;
  */
 struct nil_threads_queue {
   volatile cnt_t    cnt;        /**< @brief Threads Queue counter.          */
+#if (CH_CFG_USE_THREADS_BITMAPS == TRUE) || defined(__DOXYGEN__)
+  threads_map_t     map;        /**< @brief Bitmap of the waiting threads.  */
+#endif
 };
 
 /**
@@ -530,8 +566,15 @@ struct nil_thread {
     eventmask_t         ewmask;     /**< @brief Enabled events mask.        */
 #endif
   } u1;
+#if (CH_CFG_USE_TIMEOUTS_HEAP == TRUE) || defined(__DOXYGEN__)
+  systime_t             deadline;   /**< @brief Timeout absolute time.      */
+  uint8_t               heapidx;    /**< @brief Position in the timeouts
+                                                heap plus one, zero if
+                                                disabled.                   */
+#else
   volatile sysinterval_t timeout;   /**< @brief Timeout counter, zero
                                                 if disabled.                */
+#endif
 #if (CH_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
   eventmask_t           epmask;     /**< @brief Pending events mask.        */
 #endif
@@ -561,6 +604,25 @@ struct nil_os_instance {
    *          or to an higher priority thread if a switch is required.
    */
   thread_t              *next;
+#if (CH_CFG_USE_THREADS_BITMAPS == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Bitmap of the ready threads.
+   * @note    The idle thread is not part of the bitmap, it is selected
+   *          when the bitmap is empty.
+   */
+  threads_map_t         rdymap;
+#endif
+#if (CH_CFG_USE_TIMEOUTS_HEAP == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Number of threads in the timeouts heap.
+   */
+  ucnt_t                heapcnt;
+  /**
+   * @brief   Timeouts heap, the thread with the nearest deadline is the
+   *          first element.
+   */
+  thread_t              *heap[CH_CFG_MAX_THREADS];
+#endif
 #if (CH_CFG_ST_TIMEDELTA == 0) || defined(__DOXYGEN__)
   /**
    * @brief   System time.
@@ -617,6 +679,41 @@ struct nil_os_instance {
  */
 #define __CH_STRINGIFY(a) #a
 
+#if (CH_CFG_USE_THREADS_BITMAPS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @name    Threads bitmaps
+ * @{
+ */
+/**
+ * @brief   Count leading zeros of a non-zero value.
+ * @note    It can be redefined in @p chconf.h in order to use a specific
+ *          compiler intrinsic, the default uses the GCC built-in.
+ *
+ * @param[in] n         the value, it must not be zero
+ */
+#if !defined(NIL_CLZ) || defined(__DOXYGEN__)
+#define NIL_CLZ(n)                                                          \
+  ((tprio_t)__builtin_clzl((unsigned long)(n)) -                            \
+   (tprio_t)((sizeof (unsigned long) - sizeof (threads_map_t)) * 8U))
+#endif
+
+/**
+ * @brief   Returns the bitmap bit associated to a thread.
+ *
+ * @param[in] tp        pointer to the thread
+ */
+#define NIL_THD_BIT(tp)                                                     \
+  (threads_map_t)((threads_map_t)0x8000U >> ((tp) - &nil.threads[0]))
+
+/**
+ * @brief   Returns the highest priority thread in a threads bitmap.
+ *
+ * @param[in] map       the threads bitmap, it must not be empty
+ */
+#define NIL_MAP_FIRST(map) (&nil.threads[NIL_CLZ(map)])
+/** @} */
+#endif
+
 /**
  * @name    Threads tables definition macros
  * @{
@@ -961,7 +1058,11 @@ struct nil_os_instance {
  *
  * @param[in] name      the name of the threads queue variable
  */
+#if (CH_CFG_USE_THREADS_BITMAPS == TRUE) || defined(__DOXYGEN__)
+#define __THREADS_QUEUE_DATA(name) {(cnt_t)0, (threads_map_t)0}
+#else
 #define __THREADS_QUEUE_DATA(name) {(cnt_t)0}
+#endif
 
 /**
  * @brief   Static threads queue object initializer.
@@ -1223,7 +1324,12 @@ struct nil_os_instance {
  *
  * @init
  */
+#if (CH_CFG_USE_THREADS_BITMAPS == TRUE) || defined(__DOXYGEN__)
+#define chThdQueueObjectInit(tqp)                                           \
+  ((tqp)->cnt = (cnt_t)0, (tqp)->map = (threads_map_t)0)
+#else
 #define chThdQueueObjectInit(tqp) ((tqp)->cnt = (cnt_t)0)
+#endif
 
 /**
  * @brief   Evaluates to @p true if the specified queue is empty.
@@ -1389,7 +1495,8 @@ extern const thread_descriptor_t nil_thd_configs[];
 extern "C" {
 #endif
   thread_t *nil_find_thread(tstate_t state, void *p);
-  cnt_t nil_ready_all(void *p, cnt_t cnt, msg_t msg);
+  thread_t *nil_dequeue_thread(threads_queue_t *tqp);
+  cnt_t nil_ready_all(threads_queue_t *tqp, cnt_t cnt, msg_t msg);
   void chSysInit(void);
   void chSysHalt(const char *reason);
   void chSysTimerHandlerI(void);
@@ -63,7 +63,11 @@
  * @param[in] n         the counter initial value, this value must be
  *                      non-negative
  */
+#if (CH_CFG_USE_THREADS_BITMAPS == TRUE) || defined(__DOXYGEN__)
+#define __SEMAPHORE_DATA(name, n) {n, (threads_map_t)0}
+#else
 #define __SEMAPHORE_DATA(name, n) {n}
+#endif
 
 /**
  * @brief   Static semaphore initializer.
@@ -90,7 +94,11 @@
  *
  * @init
  */
+#if (CH_CFG_USE_THREADS_BITMAPS == TRUE) || defined(__DOXYGEN__)
+#define chSemObjectInit(sp, n) ((sp)->cnt = (n), (sp)->map = (threads_map_t)0)
+#else
 #define chSemObjectInit(sp, n) ((sp)->cnt = (n))
+#endif
 
 /**
  * @brief   Performs a reset operation on the semaphore.
@@ -48,6 +48,159 @@ os_instance_t nil;
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_TIMEOUTS_HEAP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Time reference for the deadlines in the timeouts heap.
+ * @note    All the deadlines in the heap follow this time so they can be
+ *          compared using their distance from it.
+ */
+#if (CH_CFG_ST_TIMEDELTA == 0) || defined(__DOXYGEN__)
+#define HEAP_BASE_TIME()    (nil.systime)
+#else
+#define HEAP_BASE_TIME()    (nil.lasttime)
+#endif
+
+/**
+ * @brief   Determines if a thread deadline precedes another.
+ *
+ * @param[in] atp       pointer to the first thread
+ * @param[in] btp       pointer to the second thread
+ * @return              The comparison result.
+ */
+static bool heap_precedes(thread_t *atp, thread_t *btp) {
+  systime_t base = HEAP_BASE_TIME();
+
+  return (bool)(chTimeDiffX(base, atp->deadline) <
+                chTimeDiffX(base, btp->deadline));
+}
+
+/**
+ * @brief   Stores a thread in a timeouts heap position.
+ *
+ * @param[in] i         heap position
+ * @param[in] tp        pointer to the thread
+ */
+static void heap_place(ucnt_t i, thread_t *tp) {
+
+  nil.heap[i] = tp;
+  tp->heapidx = (uint8_t)(i + (ucnt_t)1);
+}
+
+/**
+ * @brief   Moves a timeouts heap element toward the root.
+ *
+ * @param[in] i         heap position of the element
+ */
+static void heap_sift_up(ucnt_t i) {
+  thread_t *tp = nil.heap[i];
+
+  while (i > (ucnt_t)0) {
+    ucnt_t parent = (i - (ucnt_t)1) / (ucnt_t)2;
+
+    if (!heap_precedes(tp, nil.heap[parent])) {
+      break;
+    }
+    heap_place(i, nil.heap[parent]);
+    i = parent;
+  }
+  heap_place(i, tp);
+}
+
+/**
+ * @brief   Moves a timeouts heap element toward the leaves.
+ *
+ * @param[in] i         heap position of the element
+ */
+static void heap_sift_down(ucnt_t i) {
+  thread_t *tp = nil.heap[i];
+
+  while (true) {
+    ucnt_t child = (i * (ucnt_t)2) + (ucnt_t)1;
+
+    if (child >= nil.heapcnt) {
+      break;
+    }
+    if (((child + (ucnt_t)1) < nil.heapcnt) &&
+        heap_precedes(nil.heap[child + (ucnt_t)1], nil.heap[child])) {
+      child++;
+    }
+    if (!heap_precedes(nil.heap[child], tp)) {
+      break;
+    }
+    heap_place(i, nil.heap[child]);
+    i = child;
+  }
+  heap_place(i, tp);
+}
+
+/**
+ * @brief   Inserts a thread in the timeouts heap.
+ *
+ * @param[in] tp        pointer to the thread, the deadline must be set
+ */
+static void heap_insert(thread_t *tp) {
+  ucnt_t i = nil.heapcnt;
+
+  chDbgAssert(i < (ucnt_t)CH_CFG_MAX_THREADS, "heap overflow");
+
+  nil.heap[i] = tp;
+  nil.heapcnt = i + (ucnt_t)1;
+  heap_sift_up(i);
+}
+
+/**
+ * @brief   Removes a thread from the timeouts heap.
+ *
+ * @param[in] tp        pointer to the thread
+ */
+static void heap_remove(thread_t *tp) {
+  ucnt_t i = (ucnt_t)tp->heapidx - (ucnt_t)1;
+
+  chDbgAssert(nil.heap[i] == tp, "not in heap");
+
+  tp->heapidx = (uint8_t)0;
+  nil.heapcnt--;
+  if (i < nil.heapcnt) {
+    nil.heap[i] = nil.heap[nil.heapcnt];
+    if ((i > (ucnt_t)0) &&
+        heap_precedes(nil.heap[i], nil.heap[(i - (ucnt_t)1) / (ucnt_t)2])) {
+      heap_sift_up(i);
+    }
+    else {
+      heap_sift_down(i);
+    }
+  }
+}
+
+/**
+ * @brief   Wakes up a thread whose timeout expired.
+ *
+ * @param[in] tp        pointer to the thread, it must be the first
+ *                      element of the timeouts heap
+ */
+static void heap_timeout(thread_t *tp) {
+
+  chDbgAssert(!NIL_THD_IS_READY(tp), "is ready");
+
+  heap_remove(tp);
+
+  /* Timeout on thread queues requires a special handling because the
+     counter must be incremented.*/
+  if (NIL_THD_IS_WTQUEUE(tp)) {
+    tp->u1.tqp->cnt++;
+#if CH_CFG_USE_THREADS_BITMAPS == TRUE
+    tp->u1.tqp->map &= (threads_map_t)~NIL_THD_BIT(tp);
+#endif
+  }
+  else {
+    if (NIL_THD_IS_SUSPENDED(tp)) {
+      *tp->u1.trp = NULL;
+    }
+  }
+  (void) chSchReadyI(tp, MSG_TIMEOUT);
+}
+#endif /* CH_CFG_USE_TIMEOUTS_HEAP == TRUE */
+
 /*===========================================================================*/
 /* Module interrupt handlers.                                                */
 /*===========================================================================*/
@@ -81,10 +234,40 @@ thread_t *nil_find_thread(tstate_t state, void *p) {
 }
 
 /**
- * @brief   Puts in ready state all thread matching the specified status and
- *          associated object.
+ * @brief   Retrieves the highest priority thread waiting on a threads queue.
+ * @note    The thread is removed from the queue bitmap, if enabled, but it
+ *          is not readied.
  *
- * @param[in] p         object pointer
+ * @param[in] tqp       pointer to the threads queue object
+ * @return              The pointer to the found thread.
+ * @retval NULL         if the thread is not found.
+ *
+ * @notapi
+ */
+thread_t *nil_dequeue_thread(threads_queue_t *tqp) {
+#if CH_CFG_USE_THREADS_BITMAPS == TRUE
+  thread_t *tp;
+
+  if (tqp->map == (threads_map_t)0) {
+    return NULL;
+  }
+
+  tp = NIL_MAP_FIRST(tqp->map);
+  tqp->map &= (threads_map_t)~NIL_THD_BIT(tp);
+
+  chDbgAssert(NIL_THD_IS_WTQUEUE(tp) && (tp->u1.tqp == tqp),
+              "not waiting on queue");
+
+  return tp;
+#else
+  return nil_find_thread(NIL_STATE_WTQUEUE, (void *)tqp);
+#endif
+}
+
+/**
+ * @brief   Puts in ready state all the threads waiting on a threads queue.
+ *
+ * @param[in] tqp       pointer to the threads queue object
  * @param[in] cnt       number of threads to be readied as a negative number,
  *                      non negative numbers are ignored
  * @param[in] msg       the wakeup message
@@ -92,8 +275,19 @@ thread_t *nil_find_thread(tstate_t state, void *p) {
  *
  * @notapi
  */
-cnt_t nil_ready_all(void *p, cnt_t cnt, msg_t msg) {
-  thread_t *tp = nil.threads;;
+cnt_t nil_ready_all(threads_queue_t *tqp, cnt_t cnt, msg_t msg) {
+#if CH_CFG_USE_THREADS_BITMAPS == TRUE
+
+  while (cnt < (cnt_t)0) {
+    thread_t *tp = nil_dequeue_thread(tqp);
+
+    chDbgAssert(tp != NULL, "thread not found");
+
+    cnt++;
+    (void) chSchReadyI(tp, msg);
+  }
+#else
+  thread_t *tp = nil.threads;
 
   while (cnt < (cnt_t)0) {
 
@@ -101,12 +295,13 @@ cnt_t nil_ready_all(void *p, cnt_t cnt, msg_t msg) {
                 "pointer out of range");
 
     /* Is this thread waiting on this queue?*/
-    if ((tp->state == NIL_STATE_WTQUEUE) && (tp->u1.p == p)) {
+    if ((tp->state == NIL_STATE_WTQUEUE) && (tp->u1.tqp == tqp)) {
       cnt++;
       (void) chSchReadyI(tp, msg);
     }
     tp++;
   }
+#endif
 
   return cnt;
 }
@@ -356,7 +551,59 @@ void chSysTimerHandlerI(void) {
 
   chDbgCheckClassI();
 
+#if CH_CFG_USE_TIMEOUTS_HEAP == TRUE
 #if CH_CFG_ST_TIMEDELTA == 0
+  nil.systime++;
+
+  /* Only the threads whose deadline is the current time are processed,
+     deadlines are always in the future so the heap first element is
+     either expired or all the other elements are not.*/
+  while (nil.heapcnt > (ucnt_t)0) {
+    thread_t *tp = nil.heap[0];
+
+    if (tp->deadline != nil.systime) {
+      break;
+    }
+    heap_timeout(tp);
+
+    /* Lock released in order to give a preemption chance on those
+       architectures supporting IRQ preemption.*/
+    chSysUnlockFromISR();
+    chSysLockFromISR();
+  }
+#else
+  sysinterval_t elapsed;
+
+  chDbgAssert(nil.nexttime == port_timer_get_alarm(), "time mismatch");
+
+  /* Processing all the threads whose deadline is not after the time of
+     this event.*/
+  elapsed = chTimeDiffX(nil.lasttime, nil.nexttime);
+  while (nil.heapcnt > (ucnt_t)0) {
+    thread_t *tp = nil.heap[0];
+
+    if (chTimeDiffX(nil.lasttime, tp->deadline) > elapsed) {
+      break;
+    }
+    heap_timeout(tp);
+
+    /* Lock released in order to give a preemption chance on those
+       architectures supporting IRQ preemption.*/
+    chSysUnlockFromISR();
+    chSysLockFromISR();
+  }
+
+  nil.lasttime = nil.nexttime;
+  if (nil.heapcnt > (ucnt_t)0) {
+    nil.nexttime = nil.heap[0]->deadline;
+    port_timer_set_alarm(nil.nexttime);
+  }
+  else {
+    /* No tick event needed.*/
+    port_timer_stop_alarm();
+  }
+#endif
+#elif CH_CFG_ST_TIMEDELTA == 0
   thread_t *tp = &nil.threads[0];
   nil.systime++;
   do {
@@ -373,6 +620,9 @@ void chSysTimerHandlerI(void) {
 #if CH_CFG_USE_SEMAPHORES == TRUE
         if (NIL_THD_IS_WTQUEUE(tp)) {
           tp->u1.semp->cnt++;
+#if CH_CFG_USE_THREADS_BITMAPS == TRUE
+          tp->u1.semp->map &= (threads_map_t)~NIL_THD_BIT(tp);
+#endif
         }
         else
 #endif
@@ -414,6 +664,9 @@ void chSysTimerHandlerI(void) {
            counter must be incremented.*/
         if (NIL_THD_IS_WTQUEUE(tp)) {
           tp->u1.tqp->cnt++;
+#if CH_CFG_USE_THREADS_BITMAPS == TRUE
+          tp->u1.tqp->map &= (threads_map_t)~NIL_THD_BIT(tp);
+#endif
         }
         else {
           if (NIL_THD_IS_SUSPENDED(tp)) {
@@ -587,7 +840,21 @@ thread_t *chSchReadyI(thread_t *tp, msg_t msg) {
 
   tp->u1.msg = msg;
   tp->state = NIL_STATE_READY;
+#if CH_CFG_USE_TIMEOUTS_HEAP == TRUE
+  if (tp->heapidx != (uint8_t)0) {
+    heap_remove(tp);
+#if CH_CFG_ST_TIMEDELTA > 0
+    if (nil.heapcnt == (ucnt_t)0) {
+      port_timer_stop_alarm();
+    }
+#endif
+  }
+#else
   tp->timeout = (sysinterval_t)0;
+#endif
+#if CH_CFG_USE_THREADS_BITMAPS == TRUE
+  nil.rdymap |= NIL_THD_BIT(tp);
+#endif
   if (tp < nil.next) {
     nil.next = tp;
   }
@@ -671,7 +938,42 @@ msg_t chSchGoSleepTimeoutS(tstate_t newstate, sysinterval_t timeout) {
   /* Storing the wait object for the current thread.*/
   otp->state = newstate;
 
+#if CH_CFG_USE_TIMEOUTS_HEAP == TRUE
+  if (timeout != TIME_INFINITE) {
 #if CH_CFG_ST_TIMEDELTA > 0
+    systime_t now = chVTGetSystemTimeX();
+
+    /* TIMEDELTA makes sure to have enough time to reprogram the timer
+       before the free-running timer counter reaches the selected timeout.*/
+    if (timeout < (sysinterval_t)CH_CFG_ST_TIMEDELTA) {
+      timeout = (sysinterval_t)CH_CFG_ST_TIMEDELTA;
+    }
+
+    /* If the heap is empty then the heap base time is moved forward to
+       the current time.*/
+    if (nil.heapcnt == (ucnt_t)0) {
+      nil.lasttime = now;
+    }
+    otp->deadline = chTimeAddX(now, timeout);
+    heap_insert(otp);
+
+    /* The alarm is reprogrammed if this thread has the nearest deadline,
+       the alarm is only active while the heap is not empty.*/
+    if (nil.heap[0] == otp) {
+      if (nil.heapcnt == (ucnt_t)1) {
+        port_timer_start_alarm(otp->deadline);
+      }
+      else {
+        port_timer_set_alarm(otp->deadline);
+      }
+      nil.nexttime = otp->deadline;
+    }
+#else
+    otp->deadline = chTimeAddX(nil.systime, timeout);
+    heap_insert(otp);
+#endif
+  }
+#elif CH_CFG_ST_TIMEDELTA > 0
   if (timeout != TIME_INFINITE) {
     systime_t abstime;
 
@@ -707,6 +1009,23 @@ msg_t chSchGoSleepTimeoutS(tstate_t newstate, sysinterval_t timeout) {
   otp->timeout = timeout;
 #endif
 
+#if CH_CFG_USE_THREADS_BITMAPS == TRUE
+  /* The highest priority ready thread is taken from the ready bitmap, the
+     idle thread is selected if the bitmap is empty.*/
+  nil.rdymap &= (threads_map_t)~NIL_THD_BIT(otp);
+  if (nil.rdymap != (threads_map_t)0) {
+    ntp = NIL_MAP_FIRST(nil.rdymap);
+  }
+  else {
+    ntp = &nil.threads[CH_CFG_MAX_THREADS];
+  }
+  nil.current = nil.next = ntp;
+  if (ntp == &nil.threads[CH_CFG_MAX_THREADS]) {
+    CH_CFG_IDLE_ENTER_HOOK();
+  }
+  port_switch(ntp, otp);
+  return nil.current->u1.msg;
+#else
   /* Scanning the whole threads array.*/
   ntp = nil.threads;
   while (true) {
@@ -725,6 +1044,7 @@ msg_t chSchGoSleepTimeoutS(tstate_t newstate, sysinterval_t timeout) {
     chDbgAssert(ntp <= &nil.threads[CH_CFG_MAX_THREADS],
                 "pointer out of range");
   }
+#endif
 }
 
 /**
@@ -1014,6 +1334,9 @@ msg_t chThdEnqueueTimeoutS(threads_queue_t *tqp, sysinterval_t timeout) {
   }
 
   tqp->cnt--;
+#if CH_CFG_USE_THREADS_BITMAPS == TRUE
+  tqp->map |= NIL_THD_BIT(nil.current);
+#endif
   nil.current->u1.tqp = tqp;
   return chSchGoSleepTimeoutS(NIL_STATE_WTQUEUE, timeout);
 }
@@ -1035,7 +1358,7 @@ void chThdDoDequeueNextI(threads_queue_t *tqp, msg_t msg) {
   chDbgAssert(tqp->cnt < (cnt_t)0, "empty queue");
 
   tqp->cnt++;
-  tp = nil_find_thread(NIL_STATE_WTQUEUE, (void *)tqp);
+  tp = nil_dequeue_thread(tqp);
 
   chDbgAssert(tp != NULL, "thread not found");
 
@@ -1074,7 +1397,7 @@ void chThdDequeueAllI(threads_queue_t *tqp, msg_t msg) {
   chDbgCheckClassI();
   chDbgCheck(tqp != NULL);
 
-  tqp->cnt = nil_ready_all((void *)tqp, tqp->cnt, msg);
+  tqp->cnt = nil_ready_all(tqp, tqp->cnt, msg);
 }
 
 /** @} */
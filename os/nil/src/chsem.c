@@ -115,6 +115,9 @@ msg_t chSemWaitTimeoutS(semaphore_t *sp, sysinterval_t timeout) {
       return MSG_TIMEOUT;
     }
     sp->cnt = cnt - (cnt_t)1;
+#if CH_CFG_USE_THREADS_BITMAPS == TRUE
+    sp->map |= NIL_THD_BIT(nil.current);
+#endif
     nil.current->u1.semp = sp;
 
     return chSchGoSleepTimeoutS(NIL_STATE_WTQUEUE, timeout);
@@ -156,7 +159,7 @@ void chSemSignalI(semaphore_t *sp) {
   chDbgCheck(sp != NULL);
 
   if (++sp->cnt <= (cnt_t)0) {
-    thread_t *tp = nil_find_thread(NIL_STATE_WTQUEUE, (void *)sp);
+    thread_t *tp = nil_dequeue_thread(sp);
 
     chDbgAssert(tp != NULL, "thread not found");
 
@@ -216,7 +219,7 @@ void chSemResetWithMessageI(semaphore_t *sp, cnt_t n, msg_t msg) {
   sp->cnt = n;
 
   /* Does nothing for cnt >= 0, calling anyway.*/
-  (void) nil_ready_all((void *)sp, cnt, msg);
+  (void) nil_ready_all(sp, cnt, msg);
 }
 
 #endif /* CH_CFG_USE_SEMAPHORES == TRUE */
@@ -67,6 +67,10 @@
 #error "CH_CFG_USE_JOBS requires CH_CFG_USE_MAILBOXES"
 #endif
 
+#if (CH_CFG_USE_DELAYED_JOBS == TRUE) && !defined(__CHIBIOS_RT__)
+#error "CH_CFG_USE_DELAYED_JOBS requires ChibiOS/RT"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -104,6 +108,71 @@ typedef struct ch_job_descriptor {
   void                      *jobarg;
 } job_descriptor_t;
 
+#if (CH_CFG_USE_DELAYED_JOBS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a delayed job.
+ * @note    Delayed jobs are allocated by the caller, a job descriptor is
+ *          taken from the jobs queue pool only when the job is due.
+ */
+typedef struct ch_delayed_job {
+  /**
+   * @brief   Delta list element.
+   * @note    The @p next field is @p NULL when the job is not scheduled.
+   */
+  ch_delta_list_t           dlist;
+  /**
+   * @brief   Job function.
+   */
+  job_function_t            jobfunc;
+  /**
+   * @brief   Argument to be passed to the job function.
+   */
+  void                      *jobarg;
+  /**
+   * @brief   Reload period or zero for one-shot jobs.
+   */
+  sysinterval_t             period;
+} delayed_job_t;
+
+/**
+ * @brief   Type of a jobs timer.
+ * @details A jobs timer keeps any number of delayed jobs in a delta list
+ *          using a single virtual timer armed on the nearest deadline.
+ */
+typedef struct ch_jobs_timer {
+  /**
+   * @brief   Jobs queue where the due jobs are posted.
+   */
+  jobs_queue_t              *jqp;
+  /**
+   * @brief   Delta list header.
+   */
+  ch_delta_list_t           dlist;
+  /**
+   * @brief   System time of the delta list base.
+   */
+  systime_t                 lasttime;
+  /**
+   * @brief   Shared virtual timer.
+   */
+  virtual_timer_t           vt;
+  /**
+   * @brief   Number of jobs posted by this timer.
+   */
+  ucnt_t                    posted;
+  /**
+   * @brief   Number of due jobs merged with an identical job due at the
+   *          same tick.
+   */
+  ucnt_t                    coalesced;
+  /**
+   * @brief   Number of due jobs dropped because no job descriptor was
+   *          available in the jobs queue.
+   */
+  ucnt_t                    missed;
+} jobs_timer_t;
+#endif /* CH_CFG_USE_DELAYED_JOBS == TRUE */
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -116,6 +185,17 @@ typedef struct ch_job_descriptor {
 extern "C" {
 #endif
 
+#if CH_CFG_USE_DELAYED_JOBS == TRUE
+  void chJobTimerObjectInit(jobs_timer_t *jtp, jobs_queue_t *jqp);
+  void chJobPostDelayedI(jobs_timer_t *jtp, delayed_job_t *djp,
+                         sysinterval_t delay, sysinterval_t period,
+                         job_function_t jobfunc, void *jobarg);
+  void chJobPostDelayed(jobs_timer_t *jtp, delayed_job_t *djp,
+                        sysinterval_t delay, sysinterval_t period,
+                        job_function_t jobfunc, void *jobarg);
+  bool chJobCancelI(jobs_timer_t *jtp, delayed_job_t *djp);
+  bool chJobCancel(jobs_timer_t *jtp, delayed_job_t *djp);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -390,6 +470,40 @@ static inline msg_t chJobDispatchTimeout(jobs_queue_t *jqp,
   return msg;
 }
 
+#if (CH_CFG_USE_DELAYED_JOBS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a delayed job object.
+ * @note    Initializing a delayed job object is not strictly required
+ *          because the function @p chJobPostDelayedI() initializes the
+ *          object too. This function is only useful if you need to
+ *          perform a @p chDelayedJobIsScheduledI() check before calling
+ *          @p chJobPostDelayedI().
+ *
+ * @param[out] djp      pointer to a @p delayed_job_t structure
+ *
+ * @init
+ */
+static inline void chDelayedJobObjectInit(delayed_job_t *djp) {
+
+  djp->dlist.next = NULL;
+}
+
+/**
+ * @brief   Returns @p true if the specified delayed job is scheduled.
+ *
+ * @param[in] djp       pointer to a @p delayed_job_t structure
+ * @return              true if the job is scheduled.
+ *
+ * @iclass
+ */
+static inline bool chDelayedJobIsScheduledI(const delayed_job_t *djp) {
+
+  chDbgCheckClassI();
+
+  return (bool)(djp->dlist.next != NULL);
+}
+#endif /* CH_CFG_USE_DELAYED_JOBS == TRUE */
+
 #endif /* CH_CFG_USE_JOBS == TRUE */
 
 #endif /* CHJOBS_H */
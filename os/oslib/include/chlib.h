@@ -120,6 +120,18 @@
 #error "CH_CFG_USE_JOBS not defined in chconf.h"
 #endif
 
+#if !defined(CH_CFG_USE_DELAYED_JOBS)
+#error "CH_CFG_USE_DELAYED_JOBS not defined in chconf.h"
+#endif
+
+#if !defined(CH_CFG_USE_TOPICS)
+#error "CH_CFG_USE_TOPICS not defined in chconf.h"
+#endif
+
+#if !defined(CH_CFG_USE_TASKS)
+#error "CH_CFG_USE_TASKS not defined in chconf.h"
+#endif
+
 /* Objects factory options checks.*/
 #if !defined(CH_CFG_USE_FACTORY)
 #error "CH_CFG_USE_FACTORY not defined in chconf.h"
@@ -186,6 +198,8 @@
 #undef CH_CFG_USE_OBJ_CACHES
 #undef CH_CFG_USE_DELEGATES
 #undef CH_CFG_USE_JOBS
+#undef CH_CFG_USE_TOPICS
+#undef CH_CFG_USE_TASKS
 
 #define CH_CFG_USE_HEAP                     FALSE
 #define CH_CFG_USE_MEMPOOLS                 FALSE
@@ -194,6 +208,8 @@
 #define CH_CFG_USE_OBJ_CACHES               FALSE
 #define CH_CFG_USE_DELEGATES                FALSE
 #define CH_CFG_USE_JOBS                     FALSE
+#define CH_CFG_USE_TOPICS                   FALSE
+#define CH_CFG_USE_TASKS                    FALSE
 
 #endif /* (CH_CUSTOMER_LIC_OSLIB == FALSE) ||
           (CH_LICENSE_FEATURES == CH_FEATURES_BASIC) */
@@ -235,6 +251,8 @@
 #include "chobjcaches.h"
 #include "chdelegates.h"
 #include "chjobs.h"
+#include "chtopics.h"
+#include "chtasks.h"
 #include "chfactory.h"
 
 /*===========================================================================*/
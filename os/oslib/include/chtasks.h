@@ -0,0 +1,387 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    oslib/include/chtasks.h
+ * @brief   Stackless Tasks macros and structures.
+ *
+ * @addtogroup oslib_tasks
+ * @{
+ */
+
+#ifndef CHTASKS_H
+#define CHTASKS_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Task states
+ * @{
+ */
+#define TASK_STATE_READY        (task_state_t)0 /**< @brief Ready or yielded. */
+#define TASK_STATE_SLEEPING     (task_state_t)1 /**< @brief Sleeping.         */
+#define TASK_STATE_WTEVENTS     (task_state_t)2 /**< @brief Waiting events.   */
+#define TASK_STATE_POLLING      (task_state_t)3 /**< @brief Waiting for a
+                                                            condition.        */
+#define TASK_STATE_RUNNING      (task_state_t)4 /**< @brief Running.          */
+#define TASK_STATE_FINAL        (task_state_t)5 /**< @brief Terminated.       */
+/** @} */
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+#if (CH_CFG_USE_TASKS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a task state.
+ */
+typedef uint8_t task_state_t;
+
+/**
+ * @brief   Type of a stackless task.
+ */
+typedef struct ch_task task_t;
+
+/**
+ * @brief   Type of a task function.
+ * @details The function runs the task until its next wait point then
+ *          returns the state the task has to be put in.
+ */
+typedef task_state_t (*task_func_t)(task_t *tp);
+
+/**
+ * @brief   Type of a tasks executor.
+ */
+typedef struct ch_task_executor {
+  /**
+   * @brief   First task in the ready list.
+   */
+  task_t                    *rhead;
+  /**
+   * @brief   Last task in the ready list.
+   */
+  task_t                    *rtail;
+  /**
+   * @brief   Sleeping tasks ordered by wakeup time.
+   */
+  task_t                    *sleeping;
+  /**
+   * @brief   Tasks waiting for a condition.
+   */
+  task_t                    *polling;
+  /**
+   * @brief   Executor thread while waiting for tasks to become ready.
+   */
+  thread_reference_t        thread;
+  /**
+   * @brief   Number of started tasks not yet terminated.
+   */
+  ucnt_t                    ntasks;
+  /**
+   * @brief   Number of task switches performed.
+   */
+  ucnt_t                    switches;
+  /**
+   * @brief   Polling tasks have to check their condition again.
+   */
+  bool                      pollreq;
+} task_executor_t;
+
+/**
+ * @brief   Structure representing a stackless task.
+ * @note    Task functions do not keep local variables across wait points,
+ *          the task state must be kept in a structure containing the
+ *          @p task_t or pointed by the task argument.
+ */
+struct ch_task {
+  /**
+   * @brief   Next task in the executor list the task is linked to.
+   */
+  task_t                    *next;
+  /**
+   * @brief   Executor running the task.
+   */
+  task_executor_t           *executor;
+  /**
+   * @brief   Task function.
+   */
+  task_func_t               func;
+  /**
+   * @brief   Task argument.
+   */
+  void                      *arg;
+  /**
+   * @brief   Wakeup time of a sleeping task.
+   */
+  systime_t                 wakeup;
+  /**
+   * @brief   Pending events mask.
+   */
+  eventmask_t               epending;
+  /**
+   * @brief   Events the task is waiting for.
+   */
+  eventmask_t               ewmask;
+  /**
+   * @brief   Continuation point in the task function.
+   */
+  uint16_t                  lc;
+  /**
+   * @brief   Current task state.
+   */
+  task_state_t              state;
+};
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Task function declaration.
+ *
+ * @param[in] tname     task function name
+ * @param[in] tp        name of the task pointer parameter
+ */
+#define TASK_FUNCTION(tname, tp) task_state_t tname(task_t *tp)
+
+/**
+ * @name    Task functions macros
+ * @note    The continuation points are identified by source line numbers,
+ *          only one wait macro can be used on each line and task functions
+ *          must be in source files having less than 65536 lines.
+ * @note    The wait macros cannot be used inside @p switch statements.
+ * @{
+ */
+/**
+ * @brief   Task function body start.
+ *
+ * @param[in] tp        pointer to the task
+ */
+#define TASK_BEGIN(tp)                                                      \
+  switch ((tp)->lc) {                                                       \
+  case 0U:
+
+/**
+ * @brief   Task function body end, the task terminates.
+ *
+ * @param[in] tp        pointer to the task
+ */
+#define TASK_END(tp)                                                        \
+  default:                                                                  \
+    break;                                                                  \
+  }                                                                         \
+  (tp)->lc = 0U;                                                            \
+  return TASK_STATE_FINAL
+
+/**
+ * @brief   Terminates the task.
+ *
+ * @param[in] tp        pointer to the task
+ */
+#define TASK_EXIT(tp) do {                                                  \
+  (tp)->lc = 0U;                                                            \
+  return TASK_STATE_FINAL;                                                  \
+} while (false)
+
+/**
+ * @brief   Returns to the executor in the specified state, the task
+ *          resumes from the following statement.
+ * @note    Not meant for use in application code.
+ *
+ * @param[in] tp        pointer to the task
+ * @param[in] s         the new task state
+ */
+#define __TASK_SWITCH(tp, s)                                                \
+  (tp)->lc = (uint16_t)__LINE__;                                            \
+  return (s);                                                               \
+  case (uint16_t)__LINE__:
+
+/**
+ * @brief   Yields to the other ready tasks.
+ *
+ * @param[in] tp        pointer to the task
+ */
+#define TASK_YIELD(tp) do {                                                 \
+  __TASK_SWITCH(tp, TASK_STATE_READY);                                      \
+} while (false)
+
+/**
+ * @brief   Suspends the task for the specified time interval.
+ *
+ * @param[in] tp        pointer to the task
+ * @param[in] interval  the sleep interval, it cannot be @p TIME_INFINITE
+ */
+#define TASK_SLEEP(tp, interval) do {                                       \
+  (tp)->wakeup = chTimeAddX(chVTGetSystemTimeX(), (interval));              \
+  __TASK_SWITCH(tp, TASK_STATE_SLEEPING);                                   \
+} while (false)
+
+/**
+ * @brief   Suspends the task until the specified absolute time.
+ * @note    The time must be in the future or at most half the system time
+ *          range in the past.
+ *
+ * @param[in] tp        pointer to the task
+ * @param[in] abstime   the wakeup time
+ */
+#define TASK_SLEEP_UNTIL(tp, abstime) do {                                  \
+  (tp)->wakeup = (abstime);                                                 \
+  __TASK_SWITCH(tp, TASK_STATE_SLEEPING);                                   \
+} while (false)
+
+/**
+ * @brief   Waits for any of the specified events.
+ * @details The events are not cleared, use @p chTaskGetAndClearEvents()
+ *          after the wait.
+ *
+ * @param[in] tp        pointer to the task
+ * @param[in] mask      mask of the events to wait for
+ */
+#define TASK_WAIT_EVENTS(tp, mask) do {                                     \
+  (tp)->ewmask = (mask);                                                    \
+  __TASK_SWITCH(tp, TASK_STATE_WTEVENTS);                                   \
+} while (false)
+
+/**
+ * @brief   Waits until the specified condition is true.
+ * @details The condition is checked again each time other tasks run, the
+ *          executor is notified or the task receives events.
+ * @note    Threads and ISRs making the condition true must notify the
+ *          executor using @p chTaskExecutorNotify() or
+ *          @p chTaskExecutorNotifyI().
+ *
+ * @param[in] tp        pointer to the task
+ * @param[in] cond      the condition expression
+ */
+#define TASK_WAIT_UNTIL(tp, cond) do {                                      \
+  while (!(cond)) {                                                         \
+    __TASK_SWITCH(tp, TASK_STATE_POLLING);                                  \
+  }                                                                         \
+} while (false)
+
+#if (CH_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Fetches a message from a mailbox, waits while the mailbox is
+ *          empty.
+ * @note    Threads posting to the mailbox must notify the executor.
+ *
+ * @param[in] tp        pointer to the task
+ * @param[in] mbp       pointer to a @p mailbox_t object
+ * @param[out] msgp     pointer to a message variable, it must not be a
+ *                      local variable of the task function
+ */
+#define TASK_MB_FETCH(tp, mbp, msgp)                                        \
+  TASK_WAIT_UNTIL(tp, chMBFetchTimeout((mbp), (msgp), TIME_IMMEDIATE) ==    \
+                      MSG_OK)
+
+/**
+ * @brief   Posts a message into a mailbox, waits while the mailbox is full.
+ * @note    Threads fetching from the mailbox must notify the executor.
+ *
+ * @param[in] tp        pointer to the task
+ * @param[in] mbp       pointer to a @p mailbox_t object
+ * @param[in] msg       the message to be posted, it is evaluated each time
+ *                      the post is attempted
+ */
+#define TASK_MB_POST(tp, mbp, msg)                                          \
+  TASK_WAIT_UNTIL(tp, chMBPostTimeout((mbp), (msg), TIME_IMMEDIATE) ==      \
+                      MSG_OK)
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chTaskExecutorObjectInit(task_executor_t *tep);
+  void chTaskExecutorRun(task_executor_t *tep);
+  void chTaskExecutorNotifyI(task_executor_t *tep);
+  void chTaskExecutorNotify(task_executor_t *tep);
+  void chTaskObjectInit(task_t *tp, task_func_t func, void *arg);
+  void chTaskStartI(task_executor_t *tep, task_t *tp);
+  void chTaskStart(task_executor_t *tep, task_t *tp);
+  void chTaskSignalI(task_t *tp, eventmask_t events);
+  void chTaskSignal(task_t *tp, eventmask_t events);
+  eventmask_t chTaskGetAndClearEvents(task_t *tp, eventmask_t events);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the argument of a task.
+ *
+ * @param[in] tp        pointer to the task
+ * @return              The task argument.
+ *
+ * @xclass
+ */
+static inline void *chTaskGetArgX(task_t *tp) {
+
+  return tp->arg;
+}
+
+/**
+ * @brief   Returns the state of a task.
+ *
+ * @param[in] tp        pointer to the task
+ * @return              The task state.
+ *
+ * @xclass
+ */
+static inline task_state_t chTaskGetStateX(task_t *tp) {
+
+  return tp->state;
+}
+
+/**
+ * @brief   Returns the number of task switches performed by an executor.
+ *
+ * @param[in] tep       pointer to the @p task_executor_t object
+ * @return              The number of task switches.
+ *
+ * @xclass
+ */
+static inline ucnt_t chTaskExecutorGetSwitchesX(task_executor_t *tep) {
+
+  return tep->switches;
+}
+
+#endif /* CH_CFG_USE_TASKS == TRUE */
+
+#endif /* CHTASKS_H */
+
+/** @} */
@@ -0,0 +1,296 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    oslib/include/chtopics.h
+ * @brief   Publish/Subscribe Topics macros and structures.
+ *
+ * @addtogroup oslib_topics
+ * @{
+ */
+
+#ifndef CHTOPICS_H
+#define CHTOPICS_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+#if (CH_CFG_USE_TOPICS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CH_CFG_USE_MEMPOOLS == FALSE
+#error "CH_CFG_USE_TOPICS requires CH_CFG_USE_MEMPOOLS"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a topic.
+ */
+typedef struct ch_topic topic_t;
+
+/**
+ * @brief   Type of a topic subscriber.
+ */
+typedef struct ch_topic_subscriber topic_subscriber_t;
+
+/**
+ * @brief   Subscriber queue overflow policies.
+ */
+typedef enum {
+  /**
+   * @brief   The newly published message is not queued.
+   */
+  TOPIC_POLICY_DROP_NEWEST      = 0,
+  /**
+   * @brief   The oldest queued message is dropped.
+   */
+  TOPIC_POLICY_DROP_OLDEST      = 1,
+  /**
+   * @brief   Only the last published message is retained.
+   * @note    No queue buffer is required by subscribers using this policy.
+   */
+  TOPIC_POLICY_LAST_VALUE       = 2
+} topic_policy_t;
+
+/**
+ * @brief   Header of a topic message.
+ * @details The message payload follows the header, messages are allocated
+ *          from the topic pool and are shared by reference among all the
+ *          subscribers, the message is returned to the pool when the last
+ *          reference is released.
+ */
+typedef struct ch_topic_message {
+  /**
+   * @brief   Topic owning this message.
+   */
+  topic_t                   *topic;
+  /**
+   * @brief   Number of references to this message.
+   */
+  cnt_t                     refs;
+} topic_message_t;
+
+/**
+ * @brief   Topic statistics.
+ */
+typedef struct ch_topic_stats {
+  /**
+   * @brief   Number of published messages.
+   */
+  ucnt_t                    published;
+  /**
+   * @brief   Number of message references queued to subscribers.
+   */
+  ucnt_t                    delivered;
+  /**
+   * @brief   Number of message references dropped by subscribers queues.
+   */
+  ucnt_t                    dropped;
+  /**
+   * @brief   Number of failed message allocations.
+   */
+  ucnt_t                    nomem;
+} topic_stats_t;
+
+/**
+ * @brief   Structure representing a topic.
+ */
+struct ch_topic {
+  /**
+   * @brief   Topic name or @p NULL.
+   */
+  const char                *name;
+  /**
+   * @brief   Pool of the free messages.
+   */
+  memory_pool_t             pool;
+  /**
+   * @brief   List of the subscribers.
+   */
+  topic_subscriber_t        *subscribers;
+  /**
+   * @brief   Topic statistics.
+   */
+  topic_stats_t             stats;
+};
+
+/**
+ * @brief   Structure representing a topic subscriber.
+ */
+struct ch_topic_subscriber {
+  /**
+   * @brief   Next subscriber of the same topic.
+   */
+  topic_subscriber_t        *next;
+  /**
+   * @brief   Subscribed topic or @p NULL.
+   */
+  topic_t                   *topic;
+  /**
+   * @brief   Pointer to the queue buffer.
+   */
+  topic_message_t           **buffer;
+  /**
+   * @brief   Pointer to the location after the buffer.
+   */
+  topic_message_t           **top;
+  /**
+   * @brief   Write pointer.
+   */
+  topic_message_t           **wrptr;
+  /**
+   * @brief   Read pointer.
+   */
+  topic_message_t           **rdptr;
+  /**
+   * @brief   Messages in queue.
+   */
+  size_t                    cnt;
+  /**
+   * @brief   Queue overflow policy.
+   */
+  topic_policy_t            policy;
+  /**
+   * @brief   Single slot buffer used by the last-value policy.
+   */
+  topic_message_t           *slot;
+  /**
+   * @brief   Queued readers.
+   */
+  threads_queue_t           qr;
+  /**
+   * @brief   Number of messages dropped by this subscriber queue.
+   */
+  ucnt_t                    dropped;
+};
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of a topic message with the specified payload size.
+ * @details This macro can be used to size the messages buffer passed to
+ *          @p chTopicObjectInit().
+ *
+ * @param[in] n         the payload size
+ */
+#define TOPIC_MESSAGE_SIZE(n)                                               \
+  MEM_ALIGN_NEXT(sizeof (topic_message_t) + (size_t)(n), PORT_NATURAL_ALIGN)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chTopicObjectInit(topic_t *tp, const char *name, size_t size,
+                         void *msgbuf, size_t n);
+  void chTopicSubscribe(topic_t *tp, topic_subscriber_t *sp,
+                        topic_message_t **buf, size_t n,
+                        topic_policy_t policy);
+  void chTopicUnsubscribe(topic_subscriber_t *sp);
+  topic_message_t *chTopicAllocI(topic_t *tp);
+  topic_message_t *chTopicAlloc(topic_t *tp);
+  void chTopicPublishI(topic_message_t *tmp);
+  void chTopicPublishS(topic_message_t *tmp);
+  void chTopicPublish(topic_message_t *tmp);
+  msg_t chTopicFetchI(topic_subscriber_t *sp, topic_message_t **tmpp);
+  msg_t chTopicFetchTimeoutS(topic_subscriber_t *sp, topic_message_t **tmpp,
+                             sysinterval_t timeout);
+  msg_t chTopicFetchTimeout(topic_subscriber_t *sp, topic_message_t **tmpp,
+                            sysinterval_t timeout);
+  void chTopicReleaseI(topic_message_t *tmp);
+  void chTopicRelease(topic_message_t *tmp);
+  void chTopicGetStats(topic_t *tp, topic_stats_t *tsp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns a pointer to the message payload.
+ *
+ * @param[in] tmp       pointer to a @p topic_message_t structure
+ * @return              Pointer to the message payload.
+ *
+ * @xclass
+ */
+static inline void *chTopicGetPayloadX(topic_message_t *tmp) {
+
+  /*lint -save -e9087 [11.3] Safe cast.*/
+  return (void *)(tmp + 1);
+  /*lint -restore*/
+}
+
+/**
+ * @brief   Adds a reference to a message.
+ * @details Subscribers can keep a message beyond its release by adding a
+ *          reference, each added reference must be released.
+ *
+ * @param[in] tmp       pointer to a @p topic_message_t structure
+ * @return              The message pointer.
+ *
+ * @iclass
+ */
+static inline topic_message_t *chTopicAddRefI(topic_message_t *tmp) {
+
+  chDbgCheckClassI();
+  chDbgAssert(tmp->refs > (cnt_t)0, "not referenced");
+
+  tmp->refs++;
+
+  return tmp;
+}
+
+/**
+ * @brief   Returns the number of messages in a subscriber queue.
+ *
+ * @param[in] sp        pointer to a @p topic_subscriber_t structure
+ * @return              The number of queued messages.
+ *
+ * @iclass
+ */
+static inline size_t chTopicGetUsedCountI(const topic_subscriber_t *sp) {
+
+  chDbgCheckClassI();
+
+  return sp->cnt;
+}
+
+#endif /* CH_CFG_USE_TOPICS == TRUE */
+
+#endif /* CHTOPICS_H */
+
+/** @} */
@@ -33,6 +33,15 @@ endif
 ifneq ($(findstring CH_CFG_USE_DELEGATES TRUE,$(CHLIBCONF)),)
 OSLIBSRC += $(CHIBIOS)/os/oslib/src/chdelegates.c
 endif
+ifneq ($(findstring CH_CFG_USE_JOBS TRUE,$(CHLIBCONF)),)
+OSLIBSRC += $(CHIBIOS)/os/oslib/src/chjobs.c
+endif
+ifneq ($(findstring CH_CFG_USE_TOPICS TRUE,$(CHLIBCONF)),)
+OSLIBSRC += $(CHIBIOS)/os/oslib/src/chtopics.c
+endif
+ifneq ($(findstring CH_CFG_USE_TASKS TRUE,$(CHLIBCONF)),)
+OSLIBSRC += $(CHIBIOS)/os/oslib/src/chtasks.c
+endif
 ifneq ($(findstring CH_CFG_USE_FACTORY TRUE,$(CHLIBCONF)),)
 OSLIBSRC += $(CHIBIOS)/os/oslib/src/chfactory.c
 endif
@@ -44,6 +53,9 @@ OSLIBSRC := $(CHIBIOS)/os/oslib/src/chmboxes.c \
             $(CHIBIOS)/os/oslib/src/chpipes.c \
             $(CHIBIOS)/os/oslib/src/chobjcaches.c \
             $(CHIBIOS)/os/oslib/src/chdelegates.c \
+            $(CHIBIOS)/os/oslib/src/chjobs.c \
+            $(CHIBIOS)/os/oslib/src/chtopics.c \
+            $(CHIBIOS)/os/oslib/src/chtasks.c \
             $(CHIBIOS)/os/oslib/src/chfactory.c
 endif
 
@@ -0,0 +1,345 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    oslib/src/chjobs.c
+ * @brief   Jobs Queues code.
+ * @details Delayed and periodic jobs.
+ *          <h2>Operation mode</h2>
+ *          A jobs timer holds any number of delayed jobs in a delta list
+ *          ordered by deadline, a single virtual timer is armed on the
+ *          nearest deadline. When the timer triggers all the jobs due
+ *          at that tick are posted to the associated jobs queue by the
+ *          same timer event. Identical jobs, same function and argument,
+ *          scheduled consecutively for the same tick are coalesced and
+ *          posted once.
+ * @pre     In order to use the delayed jobs APIs the
+ *          @p CH_CFG_USE_DELAYED_JOBS option must be enabled in
+ *          @p chconf.h.
+ * @note    Compatible with RT only.
+ *
+ * @addtogroup oslib_jobs_queues
+ * @{
+ */
+
+#include "ch.h"
+
+#if ((CH_CFG_USE_JOBS == TRUE) && (CH_CFG_USE_DELAYED_JOBS == TRUE)) ||     \
+    defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Posts a due job to the jobs queue.
+ *
+ * @param[in] jtp       pointer to a @p jobs_timer_t structure
+ * @param[in] djp       pointer to the due @p delayed_job_t structure
+ */
+static void jt_post(jobs_timer_t *jtp, delayed_job_t *djp) {
+  job_descriptor_t *jp;
+
+  jp = chJobGetI(jtp->jqp);
+  if (jp == NULL) {
+    jtp->missed++;
+    return;
+  }
+
+  jp->jobfunc = djp->jobfunc;
+  jp->jobarg  = djp->jobarg;
+  chJobPostI(jtp->jqp, jp);
+  jtp->posted++;
+}
+
+/**
+ * @brief   Shared virtual timer callback.
+ * @details All the jobs with deadline lower or equal than the current
+ *          time are posted, the timer is then re-armed on the next
+ *          deadline, if any.
+ *
+ * @param[in] vtp       pointer to the @p virtual_timer_t calling this callback
+ * @param[in] p         pointer to the @p jobs_timer_t structure
+ */
+static void jt_handler(virtual_timer_t *vtp, void *p) {
+  jobs_timer_t *jtp = (jobs_timer_t *)p;
+  job_function_t lastfunc = NULL;
+  void *lastarg = NULL;
+  sysinterval_t nowdelta;
+
+  (void)vtp;
+
+  chSysLockFromISR();
+
+  /* Delta between current time and the delta list base time.*/
+  nowdelta = chTimeDiffX(jtp->lasttime, chVTGetSystemTimeX());
+
+  /* Consuming all jobs with deltas lower or equal than "nowdelta", note
+     that the list scan is limited by the delta list header having
+     "jtp->dlist.delta == (sysinterval_t)-1".*/
+  while (jtp->dlist.next->delta <= nowdelta) {
+    delayed_job_t *djp = (delayed_job_t *)jtp->dlist.next;
+
+    /* A non-zero delta starts a new group of jobs due at the same tick,
+       coalescing is only performed within a group.*/
+    if (djp->dlist.delta > (sysinterval_t)0) {
+      lastfunc = NULL;
+    }
+
+    /* The list base time is moved to the job deadline.*/
+    nowdelta -= djp->dlist.delta;
+    jtp->lasttime = chTimeAddX(jtp->lasttime, djp->dlist.delta);
+
+    /* Removing the job from the list, marking it as not scheduled.*/
+    (void) ch_dlist_remove_first(&jtp->dlist);
+    djp->dlist.next = NULL;
+
+    if ((djp->jobfunc == lastfunc) && (djp->jobarg == lastarg)) {
+      jtp->coalesced++;
+    }
+    else {
+      jt_post(jtp, djp);
+      lastfunc = djp->jobfunc;
+      lastarg  = djp->jobarg;
+    }
+
+    /* Periodic jobs are rescheduled relative to their own deadline so
+       that there is no cumulative drift.*/
+    if (djp->period > (sysinterval_t)0) {
+      ch_dlist_insert(&jtp->dlist, &djp->dlist, djp->period);
+    }
+  }
+
+  /* Re-arming the shared timer on the next deadline, the unprocessed
+     "nowdelta" is moved from the next job delta to the base time.*/
+  if (ch_dlist_notempty(&jtp->dlist)) {
+    jtp->lasttime = chTimeAddX(jtp->lasttime, nowdelta);
+    jtp->dlist.next->delta -= nowdelta;
+    chVTSetI(&jtp->vt, jtp->dlist.next->delta, jt_handler, (void *)jtp);
+  }
+
+  chSysUnlockFromISR();
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a jobs timer object.
+ *
+ * @param[out] jtp      pointer to a @p jobs_timer_t structure
+ * @param[in] jqp       pointer to the @p jobs_queue_t structure where due
+ *                      jobs are posted
+ *
+ * @init
+ */
+void chJobTimerObjectInit(jobs_timer_t *jtp, jobs_queue_t *jqp) {
+
+  chDbgCheck((jtp != NULL) && (jqp != NULL));
+
+  jtp->jqp       = jqp;
+  ch_dlist_init(&jtp->dlist);
+  jtp->lasttime  = (systime_t)0;
+  chVTObjectInit(&jtp->vt);
+  jtp->posted    = (ucnt_t)0;
+  jtp->coalesced = (ucnt_t)0;
+  jtp->missed    = (ucnt_t)0;
+}
+
+/**
+ * @brief   Schedules a delayed job.
+ * @details The job is posted to the jobs queue associated to the jobs timer
+ *          after the specified delay, if a period is specified then the
+ *          job is posted again every @p period ticks until cancelled.
+ * @pre     The delayed job must not be already scheduled.
+ * @note    A job descriptor is taken from the jobs queue pool only when the
+ *          job is due, if none is available then the posting is skipped
+ *          and counted in the @p missed counter.
+ *
+ * @param[in] jtp       pointer to a @p jobs_timer_t structure
+ * @param[out] djp      pointer to a @p delayed_job_t structure
+ * @param[in] delay     the number of ticks before the first posting, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] period    the interval between subsequent postings or zero
+ *                      for a one-shot job
+ * @param[in] jobfunc   the job function
+ * @param[in] jobarg    argument to be passed to the job function
+ *
+ * @iclass
+ */
+void chJobPostDelayedI(jobs_timer_t *jtp, delayed_job_t *djp,
+                       sysinterval_t delay, sysinterval_t period,
+                       job_function_t jobfunc, void *jobarg) {
+  sysinterval_t nowdelta, delta;
+  systime_t now;
+
+  chDbgCheckClassI();
+  chDbgCheck((jtp != NULL) && (djp != NULL) && (jobfunc != NULL) &&
+             (delay != TIME_IMMEDIATE));
+
+  djp->jobfunc = jobfunc;
+  djp->jobarg  = jobarg;
+  djp->period  = period;
+
+  now = chVTGetSystemTimeX();
+
+  /* Special case where the list is empty, the current time becomes the
+     new list base time.*/
+  if (ch_dlist_isempty(&jtp->dlist)) {
+    jtp->lasttime = now;
+    ch_dlist_insert_after(&jtp->dlist, &djp->dlist, delay);
+    chVTSetI(&jtp->vt, delay, jt_handler, (void *)jtp);
+
+    return;
+  }
+
+  /* Delay as delta from the list base time, in case of overflow the delta
+     is shortened to make it fit the numeric range.*/
+  nowdelta = chTimeDiffX(jtp->lasttime, now);
+  delta    = nowdelta + delay;
+  if (delta < nowdelta) {
+    delta = delay;
+  }
+
+  /* If this job becomes the first in the list then the shared timer needs
+     to be moved to the new deadline.*/
+  if (delta < jtp->dlist.next->delta) {
+    chVTSetI(&jtp->vt, delay, jt_handler, (void *)jtp);
+  }
+
+  ch_dlist_insert(&jtp->dlist, &djp->dlist, delta);
+}
+
+/**
+ * @brief   Schedules a delayed job.
+ * @details The job is posted to the jobs queue associated to the jobs timer
+ *          after the specified delay, if a period is specified then the
+ *          job is posted again every @p period ticks until cancelled.
+ * @pre     The delayed job must not be already scheduled.
+ *
+ * @param[in] jtp       pointer to a @p jobs_timer_t structure
+ * @param[out] djp      pointer to a @p delayed_job_t structure
+ * @param[in] delay     the number of ticks before the first posting, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] period    the interval between subsequent postings or zero
+ *                      for a one-shot job
+ * @param[in] jobfunc   the job function
+ * @param[in] jobarg    argument to be passed to the job function
+ *
+ * @api
+ */
+void chJobPostDelayed(jobs_timer_t *jtp, delayed_job_t *djp,
+                      sysinterval_t delay, sysinterval_t period,
+                      job_function_t jobfunc, void *jobarg) {
+
+  chSysLock();
+  chJobPostDelayedI(jtp, djp, delay, period, jobfunc, jobarg);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Cancels a delayed job.
+ * @note    Cancelling the nearest job does not move the shared timer, the
+ *          timer triggers at the old deadline without posting anything and
+ *          it is then re-armed on the next deadline.
+ *
+ * @param[in] jtp       pointer to a @p jobs_timer_t structure
+ * @param[in] djp       pointer to a @p delayed_job_t structure
+ * @return              The cancellation result.
+ * @retval true         if the job was scheduled and has been cancelled.
+ * @retval false        if the job was not scheduled.
+ *
+ * @iclass
+ */
+bool chJobCancelI(jobs_timer_t *jtp, delayed_job_t *djp) {
+
+  chDbgCheckClassI();
+  chDbgCheck((jtp != NULL) && (djp != NULL));
+
+  if (djp->dlist.next == NULL) {
+    return false;
+  }
+
+  /* Removing the element from the delta list, its delta is added to the
+     next element.*/
+  (void) ch_dlist_dequeue(&djp->dlist);
+  djp->dlist.next->delta += djp->dlist.delta;
+  djp->dlist.next = NULL;
+
+  /* The above code changes the value in the header when the removed element
+     is the last of the list, restoring it.*/
+  jtp->dlist.delta = (sysinterval_t)-1;
+
+  /* If the list became empty then the shared timer is no more needed.*/
+  if (ch_dlist_isempty(&jtp->dlist)) {
+    chVTResetI(&jtp->vt);
+  }
+
+  return true;
+}
+
+/**
+ * @brief   Cancels a delayed job.
+ *
+ * @param[in] jtp       pointer to a @p jobs_timer_t structure
+ * @param[in] djp       pointer to a @p delayed_job_t structure
+ * @return              The cancellation result.
+ * @retval true         if the job was scheduled and has been cancelled.
+ * @retval false        if the job was not scheduled.
+ *
+ * @api
+ */
+bool chJobCancel(jobs_timer_t *jtp, delayed_job_t *djp) {
+  bool b;
+
+  chSysLock();
+  b = chJobCancelI(jtp, djp);
+  chSysUnlock();
+
+  return b;
+}
+
+#endif /* (CH_CFG_USE_JOBS == TRUE) && (CH_CFG_USE_DELAYED_JOBS == TRUE) */
+
+/** @} */
@@ -0,0 +1,447 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    oslib/src/chtasks.c
+ * @brief   Stackless Tasks code.
+ * @details Cooperative tasks without a private stack.
+ *          <h2>Operation mode</h2>
+ *          A stackless task is a function returning to its executor at each
+ *          wait point, the position where the task has to resume is stored
+ *          in the task structure and the function restarts from there the
+ *          next time it is invoked.<br>
+ *          An executor runs its tasks on the stack of a single thread, a
+ *          task switch is a function return followed by a function call so
+ *          it is much cheaper than a thread context switch and the memory
+ *          cost of a task is only its @p task_t structure.<br>
+ *          Operations defined for tasks:
+ *          - <b>Yield</b>: The task is queued after the other ready tasks.
+ *          - <b>Sleep</b>: The task is suspended until its wakeup time.
+ *          - <b>Wait Events</b>: The task is suspended until it receives
+ *            any of the specified events.
+ *          - <b>Wait Until</b>: The task is suspended until a condition
+ *            becomes true, the condition is checked again after each
+ *            task step and each executor notification.
+ *          .
+ *          When no tasks are ready the executor thread is suspended until
+ *          the next sleeping task wakeup time or until it is notified.
+ * @pre     In order to use the tasks APIs the @p CH_CFG_USE_TASKS option
+ *          must be enabled in @p chconf.h.
+ * @note    Compatible with RT and NIL.
+ *
+ * @addtogroup oslib_tasks
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_TASKS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Time remaining before a sleeping task wakeup.
+ * @note    Wakeup times already past are considered as due now.
+ *
+ * @param[in] tp        pointer to the task
+ * @param[in] now       the current system time
+ * @return              The remaining time.
+ * @retval 0            if the task is due.
+ */
+static sysinterval_t task_remaining(task_t *tp, systime_t now) {
+  sysinterval_t remaining;
+
+  remaining = chTimeDiffX(now, tp->wakeup);
+  if (remaining > (sysinterval_t)(TIME_MAX_SYSTIME / (systime_t)2)) {
+    return (sysinterval_t)0;
+  }
+
+  return remaining;
+}
+
+/**
+ * @brief   Appends a task to the executor ready list.
+ *
+ * @param[in] tep       pointer to the @p task_executor_t object
+ * @param[in] tp        pointer to the task
+ */
+static void task_ready(task_executor_t *tep, task_t *tp) {
+
+  tp->state = TASK_STATE_READY;
+  tp->next  = NULL;
+  if (tep->rhead == NULL) {
+    tep->rhead = tp;
+  }
+  else {
+    tep->rtail->next = tp;
+  }
+  tep->rtail = tp;
+}
+
+/**
+ * @brief   Inserts a task in the executor sleeping list.
+ * @details The list is ordered by remaining time, tasks with the same
+ *          wakeup time are kept in FIFO order.
+ *
+ * @param[in] tep       pointer to the @p task_executor_t object
+ * @param[in] tp        pointer to the task
+ * @param[in] now       the current system time
+ */
+static void task_sleep(task_executor_t *tep, task_t *tp, systime_t now) {
+  sysinterval_t remaining = task_remaining(tp, now);
+  task_t **tpp;
+
+  tp->state = TASK_STATE_SLEEPING;
+  tpp = &tep->sleeping;
+  while ((*tpp != NULL) && (task_remaining(*tpp, now) <= remaining)) {
+    tpp = &(*tpp)->next;
+  }
+  tp->next = *tpp;
+  *tpp = tp;
+}
+
+/**
+ * @brief   Wakes up the executor thread if it is waiting.
+ *
+ * @param[in] tep       pointer to the @p task_executor_t object
+ */
+static void task_wakeup_executor(task_executor_t *tep) {
+
+  chThdResumeI(&tep->thread, MSG_OK);
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p task_executor_t object.
+ *
+ * @param[out] tep      pointer to a @p task_executor_t object
+ *
+ * @init
+ */
+void chTaskExecutorObjectInit(task_executor_t *tep) {
+
+  chDbgCheck(tep != NULL);
+
+  tep->rhead    = NULL;
+  tep->rtail    = NULL;
+  tep->sleeping = NULL;
+  tep->polling  = NULL;
+  tep->thread   = NULL;
+  tep->ntasks   = (ucnt_t)0;
+  tep->switches = (ucnt_t)0;
+  tep->pollreq  = false;
+}
+
+/**
+ * @brief   Runs the tasks of an executor.
+ * @details The tasks are executed on the stack of the calling thread, the
+ *          function returns when all the started tasks are terminated.
+ * @note    An executor can be run by a single thread at time.
+ *
+ * @param[in] tep       pointer to the @p task_executor_t object
+ *
+ * @api
+ */
+void chTaskExecutorRun(task_executor_t *tep) {
+
+  chDbgCheck(tep != NULL);
+
+  chSysLock();
+
+  chDbgAssert(tep->thread == NULL, "already running");
+
+  while (tep->ntasks > (ucnt_t)0) {
+    systime_t now = chVTGetSystemTimeX();
+    task_state_t state;
+    task_t *tp;
+
+    /* Sleeping tasks whose wakeup time is past become ready.*/
+    while ((tep->sleeping != NULL) &&
+           (task_remaining(tep->sleeping, now) == (sysinterval_t)0)) {
+      tp = tep->sleeping;
+      tep->sleeping = tp->next;
+      task_ready(tep, tp);
+    }
+
+    /* Polling tasks check their condition again if something happened
+       since their last check.*/
+    if (tep->pollreq) {
+      tep->pollreq = false;
+      while (tep->polling != NULL) {
+        tp = tep->polling;
+        tep->polling = tp->next;
+        task_ready(tep, tp);
+      }
+    }
+
+    /* Nothing to do, waiting for a wakeup time or a notification.*/
+    if (tep->rhead == NULL) {
+      sysinterval_t timeout = TIME_INFINITE;
+
+      if (tep->sleeping != NULL) {
+        timeout = task_remaining(tep->sleeping, now);
+      }
+      (void) chThdSuspendTimeoutS(&tep->thread, timeout);
+      continue;
+    }
+
+    /* Running the next ready task until its next wait point.*/
+    tp = tep->rhead;
+    tep->rhead = tp->next;
+    tp->state = TASK_STATE_RUNNING;
+    chSysUnlock();
+
+    state = tp->func(tp);
+
+    chSysLock();
+    tep->switches++;
+
+    if (state != TASK_STATE_POLLING) {
+      tep->pollreq = true;
+    }
+
+    switch (state) {
+    case TASK_STATE_READY:
+      task_ready(tep, tp);
+      break;
+    case TASK_STATE_SLEEPING:
+      task_sleep(tep, tp, chVTGetSystemTimeX());
+      break;
+    case TASK_STATE_WTEVENTS:
+      if ((tp->epending & tp->ewmask) != (eventmask_t)0) {
+        task_ready(tep, tp);
+      }
+      else {
+        tp->state = TASK_STATE_WTEVENTS;
+      }
+      break;
+    case TASK_STATE_POLLING:
+      /* Polling tasks are kept in LIFO order, they are all made ready
+         together anyway.*/
+      tp->state = TASK_STATE_POLLING;
+      tp->next  = tep->polling;
+      tep->polling = tp;
+      break;
+    default:
+      chDbgAssert(state == TASK_STATE_FINAL, "invalid state");
+      tp->state = TASK_STATE_FINAL;
+      tep->ntasks--;
+      break;
+    }
+  }
+
+  chSysUnlock();
+}
+
+/**
+ * @brief   Notifies an executor that conditions awaited by its polling
+ *          tasks could have changed.
+ *
+ * @param[in] tep       pointer to the @p task_executor_t object
+ *
+ * @iclass
+ */
+void chTaskExecutorNotifyI(task_executor_t *tep) {
+
+  chDbgCheckClassI();
+  chDbgCheck(tep != NULL);
+
+  tep->pollreq = true;
+  task_wakeup_executor(tep);
+}
+
+/**
+ * @brief   Notifies an executor that conditions awaited by its polling
+ *          tasks could have changed.
+ *
+ * @param[in] tep       pointer to the @p task_executor_t object
+ *
+ * @api
+ */
+void chTaskExecutorNotify(task_executor_t *tep) {
+
+  chSysLock();
+  chTaskExecutorNotifyI(tep);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Initializes a @p task_t object.
+ *
+ * @param[out] tp       pointer to a @p task_t object
+ * @param[in] func      the task function
+ * @param[in] arg       the task argument
+ *
+ * @init
+ */
+void chTaskObjectInit(task_t *tp, task_func_t func, void *arg) {
+
+  chDbgCheck((tp != NULL) && (func != NULL));
+
+  tp->next     = NULL;
+  tp->executor = NULL;
+  tp->func     = func;
+  tp->arg      = arg;
+  tp->wakeup   = (systime_t)0;
+  tp->epending = (eventmask_t)0;
+  tp->ewmask   = (eventmask_t)0;
+  tp->lc       = 0U;
+  tp->state    = TASK_STATE_FINAL;
+}
+
+/**
+ * @brief   Starts a task on an executor.
+ * @details The task is appended to the executor ready list, a terminated
+ *          task can be started again.
+ *
+ * @param[in] tep       pointer to the @p task_executor_t object
+ * @param[in] tp        pointer to the task
+ *
+ * @iclass
+ */
+void chTaskStartI(task_executor_t *tep, task_t *tp) {
+
+  chDbgCheckClassI();
+  chDbgCheck((tep != NULL) && (tp != NULL));
+  chDbgAssert(tp->state == TASK_STATE_FINAL, "task running");
+
+  tp->executor = tep;
+  tp->epending = (eventmask_t)0;
+  tp->lc       = 0U;
+  tep->ntasks++;
+  task_ready(tep, tp);
+  task_wakeup_executor(tep);
+}
+
+/**
+ * @brief   Starts a task on an executor.
+ * @details The task is appended to the executor ready list, a terminated
+ *          task can be started again.
+ *
+ * @param[in] tep       pointer to the @p task_executor_t object
+ * @param[in] tp        pointer to the task
+ *
+ * @api
+ */
+void chTaskStart(task_executor_t *tep, task_t *tp) {
+
+  chSysLock();
+  chTaskStartI(tep, tp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Adds events to the pending events of a task.
+ * @details A task waiting for any of the signaled events is made ready,
+ *          polling tasks are made to check their condition again.
+ *
+ * @param[in] tp        pointer to the task
+ * @param[in] events    the events to be added
+ *
+ * @iclass
+ */
+void chTaskSignalI(task_t *tp, eventmask_t events) {
+  task_executor_t *tep;
+
+  chDbgCheckClassI();
+  chDbgCheck((tp != NULL) && (tp->executor != NULL));
+
+  tep = tp->executor;
+  tp->epending |= events;
+  if (tp->state == TASK_STATE_WTEVENTS) {
+    if ((tp->epending & tp->ewmask) != (eventmask_t)0) {
+      task_ready(tep, tp);
+      task_wakeup_executor(tep);
+    }
+  }
+  else if (tp->state == TASK_STATE_POLLING) {
+    tep->pollreq = true;
+    task_wakeup_executor(tep);
+  }
+  else {
+    /* Nothing to do.*/
+  }
+}
+
+/**
+ * @brief   Adds events to the pending events of a task.
+ * @details A task waiting for any of the signaled events is made ready,
+ *          polling tasks are made to check their condition again.
+ *
+ * @param[in] tp        pointer to the task
+ * @param[in] events    the events to be added
+ *
+ * @api
+ */
+void chTaskSignal(task_t *tp, eventmask_t events) {
+
+  chSysLock();
+  chTaskSignalI(tp, events);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Clears the pending events of a task.
+ *
+ * @param[in] tp        pointer to the task
+ * @param[in] events    the events to be cleared
+ * @return              The pending events that were cleared.
+ *
+ * @api
+ */
+eventmask_t chTaskGetAndClearEvents(task_t *tp, eventmask_t events) {
+  eventmask_t m;
+
+  chDbgCheck(tp != NULL);
+
+  chSysLock();
+  m = tp->epending & events;
+  tp->epending &= ~events;
+  chSysUnlock();
+
+  return m;
+}
+
+#endif /* CH_CFG_USE_TASKS == TRUE */
+
+/** @} */
@@ -0,0 +1,523 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    oslib/src/chtopics.c
+ * @brief   Publish/Subscribe Topics code.
+ * @details Zero-copy publish/subscribe.
+ *          <h2>Operation mode</h2>
+ *          A topic owns a pool of messages of fixed size. A publisher
+ *          allocates a message from the topic, fills its payload once then
+ *          publishes it, each subscriber receives a reference to the same
+ *          message through its own bounded queue.<br>
+ *          Messages are reference counted, a message returns to the topic
+ *          pool when the last subscriber releases it.<br>
+ *          Operations defined for topics:
+ *          - <b>Alloc</b>: A message is taken from the topic pool.
+ *          - <b>Publish</b>: A reference to the message is queued to each
+ *            subscriber, on queue overflow the subscriber policy decides
+ *            which message is dropped.
+ *          - <b>Fetch</b>: A subscriber takes the next message reference
+ *            from its queue.
+ *          - <b>Release</b>: A message reference is released.
+ *          .
+ * @pre     In order to use the topics APIs the @p CH_CFG_USE_TOPICS option
+ *          must be enabled in @p chconf.h.
+ * @note    Compatible with RT and NIL.
+ *
+ * @addtogroup oslib_topics
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_TOPICS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Takes the oldest message reference from a subscriber queue.
+ * @pre     The queue must not be empty.
+ *
+ * @param[in] sp        pointer to a @p topic_subscriber_t structure
+ * @return              The message pointer.
+ */
+static topic_message_t *ts_get(topic_subscriber_t *sp) {
+  topic_message_t *tmp;
+
+  tmp = *sp->rdptr++;
+  if (sp->rdptr >= sp->top) {
+    sp->rdptr = sp->buffer;
+  }
+  sp->cnt--;
+
+  return tmp;
+}
+
+/**
+ * @brief   Queues a message reference in a subscriber queue.
+ * @details The overflow policy of the subscriber is applied.
+ *
+ * @param[in] sp        pointer to a @p topic_subscriber_t structure
+ * @param[in] tmp       pointer to a @p topic_message_t structure
+ */
+static void ts_put(topic_subscriber_t *sp, topic_message_t *tmp) {
+  topic_t *tp = sp->topic;
+
+  if (sp->cnt >= (size_t)(sp->top - sp->buffer)) {
+
+    /* Overflow, the policy decides which message is dropped.*/
+    sp->dropped++;
+    tp->stats.dropped++;
+    if (sp->policy == TOPIC_POLICY_DROP_NEWEST) {
+      return;
+    }
+
+    chTopicReleaseI(ts_get(sp));
+  }
+
+  tmp->refs++;
+  *sp->wrptr++ = tmp;
+  if (sp->wrptr >= sp->top) {
+    sp->wrptr = sp->buffer;
+  }
+  sp->cnt++;
+  tp->stats.delivered++;
+
+  /* If there is a reader waiting then makes it ready.*/
+  chThdDequeueNextI(&sp->qr, MSG_OK);
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a @p topic_t object.
+ *
+ * @param[out] tp       pointer to a @p topic_t structure
+ * @param[in] name      name of the topic or @p NULL
+ * @param[in] size      size of the messages payload
+ * @param[in] msgbuf    pointer to the buffer of messages, it must be able
+ *                      to hold @p n messages of @p TOPIC_MESSAGE_SIZE(size)
+ *                      bytes each
+ * @param[in] n         number of messages available in the buffer
+ *
+ * @init
+ */
+void chTopicObjectInit(topic_t *tp, const char *name, size_t size,
+                       void *msgbuf, size_t n) {
+
+  chDbgCheck((tp != NULL) && (msgbuf != NULL) && (n > (size_t)0));
+
+  tp->name        = name;
+  chPoolObjectInit(&tp->pool, TOPIC_MESSAGE_SIZE(size), NULL);
+  chPoolLoadArray(&tp->pool, msgbuf, n);
+  tp->subscribers = NULL;
+  tp->stats.published = (ucnt_t)0;
+  tp->stats.delivered = (ucnt_t)0;
+  tp->stats.dropped   = (ucnt_t)0;
+  tp->stats.nomem     = (ucnt_t)0;
+}
+
+/**
+ * @brief   Subscribes to a topic.
+ *
+ * @param[in] tp        pointer to a @p topic_t structure
+ * @param[out] sp       pointer to a @p topic_subscriber_t structure
+ * @param[in] buf       pointer to the subscriber queue buffer, it is ignored
+ *                      if the policy is @p TOPIC_POLICY_LAST_VALUE
+ * @param[in] n         number of elements in the queue buffer, it is ignored
+ *                      if the policy is @p TOPIC_POLICY_LAST_VALUE
+ * @param[in] policy    the queue overflow policy
+ *
+ * @api
+ */
+void chTopicSubscribe(topic_t *tp, topic_subscriber_t *sp,
+                      topic_message_t **buf, size_t n,
+                      topic_policy_t policy) {
+
+  chDbgCheck((tp != NULL) && (sp != NULL) &&
+             ((policy == TOPIC_POLICY_LAST_VALUE) ||
+              ((buf != NULL) && (n > (size_t)0))));
+
+  /* The last-value policy is a single slot queue dropping the oldest
+     message on overflow.*/
+  if (policy == TOPIC_POLICY_LAST_VALUE) {
+    buf    = &sp->slot;
+    n      = (size_t)1;
+    policy = TOPIC_POLICY_DROP_OLDEST;
+  }
+
+  sp->topic   = tp;
+  sp->buffer  = buf;
+  sp->top     = buf + n;
+  sp->wrptr   = buf;
+  sp->rdptr   = buf;
+  sp->cnt     = (size_t)0;
+  sp->policy  = policy;
+  sp->slot    = NULL;
+  sp->dropped = (ucnt_t)0;
+  chThdQueueObjectInit(&sp->qr);
+
+  chSysLock();
+  sp->next = tp->subscribers;
+  tp->subscribers = sp;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Unsubscribes from a topic.
+ * @details All the queued message references are released, threads
+ *          waiting on the subscriber queue are resumed with @p MSG_RESET.
+ *
+ * @param[in] sp        pointer to a @p topic_subscriber_t structure
+ *
+ * @api
+ */
+void chTopicUnsubscribe(topic_subscriber_t *sp) {
+  topic_subscriber_t **spp;
+
+  chDbgCheck((sp != NULL) && (sp->topic != NULL));
+
+  chSysLock();
+
+  /* Unlinking the subscriber from the topic list.*/
+  spp = &sp->topic->subscribers;
+  while (*spp != sp) {
+    chDbgAssert(*spp != NULL, "not subscribed");
+    spp = &(*spp)->next;
+  }
+  *spp = sp->next;
+
+  /* Releasing all queued references.*/
+  while (sp->cnt > (size_t)0) {
+    chTopicReleaseI(ts_get(sp));
+  }
+  sp->topic = NULL;
+
+  chThdDequeueAllI(&sp->qr, MSG_RESET);
+  chSchRescheduleS();
+
+  chSysUnlock();
+}
+
+/**
+ * @brief   Allocates a message from a topic.
+ * @details The returned message is owned by the caller with a single
+ *          reference, the reference is passed to the topic on publish.
+ *
+ * @param[in] tp        pointer to a @p topic_t structure
+ * @return              The pointer to the allocated message.
+ * @retval NULL         if a message is not immediately available.
+ *
+ * @iclass
+ */
+topic_message_t *chTopicAllocI(topic_t *tp) {
+  topic_message_t *tmp;
+
+  chDbgCheckClassI();
+  chDbgCheck(tp != NULL);
+
+  tmp = (topic_message_t *)chPoolAllocI(&tp->pool);
+  if (tmp == NULL) {
+    tp->stats.nomem++;
+    return NULL;
+  }
+
+  tmp->topic = tp;
+  tmp->refs  = (cnt_t)1;
+
+  return tmp;
+}
+
+/**
+ * @brief   Allocates a message from a topic.
+ * @details The returned message is owned by the caller with a single
+ *          reference, the reference is passed to the topic on publish.
+ *
+ * @param[in] tp        pointer to a @p topic_t structure
+ * @return              The pointer to the allocated message.
+ * @retval NULL         if a message is not immediately available.
+ *
+ * @api
+ */
+topic_message_t *chTopicAlloc(topic_t *tp) {
+  topic_message_t *tmp;
+
+  chSysLock();
+  tmp = chTopicAllocI(tp);
+  chSysUnlock();
+
+  return tmp;
+}
+
+/**
+ * @brief   Publishes a message.
+ * @details A reference to the message is queued to each subscriber then
+ *          the publisher reference is released. If there are no subscribers
+ *          then the message returns immediately to the topic pool.
+ * @post    The message must not be accessed by the publisher after this
+ *          call.
+ *
+ * @param[in] tmp       pointer to a @p topic_message_t structure
+ *
+ * @iclass
+ */
+void chTopicPublishI(topic_message_t *tmp) {
+  topic_subscriber_t *sp;
+
+  chDbgCheckClassI();
+  chDbgCheck(tmp != NULL);
+  chDbgAssert(tmp->refs == (cnt_t)1, "already published");
+
+  tmp->topic->stats.published++;
+
+  sp = tmp->topic->subscribers;
+  while (sp != NULL) {
+    ts_put(sp, tmp);
+    sp = sp->next;
+  }
+
+  /* Releasing the publisher reference.*/
+  chTopicReleaseI(tmp);
+}
+
+/**
+ * @brief   Publishes a message.
+ * @details A reference to the message is queued to each subscriber then
+ *          the publisher reference is released. If there are no subscribers
+ *          then the message returns immediately to the topic pool.
+ * @post    The message must not be accessed by the publisher after this
+ *          call.
+ *
+ * @param[in] tmp       pointer to a @p topic_message_t structure
+ *
+ * @sclass
+ */
+void chTopicPublishS(topic_message_t *tmp) {
+
+  chDbgCheckClassS();
+
+  chTopicPublishI(tmp);
+  chSchRescheduleS();
+}
+
+/**
+ * @brief   Publishes a message.
+ * @details A reference to the message is queued to each subscriber then
+ *          the publisher reference is released. If there are no subscribers
+ *          then the message returns immediately to the topic pool.
+ * @post    The message must not be accessed by the publisher after this
+ *          call.
+ *
+ * @param[in] tmp       pointer to a @p topic_message_t structure
+ *
+ * @api
+ */
+void chTopicPublish(topic_message_t *tmp) {
+
+  chSysLock();
+  chTopicPublishS(tmp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Fetches a message reference from a subscriber queue.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if the queue is empty.
+ * @post    The fetched message must be released using @p chTopicRelease()
+ *          or @p chTopicReleaseI().
+ *
+ * @param[in] sp        pointer to a @p topic_subscriber_t structure
+ * @param[out] tmpp     pointer to the fetched message pointer
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_TIMEOUT  if the queue is empty.
+ *
+ * @iclass
+ */
+msg_t chTopicFetchI(topic_subscriber_t *sp, topic_message_t **tmpp) {
+
+  chDbgCheckClassI();
+  chDbgCheck((sp != NULL) && (tmpp != NULL));
+
+  if (sp->cnt == (size_t)0) {
+    return MSG_TIMEOUT;
+  }
+
+  *tmpp = ts_get(sp);
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Fetches a message reference from a subscriber queue.
+ * @details The invoking thread waits until a message is available or the
+ *          specified time expires.
+ * @post    The fetched message must be released using @p chTopicRelease()
+ *          or @p chTopicReleaseI().
+ *
+ * @param[in] sp        pointer to a @p topic_subscriber_t structure
+ * @param[out] tmpp     pointer to the fetched message pointer
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_RESET    if the subscriber has been unsubscribed.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+msg_t chTopicFetchTimeoutS(topic_subscriber_t *sp, topic_message_t **tmpp,
+                           sysinterval_t timeout) {
+  msg_t rdymsg;
+
+  chDbgCheckClassS();
+  chDbgCheck((sp != NULL) && (tmpp != NULL));
+
+  do {
+    /* If the subscriber is no more subscribed then returns immediately.*/
+    if (sp->topic == NULL) {
+      return MSG_RESET;
+    }
+
+    /* Is there a message in queue? if so then fetch.*/
+    if (sp->cnt > (size_t)0) {
+      *tmpp = ts_get(sp);
+
+      return MSG_OK;
+    }
+
+    /* No message in the queue, waiting for a message to become available.*/
+    rdymsg = chThdEnqueueTimeoutS(&sp->qr, timeout);
+  } while (rdymsg == MSG_OK);
+
+  return rdymsg;
+}
+
+/**
+ * @brief   Fetches a message reference from a subscriber queue.
+ * @details The invoking thread waits until a message is available or the
+ *          specified time expires.
+ * @post    The fetched message must be released using @p chTopicRelease()
+ *          or @p chTopicReleaseI().
+ *
+ * @param[in] sp        pointer to a @p topic_subscriber_t structure
+ * @param[out] tmpp     pointer to the fetched message pointer
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_RESET    if the subscriber has been unsubscribed.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chTopicFetchTimeout(topic_subscriber_t *sp, topic_message_t **tmpp,
+                          sysinterval_t timeout) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chTopicFetchTimeoutS(sp, tmpp, timeout);
+  chSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Releases a message reference.
+ * @details The message is returned to the topic pool when the last
+ *          reference is released.
+ *
+ * @param[in] tmp       pointer to a @p topic_message_t structure
+ *
+ * @iclass
+ */
+void chTopicReleaseI(topic_message_t *tmp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(tmp != NULL);
+  chDbgAssert(tmp->refs > (cnt_t)0, "not referenced");
+
+  if (--tmp->refs == (cnt_t)0) {
+    chPoolFreeI(&tmp->topic->pool, (void *)tmp);
+  }
+}
+
+/**
+ * @brief   Releases a message reference.
+ * @details The message is returned to the topic pool when the last
+ *          reference is released.
+ *
+ * @param[in] tmp       pointer to a @p topic_message_t structure
+ *
+ * @api
+ */
+void chTopicRelease(topic_message_t *tmp) {
+
+  chSysLock();
+  chTopicReleaseI(tmp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Returns a snapshot of the topic statistics.
+ *
+ * @param[in] tp        pointer to a @p topic_t structure
+ * @param[out] tsp      pointer to a @p topic_stats_t structure
+ *
+ * @api
+ */
+void chTopicGetStats(topic_t *tp, topic_stats_t *tsp) {
+
+  chDbgCheck((tp != NULL) && (tsp != NULL));
+
+  chSysLock();
+  *tsp = tp->stats;
+  chSysUnlock();
+}
+
+#endif /* CH_CFG_USE_TOPICS == TRUE */
+
+/** @} */
@@ -106,20 +106,26 @@
 #include "chport.h"
 #include "chtm.h"
 #include "chstats.h"
+#include "chcsprof.h"
 #include "chobjects.h"
 #include "chsys.h"
 #include "chinstances.h"
 #include "chvt.h"
+#include "chrecorder.h"
 #include "chschd.h"
 #include "chthreads.h"
+#include "chedf.h"
 
 /* Optional subsystems headers.*/
 #include "chregistry.h"
 #include "chsem.h"
 #include "chmtx.h"
+#include "chrwlock.h"
+#include "chpcmtx.h"
 #include "chcond.h"
 #include "chevents.h"
 #include "chmsg.h"
+#include "chstkprof.h"
 
 /* OSLIB.*/
 #include "chlib.h"
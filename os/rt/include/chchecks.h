@@ -101,10 +101,18 @@
 #error "CH_CFG_USE_TIMESTAMP not defined in chconf.h"
 #endif
 
+#if !defined(CH_CFG_USE_VT_DEFERRED)
+#error "CH_CFG_USE_VT_DEFERRED not defined in chconf.h"
+#endif
+
 #if !defined(CH_CFG_USE_REGISTRY)
 #error "CH_CFG_USE_REGISTRY not defined in chconf.h"
 #endif
 
+#if !defined(CH_CFG_REGISTRY_HASH_SIZE)
+#error "CH_CFG_REGISTRY_HASH_SIZE not defined in chconf.h"
+#endif
+
 #if !defined(CH_CFG_USE_WAITEXIT)
 #error "CH_CFG_USE_WAITEXIT not defined in chconf.h"
 #endif
@@ -125,6 +133,22 @@
 #error "CH_CFG_USE_MUTEXES_RECURSIVE not defined in chconf.h"
 #endif
 
+#if !defined(CH_CFG_USE_MUTEXES_FASTPATH)
+#error "CH_CFG_USE_MUTEXES_FASTPATH not defined in chconf.h"
+#endif
+
+#if !defined(CH_CFG_USE_RWLOCKS)
+#error "CH_CFG_USE_RWLOCKS not defined in chconf.h"
+#endif
+
+#if !defined(CH_CFG_USE_PCMUTEXES)
+#error "CH_CFG_USE_PCMUTEXES not defined in chconf.h"
+#endif
+
+#if !defined(CH_CFG_USE_EDF)
+#error "CH_CFG_USE_EDF not defined in chconf.h"
+#endif
+
 #if !defined(CH_CFG_USE_CONDVARS)
 #error "CH_CFG_USE_CONDVARS not defined in chconf.h"
 #endif
@@ -141,6 +165,10 @@
 #error "CH_CFG_USE_EVENTS_TIMEOUT not defined in chconf.h"
 #endif
 
+#if !defined(CH_CFG_USE_EVENTS_POLL)
+#error "CH_CFG_USE_EVENTS_POLL not defined in chconf.h"
+#endif
+
 #if !defined(CH_CFG_USE_MESSAGES)
 #error "CH_CFG_USE_MESSAGES not defined in chconf.h"
 #endif
@@ -149,6 +177,10 @@
 #error "CH_CFG_USE_MESSAGES_PRIORITY not defined in chconf.h"
 #endif
 
+#if !defined(CH_CFG_USE_MESSAGES_ASYNC)
+#error "CH_CFG_USE_MESSAGES_ASYNC not defined in chconf.h"
+#endif
+
 #if !defined(CH_CFG_USE_DYNAMIC)
 #error "CH_CFG_USE_DYNAMIC not defined in chconf.h"
 #endif
@@ -190,6 +222,18 @@
 #error "CH_DBG_THREADS_PROFILING not defined in chconf.h"
 #endif
 
+#if !defined(CH_DBG_STACK_PROFILER)
+#error "CH_DBG_STACK_PROFILER not defined in chconf.h"
+#endif
+
+#if !defined(CH_DBG_RECORDER)
+#error "CH_DBG_RECORDER not defined in chconf.h"
+#endif
+
+#if !defined(CH_DBG_CS_PROFILER)
+#error "CH_DBG_CS_PROFILER not defined in chconf.h"
+#endif
+
 /* System hooks checks.*/
 #if !defined(CH_CFG_SYSTEM_EXTRA_FIELDS)
 #error "CH_CFG_SYSTEM_EXTRA_FIELDS not defined in chconf.h"
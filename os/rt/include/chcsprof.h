@@ -0,0 +1,238 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/include/chcsprof.h
+ * @brief   Critical zones profiler macros and structures.
+ *
+ * @addtogroup cs_profiler
+ * @{
+ */
+
+#ifndef CHCSPROF_H
+#define CHCSPROF_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Number of longest critical zones kept by the profiler.
+ */
+#if !defined(CH_DBG_CS_PROFILER_TOP) || defined(__DOXYGEN__)
+#define CH_DBG_CS_PROFILER_TOP              8
+#endif
+
+/**
+ * @brief   Size of the call sites table.
+ * @note    It must be a power of two.
+ */
+#if !defined(CH_DBG_CS_PROFILER_SITES) || defined(__DOXYGEN__)
+#define CH_DBG_CS_PROFILER_SITES            16
+#endif
+
+/**
+ * @brief   Number of buckets in each call site histogram.
+ */
+#if !defined(CH_DBG_CS_PROFILER_BUCKETS) || defined(__DOXYGEN__)
+#define CH_DBG_CS_PROFILER_BUCKETS          8
+#endif
+
+/**
+ * @brief   Histogram resolution.
+ * @details The first bucket counts the critical zones shorter than
+ *          2^CH_DBG_CS_PROFILER_RESOLUTION realtime counter cycles, each
+ *          following bucket covers a range twice as large, the last
+ *          bucket counts all the longer zones.
+ */
+#if !defined(CH_DBG_CS_PROFILER_RESOLUTION) || defined(__DOXYGEN__)
+#define CH_DBG_CS_PROFILER_RESOLUTION       6
+#endif
+
+#if (CH_DBG_CS_PROFILER == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if PORT_SUPPORTS_RT == FALSE
+#error "CH_DBG_CS_PROFILER requires PORT_SUPPORTS_RT"
+#endif
+
+#if CH_DBG_CS_PROFILER_TOP < 1
+#error "invalid CH_DBG_CS_PROFILER_TOP value"
+#endif
+
+#if (CH_DBG_CS_PROFILER_SITES < 1) ||                                       \
+    ((CH_DBG_CS_PROFILER_SITES & (CH_DBG_CS_PROFILER_SITES - 1)) != 0)
+#error "invalid CH_DBG_CS_PROFILER_SITES value"
+#endif
+
+#if (CH_DBG_CS_PROFILER_BUCKETS < 2) || (CH_DBG_CS_PROFILER_BUCKETS > 32)
+#error "invalid CH_DBG_CS_PROFILER_BUCKETS value"
+#endif
+
+#if (CH_DBG_CS_PROFILER_RESOLUTION < 0) ||                                  \
+    (CH_DBG_CS_PROFILER_RESOLUTION > 24)
+#error "invalid CH_DBG_CS_PROFILER_RESOLUTION value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a critical zone record.
+ */
+typedef struct {
+  /**
+   * @brief   Call site or tag.
+   */
+  const void            *site;
+  /**
+   * @brief   Duration in realtime counter cycles.
+   */
+  rtcnt_t               duration;
+} csprof_record_t;
+
+/**
+ * @brief   Type of a call site statistics.
+ */
+typedef struct {
+  /**
+   * @brief   Call site or tag.
+   */
+  const void            *site;
+  /**
+   * @brief   Number of critical zones, zero if the entry is unused.
+   */
+  ucnt_t                n;
+  /**
+   * @brief   Longest critical zone.
+   */
+  rtcnt_t               worst;
+  /**
+   * @brief   Durations histogram.
+   */
+  ucnt_t                hist[CH_DBG_CS_PROFILER_BUCKETS];
+} csprof_site_t;
+
+/**
+ * @brief   Type of a critical zone being measured.
+ */
+typedef struct {
+  /**
+   * @brief   Realtime counter value on zone entry.
+   */
+  rtcnt_t               start;
+  /**
+   * @brief   Call site or tag.
+   */
+  const void            *site;
+} csprof_zone_t;
+
+/**
+ * @brief   Type of a critical zones profiler.
+ */
+typedef struct {
+  /**
+   * @brief   Thread critical zone being measured.
+   */
+  csprof_zone_t         thd;
+  /**
+   * @brief   ISR critical zone being measured.
+   */
+  csprof_zone_t         isr;
+  /**
+   * @brief   Critical zones not accounted because the sites table is full.
+   */
+  ucnt_t                lost;
+  /**
+   * @brief   Longest critical zones, in decreasing duration order.
+   */
+  csprof_record_t       top[CH_DBG_CS_PROFILER_TOP];
+  /**
+   * @brief   Call sites table.
+   */
+  csprof_site_t         sites[CH_DBG_CS_PROFILER_SITES];
+} cs_profiler_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Call site of a critical zone.
+ * @details The default is the return address of the function entering the
+ *          critical zone, @p chSysLock() and @p chSysLockFromISR() being
+ *          inline functions. It can be externally redefined.
+ *
+ * @notapi
+ */
+#if !defined(__csprof_site) || defined(__DOXYGEN__)
+#if defined(__GNUC__) || defined(__DOXYGEN__)
+#define __csprof_site()             __builtin_return_address(0)
+#else
+#define __csprof_site()             NULL
+#endif
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void __csprof_object_init(cs_profiler_t *csp);
+  void __csprof_enter_thd(const void *site);
+  void __csprof_leave_thd(void);
+  void __csprof_enter_isr(const void *site);
+  void __csprof_leave_isr(void);
+  void chCSProfSetTagI(const void *tag);
+  void chCSProfResetI(void);
+  void chCSProfReset(void);
+  bool chCSProfGetTopI(unsigned i, csprof_record_t *rp);
+  bool chCSProfGetSiteI(unsigned i, csprof_site_t *sp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#else /* CH_DBG_CS_PROFILER == FALSE */
+
+/* Stub functions for when the profiler is disabled. */
+#define __csprof_enter_thd(site)
+#define __csprof_leave_thd()
+#define __csprof_enter_isr(site)
+#define __csprof_leave_isr()
+#define chCSProfSetTagI(tag)
+
+#endif /* CH_DBG_CS_PROFILER == FALSE */
+
+#endif /* CHCSPROF_H */
+
+/** @} */
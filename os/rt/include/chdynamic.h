@@ -61,6 +61,41 @@
 /* Module data structures and types.                                         */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a thread pool object.
+ */
+typedef struct ch_thread_pool {
+  /**
+   * @brief   Memory pool providing the working areas.
+   */
+  memory_pool_t                 *mp;
+  /**
+   * @brief   List of the parked threads, last parked first.
+   */
+  ch_list_t                     parked;
+  /**
+   * @brief   Number of threads allocated from the memory pool.
+   */
+  ucnt_t                        created;
+  /**
+   * @brief   Number of parked threads handed a new function.
+   */
+  ucnt_t                        reused;
+#if (CH_CFG_USE_TM == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Latency of the creations allocating a new thread.
+   * @note    The working area allocation and fill are not measured.
+   */
+  time_measurement_t            create_tm;
+  /**
+   * @brief   Latency of the creations reusing a parked thread.
+   */
+  time_measurement_t            reuse_tm;
+#endif
+} thread_pool_t;
+#endif /* CH_CFG_USE_MEMPOOLS == TRUE */
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -83,6 +118,10 @@ extern "C" {
 #if CH_CFG_USE_MEMPOOLS == TRUE
   thread_t *chThdCreateFromMemoryPool(memory_pool_t *mp, const char *name,
                                       tprio_t prio, tfunc_t pf, void *arg);
+  void chThdPoolObjectInit(thread_pool_t *pp, memory_pool_t *mp);
+  thread_t *chThdCreateFromThreadPool(thread_pool_t *pp, const char *name,
+                                      tprio_t prio, tfunc_t pf, void *arg);
+  void chThdPoolFlush(thread_pool_t *pp);
 #endif
 #ifdef __cplusplus
 }
@@ -92,6 +131,34 @@ extern "C" {
 /* Module inline functions.                                                  */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the number of threads allocated by a thread pool.
+ *
+ * @param[in] pp        pointer to the @p thread_pool_t object
+ * @return              The number of threads allocated from the memory pool.
+ *
+ * @xclass
+ */
+static inline ucnt_t chThdPoolGetCreatedX(thread_pool_t *pp) {
+
+  return pp->created;
+}
+
+/**
+ * @brief   Returns the number of thread reuses performed by a thread pool.
+ *
+ * @param[in] pp        pointer to the @p thread_pool_t object
+ * @return              The number of creations served by parked threads.
+ *
+ * @xclass
+ */
+static inline ucnt_t chThdPoolGetReusedX(thread_pool_t *pp) {
+
+  return pp->reused;
+}
+#endif /* CH_CFG_USE_MEMPOOLS == TRUE */
+
 #endif /* CH_CFG_USE_DYNAMIC == TRUE */
 
 #endif /* CHDYNAMIC_H */
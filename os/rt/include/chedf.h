@@ -0,0 +1,145 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/include/chedf.h
+ * @brief   EDF scheduling macros and structures.
+ *
+ * @addtogroup edf
+ * @{
+ */
+
+#ifndef CHEDF_H
+#define CHEDF_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chEDFStart(sysinterval_t period, sysinterval_t deadline);
+  void chEDFStop(void);
+  bool chEDFWaitNextJob(void);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Determines if a thread precedes another thread of the same
+ *          priority.
+ * @details An EDF thread precedes threads without a deadline and EDF
+ *          threads with a later absolute deadline.
+ * @note    Deadlines are compared using their difference so the deadlines
+ *          of the ready threads must be within half the system time range.
+ *
+ * @param[in] atp       pointer to the first thread
+ * @param[in] btp       pointer to the second thread
+ * @return              The comparison result.
+ * @retval false        if the first thread does not precede the second.
+ * @retval true         if the first thread precedes the second.
+ *
+ * @notapi
+ */
+static inline bool __edf_precedes(const thread_t *atp, const thread_t *btp) {
+  systime_t diff;
+
+  if ((atp->flags & CH_FLAG_EDF) == (tmode_t)0) {
+    return false;
+  }
+  if ((btp->flags & CH_FLAG_EDF) == (tmode_t)0) {
+    return true;
+  }
+
+  diff = (systime_t)(btp->edf.deadline - atp->edf.deadline);
+
+  return (diff != (systime_t)0) && (diff <= (TIME_MAX_SYSTIME / (systime_t)2));
+}
+
+/**
+ * @brief   Returns the absolute deadline of the current job of a thread.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The absolute deadline.
+ *
+ * @xclass
+ */
+static inline systime_t chEDFGetDeadlineX(thread_t *tp) {
+
+  return tp->edf.deadline;
+}
+
+/**
+ * @brief   Returns the number of jobs completed by a thread.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The number of completed jobs.
+ *
+ * @xclass
+ */
+static inline ucnt_t chEDFGetJobsX(thread_t *tp) {
+
+  return tp->edf.jobs;
+}
+
+/**
+ * @brief   Returns the number of deadlines missed by a thread.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The number of jobs completed after their deadline.
+ *
+ * @xclass
+ */
+static inline ucnt_t chEDFGetMissesX(thread_t *tp) {
+
+  return tp->edf.misses;
+}
+
+#endif /* CH_CFG_USE_EDF == TRUE */
+
+#endif /* CHEDF_H */
+
+/** @} */
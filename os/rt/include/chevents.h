@@ -51,6 +51,13 @@
 
 typedef struct event_listener event_listener_t;
 
+#if (CH_CFG_USE_EVENTS_POLL == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of an Events Poll Set.
+ */
+typedef struct event_poll event_poll_t;
+#endif
+
 /**
  * @brief   Event Listener structure.
  */
@@ -66,8 +73,29 @@ struct event_listener {
                                                     by the event source.    */
   eventflags_t          wflags;         /**< @brief Flags that this listener
                                                     interested in.          */
+#if (CH_CFG_USE_EVENTS_POLL == TRUE) || defined(__DOXYGEN__)
+  event_poll_t          *poll;          /**< @brief Poll set owning the
+                                                    listener or @p NULL.    */
+  event_listener_t      *rnext;         /**< @brief Next listener in the poll
+                                                    set ready list, @p NULL
+                                                    if not ready, itself if
+                                                    last.                   */
+#endif
 };
 
+#if (CH_CFG_USE_EVENTS_POLL == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Events Poll Set structure.
+ */
+struct event_poll {
+  event_listener_t      *rfirst;        /**< @brief First ready listener or
+                                                    @p NULL.                */
+  event_listener_t      *rlast;         /**< @brief Last ready listener.   */
+  thread_reference_t    thread;         /**< @brief Thread waiting on the
+                                                    poll set.               */
+};
+#endif
+
 /**
  * @brief   Event Source structure.
  */
@@ -139,6 +167,16 @@ extern "C" {
   void chEvtBroadcastFlags(event_source_t *esp, eventflags_t flags);
   void chEvtBroadcastFlagsI(event_source_t *esp, eventflags_t flags);
   void chEvtDispatch(const evhandler_t *handlers, eventmask_t events);
+#if CH_CFG_USE_EVENTS_POLL == TRUE
+  void chEvtPollRegisterWithFlags(event_poll_t *epp,
+                                  event_source_t *esp,
+                                  event_listener_t *elp,
+                                  eventflags_t wflags);
+  cnt_t chEvtPollWaitTimeout(event_poll_t *epp,
+                             event_listener_t *elps[],
+                             cnt_t n,
+                             sysinterval_t timeout);
+#endif
 #if (CH_CFG_OPTIMIZE_SPEED == TRUE) || (CH_CFG_USE_EVENTS_TIMEOUT == FALSE)
   eventmask_t chEvtWaitOne(eventmask_t events);
   eventmask_t chEvtWaitAny(eventmask_t events);
@@ -288,6 +326,57 @@ static inline eventmask_t chEvtGetEventsX(void) {
   return __sch_get_currthread()->epending;
 }
 
+#if (CH_CFG_USE_EVENTS_POLL == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an Events Poll Set.
+ *
+ * @param[out] epp      pointer to the @p event_poll_t structure
+ *
+ * @init
+ */
+static inline void chEvtPollObjectInit(event_poll_t *epp) {
+
+  epp->rfirst = NULL;
+  epp->rlast  = NULL;
+  epp->thread = NULL;
+}
+
+/**
+ * @brief   Registers an Event Listener on an Event Source and a Poll Set.
+ * @details The listener is added to the poll set ready list when the source
+ *          is broadcasted.
+ *
+ * @param[in] epp       pointer to the @p event_poll_t structure
+ * @param[in] esp       pointer to the @p event_source_t structure
+ * @param[out] elp      pointer to the @p event_listener_t structure
+ *
+ * @api
+ */
+static inline void chEvtPollRegister(event_poll_t *epp,
+                                     event_source_t *esp,
+                                     event_listener_t *elp) {
+
+  chEvtPollRegisterWithFlags(epp, esp, elp, (eventflags_t)-1);
+}
+
+/**
+ * @brief   Verifies if a poll set has ready listeners.
+ *
+ * @param[in] epp       pointer to the @p event_poll_t structure
+ * @return              The poll set status.
+ * @retval false        if there are no ready listeners.
+ * @retval true         if there is at least one ready listener.
+ *
+ * @iclass
+ */
+static inline bool chEvtPollIsReadyI(event_poll_t *epp) {
+
+  chDbgCheckClassI();
+
+  return (bool)(epp->rfirst != NULL);
+}
+#endif /* CH_CFG_USE_EVENTS_POLL == TRUE */
+
 #endif /* CH_CFG_USE_EVENTS == TRUE */
 
 #endif /* CHEVENTS_H */
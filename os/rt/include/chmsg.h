@@ -34,6 +34,18 @@
 /* Module constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @name    Asynchronous message states
+ * @{
+ */
+#define CH_MSG_ASYNC_NONE       (uint8_t)0  /**< @brief No pending message. */
+#define CH_MSG_ASYNC_QUEUED     (uint8_t)1  /**< @brief Queued on the server.*/
+#define CH_MSG_ASYNC_RECEIVED   (uint8_t)2  /**< @brief Received by the
+                                                 server.                    */
+#define CH_MSG_ASYNC_ANSWERED   (uint8_t)3  /**< @brief Answered, the answer
+                                                 is not yet collected.      */
+/** @} */
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -50,10 +62,19 @@
 /* Module macros.                                                            */
 /*===========================================================================*/
 
+#if CH_CFG_USE_MESSAGES_ASYNC == TRUE
+#define __ch_msg_node(tp)       ((ch_queue_t *)&(tp)->msgsnd.queue)
+#define __ch_msg_thread(p)                                                  \
+  ((thread_t *)(void *)((uint8_t *)(p) - offsetof(thread_t, msgsnd.queue)))
+#else
+#define __ch_msg_node(tp)       (&(tp)->hdr.queue)
+#define __ch_msg_thread(p)      threadref(p)
+#endif
+
 #if CH_CFG_USE_MESSAGES_PRIORITY == TRUE
-#define __ch_msg_insert(qp, tp) ch_sch_prio_insert(qp, &tp->hdr.queue)
+#define __ch_msg_insert(qp, tp) ch_sch_prio_insert(qp, __ch_msg_node(tp))
 #else
-#define __ch_msg_insert(qp, tp) ch_queue_insert(qp, &tp->hdr.queue)
+#define __ch_msg_insert(qp, tp) ch_queue_insert(qp, __ch_msg_node(tp))
 #endif
 
 /*===========================================================================*/
@@ -67,7 +88,15 @@ extern "C" {
   thread_t *chMsgWaitS(void);
   thread_t *chMsgWaitTimeoutS(sysinterval_t timeout);
   thread_t *chMsgPollS(void);
+  cnt_t chMsgWaitBatchTimeoutS(thread_t **tpp, cnt_t n,
+                               sysinterval_t timeout);
+  void chMsgReleaseI(thread_t *tp, msg_t msg);
   void chMsgRelease(thread_t *tp, msg_t msg);
+  void chMsgReleaseBatch(thread_t **tpp, const msg_t *msgs, cnt_t n);
+#if CH_CFG_USE_MESSAGES_ASYNC == TRUE
+  void chMsgSendAsync(thread_t *tp, msg_t msg);
+  msg_t chMsgWaitAnswer(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -162,6 +191,60 @@ static inline thread_t *chMsgPoll(void) {
   return tp;
 }
 
+/**
+ * @brief   Receives a batch of messages.
+ * @details The function waits for at least one message then dequeues up to
+ *          @p n pending senders, in queue order, in a single critical zone.
+ * @post    Each received message must be retrieved using @p chMsgGet() and
+ *          acknowledged using @p chMsgRelease() or, all together, using
+ *          @p chMsgReleaseBatch().
+ * @note    The reference counters of the sender threads are not increased,
+ *          the returned pointers are temporary references.
+ *
+ * @param[out] tpp      array receiving the pointers to the sender threads
+ * @param[in] n         size of the array, it must be greater than zero
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of received messages.
+ * @retval 0            if a timeout occurred.
+ *
+ * @api
+ */
+static inline cnt_t chMsgWaitBatchTimeout(thread_t **tpp, cnt_t n,
+                                          sysinterval_t timeout) {
+  cnt_t cnt;
+
+  chSysLock();
+  cnt = chMsgWaitBatchTimeoutS(tpp, n, timeout);
+  chSysUnlock();
+
+  return cnt;
+}
+
+/**
+ * @brief   Receives a batch of messages.
+ * @details The function waits for at least one message then dequeues up to
+ *          @p n pending senders, in queue order, in a single critical zone.
+ * @post    Each received message must be retrieved using @p chMsgGet() and
+ *          acknowledged using @p chMsgRelease() or, all together, using
+ *          @p chMsgReleaseBatch().
+ * @note    The reference counters of the sender threads are not increased,
+ *          the returned pointers are temporary references.
+ *
+ * @param[out] tpp      array receiving the pointers to the sender threads
+ * @param[in] n         size of the array, it must be greater than zero
+ * @return              The number of received messages.
+ *
+ * @api
+ */
+static inline cnt_t chMsgWaitBatch(thread_t **tpp, cnt_t n) {
+
+  return chMsgWaitBatchTimeout(tpp, n, TIME_INFINITE);
+}
+
 /**
  * @brief   Evaluates to @p true if the thread has pending messages.
  *
@@ -189,6 +272,12 @@ static inline bool chMsgIsPendingI(thread_t *tp) {
  */
 static inline msg_t chMsgGet(thread_t *tp) {
 
+#if CH_CFG_USE_MESSAGES_ASYNC == TRUE
+  if (tp->msgsnd.state == CH_MSG_ASYNC_RECEIVED) {
+    return tp->msgsnd.msg;
+  }
+#endif
+
   chDbgAssert(tp->state == CH_STATE_SNDMSG, "invalid state");
 
   return tp->u.sentmsg;
@@ -208,9 +297,38 @@ static inline void chMsgReleaseS(thread_t *tp, msg_t msg) {
 
   chDbgCheckClassS();
 
+#if CH_CFG_USE_MESSAGES_ASYNC == TRUE
+  if (tp->msgsnd.state == CH_MSG_ASYNC_RECEIVED) {
+    tp->msgsnd.msg   = msg;
+    tp->msgsnd.state = CH_MSG_ASYNC_ANSWERED;
+
+    /* The sender is not necessarily waiting for the answer yet.*/
+    if (tp->state != CH_STATE_SNDMSG) {
+      return;
+    }
+  }
+#endif
+
   chSchWakeupS(tp, msg);
 }
 
+#if (CH_CFG_USE_MESSAGES_ASYNC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Checks if the answer to an asynchronous message is available.
+ *
+ * @return              The answer state.
+ * @retval false        if there is no answer to be collected.
+ * @retval true         if the answer is available, @p chMsgWaitAnswer()
+ *                      would not block.
+ *
+ * @xclass
+ */
+static inline bool chMsgIsAnsweredX(void) {
+
+  return (bool)(chThdGetSelfX()->msgsnd.state == CH_MSG_ASYNC_ANSWERED);
+}
+#endif
+
 #endif /* CH_CFG_USE_MESSAGES == TRUE */
 
 #endif /* CHMSG_H */
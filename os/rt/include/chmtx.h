@@ -42,6 +42,11 @@
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_MUTEXES_FASTPATH == TRUE) &&                                \
+    (!defined(PORT_SUPPORTS_ATOMIC_CAS) || (PORT_SUPPORTS_ATOMIC_CAS == FALSE))
+#error "CH_CFG_USE_MUTEXES_FASTPATH requires port atomic CAS support"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -70,6 +75,46 @@ struct ch_mutex {
 /* Module macros.                                                            */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_MUTEXES_FASTPATH == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Owner field flag signaling threads waiting on the mutex.
+ * @details The flag makes the owner compare-and-swap of the unlock fast
+ *          path fail so that the waiting threads are handled by the kernel.
+ */
+#define __MTX_WAITERS_FLAG  ((uintptr_t)1U)
+
+/**
+ * @brief   Returns the mutex owner thread from the owner field.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @return              The owner thread.
+ * @retval NULL         if the mutex is not owned.
+ *
+ * @notapi
+ */
+#define __mtx_owner(mp)                                                     \
+  ((thread_t *)((uintptr_t)(mp)->owner & ~__MTX_WAITERS_FLAG))
+#else
+#define __mtx_owner(mp) ((mp)->owner)
+#endif
+
+/**
+ * @brief   Returns the base priority of a thread.
+ * @details The base priority is the thread own priority raised to the
+ *          ceiling of the owned priority ceiling mutexes, if any, the
+ *          priority inherited through mutexes is not included.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The base priority.
+ *
+ * @notapi
+ */
+#if (CH_CFG_USE_PCMUTEXES == TRUE) || defined(__DOXYGEN__)
+#define __mtx_base_prio(tp) __pcmtx_base_prio(tp)
+#else
+#define __mtx_base_prio(tp) ((tp)->realprio)
+#endif
+
 /**
  * @brief   Data part of a static mutex initializer.
  * @details This macro should be used when statically initializing a mutex
@@ -108,6 +153,8 @@ extern "C" {
   void chMtxUnlockS(mutex_t *mp);
   void chMtxUnlockAll(void);
   void chMtxUnlockAllS(void);
+  void __mtx_prio_boost(thread_t *tp, tprio_t prio);
+  bool __mtx_take_or_enqueue(mutex_t *mp, thread_t *tp);
 #ifdef __cplusplus
 }
 #endif
@@ -145,7 +192,7 @@ static inline thread_t *chMtxGetOwnerI(mutex_t *mp) {
 
   chDbgCheckClassI();
 
-  return mp->owner;
+  return __mtx_owner(mp);
 }
 
 /**
@@ -89,8 +89,55 @@ struct ch_virtual_timer {
    * @brief   Current reload interval.
    */
   sysinterval_t                 reload;
+#if (CH_CFG_USE_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Callback deferred to the timers thread.
+   */
+  bool                          deferred;
+  /**
+   * @brief   Next timer in the deferred callbacks list.
+   * @note    It is @p NULL if the callback is not pending, the last timer
+   *          in the list points to itself.
+   */
+  virtual_timer_t               *dnext;
+  /**
+   * @brief   Previous timer in the deferred callbacks list.
+   * @note    It is @p NULL for the first timer in the list.
+   */
+  virtual_timer_t               *dprev;
+  /**
+   * @brief   Realtime counter value when the callback has been deferred.
+   */
+  rtcnt_t                       dstamp;
+#endif
 };
 
+#if (CH_CFG_USE_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of deferred callbacks statistics.
+ * @note    Latencies are measured in realtime counter cycles from the timer
+ *          expiration to the callback invocation.
+ */
+typedef struct ch_vt_deferred_stats {
+  /**
+   * @brief   Best latency.
+   */
+  rtcnt_t                       best;
+  /**
+   * @brief   Worst latency.
+   */
+  rtcnt_t                       worst;
+  /**
+   * @brief   Number of deferred callbacks invoked.
+   */
+  ucnt_t                        n;
+  /**
+   * @brief   Accumulated latency.
+   */
+  rttime_t                      cumulative;
+} vt_deferred_stats_t;
+#endif
+
 /**
  * @brief   Type of virtual timers list header.
  * @note    The timers list is implemented as a double link bidirectional list
@@ -120,6 +167,29 @@ typedef struct ch_virtual_timers_list {
    */
   volatile uint64_t             laststamp;
 #endif
+#if (CH_CFG_USE_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Deferred callbacks state.
+   */
+  struct {
+    /**
+     * @brief   First timer with a pending callback or @p NULL.
+     */
+    virtual_timer_t             *first;
+    /**
+     * @brief   Last timer with a pending callback.
+     */
+    virtual_timer_t             *last;
+    /**
+     * @brief   Timers thread waiting for callbacks.
+     */
+    thread_t                    *thread;
+    /**
+     * @brief   Deferral latency statistics.
+     */
+    vt_deferred_stats_t         stats;
+  } deferred;
+#endif
 } virtual_timers_list_t;
 
 /**
@@ -130,6 +200,20 @@ typedef struct ch_registry {
    * @brief   Registry queue header.
    */
   ch_queue_t                    queue;
+  /**
+   * @brief   Generation of the last registered thread.
+   */
+  ucnt_t                        gen;
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+  /**
+   * @brief   Threads hashed by name.
+   */
+  thread_t                      *names[CH_CFG_REGISTRY_HASH_SIZE];
+  /**
+   * @brief   Threads hashed by pointer.
+   */
+  thread_t                      *pointers[CH_CFG_REGISTRY_HASH_SIZE];
+#endif
 } registry_t;
 
 /**
@@ -152,6 +236,10 @@ typedef struct ch_threads_queue {
  * @note    Not all the listed fields are always needed, by switching off some
  *          not needed ChibiOS/RT subsystems it is possible to save RAM space
  *          by shrinking this structure.
+ * @note    The fields accessed on each context switch are grouped at the
+ *          beginning of the structure so that they share the first cache
+ *          line on cached cores, the registry, debug and statistics fields
+ *          are placed after the scheduler fields.
  */
 struct ch_thread {
   /**
@@ -175,31 +263,10 @@ struct ch_thread {
    * @brief   Processor context.
    */
   struct port_context           ctx;
-#if (CH_CFG_USE_REGISTRY == TRUE) || defined(__DOXYGEN__)
-  /**
-   * @brief   Registry queue element.
-   */
-  ch_queue_t                    rqueue;
-#endif
   /**
    * @brief   OS instance owner of this thread.
    */
   os_instance_t                 *owner;
-#if (CH_CFG_USE_REGISTRY == TRUE) || defined(__DOXYGEN__)
-  /**
-   * @brief   Thread name or @p NULL.
-   */
-  const char                    *name;
-#endif
-#if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE) ||  \
-    defined(__DOXYGEN__)
-  /**
-   * @brief   Working area base address.
-   * @note    This pointer is used for stack overflow checks and for
-   *          dynamic threading.
-   */
-  stkalign_t                    *wabase;
-#endif
   /**
    * @brief   Current thread state.
    */
@@ -208,24 +275,15 @@ struct ch_thread {
    * @brief   Various thread flags.
    */
   tmode_t                       flags;
-#if (CH_CFG_USE_REGISTRY == TRUE) || defined(__DOXYGEN__)
-  /**
-   * @brief   References to this thread.
-   */
-  trefs_t                       refs;
-#endif
+#if (CH_CFG_TIME_QUANTUM > 0) || defined(__DOXYGEN__)
   /**
    * @brief   Number of ticks remaining to this thread.
    */
-#if (CH_CFG_TIME_QUANTUM > 0) || defined(__DOXYGEN__)
   tslices_t                     ticks;
-#endif
-#if (CH_DBG_THREADS_PROFILING == TRUE) || defined(__DOXYGEN__)
   /**
-   * @brief   Thread consumed time in ticks.
-   * @note    This field can overflow.
+   * @brief   Time quantum assigned to this thread.
    */
-  volatile systime_t            time;
+  tslices_t                     quantum;
 #endif
   /**
    * @brief   State-specific fields.
@@ -284,6 +342,22 @@ struct ch_thread {
      *          state.
      */
     struct ch_mutex             *wtmtxp;
+    /**
+     * @brief   Pointer to a generic readers-writer lock object.
+     * @note    This field is used to get a pointer to a synchronization
+     *          object and is valid when the thread is in @p CH_STATE_WTRWRD
+     *          or @p CH_STATE_WTRWWR states.
+     */
+    struct ch_rwlock            *wtrwlp;
+#endif
+#if (CH_CFG_USE_PCMUTEXES == TRUE) || defined(__DOXYGEN__)
+    /**
+     * @brief   Pointer to a generic priority ceiling mutex object.
+     * @note    This field is used to get a pointer to a synchronization
+     *          object and is valid when the thread is in
+     *          @p CH_STATE_WTPCMTX state.
+     */
+    struct ch_pcmutex           *wtpcmtxp;
 #endif
 #if (CH_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
     /**
@@ -294,17 +368,48 @@ struct ch_thread {
     eventmask_t                 ewmask;
 #endif
   }                             u;
-#if (CH_CFG_USE_WAITEXIT == TRUE) || defined(__DOXYGEN__)
+#if (CH_DBG_THREADS_PROFILING == TRUE) || defined(__DOXYGEN__)
   /**
-   * @brief   Termination waiting list.
+   * @brief   Thread consumed time in ticks.
+   * @note    This field can overflow.
    */
-  ch_list_t                     waiting;
+  volatile systime_t            time;
 #endif
 #if (CH_CFG_USE_MESSAGES == TRUE) || defined(__DOXYGEN__)
   /**
    * @brief   Messages queue.
    */
   ch_queue_t                    msgqueue;
+#if (CH_CFG_USE_MESSAGES_PRIORITY == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Server thread the message has been sent to.
+   * @note    This field is only valid while the thread is in the
+   *          @p CH_STATE_SNDMSGQ state, it is required for re-enqueuing
+   *          the sender when its priority is boosted.
+   */
+  thread_t                      *msgserver;
+#endif
+#if (CH_CFG_USE_MESSAGES_ASYNC == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Messages sender state.
+   */
+  struct {
+    /**
+     * @brief   Link in the server messages queue.
+     * @note    A dedicated link because an asynchronous sender can be
+     *          queued on a server while waiting on another object.
+     */
+    ch_priority_queue_t         queue;
+    /**
+     * @brief   Asynchronous message, then its answer.
+     */
+    msg_t                       msg;
+    /**
+     * @brief   Asynchronous message state.
+     */
+    uint8_t                     state;
+  }                             msgsnd;
+#endif
 #endif
 #if (CH_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
   /**
@@ -323,6 +428,78 @@ struct ch_thread {
    */
   tprio_t                       realprio;
 #endif
+#if (CH_CFG_USE_PCMUTEXES == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   List of the priority ceiling mutexes owned by this thread.
+   * @note    The list is terminated by a @p NULL in this field.
+   */
+  struct ch_pcmutex             *pcmtxlist;
+#endif
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   EDF scheduling parameters and counters.
+   * @note    The fields are only valid if the thread has the
+   *          @p CH_FLAG_EDF flag set.
+   */
+  struct {
+    /**
+     * @brief   Absolute deadline of the current job.
+     */
+    systime_t                   deadline;
+    /**
+     * @brief   Release time of the current job.
+     */
+    systime_t                   release;
+    /**
+     * @brief   Jobs period.
+     */
+    sysinterval_t               period;
+    /**
+     * @brief   Jobs deadline relative to their release time.
+     */
+    sysinterval_t               reldeadline;
+    /**
+     * @brief   Number of completed jobs.
+     */
+    ucnt_t                      jobs;
+    /**
+     * @brief   Number of jobs completed after their deadline.
+     */
+    ucnt_t                      misses;
+  } edf;
+#endif
+  /* Fields not involved in scheduling, kept out of the first cache line.*/
+#if (CH_CFG_USE_REGISTRY == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Registry queue element.
+   */
+  ch_queue_t                    rqueue;
+  /**
+   * @brief   Thread name or @p NULL.
+   */
+  const char                    *name;
+#endif
+#if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE) ||  \
+    (CH_DBG_STACK_PROFILER == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Working area base address.
+   * @note    This pointer is used for stack overflow checks, for
+   *          dynamic threading and for stack profiling.
+   */
+  stkalign_t                    *wabase;
+#endif
+#if (CH_CFG_USE_REGISTRY == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   References to this thread.
+   */
+  trefs_t                       refs;
+#endif
+#if (CH_CFG_USE_WAITEXIT == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Termination waiting list.
+   */
+  ch_list_t                     waiting;
+#endif
 #if ((CH_CFG_USE_DYNAMIC == TRUE) && (CH_CFG_USE_MEMPOOLS == TRUE)) ||      \
     defined(__DOXYGEN__)
   /**
@@ -335,6 +512,49 @@ struct ch_thread {
    * @brief   Thread statistics.
    */
   time_measurement_t            stats;
+  /**
+   * @brief   Number of times the thread has been put behind its peers
+   *          because its time quantum expired.
+   */
+  ucnt_t                        rrswc;
+#endif
+#if (CH_CFG_USE_REGISTRY == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Thread generation, unique among the threads created in the
+   *          same registry.
+   */
+  ucnt_t                        gen;
+#endif
+#if (CH_DBG_STACK_PROFILER == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Stack profiler state.
+   */
+  struct {
+    /**
+     * @brief   Next stack byte to be checked.
+     */
+    uint8_t                     *scan;
+    /**
+     * @brief   Lowest stack byte found used or @p NULL if the thread has
+     *          not been sampled yet.
+     */
+    uint8_t                     *mark;
+    /**
+     * @brief   Low headroom already signaled.
+     */
+    bool                        warned;
+  } stkprof;
+#endif
+#if ((CH_CFG_USE_REGISTRY == TRUE) && (CH_CFG_REGISTRY_HASH_SIZE > 0)) ||   \
+    defined(__DOXYGEN__)
+  /**
+   * @brief   Next thread in the registry name hash chain.
+   */
+  thread_t                      *hnname;
+  /**
+   * @brief   Next thread in the registry pointer hash chain.
+   */
+  thread_t                      *hnptr;
 #endif
 #if defined(CH_CFG_THREAD_EXTRA_FIELDS)
   /* Extra fields defined in chconf.h.*/
@@ -366,7 +586,7 @@ typedef struct ch_os_instance_config {
    */
   const char                    *name;
 #if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE) ||  \
-    defined(__DOXYGEN__)
+    (CH_DBG_STACK_PROFILER == TRUE) || defined(__DOXYGEN__)
   /**
    * @brief   Lower limit of the main function thread stack.
    */
@@ -386,6 +606,16 @@ typedef struct ch_os_instance_config {
    */
   stkalign_t                    *idlethread_end;
 #endif
+#if (CH_CFG_USE_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Lower limit of the timers thread stack.
+   */
+  stkalign_t                    *timerthread_base;
+  /**
+   * @brief   Upper limit of the timers thread stack.
+   */
+  stkalign_t                    *timerthread_end;
+#endif
 } os_instance_config_t;
 
 /**
@@ -443,6 +673,12 @@ struct ch_os_instance {
    */
   kernel_stats_t                kernel_stats;
 #endif
+#if (CH_DBG_CS_PROFILER == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Critical zones profiler.
+   */
+  cs_profiler_t                 csprof;
+#endif
 #if defined(PORT_INSTANCE_EXTRA_FIELDS) || defined(__DOXYGEN__)
   /* Extra fields from port layer.*/
   PORT_INSTANCE_EXTRA_FIELDS
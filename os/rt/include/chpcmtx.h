@@ -0,0 +1,186 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/include/chpcmtx.h
+ * @brief   Priority Ceiling Mutexes macros and structures.
+ *
+ * @addtogroup pcmutexes
+ * @{
+ */
+
+#ifndef CHPCMTX_H
+#define CHPCMTX_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+#if (CH_CFG_USE_PCMUTEXES == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CH_CFG_USE_MUTEXES == FALSE
+#error "CH_CFG_USE_PCMUTEXES requires CH_CFG_USE_MUTEXES"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a priority ceiling mutex structure.
+ */
+typedef struct ch_pcmutex pcmutex_t;
+
+/**
+ * @brief   Priority ceiling mutex structure.
+ */
+struct ch_pcmutex {
+  ch_queue_t            queue;      /**< @brief Queue of the threads sleeping
+                                                on this mutex.              */
+  thread_t              *owner;     /**< @brief Owner @p thread_t pointer or
+                                                @p NULL.                    */
+  pcmutex_t             *next;      /**< @brief Next @p pcmutex_t into an
+                                                owner-list or @p NULL.      */
+  tprio_t               ceiling;    /**< @brief Priority ceiling.           */
+  tprio_t               maxceiling; /**< @brief Highest ceiling among this
+                                                mutex and the mutexes owned
+                                                before it.                  */
+};
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Data part of a static priority ceiling mutex initializer.
+ * @details This macro should be used when statically initializing a
+ *          priority ceiling mutex that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the mutex variable
+ * @param[in] prio      the priority ceiling
+ */
+#define __PCMUTEX_DATA(name, prio) {__CH_QUEUE_DATA(name.queue), NULL,     \
+                                    NULL, (tprio_t)(prio), (tprio_t)0}
+
+/**
+ * @brief   Static priority ceiling mutex initializer.
+ * @details Statically initialized mutexes require no explicit
+ *          initialization using @p chPCMtxObjectInit().
+ *
+ * @param[in] name      the name of the mutex variable
+ * @param[in] prio      the priority ceiling
+ */
+#define PCMUTEX_DECL(name, prio) pcmutex_t name = __PCMUTEX_DATA(name, prio)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chPCMtxObjectInit(pcmutex_t *pcmp, tprio_t ceiling);
+  void chPCMtxLock(pcmutex_t *pcmp);
+  void chPCMtxLockS(pcmutex_t *pcmp);
+  bool chPCMtxTryLock(pcmutex_t *pcmp);
+  bool chPCMtxTryLockS(pcmutex_t *pcmp);
+  void chPCMtxUnlock(pcmutex_t *pcmp);
+  void chPCMtxUnlockS(pcmutex_t *pcmp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the priority ceiling of a mutex.
+ *
+ * @param[in] pcmp      pointer to the @p pcmutex_t structure
+ * @return              The priority ceiling.
+ *
+ * @xclass
+ */
+static inline tprio_t chPCMtxGetCeilingX(pcmutex_t *pcmp) {
+
+  return pcmp->ceiling;
+}
+
+/**
+ * @brief   Returns the mutex owner thread.
+ *
+ * @param[in] pcmp      pointer to the @p pcmutex_t structure
+ * @return              The owner thread.
+ * @retval NULL         if the mutex is not owned.
+ *
+ * @iclass
+ */
+static inline thread_t *chPCMtxGetOwnerI(pcmutex_t *pcmp) {
+
+  chDbgCheckClassI();
+
+  return pcmp->owner;
+}
+
+/**
+ * @brief   Returns the base priority of a thread.
+ * @details The thread own priority raised to the highest ceiling among
+ *          the owned priority ceiling mutexes.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The base priority.
+ *
+ * @notapi
+ */
+static inline tprio_t __pcmtx_base_prio(thread_t *tp) {
+
+  if ((tp->pcmtxlist != NULL) && (tp->pcmtxlist->maxceiling > tp->realprio)) {
+    return tp->pcmtxlist->maxceiling;
+  }
+
+  return tp->realprio;
+}
+
+/**
+ * @brief   Returns the next priority ceiling mutex to be unlocked.
+ *
+ * @return              A pointer to the next mutex in the stack.
+ * @retval NULL         if the stack is empty.
+ *
+ * @xclass
+ */
+static inline pcmutex_t *chPCMtxGetNextMutexX(void) {
+
+  return chThdGetSelfX()->pcmtxlist;
+}
+
+#endif /* CH_CFG_USE_PCMUTEXES == TRUE */
+
+#endif /* CHPCMTX_H */
+
+/** @} */
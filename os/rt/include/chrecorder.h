@@ -0,0 +1,351 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/include/chrecorder.h
+ * @brief   Flight recorder macros and structures.
+ *
+ * @addtogroup recorder
+ * @{
+ */
+
+#ifndef CHRECORDER_H
+#define CHRECORDER_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Recorder area magic number.
+ */
+#define CH_REC_MAGIC                        0x52454344U
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Recorder events in each history.
+ * @note    It must be a power of two.
+ */
+#if !defined(CH_DBG_RECORDER_SIZE) || defined(__DOXYGEN__)
+#define CH_DBG_RECORDER_SIZE                256
+#endif
+
+/**
+ * @brief   Recorded events.
+ * @details It is a mask of the @p CH_DBG_TRACE_MASK_XXX values, events not
+ *          in the mask are removed at compile time.
+ */
+#if !defined(CH_DBG_RECORDER_MASK) || defined(__DOXYGEN__)
+#define CH_DBG_RECORDER_MASK                (CH_DBG_TRACE_MASK_SWITCH |     \
+                                             CH_DBG_TRACE_MASK_HALT |       \
+                                             CH_DBG_TRACE_MASK_USER)
+#endif
+
+/**
+ * @brief   Recorder area linker section.
+ * @details The section must not be initialized by the startup code, the
+ *          default is the no-init part of RAM0 in the ARMCMx linker
+ *          scripts.
+ * @note    The section is only applied if the port includes
+ *          @p ccportab.h, else the area is a normal variable and the
+ *          previous history is not preserved.
+ */
+#if !defined(CH_DBG_RECORDER_SECTION) || defined(__DOXYGEN__)
+#define CH_DBG_RECORDER_SECTION             ".ram0"
+#endif
+
+#if (CH_DBG_RECORDER == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (CH_DBG_RECORDER_SIZE < 16) ||                                          \
+    ((CH_DBG_RECORDER_SIZE & (CH_DBG_RECORDER_SIZE - 1)) != 0)
+#error "invalid CH_DBG_RECORDER_SIZE value"
+#endif
+
+#if (CH_DBG_RECORDER_MASK & ~CH_DBG_TRACE_MASK_ALL) != 0
+#error "invalid CH_DBG_RECORDER_MASK value"
+#endif
+
+#if CH_CFG_SMP_MODE == TRUE
+#error "CH_DBG_RECORDER is not compatible with CH_CFG_SMP_MODE"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Recorded histories.
+ */
+typedef enum {
+  CH_REC_CURRENT = 0,                   /**< History of this run.           */
+  CH_REC_PREVIOUS = 1                   /**< History of the previous run.   */
+} rec_history_t;
+
+/**
+ * @brief   Recorder event.
+ * @details The event type is one of the @p CH_TRACE_TYPE_XXX values, the
+ *          value field depends on the type:
+ *          - @p CH_TRACE_TYPE_READY, the thread made ready, the state field
+ *            is its previous state.
+ *          - @p CH_TRACE_TYPE_SWITCH, the switched in thread, the state
+ *            field is the state of the switched out thread.
+ *          - @p CH_TRACE_TYPE_ISR_ENTER and @p CH_TRACE_TYPE_ISR_LEAVE, the
+ *            ISR name pointer.
+ *          - @p CH_TRACE_TYPE_HALT, the halt reason pointer.
+ *          - @p CH_TRACE_TYPE_USER, the user value, the state field is the
+ *            user code.
+ *          .
+ * @note    Pointers are recorded as 32 bits values, they are meant to be
+ *          resolved using the application map file.
+ */
+typedef struct {
+  /**
+   * @brief   Type, state and time stamp.
+   * @details Bits 0..2 are the event type, bits 3..7 are the state or user
+   *          code, bits 8..31 are the lower bits of the realtime counter or
+   *          of the system time if the port does not support it.
+   */
+  uint32_t              info;
+  /**
+   * @brief   Event value.
+   */
+  uint32_t              value;
+} rec_event_t;
+
+/**
+ * @brief   Recorder history.
+ */
+typedef struct {
+  /**
+   * @brief   Number of events written in the history.
+   */
+  uint32_t              index;
+  /**
+   * @brief   Ring buffer.
+   */
+  rec_event_t           buffer[CH_DBG_RECORDER_SIZE];
+} rec_bank_t;
+
+/**
+ * @brief   Recorder area.
+ * @details The area contains two histories, on reset the history being
+ *          written becomes the previous one and the recording continues
+ *          on the other history.
+ */
+typedef struct {
+  /**
+   * @brief   Area magic number.
+   */
+  uint32_t              magic;
+  /**
+   * @brief   Number of events in each history.
+   */
+  uint32_t              size;
+  /**
+   * @brief   Index of the history being written.
+   */
+  uint32_t              active;
+  /**
+   * @brief   Number of resets since the area initialization.
+   */
+  uint32_t              boots;
+  /**
+   * @brief   Histories.
+   */
+  rec_bank_t            banks[2];
+} ch_recorder_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @name    Recorder event fields
+ * @{
+ */
+/**
+ * @brief   Returns the type of a recorder event.
+ *
+ * @param[in] ep        pointer to a @p rec_event_t structure
+ * @return              The event type.
+ */
+#define CH_REC_EVENT_TYPE(ep)       ((ep)->info & 7U)
+
+/**
+ * @brief   Returns the state or user code of a recorder event.
+ *
+ * @param[in] ep        pointer to a @p rec_event_t structure
+ * @return              The event state.
+ */
+#define CH_REC_EVENT_STATE(ep)      (((ep)->info >> 3) & 31U)
+
+/**
+ * @brief   Returns the time stamp of a recorder event.
+ *
+ * @param[in] ep        pointer to a @p rec_event_t structure
+ * @return              The 24 bits event time stamp.
+ */
+#define CH_REC_EVENT_STAMP(ep)      ((ep)->info >> 8)
+/** @} */
+
+/**
+ * @brief   Converts a pointer to a recorder event value.
+ *
+ * @param[in] p         the pointer
+ * @return              The lower 32 bits of the pointer.
+ *
+ * @notapi
+ */
+#define __rec_ptr(p)                ((uint32_t)(uintptr_t)(p))
+
+#if ((CH_DBG_RECORDER_MASK & CH_DBG_TRACE_MASK_READY) != 0) ||              \
+    defined(__DOXYGEN__)
+#define __rec_ready(tp)                                                     \
+  __rec_write(CH_TRACE_TYPE_READY, (uint32_t)(tp)->state, __rec_ptr(tp))
+#endif
+
+#if ((CH_DBG_RECORDER_MASK & CH_DBG_TRACE_MASK_SWITCH) != 0) ||             \
+    defined(__DOXYGEN__)
+#define __rec_switch(ntp, otp)                                              \
+  __rec_write(CH_TRACE_TYPE_SWITCH, (uint32_t)(otp)->state, __rec_ptr(ntp))
+#endif
+
+#if ((CH_DBG_RECORDER_MASK & CH_DBG_TRACE_MASK_ISR) != 0) ||                \
+    defined(__DOXYGEN__)
+#define __rec_isr_enter(isr) {                                              \
+  port_lock_from_isr();                                                     \
+  __rec_write(CH_TRACE_TYPE_ISR_ENTER, 0U, __rec_ptr(isr));                 \
+  port_unlock_from_isr();                                                   \
+}
+
+#define __rec_isr_leave(isr) {                                              \
+  port_lock_from_isr();                                                     \
+  __rec_write(CH_TRACE_TYPE_ISR_LEAVE, 0U, __rec_ptr(isr));                 \
+  port_unlock_from_isr();                                                   \
+}
+#endif
+
+#if ((CH_DBG_RECORDER_MASK & CH_DBG_TRACE_MASK_HALT) != 0) ||               \
+    defined(__DOXYGEN__)
+#define __rec_halt(reason)                                                  \
+  __rec_write(CH_TRACE_TYPE_HALT, 0U, __rec_ptr(reason))
+#endif
+
+#endif /* CH_DBG_RECORDER == TRUE */
+
+/* When the recorder or some of its events are disabled the associated
+   hooks are replaced by empty macros.*/
+#if !defined(__rec_ready)
+#define __rec_ready(tp)
+#endif
+#if !defined(__rec_switch)
+#define __rec_switch(ntp, otp)
+#endif
+#if !defined(__rec_isr_enter)
+#define __rec_isr_enter(isr)
+#endif
+#if !defined(__rec_isr_leave)
+#define __rec_isr_leave(isr)
+#endif
+#if !defined(__rec_halt)
+#define __rec_halt(reason)
+#endif
+
+#if (CH_DBG_RECORDER == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if !defined(__DOXYGEN__)
+extern ch_recorder_t ch_recorder;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void __rec_object_init(void);
+  void chRecWriteI(uint32_t code, uint32_t value);
+  void chRecWrite(uint32_t code, uint32_t value);
+  size_t chRecGetSizeI(rec_history_t h);
+  bool chRecGetEventI(rec_history_t h, size_t n, rec_event_t *ep);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Writes an event in the current history.
+ * @note    The indexes are masked so that writing before the recorder
+ *          initialization cannot corrupt memory.
+ *
+ * @param[in] type      the event type
+ * @param[in] state     the event state or user code
+ * @param[in] value     the event value
+ *
+ * @notapi
+ */
+static inline void __rec_write(uint32_t type, uint32_t state,
+                               uint32_t value) {
+  rec_bank_t *bp = &ch_recorder.banks[ch_recorder.active & 1U];
+  rec_event_t *ep;
+  uint32_t stamp;
+
+#if PORT_SUPPORTS_RT == TRUE
+  stamp = (uint32_t)chSysGetRealtimeCounterX();
+#else
+  stamp = (uint32_t)chVTGetSystemTimeX();
+#endif
+
+  ep = &bp->buffer[bp->index & ((uint32_t)CH_DBG_RECORDER_SIZE - 1U)];
+  bp->index++;
+  ep->info  = (stamp << 8) | (state << 3) | type;
+  ep->value = value;
+}
+
+/**
+ * @brief   Returns the number of resets since the recorder area
+ *          initialization.
+ * @note    The recorder area is initialized when it is found invalid,
+ *          usually after a power-on.
+ *
+ * @return              The number of resets.
+ *
+ * @xclass
+ */
+static inline uint32_t chRecGetBootsX(void) {
+
+  return ch_recorder.boots;
+}
+
+#endif /* CH_DBG_RECORDER == TRUE */
+
+#endif /* CHRECORDER_H */
+
+/** @} */
@@ -42,6 +42,10 @@
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if CH_CFG_REGISTRY_HASH_SIZE < 0
+#error "invalid CH_CFG_REGISTRY_HASH_SIZE value"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -87,35 +91,73 @@ typedef struct {
   uint8_t   off_inst_rfcu;          /**< @brief Offset of @p rfcu field.    */
 } chdebug_t;
 
+/**
+ * @brief   Type of a generation-tagged thread handle.
+ * @details A handle remains bound to the thread it has been obtained from,
+ *          a thread created later in the same memory does not match it.
+ */
+typedef struct {
+  thread_t  *tp;                    /**< @brief Pointer to the thread.      */
+  ucnt_t    gen;                    /**< @brief Thread generation.          */
+} thread_handle_t;
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
 
 /**
- * @brief   Access to the registry list header.
+ * @brief   Access to the registry.
  */
 #if (CH_CFG_SMP_MODE == TRUE) || defined(__DOXYGEN__)
-#define REG_HEADER(oip) (&ch_system.reglist.queue)
+#define REG_REGISTRY(oip) (&ch_system.reglist)
 #else
-#define REG_HEADER(oip) (&(oip)->reglist.queue)
+#define REG_REGISTRY(oip) (&(oip)->reglist)
 #endif
 
+/**
+ * @brief   Access to the registry list header.
+ */
+#define REG_HEADER(oip) (&REG_REGISTRY(oip)->queue)
+
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
 /**
  * @brief   Removes a thread from the registry list.
+ * @details The thread generation is cleared, handles to the thread become
+ *          stale.
  * @note    This macro is not meant for use in application code.
  *
  * @param[in] tp        thread to remove from the registry
  */
-#define REG_REMOVE(tp) (void) ch_queue_dequeue(&(tp)->rqueue)
+#define REG_REMOVE(tp) do {                                                 \
+  (void) ch_queue_dequeue(&(tp)->rqueue);                                   \
+  __reg_hash_remove(REG_REGISTRY((tp)->owner), tp);                         \
+  (tp)->gen = (ucnt_t)0;                                                    \
+} while (false)
 
 /**
  * @brief   Adds a thread to the registry list.
+ * @details The thread is assigned a new generation.
  * @note    This macro is not meant for use in application code.
  *
  * @param[in] oip       pointer to the OS instance
  * @param[in] tp        thread to add to the registry
  */
-#define REG_INSERT(oip, tp) ch_queue_insert(REG_HEADER(oip), &(tp)->rqueue)
+#define REG_INSERT(oip, tp) do {                                            \
+  (tp)->gen = ++REG_REGISTRY(oip)->gen;                                     \
+  ch_queue_insert(REG_HEADER(oip), &(tp)->rqueue);                          \
+  __reg_hash_insert(REG_REGISTRY(oip), tp);                                 \
+} while (false)
+#else
+#define REG_REMOVE(tp) do {                                                 \
+  (void) ch_queue_dequeue(&(tp)->rqueue);                                   \
+  (tp)->gen = (ucnt_t)0;                                                    \
+} while (false)
+
+#define REG_INSERT(oip, tp) do {                                            \
+  (tp)->gen = ++REG_REGISTRY(oip)->gen;                                     \
+  ch_queue_insert(REG_HEADER(oip), &(tp)->rqueue);                          \
+} while (false)
+#endif
 
 /*===========================================================================*/
 /* External declarations.                                                    */
@@ -130,6 +172,12 @@ extern "C" {
   thread_t *chRegFindThreadByName(const char *name);
   thread_t *chRegFindThreadByPointer(thread_t *tp);
   thread_t *chRegFindThreadByWorkingArea(stkalign_t *wa);
+  thread_t *chRegFindThreadByHandle(const thread_handle_t *thp);
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  void __reg_hash_insert(registry_t *rp, thread_t *tp);
+  void __reg_hash_remove(registry_t *rp, thread_t *tp);
+  void __reg_set_name(thread_t *tp, const char *name);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -151,6 +199,17 @@ extern "C" {
 static inline void __reg_object_init(registry_t *rp) {
 
   ch_queue_init(&rp->queue);
+  rp->gen = (ucnt_t)0;
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  {
+    unsigned i;
+
+    for (i = 0U; i < (unsigned)CH_CFG_REGISTRY_HASH_SIZE; i++) {
+      rp->names[i]    = NULL;
+      rp->pointers[i] = NULL;
+    }
+  }
+#endif
 }
 
 /**
@@ -164,7 +223,9 @@ static inline void __reg_object_init(registry_t *rp) {
  */
 static inline void chRegSetThreadName(const char *name) {
 
-#if CH_CFG_USE_REGISTRY == TRUE
+#if (CH_CFG_USE_REGISTRY == TRUE) && (CH_CFG_REGISTRY_HASH_SIZE > 0)
+  __reg_set_name(__sch_get_currthread(), name);
+#elif CH_CFG_USE_REGISTRY == TRUE
   __sch_get_currthread()->name = name;
 #else
   (void)name;
@@ -204,7 +265,9 @@ static inline const char *chRegGetThreadNameX(thread_t *tp) {
  */
 static inline void chRegSetThreadNameX(thread_t *tp, const char *name) {
 
-#if CH_CFG_USE_REGISTRY == TRUE
+#if (CH_CFG_USE_REGISTRY == TRUE) && (CH_CFG_REGISTRY_HASH_SIZE > 0)
+  __reg_set_name(tp, name);
+#elif CH_CFG_USE_REGISTRY == TRUE
   tp->name = name;
 #else
   (void)tp;
@@ -212,6 +275,25 @@ static inline void chRegSetThreadNameX(thread_t *tp, const char *name) {
 #endif
 }
 
+#if (CH_CFG_USE_REGISTRY == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns a generation-tagged handle of the specified thread.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The thread handle.
+ *
+ * @xclass
+ */
+static inline thread_handle_t chRegGetHandleX(thread_t *tp) {
+  thread_handle_t th;
+
+  th.tp  = tp;
+  th.gen = tp->gen;
+
+  return th;
+}
+#endif
+
 #endif /* CHREGISTRY_H */
 
 /** @} */
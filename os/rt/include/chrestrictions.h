@@ -70,9 +70,15 @@
 /* Restricted subsystems.*/
 #undef CH_DBG_STATISTICS
 #undef CH_DBG_TRACE_MASK
+#undef CH_DBG_STACK_PROFILER
+#undef CH_DBG_RECORDER
+#undef CH_DBG_CS_PROFILER
 
 #define CH_DBG_STATISTICS                   FALSE
 #define CH_DBG_TRACE_MASK                   CH_DBG_TRACE_MASK_DISABLED
+#define CH_DBG_STACK_PROFILER               FALSE
+#define CH_DBG_RECORDER                     FALSE
+#define CH_DBG_CS_PROFILER                  FALSE
 
 #endif /* (CH_LICENSE_FEATURES == CH_FEATURES_INTERMEDIATE) ||
           (CH_LICENSE_FEATURES == CH_FEATURES_BASIC) */
@@ -88,11 +94,17 @@
 #undef CH_CFG_USE_TM
 #undef CH_CFG_USE_MUTEXES
 #undef CH_CFG_USE_CONDVARS
+#undef CH_CFG_USE_RWLOCKS
+#undef CH_CFG_USE_PCMUTEXES
+#undef CH_CFG_USE_EDF
 #undef CH_CFG_USE_DYNAMIC
 
 #define CH_CFG_USE_TM                       FALSE
 #define CH_CFG_USE_MUTEXES                  FALSE
 #define CH_CFG_USE_CONDVARS                 FALSE
+#define CH_CFG_USE_RWLOCKS                  FALSE
+#define CH_CFG_USE_PCMUTEXES                FALSE
+#define CH_CFG_USE_EDF                      FALSE
 #define CH_CFG_USE_DYNAMIC                  FALSE
 
 #endif /* CH_LICENSE_FEATURES == CH_FEATURES_BASIC */
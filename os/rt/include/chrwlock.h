@@ -0,0 +1,182 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/include/chrwlock.h
+ * @brief   Readers-Writer Locks macros and structures.
+ *
+ * @addtogroup rwlocks
+ * @{
+ */
+
+#ifndef CHRWLOCK_H
+#define CHRWLOCK_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+#if (CH_CFG_USE_RWLOCKS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CH_CFG_USE_MUTEXES == FALSE
+#error "CH_CFG_USE_RWLOCKS requires CH_CFG_USE_MUTEXES"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a readers-writer lock structure.
+ */
+typedef struct ch_rwlock rwlock_t;
+
+/**
+ * @brief   Readers-writer lock structure.
+ * @note    The embedded mutex represents the writer ownership, it is linked
+ *          in the writer owned mutexes list so that the priority
+ *          inheritance is handled together with the other owned mutexes.
+ *          The mutex queue holds both the waiting readers and writers.
+ */
+struct ch_rwlock {
+  mutex_t               mtx;        /**< @brief Writer ownership and queue
+                                                of the waiting threads.     */
+  cnt_t                 readers;    /**< @brief Number of readers owning
+                                                the lock.                   */
+};
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Data part of a static readers-writer lock initializer.
+ * @details This macro should be used when statically initializing a
+ *          readers-writer lock that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the readers-writer lock variable
+ */
+#define __RWLOCK_DATA(name) {__MUTEX_DATA(name.mtx), (cnt_t)0}
+
+/**
+ * @brief   Static readers-writer lock initializer.
+ * @details Statically initialized readers-writer locks require no explicit
+ *          initialization using @p chRWLockObjectInit().
+ *
+ * @param[in] name      the name of the readers-writer lock variable
+ */
+#define RWLOCK_DECL(name) rwlock_t name = __RWLOCK_DATA(name)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chRWLockObjectInit(rwlock_t *rwp);
+  msg_t chRWLockReadLockTimeoutS(rwlock_t *rwp, sysinterval_t timeout);
+  msg_t chRWLockReadLockTimeout(rwlock_t *rwp, sysinterval_t timeout);
+  bool chRWLockTryReadLockS(rwlock_t *rwp);
+  bool chRWLockTryReadLock(rwlock_t *rwp);
+  void chRWLockReadUnlockS(rwlock_t *rwp);
+  void chRWLockReadUnlock(rwlock_t *rwp);
+  msg_t chRWLockWriteLockTimeoutS(rwlock_t *rwp, sysinterval_t timeout);
+  msg_t chRWLockWriteLockTimeout(rwlock_t *rwp, sysinterval_t timeout);
+  bool chRWLockTryWriteLockS(rwlock_t *rwp);
+  bool chRWLockTryWriteLock(rwlock_t *rwp);
+  void chRWLockWriteUnlockS(rwlock_t *rwp);
+  void chRWLockWriteUnlock(rwlock_t *rwp);
+  void __rwlock_release(rwlock_t *rwp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Locks the specified readers-writer lock for reading.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ *
+ * @api
+ */
+static inline void chRWLockReadLock(rwlock_t *rwp) {
+
+  (void) chRWLockReadLockTimeout(rwp, TIME_INFINITE);
+}
+
+/**
+ * @brief   Locks the specified readers-writer lock for writing.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ *
+ * @api
+ */
+static inline void chRWLockWriteLock(rwlock_t *rwp) {
+
+  (void) chRWLockWriteLockTimeout(rwp, TIME_INFINITE);
+}
+
+/**
+ * @brief   Returns the number of readers owning the lock.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @return              The number of readers.
+ *
+ * @iclass
+ */
+static inline cnt_t chRWLockGetReadersI(rwlock_t *rwp) {
+
+  chDbgCheckClassI();
+
+  return rwp->readers;
+}
+
+/**
+ * @brief   Returns the writer owning the lock.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @return              The writer thread.
+ * @retval NULL         if the lock is not owned by a writer.
+ *
+ * @iclass
+ */
+static inline thread_t *chRWLockGetWriterI(rwlock_t *rwp) {
+
+  chDbgCheckClassI();
+
+  return rwp->mtx.owner;
+}
+
+#endif /* CH_CFG_USE_RWLOCKS == TRUE */
+
+#endif /* CHRWLOCK_H */
+
+/** @} */
@@ -79,6 +79,12 @@
 #define CH_STATE_WTMSG      (tstate_t)14     /**< @brief Waiting for a
                                                   message.                  */
 #define CH_STATE_FINAL      (tstate_t)15     /**< @brief Thread terminated. */
+#define CH_STATE_WTRWRD     (tstate_t)16     /**< @brief On a RW lock as
+                                                  reader.                   */
+#define CH_STATE_WTRWWR     (tstate_t)17     /**< @brief On a RW lock as
+                                                  writer.                   */
+#define CH_STATE_WTPCMTX    (tstate_t)18     /**< @brief On a priority
+                                                  ceiling mutex.            */
 
 /**
  * @brief   Thread states as array of strings.
@@ -88,7 +94,7 @@
 #define CH_STATE_NAMES                                                     \
   "READY", "CURRENT", "WTSTART", "SUSPENDED", "QUEUED", "WTSEM", "WTMTX",  \
   "WTCOND", "SLEEPING", "WTEXIT", "WTOREVT", "WTANDEVT", "SNDMSGQ",        \
-  "SNDMSG", "WTMSG", "FINAL"
+  "SNDMSG", "WTMSG", "FINAL", "WTRWRD", "WTRWWR", "WTPCMTX"
 /** @} */
 
 /**
@@ -104,6 +110,15 @@
                                                  from a Memory Pool.        */
 #define CH_FLAG_TERMINATE   (tmode_t)4U     /**< @brief Termination requested
                                                  flag.                      */
+#define CH_FLAG_CONDMORPH   (tmode_t)8U     /**< @brief Condition variable
+                                                 waiter movable on the
+                                                 mutex queue.               */
+#define CH_FLAG_CONDRESET   (tmode_t)16U    /**< @brief Condition variable
+                                                 waiter released by a
+                                                 broadcast.                 */
+#define CH_FLAG_EDF         (tmode_t)32U    /**< @brief Thread scheduled by
+                                                 earliest deadline within
+                                                 its priority.              */
 /** @} */
 
 /*===========================================================================*/
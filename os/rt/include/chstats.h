@@ -56,6 +56,8 @@
 typedef struct {
   ucnt_t                n_irq;      /**< @brief Number of IRQs.             */
   ucnt_t                n_ctxswc;   /**< @brief Number of context switches. */
+  ucnt_t                n_rrswc;    /**< @brief Number of round robin
+                                                context switches.           */
   time_measurement_t    m_crit_thd; /**< @brief Measurement of threads
                                                 critical zones duration.    */
   time_measurement_t    m_crit_isr; /**< @brief Measurement of ISRs critical
@@ -76,6 +78,7 @@ extern "C" {
   void __stats_init(void);
   void __stats_increase_irq(void);
   void __stats_ctxswc(thread_t *ntp, thread_t *otp);
+  void __stats_rrswc(thread_t *tp);
   void __stats_start_measure_crit_thd(void);
   void __stats_stop_measure_crit_thd(void);
   void __stats_start_measure_crit_isr(void);
@@ -100,6 +103,7 @@ static inline void __stats_object_init(kernel_stats_t *ksp) {
 
   ksp->n_irq    = (ucnt_t)0;
   ksp->n_ctxswc = (ucnt_t)0;
+  ksp->n_rrswc  = (ucnt_t)0;
   chTMObjectInit(&ksp->m_crit_thd);
   chTMObjectInit(&ksp->m_crit_isr);
 
@@ -113,6 +117,7 @@ static inline void __stats_object_init(kernel_stats_t *ksp) {
 /* Stub functions for when the statistics module is disabled. */
 #define __stats_increase_irq()
 #define __stats_ctxswc(old, new)
+#define __stats_rrswc(tp)
 #define __stats_start_measure_crit_thd()
 #define __stats_stop_measure_crit_thd()
 #define __stats_start_measure_crit_isr()
@@ -0,0 +1,171 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/include/chstkprof.h
+ * @brief   Stack profiler macros and structures.
+ *
+ * @addtogroup stack_profiler
+ * @{
+ */
+
+#ifndef CHSTKPROF_H
+#define CHSTKPROF_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Stack bytes checked by each profiler sample.
+ * @details This value bounds the duration of the critical zone of each
+ *          sample.
+ */
+#if !defined(CH_DBG_STACK_PROFILER_STEP) || defined(__DOXYGEN__)
+#define CH_DBG_STACK_PROFILER_STEP          64
+#endif
+
+/**
+ * @brief   Default stack headroom warning margin.
+ * @details A warning is raised when the never used part of a thread stack
+ *          is smaller than this value, in bytes.
+ */
+#if !defined(CH_DBG_STACK_PROFILER_MARGIN) || defined(__DOXYGEN__)
+#define CH_DBG_STACK_PROFILER_MARGIN        64
+#endif
+
+#if (CH_DBG_STACK_PROFILER == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if CH_DBG_FILL_THREADS == FALSE
+#error "CH_DBG_STACK_PROFILER requires CH_DBG_FILL_THREADS"
+#endif
+
+#if CH_CFG_USE_REGISTRY == FALSE
+#error "CH_DBG_STACK_PROFILER requires CH_CFG_USE_REGISTRY"
+#endif
+
+#if CH_DBG_STACK_PROFILER_STEP <= 0
+#error "invalid CH_DBG_STACK_PROFILER_STEP value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  bool chStkProfSampleThread(thread_t *tp);
+  void chStkProfSample(void);
+  void chStkProfUpdate(thread_t *tp);
+  void chStkProfSetMargin(size_t margin);
+#if CH_CFG_USE_EVENTS == TRUE
+  event_source_t *chStkProfGetEventSourceX(void);
+#endif
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the upper limit of a thread stack.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The stack upper limit.
+ * @retval NULL         if the stack limits are not known.
+ *
+ * @xclass
+ */
+static inline uint8_t *chStkProfGetStackEndX(thread_t *tp) {
+
+  /* The main thread stack is not part of a working area.*/
+  if (tp == &tp->owner->mainthread) {
+    return (uint8_t *)tp->owner->config->mainthread_end;
+  }
+
+  return (uint8_t *)tp;
+}
+
+/**
+ * @brief   Returns the peak stack usage of a thread.
+ * @note    The value is updated by the profiler samples, it is zero if the
+ *          thread has not been sampled yet.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The peak stack usage in bytes.
+ *
+ * @xclass
+ */
+static inline size_t chStkProfGetPeakX(thread_t *tp) {
+
+  if (tp->stkprof.mark == NULL) {
+    return (size_t)0;
+  }
+
+  return (size_t)(chStkProfGetStackEndX(tp) - tp->stkprof.mark);
+}
+
+/**
+ * @brief   Returns the never used part of a thread stack.
+ * @note    The value is updated by the profiler samples, it is the whole
+ *          stack size if the thread has not been sampled yet.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The stack headroom in bytes, zero if the stack
+ *                      limits are not known.
+ *
+ * @xclass
+ */
+static inline size_t chStkProfGetUnusedX(thread_t *tp) {
+  uint8_t *mark = tp->stkprof.mark;
+
+  if (tp->wabase == NULL) {
+    return (size_t)0;
+  }
+  if (mark == NULL) {
+    mark = chStkProfGetStackEndX(tp);
+  }
+
+  return (size_t)(mark - (uint8_t *)tp->wabase);
+}
+
+#endif /* CH_DBG_STACK_PROFILER == TRUE */
+
+#endif /* CHSTKPROF_H */
+
+/** @} */
@@ -149,6 +149,7 @@
   CH_CFG_IRQ_PROLOGUE_HOOK();                                               \
   __stats_increase_irq();                                                   \
   __trace_isr_enter(__func__);                                              \
+  __rec_isr_enter(__func__);                                                \
   __dbg_check_enter_isr()
 
 /**
@@ -161,6 +162,7 @@
  */
 #define CH_IRQ_EPILOGUE()                                                   \
   __dbg_check_leave_isr();                                                  \
+  __rec_isr_leave(__func__);                                                \
   __trace_isr_leave(__func__);                                              \
   CH_CFG_IRQ_EPILOGUE_HOOK();                                               \
   PORT_IRQ_EPILOGUE()
@@ -305,6 +307,7 @@
 #define chSysSwitch(ntp, otp) {                                             \
                                                                             \
   __trace_switch(ntp, otp);                                                 \
+  __rec_switch(ntp, otp);                                                   \
   __stats_ctxswc(ntp, otp);                                                 \
   CH_CFG_CONTEXT_SWITCH_HOOK(ntp, otp);                                     \
   port_switch(ntp, otp);                                                    \
@@ -408,6 +411,7 @@ static inline void chSysLock(void) {
 
   port_lock();
   __stats_start_measure_crit_thd();
+  __csprof_enter_thd(__csprof_site());
   __dbg_check_lock();
 }
 
@@ -422,6 +426,7 @@ static inline void chSysUnlock(void) {
 
   __dbg_check_unlock();
   __stats_stop_measure_crit_thd();
+  __csprof_leave_thd();
 
   /* The following condition can be triggered by the use of i-class functions
      in a critical section not followed by a chSchRescheduleS(), this means
@@ -452,6 +457,7 @@ static inline void chSysLockFromISR(void) {
 
   port_lock_from_isr();
   __stats_start_measure_crit_isr();
+  __csprof_enter_isr(__csprof_site());
   __dbg_check_lock_from_isr();
 }
 
@@ -474,6 +480,7 @@ static inline void chSysUnlockFromISR(void) {
 
   __dbg_check_unlock_from_isr();
   __stats_stop_measure_crit_isr();
+  __csprof_leave_isr();
   port_unlock_from_isr();
 }
 
@@ -85,6 +85,12 @@ typedef struct {
    */
   os_instance_t     *instance;
 #endif
+#if (CH_CFG_TIME_QUANTUM > 0) || defined(__DOXYGEN__)
+  /**
+   * @brief         Thread time quantum or zero for @p CH_CFG_TIME_QUANTUM.
+   */
+  tslices_t         quantum;
+#endif
 } thread_descriptor_t;
 
 /*===========================================================================*/
@@ -174,6 +180,17 @@ typedef struct {
  * @name    Threads initializers
  * @{
  */
+/**
+ * @brief   Time quantum part of a thread descriptor initializer.
+ *
+ * @param[in] quantum   thread time quantum or zero for the default
+ */
+#if (CH_CFG_TIME_QUANTUM > 0) || defined(__DOXYGEN__)
+#define __THD_DESCRIPTOR_QUANTUM(quantum) , (tslices_t)(quantum)
+#else
+#define __THD_DESCRIPTOR_QUANTUM(quantum)
+#endif
+
 #if (CH_CFG_SMP_MODE != FALSE) || defined(__DOXYGEN__)
 /**
  * @brief   Thread descriptor initializer with no affinity.
@@ -193,6 +210,7 @@ typedef struct {
   (funcp),                                                                  \
   (arg),                                                                    \
   NULL                                                                      \
+  __THD_DESCRIPTOR_QUANTUM(0)                                               \
 }
 #else
 #define THD_DESCRIPTOR(name, wbase, wend, prio, funcp, arg) {               \
@@ -202,6 +220,7 @@ typedef struct {
   (prio),                                                                   \
   (funcp),                                                                  \
   (arg)                                                                     \
+  __THD_DESCRIPTOR_QUANTUM(0)                                               \
 }
 #endif
 
@@ -224,7 +243,46 @@ typedef struct {
   (funcp),                                                                  \
   (arg),                                                                    \
   (oip)                                                                     \
+  __THD_DESCRIPTOR_QUANTUM(0)                                               \
+}
+
+#if (CH_CFG_TIME_QUANTUM > 0) || defined(__DOXYGEN__)
+#if (CH_CFG_SMP_MODE != FALSE) || defined(__DOXYGEN__)
+/**
+ * @brief   Thread descriptor initializer with a time quantum.
+ *
+ * @param[in] name      thread name
+ * @param[in] wbase     pointer to the working area base
+ * @param[in] wend      pointer to the working area end
+ * @param[in] prio      thread priority
+ * @param[in] funcp     thread function pointer
+ * @param[in] arg       thread argument
+ * @param[in] quantum   thread time quantum in system ticks
+ */
+#define THD_DESCRIPTOR_QUANTUM(name, wbase, wend, prio, funcp, arg,         \
+                               quantum) {                                   \
+  (name),                                                                   \
+  (wbase),                                                                  \
+  (wend),                                                                   \
+  (prio),                                                                   \
+  (funcp),                                                                  \
+  (arg),                                                                    \
+  NULL,                                                                     \
+  (tslices_t)(quantum)                                                      \
+}
+#else
+#define THD_DESCRIPTOR_QUANTUM(name, wbase, wend, prio, funcp, arg,         \
+                               quantum) {                                   \
+  (name),                                                                   \
+  (wbase),                                                                  \
+  (wend),                                                                   \
+  (prio),                                                                   \
+  (funcp),                                                                  \
+  (arg),                                                                    \
+  (tslices_t)(quantum)                                                      \
 }
+#endif
+#endif
 /** @} */
 
 /**
@@ -286,6 +344,7 @@ typedef struct {
 #ifdef __cplusplus
 extern "C" {
 #endif
+  void __thd_object_reset(thread_t *tp, tprio_t prio);
    thread_t *__thd_object_init(os_instance_t *oip,
                                thread_t *tp,
                                const char *name,
@@ -310,6 +369,9 @@ extern "C" {
   msg_t chThdWait(thread_t *tp);
 #endif
   tprio_t chThdSetPriority(tprio_t newprio);
+#if CH_CFG_TIME_QUANTUM > 0
+  tslices_t chThdSetQuantum(tslices_t quantum);
+#endif
   void chThdTerminate(thread_t *tp);
   msg_t chThdSuspendS(thread_reference_t *trp);
   msg_t chThdSuspendTimeoutS(thread_reference_t *trp, sysinterval_t timeout);
@@ -356,6 +418,40 @@ static inline tprio_t chThdGetPriorityX(void) {
   return chThdGetSelfX()->hdr.pqueue.prio;
 }
 
+#if (CH_CFG_TIME_QUANTUM > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the time quantum of the specified thread.
+ * @note    Can be invoked in any context.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The thread time quantum in system ticks.
+ *
+ * @xclass
+ */
+static inline tslices_t chThdGetQuantumX(thread_t *tp) {
+
+  return tp->quantum;
+}
+#endif
+
+#if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the number of round robin switches of a thread.
+ * @details The counter is increased each time the thread is put behind its
+ *          peers because its time quantum expired.
+ * @note    Can be invoked in any context.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The number of round robin switches.
+ *
+ * @xclass
+ */
+static inline ucnt_t chThdGetRRSwitchesX(thread_t *tp) {
+
+  return tp->rrswc;
+}
+#endif
+
 /**
  * @brief   Returns the number of ticks consumed by the specified thread.
  * @note    This function is only available when the
@@ -374,7 +470,7 @@ static inline systime_t chThdGetTicksX(thread_t *tp) {
 #endif
 
 #if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE) ||  \
-    defined(__DOXYGEN__)
+    (CH_DBG_STACK_PROFILER == TRUE) || defined(__DOXYGEN__)
 /**
  * @brief   Returns the working area base of the specified thread.
  *
@@ -36,6 +36,20 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Timers thread priority.
+ */
+#if !defined(CH_CFG_VT_THREAD_PRIO) || defined(__DOXYGEN__)
+#define CH_CFG_VT_THREAD_PRIO               HIGHPRIO
+#endif
+
+/**
+ * @brief   Timers thread stack size.
+ */
+#if !defined(CH_CFG_VT_THREAD_STACK_SIZE) || defined(__DOXYGEN__)
+#define CH_CFG_VT_THREAD_STACK_SIZE         256
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -78,6 +92,13 @@ extern "C" {
   void chVTDoResetI(virtual_timer_t *vtp);
   sysinterval_t chVTGetRemainingIntervalI(virtual_timer_t *vtp);
   void chVTDoTickI(void);
+#if CH_CFG_USE_VT_DEFERRED == TRUE
+  void chVTDoSetDeferredI(virtual_timer_t *vtp, sysinterval_t delay,
+                          vtfunc_t vtfunc, void *par);
+  void chVTDoSetContinuousDeferredI(virtual_timer_t *vtp, sysinterval_t delay,
+                                    vtfunc_t vtfunc, void *par);
+  void __vt_deferred_thread(void *p);
+#endif
 #if CH_CFG_USE_TIMESTAMP == TRUE
   systimestamp_t chVTGetTimeStampI(void);
   void chVTResetTimeStampI(void);
@@ -104,6 +125,10 @@ extern "C" {
 static inline void chVTObjectInit(virtual_timer_t *vtp) {
 
   vtp->dlist.next = NULL;
+#if CH_CFG_USE_VT_DEFERRED == TRUE
+  vtp->deferred   = false;
+  vtp->dnext      = NULL;
+#endif
 }
 
 /**
@@ -274,7 +299,8 @@ static inline bool chVTIsArmed(const virtual_timer_t *vtp) {
 
 /**
  * @brief   Disables a Virtual Timer.
- * @note    The timer is first checked and disabled only if armed.
+ * @note    The timer is first checked and disabled only if armed or if
+ *          its deferred callback is pending.
  * @pre     The timer must have been initialized using @p chVTObjectInit()
  *          or @p chVTDoSetI().
  *
@@ -287,11 +313,18 @@ static inline void chVTResetI(virtual_timer_t *vtp) {
   if (chVTIsArmedI(vtp)) {
     chVTDoResetI(vtp);
   }
+#if CH_CFG_USE_VT_DEFERRED == TRUE
+  else if (vtp->deferred && (vtp->dnext != NULL)) {
+    /* Expired timer with its callback still pending.*/
+    chVTDoResetI(vtp);
+  }
+#endif
 }
 
 /**
  * @brief   Disables a Virtual Timer.
- * @note    The timer is first checked and disabled only if armed.
+ * @note    The timer is first checked and disabled only if armed or if
+ *          its deferred callback is pending.
  * @pre     The timer must have been initialized using @p chVTObjectInit()
  *          or @p chVTDoSetI().
  *
@@ -424,6 +457,82 @@ static inline void chVTSetContinuous(virtual_timer_t *vtp, sysinterval_t delay,
   chSysUnlock();
 }
 
+#if (CH_CFG_USE_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Enables a one-shot virtual timer with deferred callback.
+ * @details If the virtual timer was already enabled then it is re-enabled
+ *          using the new parameters.
+ * @pre     The timer must have been initialized using @p chVTObjectInit().
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ * @param[in] delay     the number of ticks before the operation timeouts, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] vtfunc    the timer callback function, it is invoked by the
+ *                      timers thread
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @api
+ */
+static inline void chVTSetDeferred(virtual_timer_t *vtp, sysinterval_t delay,
+                                   vtfunc_t vtfunc, void *par) {
+
+  chSysLock();
+  chVTResetI(vtp);
+  chVTDoSetDeferredI(vtp, delay, vtfunc, par);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Enables a continuous virtual timer with deferred callback.
+ * @details If the virtual timer was already enabled then it is re-enabled
+ *          using the new parameters.
+ * @pre     The timer must have been initialized using @p chVTObjectInit().
+ *
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ * @param[in] delay     the number of ticks before the operation timeouts, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] vtfunc    the timer callback function, it is invoked by the
+ *                      timers thread
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @api
+ */
+static inline void chVTSetContinuousDeferred(virtual_timer_t *vtp,
+                                             sysinterval_t delay,
+                                             vtfunc_t vtfunc, void *par) {
+
+  chSysLock();
+  chVTResetI(vtp);
+  chVTDoSetContinuousDeferredI(vtp, delay, vtfunc, par);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Returns the deferred callbacks statistics of the current
+ *          instance.
+ *
+ * @param[out] dsp      pointer to a @p vt_deferred_stats_t structure
+ *
+ * @iclass
+ */
+static inline void chVTGetDeferredStatsI(vt_deferred_stats_t *dsp) {
+
+  chDbgCheckClassI();
+
+  *dsp = currcore->vtlist.deferred.stats;
+}
+#endif /* CH_CFG_USE_VT_DEFERRED == TRUE */
+
 /**
  * @brief   Returns the current reload value.
  *
@@ -517,6 +626,15 @@ static inline void __vt_object_init(virtual_timers_list_t *vtlp) {
 #if CH_CFG_USE_TIMESTAMP == TRUE
   vtlp->laststamp = (systimestamp_t)chVTGetSystemTimeX();
 #endif
+#if CH_CFG_USE_VT_DEFERRED == TRUE
+  vtlp->deferred.first            = NULL;
+  vtlp->deferred.last             = NULL;
+  vtlp->deferred.thread           = NULL;
+  vtlp->deferred.stats.best       = (rtcnt_t)-1;
+  vtlp->deferred.stats.worst      = (rtcnt_t)0;
+  vtlp->deferred.stats.n          = (ucnt_t)0;
+  vtlp->deferred.stats.cumulative = (rttime_t)0;
+#endif
 }
 
 #endif /* CHVT_H */
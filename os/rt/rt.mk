@@ -27,6 +27,15 @@ endif
 ifneq ($(findstring CH_DBG_STATISTICS TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/rt/src/chstats.c
 endif
+ifneq ($(findstring CH_DBG_STACK_PROFILER TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/rt/src/chstkprof.c
+endif
+ifneq ($(findstring CH_DBG_RECORDER TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/rt/src/chrecorder.c
+endif
+ifneq ($(findstring CH_DBG_CS_PROFILER TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/rt/src/chcsprof.c
+endif
 ifneq ($(findstring CH_CFG_USE_REGISTRY TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/rt/src/chregistry.c
 endif
@@ -36,6 +45,15 @@ endif
 ifneq ($(findstring CH_CFG_USE_MUTEXES TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/rt/src/chmtx.c
 endif
+ifneq ($(findstring CH_CFG_USE_RWLOCKS TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/rt/src/chrwlock.c
+endif
+ifneq ($(findstring CH_CFG_USE_PCMUTEXES TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/rt/src/chpcmtx.c
+endif
+ifneq ($(findstring CH_CFG_USE_EDF TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/rt/src/chedf.c
+endif
 ifneq ($(findstring CH_CFG_USE_CONDVARS TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/rt/src/chcond.c
 endif
@@ -57,11 +75,17 @@ KERNSRC := $(CHIBIOS)/os/rt/src/chsys.c \
            $(CHIBIOS)/os/rt/src/chschd.c \
            $(CHIBIOS)/os/rt/src/chinstances.c \
            $(CHIBIOS)/os/rt/src/chthreads.c \
+           $(CHIBIOS)/os/rt/src/chedf.c \
            $(CHIBIOS)/os/rt/src/chtm.c \
            $(CHIBIOS)/os/rt/src/chstats.c \
+           $(CHIBIOS)/os/rt/src/chstkprof.c \
+           $(CHIBIOS)/os/rt/src/chrecorder.c \
+           $(CHIBIOS)/os/rt/src/chcsprof.c \
            $(CHIBIOS)/os/rt/src/chregistry.c \
            $(CHIBIOS)/os/rt/src/chsem.c \
            $(CHIBIOS)/os/rt/src/chmtx.c \
+           $(CHIBIOS)/os/rt/src/chrwlock.c \
+           $(CHIBIOS)/os/rt/src/chpcmtx.c \
            $(CHIBIOS)/os/rt/src/chcond.c \
            $(CHIBIOS)/os/rt/src/chevents.c \
            $(CHIBIOS)/os/rt/src/chmsg.c \
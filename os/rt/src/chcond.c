@@ -32,6 +32,19 @@
  *          The condition variable is a synchronization object meant to be
  *          used inside a zone protected by a mutex. Mutexes and condition
  *          variables together can implement a Monitor construct.
+ *          <h2>Wait morphing</h2>
+ *          A thread released from a condition variable must acquire the
+ *          mutex again before returning. If the mutex is owned at the time
+ *          of the signal, typically by the signaling thread, then the
+ *          released thread is moved directly from the condition variable
+ *          queue to the mutex queue instead of being made ready only to
+ *          block again on the mutex, the mutex owner inherits its priority.
+ *          If the mutex is not owned then it is assigned to the released
+ *          thread. This avoids useless context switches, especially on
+ *          broadcasts.<br>
+ *          Wait morphing is only applied to threads waiting without a
+ *          timeout and using the same mutex of the other threads waiting
+ *          on the condition variable.
  * @pre     In order to use the condition variable APIs the @p CH_CFG_USE_CONDVARS
  *          option must be enabled in @p chconf.h.
  * @{
@@ -61,6 +74,40 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Releases the first thread waiting on the condition variable.
+ * @details If the thread can be moved on the mutex queue then it is not
+ *          made ready, it will be resumed by the mutex owner unlocking it.
+ *          If the mutex is not owned then it is directly assigned to the
+ *          thread.
+ *
+ * @param[in] cp        pointer to the @p condition_variable_t structure
+ * @param[in] msg       the wakeup message
+ */
+static void cond_wakeup(condition_variable_t *cp, msg_t msg) {
+  thread_t *tp = threadref(ch_queue_fifo_remove(&cp->queue));
+
+  if ((tp->flags & CH_FLAG_CONDMORPH) != (tmode_t)0) {
+    mutex_t *mp = cp->mtxp;
+
+    if (msg == MSG_RESET) {
+      tp->flags |= CH_FLAG_CONDRESET;
+    }
+
+    /* The thread starts waiting on the mutex, it will be made ready by
+       the owner unlocking the mutex. If the mutex is not owned then it is
+       assigned to the thread.*/
+    tp->state = CH_STATE_WTMTX;
+    if (__mtx_take_or_enqueue(mp, tp)) {
+      (void) chSchReadyI(tp);
+    }
+    return;
+  }
+
+  tp->u.rdymsg = msg;
+  (void) chSchReadyI(tp);
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -77,6 +124,7 @@ void chCondObjectInit(condition_variable_t *cp) {
   chDbgCheck(cp != NULL);
 
   ch_queue_init(&cp->queue);
+  cp->mtxp = NULL;
 }
 
 /**
@@ -92,7 +140,8 @@ void chCondSignal(condition_variable_t *cp) {
 
   chSysLock();
   if (ch_queue_notempty(&cp->queue)) {
-    chSchWakeupS(threadref(ch_queue_fifo_remove(&cp->queue)), MSG_OK);
+    cond_wakeup(cp, MSG_OK);
+    chSchRescheduleS();
   }
   chSysUnlock();
 }
@@ -114,9 +163,7 @@ void chCondSignalI(condition_variable_t *cp) {
   chDbgCheck(cp != NULL);
 
   if (ch_queue_notempty(&cp->queue)) {
-    thread_t *tp = threadref(ch_queue_fifo_remove(&cp->queue));
-    tp->u.rdymsg = MSG_OK;
-    (void) chSchReadyI(tp);
+    cond_wakeup(cp, MSG_OK);
   }
 }
 
@@ -151,11 +198,12 @@ void chCondBroadcastI(condition_variable_t *cp) {
   chDbgCheckClassI();
   chDbgCheck(cp != NULL);
 
-  /* Empties the condition variable queue and inserts all the threads into the
-     ready list in FIFO order. The wakeup message is set to @p MSG_RESET in
-     order to make a chCondBroadcast() detectable from a chCondSignal().*/
+  /* Empties the condition variable queue and releases all the threads in
+     priority order, threads are moved on the mutex queue when possible. The
+     wakeup message is set to @p MSG_RESET in order to make a
+     chCondBroadcast() detectable from a chCondSignal().*/
   while (ch_queue_notempty(&cp->queue)) {
-    chSchReadyI(threadref(ch_queue_fifo_remove(&cp->queue)))->u.rdymsg = MSG_RESET;
+    cond_wakeup(cp, MSG_RESET);
   }
 }
 
@@ -214,13 +262,32 @@ msg_t chCondWaitS(condition_variable_t *cp) {
   /* Releasing "current" mutex.*/
   chMtxUnlockS(mp);
 
+  /* The first waiting thread associates the mutex to the condition
+     variable, the threads using the same mutex can be moved on the mutex
+     queue when released.*/
+  if (ch_queue_isempty(&cp->queue)) {
+    cp->mtxp = mp;
+  }
+  if ((cp->mtxp == mp) && (__mtx_owner(mp) != currtp)) {
+    currtp->flags |= CH_FLAG_CONDMORPH;
+  }
+
   /* Start waiting on the condition variable, on exit the mutex is taken
      again.*/
   currtp->u.wtobjp = cp;
   ch_sch_prio_insert(&cp->queue, &currtp->hdr.queue);
   chSchGoSleepS(CH_STATE_WTCOND);
-  msg = currtp->u.rdymsg;
-  chMtxLockS(mp);
+  if ((currtp->flags & CH_FLAG_CONDMORPH) != (tmode_t)0) {
+    /* The thread has been moved on the mutex queue, the mutex is already
+       owned.*/
+    msg = ((currtp->flags & CH_FLAG_CONDRESET) != (tmode_t)0) ? MSG_RESET :
+                                                               MSG_OK;
+    currtp->flags &= (tmode_t)~(CH_FLAG_CONDMORPH | CH_FLAG_CONDRESET);
+  }
+  else {
+    msg = currtp->u.rdymsg;
+    chMtxLockS(mp);
+  }
 
   return msg;
 }
@@ -305,7 +372,11 @@ msg_t chCondWaitTimeoutS(condition_variable_t *cp, sysinterval_t timeout) {
   chMtxUnlockS(mp);
 
   /* Start waiting on the condition variable, on exit the mutex is taken
-     again.*/
+     again. Threads waiting with a timeout are not moved on the mutex
+     queue.*/
+  if (ch_queue_isempty(&cp->queue)) {
+    cp->mtxp = mp;
+  }
   currtp->u.wtobjp = cp;
   ch_sch_prio_insert(&cp->queue, &currtp->hdr.queue);
   msg = chSchGoSleepTimeoutS(CH_STATE_WTCOND, timeout);
@@ -0,0 +1,371 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/src/chcsprof.c
+ * @brief   Critical zones profiler code.
+ *
+ * @addtogroup cs_profiler
+ * @details Measurement of the critical zones duration attributed to the
+ *          code entering them.
+ *          <h2>Operation mode</h2>
+ *          The realtime counter is sampled by @p chSysLock() and
+ *          @p chSysLockFromISR() together with the call site, the zone
+ *          duration is accounted on the matching unlock.<br>
+ *          The call site is the return address of the function entering
+ *          the critical zone, the code can replace it with a tag using
+ *          @p chCSProfSetTagI() from within the zone. Sites are resolved
+ *          using the application map file.<br>
+ *          The profiler keeps the @p CH_DBG_CS_PROFILER_TOP longest zones
+ *          and, for each site, the number of zones, the longest zone and
+ *          a logarithmic histogram of the durations. The sites table has
+ *          a fixed size, zones from sites not fitting the table are only
+ *          counted.
+ * @note    The profiler adds its own overhead to each critical zone, it
+ *          is not accounted in the measured durations but it increases the
+ *          system latency.
+ * @pre     In order to use the critical zones profiler the
+ *          @p CH_DBG_CS_PROFILER option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_DBG_CS_PROFILER == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Clears the profiler statistics.
+ *
+ * @param[out] csp      pointer to the @p cs_profiler_t structure
+ *
+ * @notapi
+ */
+static void csprof_clear(cs_profiler_t *csp) {
+  unsigned i, j;
+
+  csp->lost = (ucnt_t)0;
+  for (i = 0U; i < (unsigned)CH_DBG_CS_PROFILER_TOP; i++) {
+    csp->top[i].site     = NULL;
+    csp->top[i].duration = (rtcnt_t)0;
+  }
+  for (i = 0U; i < (unsigned)CH_DBG_CS_PROFILER_SITES; i++) {
+    csp->sites[i].site  = NULL;
+    csp->sites[i].n     = (ucnt_t)0;
+    csp->sites[i].worst = (rtcnt_t)0;
+    for (j = 0U; j < (unsigned)CH_DBG_CS_PROFILER_BUCKETS; j++) {
+      csp->sites[i].hist[j] = (ucnt_t)0;
+    }
+  }
+}
+
+/**
+ * @brief   Returns the histogram bucket of a critical zone duration.
+ *
+ * @param[in] duration  duration of the critical zone in realtime counter
+ *                      cycles
+ * @return              The bucket index, the last bucket collects all the
+ *                      durations out of range.
+ *
+ * @notapi
+ */
+static unsigned csprof_bucket(rtcnt_t duration) {
+  unsigned b = 0U;
+
+  duration >>= CH_DBG_CS_PROFILER_RESOLUTION;
+  while ((duration != (rtcnt_t)0) &&
+         (b < (unsigned)CH_DBG_CS_PROFILER_BUCKETS - 1U)) {
+    duration >>= 1;
+    b++;
+  }
+
+  return b;
+}
+
+/**
+ * @brief   Returns the statistics entry of a call site.
+ * @details The entry is allocated on the first occurrence of the site.
+ *
+ * @param[in] csp       pointer to the @p cs_profiler_t structure
+ * @param[in] site      the call site or tag
+ * @return              Pointer to the call site entry.
+ * @retval NULL         if the sites table is full.
+ *
+ * @notapi
+ */
+static csprof_site_t *csprof_find_site(cs_profiler_t *csp, const void *site) {
+  uint32_t h = (uint32_t)(uintptr_t)site;
+  unsigned i, n;
+
+  /* Open addressing, the table is never emptied so the search stops on
+     the first unused entry.*/
+  h ^= h >> 7;
+  h ^= h >> 13;
+  for (n = 0U; n < (unsigned)CH_DBG_CS_PROFILER_SITES; n++) {
+    i = (unsigned)(h + n) & ((unsigned)CH_DBG_CS_PROFILER_SITES - 1U);
+    if (csp->sites[i].n == (ucnt_t)0) {
+      csp->sites[i].site = site;
+      return &csp->sites[i];
+    }
+    if (csp->sites[i].site == site) {
+      return &csp->sites[i];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief   Accounts a terminated critical zone.
+ * @details The zone is inserted in the longest zones list if long enough
+ *          and added to the statistics of its call site.
+ *
+ * @param[in] csp       pointer to the @p cs_profiler_t structure
+ * @param[in] zp        pointer to the terminated zone
+ * @param[in] duration  duration of the zone in realtime counter cycles
+ *
+ * @notapi
+ */
+static void csprof_account(cs_profiler_t *csp, const csprof_zone_t *zp,
+                           rtcnt_t duration) {
+  csprof_site_t *sp;
+  unsigned i;
+
+  /* Insertion in the longest zones list, if long enough.*/
+  i = (unsigned)CH_DBG_CS_PROFILER_TOP - 1U;
+  if (duration > csp->top[i].duration) {
+    while ((i > 0U) && (duration > csp->top[i - 1U].duration)) {
+      csp->top[i] = csp->top[i - 1U];
+      i--;
+    }
+    csp->top[i].site     = zp->site;
+    csp->top[i].duration = duration;
+  }
+
+  /* Call site statistics.*/
+  sp = csprof_find_site(csp, zp->site);
+  if (sp == NULL) {
+    csp->lost++;
+    return;
+  }
+  sp->n++;
+  if (duration > sp->worst) {
+    sp->worst = duration;
+  }
+  sp->hist[csprof_bucket(duration)]++;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Profiler initialization.
+ * @note    Internal use only.
+ * @note    The initialization code is considered a critical zone ending on
+ *          the final call to @p chSysUnlock().
+ *
+ * @param[out] csp      pointer to the @p cs_profiler_t structure
+ *
+ * @notapi
+ */
+void __csprof_object_init(cs_profiler_t *csp) {
+
+  csprof_clear(csp);
+  csp->isr.start = (rtcnt_t)0;
+  csp->isr.site  = NULL;
+  csp->thd.start = chSysGetRealtimeCounterX();
+  csp->thd.site  = NULL;
+}
+
+/**
+ * @brief   Starts the measurement of a thread critical zone.
+ *
+ * @param[in] site      the call site
+ *
+ * @notapi
+ */
+void __csprof_enter_thd(const void *site) {
+  cs_profiler_t *csp = &currcore->csprof;
+
+  csp->thd.site  = site;
+  csp->thd.start = chSysGetRealtimeCounterX();
+}
+
+/**
+ * @brief   Stops the measurement of a thread critical zone.
+ *
+ * @notapi
+ */
+void __csprof_leave_thd(void) {
+  rtcnt_t now = chSysGetRealtimeCounterX();
+  cs_profiler_t *csp = &currcore->csprof;
+
+  csprof_account(csp, &csp->thd, now - csp->thd.start);
+}
+
+/**
+ * @brief   Starts the measurement of an ISR critical zone.
+ *
+ * @param[in] site      the call site
+ *
+ * @notapi
+ */
+void __csprof_enter_isr(const void *site) {
+  cs_profiler_t *csp = &currcore->csprof;
+
+  csp->isr.site  = site;
+  csp->isr.start = chSysGetRealtimeCounterX();
+}
+
+/**
+ * @brief   Stops the measurement of an ISR critical zone.
+ *
+ * @notapi
+ */
+void __csprof_leave_isr(void) {
+  rtcnt_t now = chSysGetRealtimeCounterX();
+  cs_profiler_t *csp = &currcore->csprof;
+
+  csprof_account(csp, &csp->isr, now - csp->isr.start);
+}
+
+/**
+ * @brief   Tags the current critical zone.
+ * @details The tag replaces the call site of the critical zone, it is
+ *          useful for zones entered by shared functions or for giving a
+ *          recognizable identifier to a zone.
+ * @note    This function must be called from within the critical zone to
+ *          be tagged, either a thread or an ISR critical zone.
+ *
+ * @param[in] tag       the tag, usually the address of a constant object
+ *
+ * @iclass
+ */
+void chCSProfSetTagI(const void *tag) {
+
+  chDbgCheckClassI();
+
+  if (port_is_isr_context()) {
+    currcore->csprof.isr.site = tag;
+  }
+  else {
+    currcore->csprof.thd.site = tag;
+  }
+}
+
+/**
+ * @brief   Clears the profiler results.
+ *
+ * @iclass
+ */
+void chCSProfResetI(void) {
+
+  chDbgCheckClassI();
+
+  csprof_clear(&currcore->csprof);
+}
+
+/**
+ * @brief   Clears the profiler results.
+ *
+ * @api
+ */
+void chCSProfReset(void) {
+
+  chSysLock();
+  chCSProfResetI();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Reads an entry of the longest critical zones list.
+ *
+ * @param[in] i         the entry index, zero is the longest zone
+ * @param[out] rp       pointer to the @p csprof_record_t structure receiving
+ *                      the entry
+ * @return              The operation status.
+ * @retval false        if the entry has been read.
+ * @retval true         if the entry is not used.
+ *
+ * @iclass
+ */
+bool chCSProfGetTopI(unsigned i, csprof_record_t *rp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(rp != NULL);
+
+  if ((i >= (unsigned)CH_DBG_CS_PROFILER_TOP) ||
+      (currcore->csprof.top[i].duration == (rtcnt_t)0)) {
+    return true;
+  }
+
+  *rp = currcore->csprof.top[i];
+
+  return false;
+}
+
+/**
+ * @brief   Reads an entry of the call sites table.
+ * @note    The table is not ordered and can contain unused entries, all
+ *          the entries from zero to @p CH_DBG_CS_PROFILER_SITES - 1 must
+ *          be scanned.
+ *
+ * @param[in] i         the entry index
+ * @param[out] sp       pointer to the @p csprof_site_t structure receiving
+ *                      the entry
+ * @return              The operation status.
+ * @retval false        if the entry has been read.
+ * @retval true         if the entry is not used.
+ *
+ * @iclass
+ */
+bool chCSProfGetSiteI(unsigned i, csprof_site_t *sp) {
+
+  chDbgCheckClassI();
+  chDbgCheck(sp != NULL);
+
+  if ((i >= (unsigned)CH_DBG_CS_PROFILER_SITES) ||
+      (currcore->csprof.sites[i].n == (ucnt_t)0)) {
+    return true;
+  }
+
+  *sp = currcore->csprof.sites[i];
+
+  return false;
+}
+
+#endif /* CH_DBG_CS_PROFILER == TRUE */
+
+/** @} */
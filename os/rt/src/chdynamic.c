@@ -23,6 +23,17 @@
  *
  * @addtogroup dynamic_threads
  * @details Dynamic threads related APIs and services.
+ *
+ *          <h2>Thread pools</h2>
+ *          A thread pool creates threads from a memory pool, a thread
+ *          returning from its function is not terminated but parked into
+ *          the thread pool. The next creation from the same thread pool
+ *          hands the new function to a parked thread, its working area and
+ *          @p thread_t are reused without allocating memory, initializing
+ *          a new context or filling the stack again.<br>
+ *          Thread pools keep the count of the threads allocated and of the
+ *          threads reused, the latency of both creation paths is also
+ *          measured if @p CH_CFG_USE_TM is enabled.
  * @{
  */
 
@@ -42,6 +53,36 @@
 /* Module local types.                                                       */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Thread pool job record.
+ * @details This structure is laid out in the working area of a pooled
+ *          thread, just above the @p thread_t structure.
+ */
+typedef struct {
+  /**
+   * @brief   Thread pool owning the thread.
+   */
+  thread_pool_t                 *pp;
+  /**
+   * @brief   Function of the current job, @p NULL terminates the thread.
+   */
+  tfunc_t                       funcp;
+  /**
+   * @brief   Argument of the current job.
+   */
+  void                          *arg;
+} pool_job_t;
+
+/**
+ * @brief   Space reserved for the job record at the top of a working area.
+ * @note    The size keeps the end of the thread working area aligned to
+ *          @p PORT_WORKING_AREA_ALIGN.
+ */
+#define POOL_JOB_SIZE       MEM_ALIGN_NEXT(sizeof (pool_job_t),            \
+                                           PORT_WORKING_AREA_ALIGN)
+#endif /* CH_CFG_USE_MEMPOOLS == TRUE */
+
 /*===========================================================================*/
 /* Module local variables.                                                   */
 /*===========================================================================*/
@@ -50,6 +91,41 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the job record of a pooled thread.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              Pointer to the job record.
+ */
+static inline pool_job_t *pool_get_job(thread_t *tp) {
+
+  return (pool_job_t *)(void *)((uint8_t *)tp +
+                                MEM_ALIGN_NEXT(sizeof (thread_t),
+                                               PORT_STACK_ALIGN));
+}
+
+/**
+ * @brief   Pooled threads function.
+ * @details Runs the jobs assigned to the thread, between jobs the thread
+ *          is parked into its thread pool.
+ *
+ * @param[in] p         pointer to the job record
+ */
+static THD_FUNCTION(pool_thread, p) {
+  pool_job_t *jp = (pool_job_t *)p;
+
+  while (jp->funcp != NULL) {
+    jp->funcp(jp->arg);
+
+    chSysLock();
+    ch_list_link(&jp->pp->parked, &chThdGetSelfX()->hdr.list);
+    chSchGoSleepS(CH_STATE_SUSPENDED);
+    chSysUnlock();
+  }
+}
+#endif /* CH_CFG_USE_MEMPOOLS == TRUE */
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -162,6 +238,185 @@ thread_t *chThdCreateFromMemoryPool(memory_pool_t *mp, const char *name,
 
   return tp;
 }
+/**
+ * @brief   Initializes a thread pool object.
+ * @pre     The memory pool must be initialized to contain only objects with
+ *          alignment @p PORT_WORKING_AREA_ALIGN.
+ * @note    Pooled threads reserve a few bytes at the top of their working
+ *          area for the job record, the memory pool objects should be
+ *          slightly larger than the stack required by the jobs.
+ *
+ * @param[out] pp       pointer to a @p thread_pool_t object
+ * @param[in] mp        pointer to the memory pool providing the working
+ *                      areas
+ *
+ * @init
+ */
+void chThdPoolObjectInit(thread_pool_t *pp, memory_pool_t *mp) {
+
+  chDbgCheck((pp != NULL) && (mp != NULL));
+
+  pp->mp      = mp;
+  ch_list_init(&pp->parked);
+  pp->created = (ucnt_t)0;
+  pp->reused  = (ucnt_t)0;
+#if CH_CFG_USE_TM == TRUE
+  chTMObjectInit(&pp->create_tm);
+  chTMObjectInit(&pp->reuse_tm);
+#endif
+}
+
+/**
+ * @brief   Creates a new thread from a thread pool.
+ * @details If the thread pool has a parked thread then the thread is
+ *          restarted with the new name, priority and function, else a new
+ *          thread is allocated from the memory pool.
+ * @pre     The configuration options @p CH_CFG_USE_DYNAMIC and
+ *          @p CH_CFG_USE_MEMPOOLS must be enabled in order to use this
+ *          function.
+ * @note    The thread function must return, the thread is then parked
+ *          into the thread pool. Pooled threads must not call
+ *          @p chThdExit() and must not be waited or released, the thread
+ *          pool owns their reference.
+ * @note    A restarted thread has a new generation, handles obtained from
+ *          the previous job become stale.
+ *
+ * @param[in] pp        pointer to the @p thread_pool_t object
+ * @param[in] name      thread name
+ * @param[in] prio      the priority level for the new thread
+ * @param[in] pf        the thread function
+ * @param[in] arg       an argument passed to the thread function. It can be
+ *                      @p NULL.
+ * @return              The pointer to the @p thread_t structure of the
+ *                      thread.
+ * @retval  NULL        if there are no parked threads and the memory pool
+ *                      is empty.
+ *
+ * @api
+ */
+thread_t *chThdCreateFromThreadPool(thread_pool_t *pp, const char *name,
+                                    tprio_t prio, tfunc_t pf, void *arg) {
+  thread_t *tp;
+  pool_job_t *jp;
+  void *wbase, *wend;
+  thread_descriptor_t td;
+
+  chDbgCheck((pp != NULL) && (prio <= HIGHPRIO) && (pf != NULL));
+
+  chSysLock();
+  if (ch_list_notempty(&pp->parked)) {
+#if CH_CFG_USE_TM == TRUE
+    chTMStartMeasurementX(&pp->reuse_tm);
+#endif
+
+    /* Restarting a parked thread, it is suspended at the end of its
+       previous job.*/
+    tp = threadref(ch_list_unlink(&pp->parked));
+
+    chDbgAssert(tp->state == CH_STATE_SUSPENDED, "not parked");
+#if CH_CFG_USE_MUTEXES == TRUE
+    chDbgAssert(tp->mtxlist == NULL, "mutexes still owned");
+#endif
+#if CH_CFG_USE_PCMUTEXES == TRUE
+    chDbgAssert(tp->pcmtxlist == NULL, "mutexes still owned");
+#endif
+
+    /* The thread state is reset as for a new thread, the registry entry
+       is kept with a new name and a new generation.*/
+    __thd_object_reset(tp, prio);
+    tp->flags = tp->flags & CH_FLAG_MODE_MASK;
+    chRegSetThreadNameX(tp, name);
+    tp->gen   = ++REG_REGISTRY(tp->owner)->gen;
+
+    jp = pool_get_job(tp);
+    jp->funcp = pf;
+    jp->arg   = arg;
+    pp->reused++;
+#if CH_CFG_USE_TM == TRUE
+    chTMStopMeasurementX(&pp->reuse_tm);
+#endif
+    chSchWakeupS(tp, MSG_OK);
+    chSysUnlock();
+
+    return tp;
+  }
+  chSysUnlock();
+
+  /* No parked threads, allocating a new one.*/
+  wbase = chPoolAlloc(pp->mp);
+  if (wbase == NULL) {
+    return NULL;
+  }
+  wend = (void *)((uint8_t *)wbase + pp->mp->object_size - POOL_JOB_SIZE);
+  jp = (pool_job_t *)wend;
+  jp->pp    = pp;
+  jp->funcp = pf;
+  jp->arg   = arg;
+
+  td.name  = name;
+  td.wbase = wbase;
+  td.wend  = wend;
+  td.prio  = prio;
+  td.funcp = pool_thread;
+  td.arg   = (void *)jp;
+#if CH_CFG_SMP_MODE != FALSE
+  td.instance = NULL;
+#endif
+#if CH_CFG_TIME_QUANTUM > 0
+  td.quantum  = (tslices_t)0;
+#endif
+
+#if CH_DBG_FILL_THREADS == TRUE
+  __thd_stackfill((uint8_t *)wbase, (uint8_t *)wend);
+#endif
+
+  chSysLock();
+#if CH_CFG_USE_TM == TRUE
+  chTMStartMeasurementX(&pp->create_tm);
+#endif
+  tp = chThdCreateSuspendedI(&td);
+  tp->flags = CH_FLAG_MODE_MPOOL;
+  tp->mpool = pp->mp;
+  pp->created++;
+#if CH_CFG_USE_TM == TRUE
+  chTMStopMeasurementX(&pp->create_tm);
+#endif
+  chSchWakeupS(tp, MSG_OK);
+  chSysUnlock();
+
+  return tp;
+}
+
+/**
+ * @brief   Terminates the parked threads of a thread pool.
+ * @details The working areas of the parked threads are returned to the
+ *          memory pool. Threads still running a job are not affected, they
+ *          are parked when their job returns.
+ *
+ * @param[in] pp        pointer to the @p thread_pool_t object
+ *
+ * @api
+ */
+void chThdPoolFlush(thread_pool_t *pp) {
+
+  chDbgCheck(pp != NULL);
+
+  chSysLock();
+  while (ch_list_notempty(&pp->parked)) {
+    thread_t *tp = threadref(ch_list_unlink(&pp->parked));
+
+    pool_get_job(tp)->funcp = NULL;
+    chSchWakeupS(tp, MSG_OK);
+    chSysUnlock();
+
+    /* Waiting the thread releases the pool reference and frees the
+       working area.*/
+    (void) chThdWait(tp);
+
+    chSysLock();
+  }
+  chSysUnlock();
+}
 #endif /* CH_CFG_USE_MEMPOOLS == TRUE */
 
 #endif /* CH_CFG_USE_DYNAMIC == TRUE */
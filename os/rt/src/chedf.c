@@ -0,0 +1,178 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/src/chedf.c
+ * @brief   EDF scheduling code.
+ *
+ * @addtogroup edf
+ * @details Earliest Deadline First scheduling class.
+ *          <h2>Operation mode</h2>
+ *          A thread entering the EDF class declares a period and a relative
+ *          deadline, the thread then executes a sequence of jobs, a job is
+ *          released at the start of each period and must complete within
+ *          the relative deadline.<br>
+ *          The scheduler still selects threads by priority, within the same
+ *          priority level EDF threads are ordered by the absolute deadline
+ *          of their current job and precede threads without a deadline. A
+ *          thread with an earlier deadline preempts a running thread of the
+ *          same priority, the round robin does not rotate an EDF thread
+ *          behind threads with later deadlines.<br>
+ *          Putting all the periodic threads of an application at the same
+ *          priority makes them scheduled by pure EDF while higher priority
+ *          threads keep preempting them as usual.
+ *
+ *          <h2>Deadline misses</h2>
+ *          A job is completed by calling @p chEDFWaitNextJob(), the kernel
+ *          counts the completed jobs and the jobs completed after their
+ *          deadline. A job overrunning its period does not shift the
+ *          following releases, the next job is released immediately.
+ * @pre     In order to use the EDF APIs the @p CH_CFG_USE_EDF option must
+ *          be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Makes the current thread an EDF thread.
+ * @details The first job is released immediately.
+ * @note    The thread keeps its priority, the deadline is only used to
+ *          order the threads with the same priority.
+ *
+ * @param[in] period    the period of the thread jobs
+ * @param[in] deadline  the deadline of each job relative to its release
+ *                      time, it must not be greater than the period
+ *
+ * @api
+ */
+void chEDFStart(sysinterval_t period, sysinterval_t deadline) {
+  thread_t *currtp = chThdGetSelfX();
+
+  chDbgCheck((deadline > (sysinterval_t)0) && (deadline <= period));
+
+  chSysLock();
+
+  currtp->edf.period      = period;
+  currtp->edf.reldeadline = deadline;
+  currtp->edf.release     = chVTGetSystemTimeX();
+  currtp->edf.deadline    = chTimeAddX(currtp->edf.release, deadline);
+  currtp->edf.jobs        = (ucnt_t)0;
+  currtp->edf.misses      = (ucnt_t)0;
+  currtp->flags          |= CH_FLAG_EDF;
+
+  /* An EDF thread with an earlier deadline could be ready.*/
+  chSchRescheduleS();
+
+  chSysUnlock();
+}
+
+/**
+ * @brief   Returns the current thread to normal scheduling.
+ * @note    The jobs and misses counters are preserved.
+ *
+ * @api
+ */
+void chEDFStop(void) {
+  thread_t *currtp = chThdGetSelfX();
+
+  chSysLock();
+
+  currtp->flags &= (tmode_t)~CH_FLAG_EDF;
+
+  /* Ready EDF threads of the same priority now precede this thread.*/
+  chSchRescheduleS();
+
+  chSysUnlock();
+}
+
+/**
+ * @brief   Completes the current job and waits for the next release.
+ * @details The job completion time is checked against the job deadline,
+ *          then the thread sleeps until the next job release time. If the
+ *          release time is already past then the next job is started
+ *          immediately.
+ *
+ * @return              The deadline check result.
+ * @retval false        if the job completed within its deadline.
+ * @retval true         if the job missed its deadline.
+ *
+ * @api
+ */
+bool chEDFWaitNextJob(void) {
+  thread_t *currtp = chThdGetSelfX();
+  sysinterval_t elapsed;
+  bool missed;
+
+  chDbgAssert((currtp->flags & CH_FLAG_EDF) != (tmode_t)0, "not EDF");
+
+  chSysLock();
+
+  /* Job completion time check.*/
+  elapsed = chTimeDiffX(currtp->edf.release, chVTGetSystemTimeX());
+  missed = (bool)(elapsed > currtp->edf.reldeadline);
+  currtp->edf.jobs++;
+  if (missed) {
+    currtp->edf.misses++;
+  }
+
+  /* Next job parameters, the deadline is updated before sleeping so that
+     the thread is ordered by the new deadline when released.*/
+  currtp->edf.release  = chTimeAddX(currtp->edf.release,
+                                    currtp->edf.period);
+  currtp->edf.deadline = chTimeAddX(currtp->edf.release,
+                                    currtp->edf.reldeadline);
+  if (elapsed < currtp->edf.period) {
+    chThdSleepS(currtp->edf.period - elapsed);
+  }
+  else {
+    /* Overrun, the deadline changed while running.*/
+    chSchRescheduleS();
+  }
+
+  chSysUnlock();
+
+  return missed;
+}
+
+#endif /* CH_CFG_USE_EDF == TRUE */
+
+/** @} */
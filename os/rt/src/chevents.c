@@ -49,7 +49,12 @@
  *          Event Source will be signaled with an events mask.<br>
  *          An unlimited number of Event Sources can exists in a system and
  *          each thread can be listening on an unlimited number of
- *          them.
+ *          them.<br>
+ *          Event Listeners can also be registered in a Poll Set, the
+ *          broadcast appends the listener to the poll set ready list instead
+ *          of signaling events. A thread waiting on the poll set retrieves
+ *          only the ready listeners, the cost does not depend on the number
+ *          of registered listeners.
  * @pre     In order to use the Events APIs the @p CH_CFG_USE_EVENTS option
  *          must be enabled in @p chconf.h.
  * @post    Enabling events requires 1-4 (depending on the architecture)
@@ -81,6 +86,65 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_EVENTS_POLL == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Appends a listener to its poll set ready list.
+ * @details The waiting thread, if any, is resumed when the ready list
+ *          becomes non-empty. Listeners already in the ready list are not
+ *          appended again.
+ *
+ * @param[in] elp       pointer to the @p event_listener_t structure
+ *
+ * @notapi
+ */
+static void evt_poll_ready(event_listener_t *elp) {
+  event_poll_t *epp = elp->poll;
+
+  if (elp->rnext == NULL) {
+    elp->rnext = elp;
+    if (epp->rfirst == NULL) {
+      epp->rfirst = elp;
+      chThdResumeI(&epp->thread, MSG_OK);
+    }
+    else {
+      epp->rlast->rnext = elp;
+    }
+    epp->rlast = elp;
+  }
+}
+
+/**
+ * @brief   Removes a listener from its poll set ready list.
+ *
+ * @param[in] elp       pointer to the @p event_listener_t structure, the
+ *                      listener must be in the ready list
+ *
+ * @notapi
+ */
+static void evt_poll_remove(event_listener_t *elp) {
+  event_poll_t *epp = elp->poll;
+  event_listener_t *p;
+
+  if (epp->rfirst == elp) {
+    epp->rfirst = (elp->rnext == elp) ? NULL : elp->rnext;
+  }
+  else {
+    p = epp->rfirst;
+    while (p->rnext != elp) {
+      p = p->rnext;
+    }
+    if (elp->rnext == elp) {
+      p->rnext   = p;
+      epp->rlast = p;
+    }
+    else {
+      p->rnext = elp->rnext;
+    }
+  }
+  elp->rnext = NULL;
+}
+#endif /* CH_CFG_USE_EVENTS_POLL == TRUE */
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -115,6 +179,10 @@ void chEvtRegisterMaskWithFlagsI(event_source_t *esp,
   elp->events   = events;
   elp->flags    = (eventflags_t)0;
   elp->wflags   = wflags;
+#if CH_CFG_USE_EVENTS_POLL == TRUE
+  elp->poll     = NULL;
+  elp->rnext    = NULL;
+#endif
 }
 
 /**
@@ -149,6 +217,8 @@ void chEvtRegisterMaskWithFlags(event_source_t *esp,
  * @note    For optimal performance it is better to perform the unregister
  *          operations in inverse order of the register operations (elements
  *          are found on top of the list).
+ * @note    A listener registered in a poll set is also removed from the
+ *          poll set ready list.
  *
  * @param[in] esp       pointer to the  @p event_source_t structure
  * @param[in] elp       pointer to the @p event_listener_t structure
@@ -169,6 +239,11 @@ void chEvtUnregister(event_source_t *esp, event_listener_t *elp) {
   /*lint -restore*/
     if (p->next == elp) {
       p->next = elp->next;
+#if CH_CFG_USE_EVENTS_POLL == TRUE
+      if ((elp->poll != NULL) && (elp->rnext != NULL)) {
+        evt_poll_remove(elp);
+      }
+#endif
       break;
     }
     p = p->next;
@@ -333,6 +408,8 @@ void chEvtSignal(thread_t *tp, eventmask_t events) {
  *          threads registered on the @p event_source_t in addition to the
  *          event flags specified by the threads themselves in the
  *          @p event_listener_t objects.
+ * @note    Listeners registered in a poll set are appended to the poll set
+ *          ready list instead of signaling their thread.
  * @post    This function does not reschedule so a call to a rescheduling
  *          function must be performed before unlocking the kernel. Note that
  *          interrupt handlers always reschedule on exit so an explicit
@@ -358,7 +435,15 @@ void chEvtBroadcastFlagsI(event_source_t *esp, eventflags_t flags) {
        source does not emit any flag.*/
     if ((flags == (eventflags_t)0) ||
         ((flags & elp->wflags) != (eventflags_t)0)) {
-      chEvtSignalI(elp->listener, elp->events);
+#if CH_CFG_USE_EVENTS_POLL == TRUE
+      if (elp->poll != NULL) {
+        evt_poll_ready(elp);
+      }
+      else
+#endif
+      {
+        chEvtSignalI(elp->listener, elp->events);
+      }
     }
     elp = elp->next;
   }
@@ -385,6 +470,89 @@ void chEvtBroadcastFlags(event_source_t *esp, eventflags_t flags) {
   chSysUnlock();
 }
 
+#if (CH_CFG_USE_EVENTS_POLL == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Registers an Event Listener on an Event Source and a Poll Set.
+ * @details The listener is added to the poll set ready list when the source
+ *          is broadcasted with flags matching @p wflags, the listener does
+ *          not signal events to the registering thread.
+ * @note    The listener is removed from the poll set by unregistering it
+ *          from the event source using @p chEvtUnregister().
+ *
+ * @param[in] epp       pointer to the @p event_poll_t structure
+ * @param[in] esp       pointer to the @p event_source_t structure
+ * @param[out] elp      pointer to the @p event_listener_t structure
+ * @param[in] wflags    mask of flags the poll set is interested in
+ *
+ * @api
+ */
+void chEvtPollRegisterWithFlags(event_poll_t *epp,
+                                event_source_t *esp,
+                                event_listener_t *elp,
+                                eventflags_t wflags) {
+
+  chDbgCheck(epp != NULL);
+
+  chSysLock();
+  chEvtRegisterMaskWithFlagsI(esp, elp, (eventmask_t)0, wflags);
+  elp->poll = epp;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Waits for ready listeners in a Poll Set.
+ * @details The function waits for at least one listener to become ready
+ *          then up to @p n ready listeners are removed from the ready list
+ *          and returned in the array, in broadcast order. The flags of
+ *          each returned listener can be fetched using
+ *          @p chEvtGetAndClearFlags().
+ * @note    Only one thread at time can wait on a poll set.
+ * @note    A listener is appended to the ready list once until it is
+ *          returned, further broadcasts only add flags to the listener.
+ *
+ * @param[in] epp       pointer to the @p event_poll_t structure
+ * @param[out] elps     array receiving the pointers to the ready listeners
+ * @param[in] n         size of the array, it must be greater than zero
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of listeners returned in the array.
+ * @retval 0            if the operation has timed out.
+ *
+ * @api
+ */
+cnt_t chEvtPollWaitTimeout(event_poll_t *epp,
+                           event_listener_t *elps[],
+                           cnt_t n,
+                           sysinterval_t timeout) {
+  event_listener_t *elp;
+  cnt_t i;
+
+  chDbgCheck((epp != NULL) && (elps != NULL) && (n > (cnt_t)0));
+
+  chSysLock();
+  if (epp->rfirst == NULL) {
+    if (chThdSuspendTimeoutS(&epp->thread, timeout) != MSG_OK) {
+      chSysUnlock();
+      return (cnt_t)0;
+    }
+  }
+  i = (cnt_t)0;
+  while ((i < n) && (epp->rfirst != NULL)) {
+    elp = epp->rfirst;
+    epp->rfirst = (elp->rnext == elp) ? NULL : elp->rnext;
+    elp->rnext = NULL;
+    elps[i] = elp;
+    i++;
+  }
+  chSysUnlock();
+
+  return i;
+}
+#endif /* CH_CFG_USE_EVENTS_POLL == TRUE */
+
 /**
  * @brief   Invokes the event handlers associated to an event flags mask.
  *
@@ -137,6 +137,11 @@ void chInstanceObjectInit(os_instance_t *oip,
   __stats_object_init(&oip->kernel_stats);
 #endif
 
+  /* Critical zones profiler initialization.*/
+#if CH_DBG_CS_PROFILER == TRUE
+  __csprof_object_init(&oip->csprof);
+#endif
+
 #if CH_CFG_NO_IDLE_THREAD == FALSE
   /* Now this instructions flow becomes the main thread.*/
 #if CH_CFG_USE_REGISTRY == TRUE
@@ -152,7 +157,8 @@ void chInstanceObjectInit(os_instance_t *oip,
                                          "idle", IDLEPRIO);
 #endif
 
-#if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE)
+#if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE) ||  \
+    (CH_DBG_STACK_PROFILER == TRUE)
   oip->rlist.current->wabase = oicp->mainthread_base;
 #endif
 
@@ -189,6 +195,31 @@ void chInstanceObjectInit(os_instance_t *oip,
     (void) chThdCreateI(&idle_descriptor);
   }
 #endif
+
+#if CH_CFG_USE_VT_DEFERRED == TRUE
+  {
+    thread_descriptor_t timer_descriptor = {
+      .name     = "timers",
+      .wbase    = oicp->timerthread_base,
+      .wend     = oicp->timerthread_end,
+      .prio     = CH_CFG_VT_THREAD_PRIO,
+      .funcp    = __vt_deferred_thread,
+      .arg      = (void *)&oip->vtlist
+    };
+
+#if CH_DBG_FILL_THREADS == TRUE
+    __thd_stackfill((uint8_t *)timer_descriptor.wbase,
+                    (uint8_t *)timer_descriptor.wend);
+#endif
+
+    /* This thread invokes the deferred virtual timer callbacks, it is
+       resumed by the system timer interrupt. It has a higher priority
+       than the current thread so it is scheduled immediately and reaches
+       its wait state.*/
+    (void) chThdCreateI(&timer_descriptor);
+    chSchRescheduleS();
+  }
+#endif
 }
 
 /** @} */
@@ -36,10 +36,23 @@
  *          Messages are usually processed in FIFO order but it is possible to
  *          process them in priority order by enabling the
  *          @p CH_CFG_USE_MESSAGES_PRIORITY option in @p chconf.h.<br>
+ *          A server can receive a batch of pending messages in a single
+ *          operation using @p chMsgWaitBatch() and answer them all using
+ *          @p chMsgReleaseBatch(), this reduces the number of context
+ *          switches when many clients are queued on the same server.<br>
+ *          By enabling the @p CH_CFG_USE_MESSAGES_ASYNC option a client
+ *          can also send a message using @p chMsgSendAsync() without
+ *          waiting, then collect the answer later using
+ *          @p chMsgWaitAnswer(). A client can have a single asynchronous
+ *          message outstanding and must collect its answer before sending
+ *          another message or terminating. When priority ordering is
+ *          enabled the priority of an asynchronous sender is sampled when
+ *          the message is sent.<br>
  * @pre     In order to use the message APIs the @p CH_CFG_USE_MESSAGES option
  *          must be enabled in @p chconf.h.
  * @post    Enabling messages requires 6-12 (depending on the architecture)
- *          extra bytes in the @p thread_t structure.
+ *          extra bytes in the @p thread_t structure, asynchronous messages
+ *          require a further messages queue link, a message and a state.
  * @{
  */
 
@@ -63,6 +76,28 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Dequeues the first sender from the messages queue.
+ * @pre     The messages queue must not be empty.
+ *
+ * @param[in] currtp    pointer to the server thread
+ * @return              A pointer to the thread carrying the message.
+ */
+static thread_t *msg_receive(thread_t *currtp) {
+  thread_t *tp;
+
+  tp = __ch_msg_thread(ch_queue_fifo_remove(&currtp->msgqueue));
+#if CH_CFG_USE_MESSAGES_ASYNC == TRUE
+  if (tp->msgsnd.state == CH_MSG_ASYNC_QUEUED) {
+    tp->msgsnd.state = CH_MSG_ASYNC_RECEIVED;
+    return tp;
+  }
+#endif
+  tp->state = CH_STATE_SNDMSG;
+
+  return tp;
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -84,7 +119,15 @@ msg_t chMsgSend(thread_t *tp, msg_t msg) {
   chDbgCheck(tp != NULL);
 
   chSysLock();
+#if CH_CFG_USE_MESSAGES_ASYNC == TRUE
+  chDbgAssert(currtp->msgsnd.state == CH_MSG_ASYNC_NONE,
+              "asynchronous message pending");
+  currtp->msgsnd.queue.prio = currtp->hdr.pqueue.prio;
+#endif
   currtp->u.sentmsg = msg;
+#if CH_CFG_USE_MESSAGES_PRIORITY == TRUE
+  currtp->msgserver = tp;
+#endif
   __ch_msg_insert(&tp->msgqueue, currtp);
   if (tp->state == CH_STATE_WTMSG) {
     (void) chSchReadyI(tp);
@@ -121,8 +164,7 @@ thread_t *chMsgWaitS(void) {
   if (!chMsgIsPendingI(currtp)) {
     chSchGoSleepS(CH_STATE_WTMSG);
   }
-  tp = threadref(ch_queue_fifo_remove(&currtp->msgqueue));
-  tp->state = CH_STATE_SNDMSG;
+  tp = msg_receive(currtp);
 
   return tp;
 }
@@ -160,8 +202,7 @@ thread_t *chMsgWaitTimeoutS(sysinterval_t timeout) {
       return NULL;
     }
   }
-  tp = threadref(ch_queue_fifo_remove(&currtp->msgqueue));
-  tp->state = CH_STATE_SNDMSG;
+  tp = msg_receive(currtp);
 
   return tp;
 }
@@ -188,8 +229,7 @@ thread_t *chMsgPollS(void) {
   thread_t *tp = NULL;
 
   if (chMsgIsPendingI(currtp)) {
-    tp = threadref(ch_queue_fifo_remove(&currtp->msgqueue));
-    tp->state = CH_STATE_SNDMSG;
+    tp = msg_receive(currtp);
   }
 
   return tp;
@@ -208,11 +248,187 @@ thread_t *chMsgPollS(void) {
 void chMsgRelease(thread_t *tp, msg_t msg) {
 
   chSysLock();
+#if CH_CFG_USE_MESSAGES_ASYNC == TRUE
+  chDbgAssert((tp->state == CH_STATE_SNDMSG) ||
+              (tp->msgsnd.state == CH_MSG_ASYNC_RECEIVED), "invalid state");
+#else
   chDbgAssert(tp->state == CH_STATE_SNDMSG, "invalid state");
+#endif
   chMsgReleaseS(tp, msg);
   chSysUnlock();
 }
 
+/**
+ * @brief   Receives a batch of messages.
+ * @details The function waits for at least one message then dequeues up to
+ *          @p n pending senders, in queue order, in a single critical zone.
+ * @post    Each received message must be retrieved using @p chMsgGet() and
+ *          acknowledged using @p chMsgRelease() or, all together, using
+ *          @p chMsgReleaseBatch().
+ * @note    The reference counters of the sender threads are not increased,
+ *          the returned pointers are temporary references.
+ *
+ * @param[out] tpp      array receiving the pointers to the sender threads
+ * @param[in] n         size of the array, it must be greater than zero
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of received messages.
+ * @retval 0            if a timeout occurred.
+ *
+ * @sclass
+ */
+cnt_t chMsgWaitBatchTimeoutS(thread_t **tpp, cnt_t n, sysinterval_t timeout) {
+  thread_t *currtp = chThdGetSelfX();
+  cnt_t cnt;
+
+  chDbgCheckClassS();
+  chDbgCheck((tpp != NULL) && (n > (cnt_t)0));
+
+  if (!chMsgIsPendingI(currtp)) {
+    if (TIME_IMMEDIATE == timeout) {
+      return (cnt_t)0;
+    }
+    (void) chSchGoSleepTimeoutS(CH_STATE_WTMSG, timeout);
+
+    /* Senders do not set a wakeup message, checking the queue instead.*/
+    if (!chMsgIsPendingI(currtp)) {
+      return (cnt_t)0;
+    }
+  }
+
+  cnt = (cnt_t)0;
+  do {
+    tpp[cnt++] = msg_receive(currtp);
+  } while ((cnt < n) && chMsgIsPendingI(currtp));
+
+  return cnt;
+}
+
+/**
+ * @brief   Releases a sender thread specifying a response message.
+ * @pre     Invoke this function only after a message has been received.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] msg       message to be returned to the sender
+ *
+ * @iclass
+ */
+void chMsgReleaseI(thread_t *tp, msg_t msg) {
+
+  chDbgCheckClassI();
+
+#if CH_CFG_USE_MESSAGES_ASYNC == TRUE
+  if (tp->msgsnd.state == CH_MSG_ASYNC_RECEIVED) {
+    tp->msgsnd.msg   = msg;
+    tp->msgsnd.state = CH_MSG_ASYNC_ANSWERED;
+
+    /* The sender is not necessarily waiting for the answer yet.*/
+    if (tp->state != CH_STATE_SNDMSG) {
+      return;
+    }
+  }
+#endif
+
+  chDbgAssert(tp->state == CH_STATE_SNDMSG, "invalid state");
+
+  tp->u.rdymsg = msg;
+  (void) chSchReadyI(tp);
+}
+
+/**
+ * @brief   Releases a batch of sender threads.
+ * @details All the senders are made ready then a single reschedule is
+ *          performed.
+ * @pre     Invoke this function only after the messages have been received
+ *          using @p chMsgWaitBatch().
+ *
+ * @param[in] tpp       array of pointers to the sender threads
+ * @param[in] msgs      array of messages to be returned to the senders
+ * @param[in] n         number of elements in the arrays
+ *
+ * @api
+ */
+void chMsgReleaseBatch(thread_t **tpp, const msg_t *msgs, cnt_t n) {
+  cnt_t i;
+
+  chDbgCheck((tpp != NULL) && (msgs != NULL));
+
+  chSysLock();
+  for (i = (cnt_t)0; i < n; i++) {
+    chMsgReleaseI(tpp[i], msgs[i]);
+  }
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+#if (CH_CFG_USE_MESSAGES_ASYNC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Sends a message to the specified thread without waiting.
+ * @details The message is queued on the server and the function returns
+ *          immediately, the answer must be collected later using
+ *          @p chMsgWaitAnswer().
+ * @pre     The calling thread must not have another asynchronous message
+ *          pending.
+ * @note    If the message is a pointer then the pointed data must remain
+ *          stable until the answer has been collected.
+ *
+ * @param[in] tp        the pointer to the thread
+ * @param[in] msg       the message
+ *
+ * @api
+ */
+void chMsgSendAsync(thread_t *tp, msg_t msg) {
+  thread_t *currtp = chThdGetSelfX();
+
+  chDbgCheck(tp != NULL);
+
+  chSysLock();
+  chDbgAssert(currtp->msgsnd.state == CH_MSG_ASYNC_NONE,
+              "asynchronous message pending");
+  currtp->msgsnd.msg        = msg;
+  currtp->msgsnd.state      = CH_MSG_ASYNC_QUEUED;
+  currtp->msgsnd.queue.prio = currtp->hdr.pqueue.prio;
+  __ch_msg_insert(&tp->msgqueue, currtp);
+  if (tp->state == CH_STATE_WTMSG) {
+    chSchWakeupS(tp, MSG_OK);
+  }
+  chSysUnlock();
+}
+
+/**
+ * @brief   Waits for the answer to an asynchronous message.
+ * @details If the answer is already available then the function returns
+ *          immediately.
+ * @pre     An asynchronous message must have been sent using
+ *          @p chMsgSendAsync().
+ *
+ * @return              The answer message from @p chMsgRelease().
+ *
+ * @api
+ */
+msg_t chMsgWaitAnswer(void) {
+  thread_t *currtp = chThdGetSelfX();
+  msg_t msg;
+
+  chSysLock();
+  chDbgAssert(currtp->msgsnd.state != CH_MSG_ASYNC_NONE,
+              "no asynchronous message");
+  if (currtp->msgsnd.state != CH_MSG_ASYNC_ANSWERED) {
+    chSchGoSleepS(CH_STATE_SNDMSG);
+  }
+  msg = currtp->msgsnd.msg;
+  currtp->msgsnd.state = CH_MSG_ASYNC_NONE;
+  chSysUnlock();
+
+  return msg;
+}
+#endif /* CH_CFG_USE_MESSAGES_ASYNC == TRUE */
+
 #endif /* CH_CFG_USE_MESSAGES == TRUE */
 
 /** @} */
@@ -52,6 +52,18 @@
  *          It is possible to enable the recursive behavior by enabling the
  *          option @p CH_CFG_USE_MUTEXES_RECURSIVE.
  *
+ *          <h2>Fast path</h2>
+ *          If the option @p CH_CFG_USE_MUTEXES_FASTPATH is enabled then
+ *          @p chMtxLock(), @p chMtxTryLock() and @p chMtxUnlock() perform
+ *          an atomic compare-and-swap on the owner field and do not enter
+ *          the kernel if the mutex is not owned or there are no waiting
+ *          threads. A waiting thread sets a flag into the owner field so
+ *          that the owner is forced to unlock the mutex through the kernel.
+ *          The port must support atomic compare-and-swap.<br>
+ *          The fast path is not used when the debug checks or assertions
+ *          are enabled, the APIs always enter the kernel and perform the
+ *          complete state checks.
+ *
  *          <h2>The priority inversion problem</h2>
  *          The mutexes in ChibiOS/RT implements the <b>full</b> priority
  *          inheritance mechanism in order handle the priority inversion
@@ -73,6 +85,25 @@
 
 #if (CH_CFG_USE_MUTEXES == TRUE) || defined(__DOXYGEN__)
 
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Uncontended fast path in the mutexes APIs.
+ * @details The fast path runs outside the kernel lock so it is disabled
+ *          when the debug checks are enabled, the kernel path performs
+ *          the state checks and the assertions.
+ */
+#if (CH_CFG_USE_MUTEXES_FASTPATH == TRUE) &&                                \
+    (CH_DBG_SYSTEM_STATE_CHECK == FALSE) &&                                 \
+    (CH_DBG_ENABLE_CHECKS == FALSE) &&                                      \
+    (CH_DBG_ENABLE_ASSERTS == FALSE)
+#define MTX_API_FASTPATH                    TRUE
+#else
+#define MTX_API_FASTPATH                    FALSE
+#endif
+
 /*===========================================================================*/
 /* Module exported variables.                                                */
 /*===========================================================================*/
@@ -89,10 +120,278 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_MUTEXES_FASTPATH == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Atomic compare-and-swap on the mutex owner field.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] cmp       expected owner field value
+ * @param[in] val       new owner field value
+ * @return              The operation result.
+ * @retval false        if the owner field did not match.
+ * @retval true         if the owner field has been updated.
+ */
+static inline bool mtx_cas(mutex_t *mp, thread_t *cmp, thread_t *val) {
+
+  /*lint -save -e9087 [11.3] Owner field accessed as generic pointer.*/
+  return port_atomic_cas_ptr((void * volatile *)&mp->owner,
+                             (void *)cmp, (void *)val);
+  /*lint -restore*/
+}
+#endif
+
+/**
+ * @brief   Takes a mutex if it is not owned.
+ * @note    If the fast path is enabled then this function can be called
+ *          outside the kernel lock.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] tp        pointer to the thread taking the mutex
+ * @return              The operation result.
+ * @retval false        if the mutex is owned.
+ * @retval true         if the mutex has been taken.
+ */
+static bool mtx_take(mutex_t *mp, thread_t *tp) {
+
+#if CH_CFG_USE_MUTEXES_FASTPATH == TRUE
+  if (!mtx_cas(mp, NULL, tp)) {
+    return false;
+  }
+#else
+  if (mp->owner != NULL) {
+    return false;
+  }
+  mp->owner = tp;
+#endif
+
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+  chDbgAssert(mp->cnt == (cnt_t)0, "counter is not zero");
+
+  mp->cnt = (cnt_t)1;
+#endif
+  /* It was not owned, inserted in the owned mutexes list.*/
+  mp->next = tp->mtxlist;
+  tp->mtxlist = mp;
+
+  return true;
+}
+
+/**
+ * @brief   Assigns an owned mutex to the specified thread.
+ * @details The mutex is inserted in the thread owned mutexes list, the
+ *          owner field is flagged if there are other waiting threads.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] tp        pointer to the new owner thread
+ */
+static void mtx_give(mutex_t *mp, thread_t *tp) {
+
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+  mp->cnt = (cnt_t)1;
+#endif
+#if CH_CFG_USE_MUTEXES_FASTPATH == TRUE
+  if (ch_queue_notempty(&mp->queue)) {
+    mp->owner = (thread_t *)((uintptr_t)tp | __MTX_WAITERS_FLAG);
+  }
+  else {
+    mp->owner = tp;
+  }
+#else
+  mp->owner = tp;
+#endif
+  mp->next = tp->mtxlist;
+  tp->mtxlist = mp;
+}
+
+#if (MTX_API_FASTPATH == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Releases a mutex if there are no waiting threads.
+ * @note    This function is called outside the kernel lock.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] tp        pointer to the owner thread
+ * @return              The operation result.
+ * @retval false        if there are waiting threads, the mutex is still
+ *                      owned.
+ * @retval true         if the mutex has been released.
+ */
+static bool mtx_release(mutex_t *mp, thread_t *tp) {
+
+  chDbgAssert(tp->mtxlist == mp, "not next in list");
+
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+  chDbgAssert(mp->cnt >= (cnt_t)1, "counter is not positive");
+
+  if (mp->cnt > (cnt_t)1) {
+    mp->cnt--;
+    return true;
+  }
+  mp->cnt = (cnt_t)0;
+#endif
+
+  /* Removing the mutex from the owned mutexes list before releasing it,
+     after the release the mutex could be taken by another thread.*/
+  tp->mtxlist = mp->next;
+  if (mtx_cas(mp, tp, NULL)) {
+    return true;
+  }
+
+  /* The owner field is flagged, restoring the state, the release is
+     performed by the kernel.*/
+  tp->mtxlist = mp;
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+  mp->cnt = (cnt_t)1;
+#endif
+
+  return false;
+}
+#endif
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
 
+/**
+ * @brief   Priority inheritance protocol.
+ * @details Explores the thread-mutex dependencies starting from the
+ *          specified owner thread, boosting the priority of all the affected
+ *          threads to equal the specified priority.
+ *
+ * @param[in] tp        the owner thread of the object the caller is going to
+ *                      wait on
+ * @param[in] prio      priority of the thread going to wait
+ *
+ * @notapi
+ */
+void __mtx_prio_boost(thread_t *tp, tprio_t prio) {
+
+  /* Does the waiting thread have higher priority than the owning thread? */
+  while (tp->hdr.pqueue.prio < prio) {
+    /* Make priority of thread tp match the waiting thread's priority.*/
+    tp->hdr.pqueue.prio = prio;
+
+    /* The following states need priority queues reordering.*/
+    switch (tp->state) {
+    case CH_STATE_WTMTX:
+      /* Re-enqueues the mutex owner with its new priority.*/
+      ch_sch_prio_insert(&tp->u.wtmtxp->queue,
+                         ch_queue_dequeue(&tp->hdr.queue));
+      tp = __mtx_owner(tp->u.wtmtxp);
+      /*lint -e{9042} [16.1] Continues the while.*/
+      continue;
+#if CH_CFG_USE_RWLOCKS == TRUE
+    case CH_STATE_WTRWRD:
+      /* Falls through.*/
+    case CH_STATE_WTRWWR:
+      /* Re-enqueues tp with its new priority on the lock queue, the
+         boost continues on the writer owning the lock, if any.*/
+      ch_sch_prio_insert(&tp->u.wtrwlp->mtx.queue,
+                         ch_queue_dequeue(&tp->hdr.queue));
+      if (tp->u.wtrwlp->mtx.owner != NULL) {
+        tp = tp->u.wtrwlp->mtx.owner;
+        /*lint -e{9042} [16.1] Continues the while.*/
+        continue;
+      }
+      break;
+#endif
+#if (CH_CFG_USE_CONDVARS == TRUE) ||                                        \
+    ((CH_CFG_USE_SEMAPHORES == TRUE) &&                                     \
+     (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)) ||                           \
+    (CH_CFG_USE_PCMUTEXES == TRUE)
+#if CH_CFG_USE_CONDVARS == TRUE
+    case CH_STATE_WTCOND:
+#endif
+#if CH_CFG_USE_PCMUTEXES == TRUE
+    case CH_STATE_WTPCMTX:
+#endif
+#if (CH_CFG_USE_SEMAPHORES == TRUE) &&                                      \
+    (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)
+    case CH_STATE_WTSEM:
+#endif
+      /* Re-enqueues tp with its new priority on the queue.*/
+      ch_sch_prio_insert(&tp->u.wtmtxp->queue,
+                         ch_queue_dequeue(&tp->hdr.queue));
+      break;
+#endif
+#if (CH_CFG_USE_MESSAGES == TRUE) &&                                        \
+    (CH_CFG_USE_MESSAGES_PRIORITY == TRUE)
+    case CH_STATE_SNDMSGQ:
+      /* Re-enqueues tp with its new priority on the server messages
+         queue.*/
+#if CH_CFG_USE_MESSAGES_ASYNC == TRUE
+      tp->msgsnd.queue.prio = prio;
+#endif
+      (void) ch_queue_dequeue(__ch_msg_node(tp));
+      __ch_msg_insert(&tp->msgserver->msgqueue, tp);
+      break;
+#endif
+    case CH_STATE_READY:
+#if CH_DBG_ENABLE_ASSERTS == TRUE
+      /* Prevents an assertion in chSchReadyI().*/
+      tp->state = CH_STATE_CURRENT;
+#endif
+      /* Re-enqueues tp with its new priority on the ready list.*/
+      (void) chSchReadyI(threadref(ch_queue_dequeue(&tp->hdr.queue)));
+      break;
+    default:
+      /* Nothing to do for other states.*/
+      break;
+    }
+    break;
+  }
+}
+
+/**
+ * @brief   Takes a mutex or enqueues a thread on it.
+ * @details If the mutex is owned then the thread is inserted in the mutex
+ *          queue and the priority inheritance protocol is applied to the
+ *          owner, the thread state is not changed.
+ *
+ * @param[in] mp        pointer to the @p mutex_t structure
+ * @param[in] tp        pointer to the thread
+ * @return              The operation result.
+ * @retval false        if the thread has been enqueued.
+ * @retval true         if the mutex has been taken.
+ *
+ * @notapi
+ */
+bool __mtx_take_or_enqueue(mutex_t *mp, thread_t *tp) {
+  thread_t *owner;
+
+  while (!mtx_take(mp, tp)) {
+#if CH_CFG_USE_MUTEXES_FASTPATH == TRUE
+    /* Flagging the owner field so that the owner cannot release the mutex
+       without entering the kernel, retrying if the mutex has been released
+       in the meantime. A flagged owner field cannot change outside the
+       kernel lock.*/
+    owner = mp->owner;
+    if (owner == NULL) {
+      continue;
+    }
+    if (((uintptr_t)owner & __MTX_WAITERS_FLAG) == 0U) {
+      if (!mtx_cas(mp, owner,
+                   (thread_t *)((uintptr_t)owner | __MTX_WAITERS_FLAG))) {
+        continue;
+      }
+    }
+#endif
+    owner = __mtx_owner(mp);
+
+    /* Sleep on the mutex.*/
+    ch_sch_prio_insert(&mp->queue, &tp->hdr.queue);
+    tp->u.wtmtxp = mp;
+
+    /* Priority inheritance protocol; explores the thread-mutex dependencies
+       boosting the priority of all the affected threads to equal the
+       priority of the thread requesting the mutex.*/
+    __mtx_prio_boost(owner, tp->hdr.pqueue.prio);
+
+    return false;
+  }
+
+  return true;
+}
+
 /**
  * @brief   Initializes s @p mutex_t structure.
  *
@@ -122,6 +421,13 @@ void chMtxObjectInit(mutex_t *mp) {
  */
 void chMtxLock(mutex_t *mp) {
 
+#if MTX_API_FASTPATH == TRUE
+  /* Fast path, the mutex is not owned.*/
+  if (mtx_take(mp, chThdGetSelfX())) {
+    return;
+  }
+#endif
+
   chSysLock();
   chMtxLockS(mp);
   chSysUnlock();
@@ -142,99 +448,29 @@ void chMtxLockS(mutex_t *mp) {
   chDbgCheckClassS();
   chDbgCheck(mp != NULL);
 
-  /* Is the mutex already locked? */
-  if (mp->owner != NULL) {
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
-
+  /* If the mutex is already owned by this thread, the counter is increased
+     and there is no need of more actions.*/
+  if (__mtx_owner(mp) == currtp) {
     chDbgAssert(mp->cnt >= (cnt_t)1, "counter is not positive");
 
-    /* If the mutex is already owned by this thread, the counter is increased
-       and there is no need of more actions.*/
-    if (mp->owner == currtp) {
-      mp->cnt++;
-    }
-    else {
-#endif
-      /* Priority inheritance protocol; explores the thread-mutex dependencies
-         boosting the priority of all the affected threads to equal the
-         priority of the running thread requesting the mutex.*/
-      thread_t *tp = mp->owner;
-
-      /* Does the running thread have higher priority than the mutex
-         owning thread? */
-      while (tp->hdr.pqueue.prio < currtp->hdr.pqueue.prio) {
-        /* Make priority of thread tp match the running thread's priority.*/
-        tp->hdr.pqueue.prio = currtp->hdr.pqueue.prio;
-
-        /* The following states need priority queues reordering.*/
-        switch (tp->state) {
-        case CH_STATE_WTMTX:
-          /* Re-enqueues the mutex owner with its new priority.*/
-          ch_sch_prio_insert(&tp->u.wtmtxp->queue,
-                             ch_queue_dequeue(&tp->hdr.queue));
-          tp = tp->u.wtmtxp->owner;
-          /*lint -e{9042} [16.1] Continues the while.*/
-          continue;
-#if (CH_CFG_USE_CONDVARS == TRUE) ||                                        \
-    ((CH_CFG_USE_SEMAPHORES == TRUE) &&                                     \
-     (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)) ||                           \
-    ((CH_CFG_USE_MESSAGES == TRUE) &&                                       \
-     (CH_CFG_USE_MESSAGES_PRIORITY == TRUE))
-#if CH_CFG_USE_CONDVARS == TRUE
-        case CH_STATE_WTCOND:
-#endif
-#if (CH_CFG_USE_SEMAPHORES == TRUE) &&                                      \
-    (CH_CFG_USE_SEMAPHORES_PRIORITY == TRUE)
-        case CH_STATE_WTSEM:
-#endif
-#if (CH_CFG_USE_MESSAGES == TRUE) && (CH_CFG_USE_MESSAGES_PRIORITY == TRUE)
-        case CH_STATE_SNDMSGQ:
-#endif
-          /* Re-enqueues tp with its new priority on the queue.*/
-          ch_sch_prio_insert(&tp->u.wtmtxp->queue,
-                             ch_queue_dequeue(&tp->hdr.queue));
-          break;
-#endif
-        case CH_STATE_READY:
-#if CH_DBG_ENABLE_ASSERTS == TRUE
-          /* Prevents an assertion in chSchReadyI().*/
-          tp->state = CH_STATE_CURRENT;
+    mp->cnt++;
+    return;
+  }
 #endif
-          /* Re-enqueues tp with its new priority on the ready list.*/
-          (void) chSchReadyI(threadref(ch_queue_dequeue(&tp->hdr.queue)));
-          break;
-        default:
-          /* Nothing to do for other states.*/
-          break;
-        }
-        break;
-      }
 
-      /* Sleep on the mutex.*/
-      ch_sch_prio_insert(&mp->queue, &currtp->hdr.queue);
-      currtp->u.wtmtxp = mp;
-      chSchGoSleepS(CH_STATE_WTMTX);
+  /* Is the mutex already locked? */
+  if (!__mtx_take_or_enqueue(mp, currtp)) {
+    chSchGoSleepS(CH_STATE_WTMTX);
 
-      /* It is assumed that the thread performing the unlock operation assigns
-         the mutex to this thread.*/
-      chDbgAssert(mp->owner == currtp, "not owner");
-      chDbgAssert(currtp->mtxlist == mp, "not owned");
+    /* It is assumed that the thread performing the unlock operation assigns
+       the mutex to this thread.*/
+    chDbgAssert(__mtx_owner(mp) == currtp, "not owner");
+    chDbgAssert(currtp->mtxlist == mp, "not owned");
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
-      chDbgAssert(mp->cnt == (cnt_t)1, "counter is not one");
-    }
+    chDbgAssert(mp->cnt == (cnt_t)1, "counter is not one");
 #endif
   }
-  else {
-#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
-    chDbgAssert(mp->cnt == (cnt_t)0, "counter is not zero");
-
-    mp->cnt++;
-#endif
-    /* It was not owned, inserted in the owned mutexes list.*/
-    mp->owner = currtp;
-    mp->next = currtp->mtxlist;
-    currtp->mtxlist = mp;
-  }
 }
 
 /**
@@ -257,6 +493,13 @@ void chMtxLockS(mutex_t *mp) {
 bool chMtxTryLock(mutex_t *mp) {
   bool b;
 
+#if MTX_API_FASTPATH == TRUE
+  /* Fast path, the mutex is not owned.*/
+  if (mtx_take(mp, chThdGetSelfX())) {
+    return true;
+  }
+#endif
+
   chSysLock();
   b = chMtxTryLockS(mp);
   chSysUnlock();
@@ -287,28 +530,16 @@ bool chMtxTryLockS(mutex_t *mp) {
   chDbgCheckClassS();
   chDbgCheck(mp != NULL);
 
-  if (mp->owner != NULL) {
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
-
+  if (__mtx_owner(mp) == currtp) {
     chDbgAssert(mp->cnt >= (cnt_t)1, "counter is not positive");
 
-    if (mp->owner == currtp) {
-      mp->cnt++;
-      return true;
-    }
-#endif
-    return false;
+    mp->cnt++;
+    return true;
   }
-#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
-
-  chDbgAssert(mp->cnt == (cnt_t)0, "counter is not zero");
-
-  mp->cnt++;
 #endif
-  mp->owner = currtp;
-  mp->next = currtp->mtxlist;
-  currtp->mtxlist = mp;
-  return true;
+
+  return mtx_take(mp, currtp);
 }
 
 /**
@@ -329,10 +560,17 @@ void chMtxUnlock(mutex_t *mp) {
 
   chDbgCheck(mp != NULL);
 
+#if MTX_API_FASTPATH == TRUE
+  /* Fast path, there are no waiting threads.*/
+  if (mtx_release(mp, currtp)) {
+    return;
+  }
+#endif
+
   chSysLock();
 
   chDbgAssert(currtp->mtxlist != NULL, "owned mutexes list empty");
-  chDbgAssert(currtp->mtxlist->owner == currtp, "ownership failure");
+  chDbgAssert(__mtx_owner(currtp->mtxlist) == currtp, "ownership failure");
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
   chDbgAssert(mp->cnt >= (cnt_t)1, "counter is not positive");
 
@@ -352,7 +590,7 @@ void chMtxUnlock(mutex_t *mp) {
 
       /* Recalculates the optimal thread priority by scanning the owned
          mutexes list.*/
-      tprio_t newprio = currtp->realprio;
+      tprio_t newprio = __mtx_base_prio(currtp);
       lmp = currtp->mtxlist;
       while (lmp != NULL) {
         /* If the highest priority thread waiting in the mutexes list has a
@@ -371,13 +609,8 @@ void chMtxUnlock(mutex_t *mp) {
 
       /* Awakens the highest priority thread waiting for the unlocked mutex and
          assigns the mutex to it.*/
-#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
-      mp->cnt = (cnt_t)1;
-#endif
       tp = threadref(ch_queue_fifo_remove(&mp->queue));
-      mp->owner = tp;
-      mp->next = tp->mtxlist;
-      tp->mtxlist = mp;
+      mtx_give(mp, tp);
 
       /* Note, not using chSchWakeupS() because that function expects the
          current thread to have the higher or equal priority than the ones
@@ -418,7 +651,7 @@ void chMtxUnlockS(mutex_t *mp) {
   chDbgCheck(mp != NULL);
 
   chDbgAssert(currtp->mtxlist != NULL, "owned mutexes list empty");
-  chDbgAssert(currtp->mtxlist->owner == currtp, "ownership failure");
+  chDbgAssert(__mtx_owner(currtp->mtxlist) == currtp, "ownership failure");
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
   chDbgAssert(mp->cnt >= (cnt_t)1, "counter is not positive");
 
@@ -438,7 +671,7 @@ void chMtxUnlockS(mutex_t *mp) {
 
       /* Recalculates the optimal thread priority by scanning the owned
          mutexes list.*/
-      tprio_t newprio = currtp->realprio;
+      tprio_t newprio = __mtx_base_prio(currtp);
       lmp = currtp->mtxlist;
       while (lmp != NULL) {
         /* If the highest priority thread waiting in the mutexes list has a
@@ -457,13 +690,8 @@ void chMtxUnlockS(mutex_t *mp) {
 
       /* Awakens the highest priority thread waiting for the unlocked mutex and
          assigns the mutex to it.*/
-#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
-      mp->cnt = (cnt_t)1;
-#endif
       tp = threadref(ch_queue_fifo_remove(&mp->queue));
-      mp->owner = tp;
-      mp->next = tp->mtxlist;
-      tp->mtxlist = mp;
+      mtx_give(mp, tp);
       (void) chSchReadyI(tp);
     }
     else {
@@ -478,6 +706,8 @@ void chMtxUnlockS(mutex_t *mp) {
  * @brief   Unlocks all mutexes owned by the invoking thread.
  * @post    The stack of owned mutexes is emptied and all the found
  *          mutexes are unlocked.
+ * @note    Readers-writer locks owned for writing are in the same stack,
+ *          they are released too.
  * @post    This function does not reschedule so a call to a rescheduling
  *          function must be performed before unlocking the kernel.
  * @note    This function is <b>MUCH MORE</b> efficient than releasing the
@@ -496,13 +726,18 @@ void chMtxUnlockAllS(void) {
       currtp->mtxlist = mp->next;
       if (chMtxQueueNotEmptyS(mp)) {
         thread_t *tp;
-#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
-        mp->cnt = (cnt_t)1;
+#if CH_CFG_USE_RWLOCKS == TRUE
+        /* A readers-writer lock owned for writing, it is released using
+           its own policy, the waiters could be readers.*/
+        tp = threadref(mp->queue.next);
+        if ((tp->state == CH_STATE_WTRWRD) ||
+            (tp->state == CH_STATE_WTRWWR)) {
+          __rwlock_release(tp->u.wtrwlp);
+          continue;
+        }
 #endif
         tp = threadref(ch_queue_fifo_remove(&mp->queue));
-        mp->owner   = tp;
-        mp->next    = tp->mtxlist;
-        tp->mtxlist = mp;
+        mtx_give(mp, tp);
         (void) chSchReadyI(tp);
       }
       else {
@@ -512,7 +747,7 @@ void chMtxUnlockAllS(void) {
         mp->owner = NULL;
       }
     } while (currtp->mtxlist != NULL);
-    currtp->hdr.pqueue.prio = currtp->realprio;
+    currtp->hdr.pqueue.prio = __mtx_base_prio(currtp);
     chSchRescheduleS();
   }
 }
@@ -521,6 +756,8 @@ void chMtxUnlockAllS(void) {
  * @brief   Unlocks all mutexes owned by the invoking thread.
  * @post    The stack of owned mutexes is emptied and all the found
  *          mutexes are unlocked.
+ * @note    Readers-writer locks owned for writing are in the same stack,
+ *          they are released too.
  * @note    This function is <b>MUCH MORE</b> efficient than releasing the
  *          mutexes one by one and not just because the call overhead,
  *          this function does not have any overhead related to the priority
@@ -0,0 +1,316 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/src/chpcmtx.c
+ * @brief   Priority Ceiling Mutexes code.
+ *
+ * @addtogroup pcmutexes
+ * @details Priority Ceiling Mutexes related APIs and services.
+ *          <h2>Operation mode</h2>
+ *          A priority ceiling mutex is a mutex with a static priority
+ *          ceiling, the ceiling must be greater or equal to the priority
+ *          of all the threads using the mutex.<br>
+ *          This is an implementation of the immediate priority ceiling
+ *          protocol, the owner is raised to the ceiling priority as soon as
+ *          the mutex is acquired and returns to its own priority when
+ *          the mutex is released. While a thread owns the mutex no other
+ *          thread using it can preempt it so the mutex is normally found
+ *          free, lock and unlock have a constant execution time because
+ *          no priority inheritance chains need to be walked.<br>
+ *          If the owner blocks while owning the mutex then other threads
+ *          can find it owned, those threads are queued by priority and the
+ *          mutex is handed to them in turn, the owner priority is not
+ *          changed.
+ *
+ *          <h2>Constraints</h2>
+ *          Priority ceiling mutexes must be unlocked in lock-reverse order,
+ *          the same restriction applies to normal mutexes but the two kinds
+ *          are tracked separately and can be freely nested.<br>
+ *          The priority of a thread can be changed using
+ *          @p chThdSetPriority() while it owns priority ceiling mutexes,
+ *          the thread keeps running at the ceiling priority and the new
+ *          priority becomes effective when the mutexes are released.
+ * @pre     In order to use the priority ceiling mutexes APIs the
+ *          @p CH_CFG_USE_PCMUTEXES option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_PCMUTEXES == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Assigns a mutex to a thread.
+ * @details The mutex is inserted in the thread owned mutexes list and the
+ *          thread is raised to the mutex priority ceiling.
+ *
+ * @param[in] pcmp      pointer to the @p pcmutex_t structure
+ * @param[in] tp        pointer to the new owner thread
+ */
+static void pcmtx_give(pcmutex_t *pcmp, thread_t *tp) {
+
+  /* The highest ceiling in the owned mutexes stack is tracked in the
+     mutexes themselves, the thread own priority is not altered.*/
+  pcmp->maxceiling = pcmp->ceiling;
+  if ((tp->pcmtxlist != NULL) &&
+      (tp->pcmtxlist->maxceiling > pcmp->ceiling)) {
+    pcmp->maxceiling = tp->pcmtxlist->maxceiling;
+  }
+  pcmp->owner      = tp;
+  pcmp->next       = tp->pcmtxlist;
+  tp->pcmtxlist    = pcmp;
+
+  if (tp->hdr.pqueue.prio < pcmp->ceiling) {
+    tp->hdr.pqueue.prio = pcmp->ceiling;
+  }
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes s @p pcmutex_t structure.
+ *
+ * @param[out] pcmp     pointer to a @p pcmutex_t structure
+ * @param[in] ceiling   the priority ceiling, it must be greater or equal
+ *                      to the priority of all the threads using the mutex
+ *
+ * @init
+ */
+void chPCMtxObjectInit(pcmutex_t *pcmp, tprio_t ceiling) {
+
+  chDbgCheck((pcmp != NULL) && (ceiling <= HIGHPRIO));
+
+  ch_queue_init(&pcmp->queue);
+  pcmp->owner    = NULL;
+  pcmp->next     = NULL;
+  pcmp->ceiling    = ceiling;
+  pcmp->maxceiling = (tprio_t)0;
+}
+
+/**
+ * @brief   Locks the specified mutex.
+ * @post    The mutex is locked and inserted in the per-thread stack of owned
+ *          priority ceiling mutexes, the thread priority is raised to the
+ *          mutex ceiling.
+ *
+ * @param[in] pcmp      pointer to the @p pcmutex_t structure
+ *
+ * @api
+ */
+void chPCMtxLock(pcmutex_t *pcmp) {
+
+  chSysLock();
+  chPCMtxLockS(pcmp);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Locks the specified mutex.
+ * @post    The mutex is locked and inserted in the per-thread stack of owned
+ *          priority ceiling mutexes, the thread priority is raised to the
+ *          mutex ceiling.
+ *
+ * @param[in] pcmp      pointer to the @p pcmutex_t structure
+ *
+ * @sclass
+ */
+void chPCMtxLockS(pcmutex_t *pcmp) {
+  thread_t *currtp = chThdGetSelfX();
+
+  chDbgCheckClassS();
+  chDbgCheck(pcmp != NULL);
+  chDbgAssert((currtp->pcmtxlist != NULL) ||
+              (currtp->realprio <= pcmp->ceiling), "ceiling violation");
+
+  /* Is the mutex already locked? */
+  if (pcmp->owner != NULL) {
+    chDbgAssert(pcmp->owner != currtp, "already owned");
+
+    /* The owner is not boosted, it is already running at the ceiling
+       priority.*/
+    ch_sch_prio_insert(&pcmp->queue, &currtp->hdr.queue);
+    currtp->u.wtpcmtxp = pcmp;
+    chSchGoSleepS(CH_STATE_WTPCMTX);
+
+    /* It is assumed that the thread performing the unlock operation assigns
+       the mutex to this thread.*/
+    chDbgAssert(pcmp->owner == currtp, "not owner");
+    chDbgAssert(currtp->pcmtxlist == pcmp, "not owned");
+  }
+  else {
+    /* It was not owned, taking it.*/
+    pcmtx_give(pcmp, currtp);
+  }
+}
+
+/**
+ * @brief   Tries to lock a mutex.
+ * @details This function attempts to lock a mutex, if the mutex is already
+ *          locked by another thread then the function exits without waiting.
+ * @post    The mutex is locked and inserted in the per-thread stack of owned
+ *          priority ceiling mutexes, the thread priority is raised to the
+ *          mutex ceiling.
+ *
+ * @param[in] pcmp      pointer to the @p pcmutex_t structure
+ * @return              The operation status.
+ * @retval true         if the mutex has been successfully acquired
+ * @retval false        if the lock attempt failed.
+ *
+ * @api
+ */
+bool chPCMtxTryLock(pcmutex_t *pcmp) {
+  bool b;
+
+  chSysLock();
+  b = chPCMtxTryLockS(pcmp);
+  chSysUnlock();
+
+  return b;
+}
+
+/**
+ * @brief   Tries to lock a mutex.
+ * @details This function attempts to lock a mutex, if the mutex is already
+ *          locked by another thread then the function exits without waiting.
+ * @post    The mutex is locked and inserted in the per-thread stack of owned
+ *          priority ceiling mutexes, the thread priority is raised to the
+ *          mutex ceiling.
+ *
+ * @param[in] pcmp      pointer to the @p pcmutex_t structure
+ * @return              The operation status.
+ * @retval true         if the mutex has been successfully acquired
+ * @retval false        if the lock attempt failed.
+ *
+ * @sclass
+ */
+bool chPCMtxTryLockS(pcmutex_t *pcmp) {
+  thread_t *currtp = chThdGetSelfX();
+
+  chDbgCheckClassS();
+  chDbgCheck(pcmp != NULL);
+  chDbgAssert((currtp->pcmtxlist != NULL) ||
+              (currtp->realprio <= pcmp->ceiling), "ceiling violation");
+
+  if (pcmp->owner != NULL) {
+    return false;
+  }
+
+  pcmtx_give(pcmp, currtp);
+
+  return true;
+}
+
+/**
+ * @brief   Unlocks the specified mutex.
+ * @note    Mutexes must be unlocked in reverse lock order. Violating this
+ *          rules will result in a panic if assertions are enabled.
+ * @pre     The invoking thread <b>must</b> have at least one owned mutex.
+ * @post    The mutex is unlocked and removed from the per-thread stack of
+ *          owned priority ceiling mutexes, the thread returns to its own
+ *          priority or to the ceiling of the other owned mutexes.
+ *
+ * @param[in] pcmp      pointer to the @p pcmutex_t structure
+ *
+ * @api
+ */
+void chPCMtxUnlock(pcmutex_t *pcmp) {
+
+  chSysLock();
+  chPCMtxUnlockS(pcmp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Unlocks the specified mutex.
+ * @note    Mutexes must be unlocked in reverse lock order. Violating this
+ *          rules will result in a panic if assertions are enabled.
+ * @pre     The invoking thread <b>must</b> have at least one owned mutex.
+ * @post    The mutex is unlocked and removed from the per-thread stack of
+ *          owned priority ceiling mutexes, the thread returns to its own
+ *          priority or to the ceiling of the other owned mutexes.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel.
+ *
+ * @param[in] pcmp      pointer to the @p pcmutex_t structure
+ *
+ * @sclass
+ */
+void chPCMtxUnlockS(pcmutex_t *pcmp) {
+  thread_t *currtp = chThdGetSelfX();
+  tprio_t newprio;
+  mutex_t *lmp;
+
+  chDbgCheckClassS();
+  chDbgCheck(pcmp != NULL);
+  chDbgAssert(pcmp->owner == currtp, "ownership failure");
+  chDbgAssert(currtp->pcmtxlist == pcmp, "not next in list");
+
+  /* Removes the top mutex from the thread's owned mutexes list and returns
+     to the thread own priority, a priority set while owning the mutex is
+     preserved, the ceilings of the other owned mutexes still apply.*/
+  currtp->pcmtxlist = pcmp->next;
+
+  /* The priority inherited from normal mutexes, if any, is preserved. The
+     list is normally empty in threads only using ceiling mutexes.*/
+  newprio = __pcmtx_base_prio(currtp);
+  lmp = currtp->mtxlist;
+  while (lmp != NULL) {
+    if (chMtxQueueNotEmptyS(lmp) &&
+        ((threadref(lmp->queue.next))->hdr.pqueue.prio > newprio)) {
+      newprio = (threadref(lmp->queue.next))->hdr.pqueue.prio;
+    }
+    lmp = lmp->next;
+  }
+  currtp->hdr.pqueue.prio = newprio;
+
+  /* Hands the mutex to the highest priority waiting thread, if any.*/
+  if (ch_queue_notempty(&pcmp->queue)) {
+    thread_t *tp = threadref(ch_queue_fifo_remove(&pcmp->queue));
+
+    pcmtx_give(pcmp, tp);
+    (void) chSchReadyI(tp);
+  }
+  else {
+    pcmp->owner = NULL;
+  }
+}
+
+#endif /* CH_CFG_USE_PCMUTEXES == TRUE */
+
+/** @} */
@@ -0,0 +1,205 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/src/chrecorder.c
+ * @brief   Flight recorder code.
+ *
+ * @addtogroup recorder
+ * @details Post-mortem recording of kernel and user events.
+ *          <h2>Operation mode</h2>
+ *          Events are written as two 32 bits words into a ring buffer
+ *          located in a memory section not initialized by the startup
+ *          code, the cost of an event is a time stamp read and a few
+ *          stores, the events not selected by @p CH_DBG_RECORDER_MASK are
+ *          removed at compile time.<br>
+ *          The recorder area contains two histories. On initialization, if
+ *          the area is found valid, the history being written before the
+ *          reset is preserved as the previous history and the recording
+ *          continues on the other one. The previous history can then be
+ *          examined, for example using the "recorder" shell command.
+ * @note    The content of the previous history is only meaningful if the
+ *          memory has been retained across the reset, after a power-on
+ *          the area is found invalid and both histories are cleared.
+ * @pre     In order to use the flight recorder the @p CH_DBG_RECORDER
+ *          option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_DBG_RECORDER == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Recorder area.
+ */
+#if defined(CC_SECTION) || defined(__DOXYGEN__)
+CC_SECTION(CH_DBG_RECORDER_SECTION)
+#endif
+ch_recorder_t ch_recorder;
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static const rec_bank_t *rec_get_bank(rec_history_t h) {
+
+  return &ch_recorder.banks[(ch_recorder.active ^ (uint32_t)h) & 1U];
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Recorder initialization.
+ * @note    Internal use only.
+ *
+ * @notapi
+ */
+void __rec_object_init(void) {
+
+  if ((ch_recorder.magic == CH_REC_MAGIC) &&
+      (ch_recorder.size == (uint32_t)CH_DBG_RECORDER_SIZE) &&
+      (ch_recorder.active <= 1U)) {
+    /* Valid area, the history written before the reset is preserved.*/
+    ch_recorder.active ^= 1U;
+    ch_recorder.boots++;
+  }
+  else {
+    /* Invalid area, starting from scratch.*/
+    ch_recorder.magic   = CH_REC_MAGIC;
+    ch_recorder.size    = (uint32_t)CH_DBG_RECORDER_SIZE;
+    ch_recorder.active  = 0U;
+    ch_recorder.boots   = 0U;
+    ch_recorder.banks[1].index = 0U;
+  }
+  ch_recorder.banks[ch_recorder.active].index = 0U;
+}
+
+/**
+ * @brief   Writes an user event in the current history.
+ * @note    The event is not recorded if @p CH_DBG_TRACE_MASK_USER is not
+ *          part of @p CH_DBG_RECORDER_MASK.
+ *
+ * @param[in] code      user event code, from 0 to 31
+ * @param[in] value     user event value
+ *
+ * @iclass
+ */
+void chRecWriteI(uint32_t code, uint32_t value) {
+
+  chDbgCheckClassI();
+  chDbgCheck(code < 32U);
+
+#if (CH_DBG_RECORDER_MASK & CH_DBG_TRACE_MASK_USER) != 0
+  __rec_write(CH_TRACE_TYPE_USER, code, value);
+#else
+  (void)value;
+#endif
+}
+
+/**
+ * @brief   Writes an user event in the current history.
+ * @note    The event is not recorded if @p CH_DBG_TRACE_MASK_USER is not
+ *          part of @p CH_DBG_RECORDER_MASK.
+ *
+ * @param[in] code      user event code, from 0 to 31
+ * @param[in] value     user event value
+ *
+ * @api
+ */
+void chRecWrite(uint32_t code, uint32_t value) {
+
+  chSysLock();
+  chRecWriteI(code, value);
+  chSysUnlock();
+}
+
+/**
+ * @brief   Returns the number of events available in a history.
+ *
+ * @param[in] h         the history
+ * @return              The number of events, at most
+ *                      @p CH_DBG_RECORDER_SIZE.
+ *
+ * @iclass
+ */
+size_t chRecGetSizeI(rec_history_t h) {
+  uint32_t index;
+
+  chDbgCheckClassI();
+
+  index = rec_get_bank(h)->index;
+  if (index > (uint32_t)CH_DBG_RECORDER_SIZE) {
+    return (size_t)CH_DBG_RECORDER_SIZE;
+  }
+
+  return (size_t)index;
+}
+
+/**
+ * @brief   Reads an event from a history.
+ * @note    The current history keeps being written, the available events
+ *          shift between calls if new events are recorded.
+ *
+ * @param[in] h         the history
+ * @param[in] n         the event index, zero is the oldest available event
+ * @param[out] ep       pointer to the @p rec_event_t structure receiving
+ *                      the event
+ * @return              The operation status.
+ * @retval false        if the event has been read.
+ * @retval true         if the event is not available.
+ *
+ * @iclass
+ */
+bool chRecGetEventI(rec_history_t h, size_t n, rec_event_t *ep) {
+  const rec_bank_t *bp;
+  size_t size;
+
+  chDbgCheckClassI();
+  chDbgCheck(ep != NULL);
+
+  size = chRecGetSizeI(h);
+  if (n >= size) {
+    return true;
+  }
+
+  bp  = rec_get_bank(h);
+  *ep = bp->buffer[(bp->index - (uint32_t)size + (uint32_t)n) &
+                   ((uint32_t)CH_DBG_RECORDER_SIZE - 1U)];
+
+  return false;
+}
+
+#endif /* CH_DBG_RECORDER == TRUE */
+
+/** @} */
@@ -40,6 +40,14 @@
  *          terminating threads can pulse an event source and an event handler
  *          can perform a scansion of the registry in order to recover the
  *          memory.
+ *          <h2>Hash index</h2>
+ *          If @p CH_CFG_REGISTRY_HASH_SIZE is greater than zero then the
+ *          registry also keeps the threads hashed by name and by pointer,
+ *          lookups by name, pointer or handle only examine a single hash
+ *          chain instead of walking the registry.<br>
+ *          Threads handles carry the generation of the thread, a stale
+ *          handle is detected even if the thread memory has been reused
+ *          by a newer thread.
  * @pre     In order to use the threads registry the @p CH_CFG_USE_REGISTRY
  *          option must be enabled in @p chconf.h.
  * @{
@@ -67,6 +75,116 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Adds a reference to a thread returned by a lookup.
+ */
+#if CH_CFG_USE_DYNAMIC == TRUE
+#define reg_add_ref(tp) do {                                                \
+  chDbgAssert((tp)->refs < (trefs_t)255, "too many references");            \
+  (tp)->refs++;                                                             \
+} while (false)
+#else
+#define reg_add_ref(tp)
+#endif
+
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the name hash chain of a thread name.
+ * @note    Threads without name are all hashed in the first chain.
+ *
+ * @param[in] rp        pointer to the registry
+ * @param[in] name      the thread name or @p NULL
+ * @return              Pointer to the chain head.
+ */
+static thread_t **reg_name_chain(registry_t *rp, const char *name) {
+  uint32_t h = 2166136261U;
+
+  if (name == NULL) {
+    return &rp->names[0];
+  }
+
+  /* FNV-1a hash of the name.*/
+  while (*name != '\0') {
+    h = (h ^ (uint32_t)(uint8_t)*name) * 16777619U;
+    name++;
+  }
+
+  return &rp->names[h % (uint32_t)CH_CFG_REGISTRY_HASH_SIZE];
+}
+
+/**
+ * @brief   Returns the pointer hash chain of a thread pointer.
+ *
+ * @param[in] rp        pointer to the registry
+ * @param[in] tp        pointer to the thread
+ * @return              Pointer to the chain head.
+ */
+static thread_t **reg_pointer_chain(registry_t *rp, const thread_t *tp) {
+  uintptr_t h = (uintptr_t)tp / (uintptr_t)PORT_STACK_ALIGN;
+
+  return &rp->pointers[(h ^ (h >> 8)) % (uintptr_t)CH_CFG_REGISTRY_HASH_SIZE];
+}
+
+/**
+ * @brief   Unlinks a thread from its name hash chain.
+ *
+ * @param[in] rp        pointer to the registry
+ * @param[in] tp        pointer to the thread
+ * @return              The operation result.
+ * @retval false        if the thread was not in the chain.
+ * @retval true         if the thread has been unlinked.
+ */
+static bool reg_name_unlink(registry_t *rp, thread_t *tp) {
+  thread_t **tpp = reg_name_chain(rp, tp->name);
+
+  while (*tpp != NULL) {
+    if (*tpp == tp) {
+      *tpp = tp->hnname;
+      return true;
+    }
+    tpp = &(*tpp)->hnname;
+  }
+
+  return false;
+}
+
+/**
+ * @brief   Links a thread at the end of its name hash chain.
+ * @note    Appending keeps the registry order among threads with the same
+ *          name, the oldest thread is found first.
+ *
+ * @param[in] rp        pointer to the registry
+ * @param[in] tp        pointer to the thread
+ */
+static void reg_name_link(registry_t *rp, thread_t *tp) {
+  thread_t **tpp = reg_name_chain(rp, tp->name);
+
+  while (*tpp != NULL) {
+    tpp = &(*tpp)->hnname;
+  }
+  tp->hnname = NULL;
+  *tpp = tp;
+}
+
+/**
+ * @brief   Searches a thread in the pointer hash index.
+ *
+ * @param[in] rp        pointer to the registry
+ * @param[in] tp        pointer to the thread, it is not dereferenced
+ * @return              The thread pointer.
+ * @retval NULL         if the thread is not in the registry.
+ */
+static thread_t *reg_pointer_find(registry_t *rp, const thread_t *tp) {
+  thread_t *ctp = *reg_pointer_chain(rp, tp);
+
+  while ((ctp != NULL) && (ctp != tp)) {
+    ctp = ctp->hnptr;
+  }
+
+  return ctp;
+}
+#endif /* CH_CFG_REGISTRY_HASH_SIZE > 0 */
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -220,6 +338,8 @@ thread_t *chRegNextThread(thread_t *tp) {
  * @note    The reference counter of the found thread is increased by one so
  *          it cannot be disposed incidentally after the pointer has been
  *          returned.
+ * @note    If the registry hash index is enabled then only the threads with
+ *          the same name hash are examined.
  *
  * @param[in] name      the thread name
  * @return              A pointer to the found thread.
@@ -230,6 +350,22 @@ thread_t *chRegNextThread(thread_t *tp) {
 thread_t *chRegFindThreadByName(const char *name) {
   thread_t *ctp;
 
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  chDbgCheck(name != NULL);
+
+  chSysLock();
+  ctp = *reg_name_chain(REG_REGISTRY(currcore), name);
+  while (ctp != NULL) {
+    if ((ctp->name != NULL) && (strcmp(ctp->name, name) == 0)) {
+      reg_add_ref(ctp);
+      break;
+    }
+    ctp = ctp->hnname;
+  }
+  chSysUnlock();
+
+  return ctp;
+#else
   /* Scanning registry.*/
   ctp = chRegFirstThread();
   do {
@@ -240,6 +376,7 @@ thread_t *chRegFindThreadByName(const char *name) {
   } while (ctp != NULL);
 
   return NULL;
+#endif
 }
 
 /**
@@ -247,6 +384,8 @@ thread_t *chRegFindThreadByName(const char *name) {
  * @note    The reference counter of the found thread is increased by one so
  *          it cannot be disposed incidentally after the pointer has been
  *          returned.
+ * @note    If the registry hash index is enabled then the search takes
+ *          constant time on average.
  *
  * @param[in] tp        pointer to the thread
  * @return              A pointer to the found thread.
@@ -257,6 +396,16 @@ thread_t *chRegFindThreadByName(const char *name) {
 thread_t *chRegFindThreadByPointer(thread_t *tp) {
   thread_t *ctp;
 
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  chSysLock();
+  ctp = reg_pointer_find(REG_REGISTRY(currcore), tp);
+  if (ctp != NULL) {
+    reg_add_ref(ctp);
+  }
+  chSysUnlock();
+
+  return ctp;
+#else
   /* Scanning registry.*/
   ctp = chRegFirstThread();
   do {
@@ -267,6 +416,7 @@ thread_t *chRegFindThreadByPointer(thread_t *tp) {
   } while (ctp != NULL);
 
   return NULL;
+#endif
 }
 
 #if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE) ||  \
@@ -299,6 +449,109 @@ thread_t *chRegFindThreadByWorkingArea(stkalign_t *wa) {
 }
 #endif
 
+/**
+ * @brief   Retrieves the thread associated to a handle.
+ * @details The handle is stale if the thread has been removed from the
+ *          registry or if its memory has been reused by another thread,
+ *          the check does not walk the registry.
+ * @note    The reference counter of the found thread is increased by one so
+ *          it cannot be disposed incidentally after the pointer has been
+ *          returned.
+ * @note    If the registry hash index is disabled then the handle thread
+ *          structure is accessed directly, the memory of the threads must
+ *          not be reused for purposes other than threads.
+ *
+ * @param[in] thp       pointer to the thread handle
+ * @return              A pointer to the found thread.
+ * @retval NULL         if the handle is stale.
+ *
+ * @api
+ */
+thread_t *chRegFindThreadByHandle(const thread_handle_t *thp) {
+  thread_t *ctp;
+
+  chDbgCheck(thp != NULL);
+
+  chSysLock();
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  ctp = reg_pointer_find(REG_REGISTRY(currcore), thp->tp);
+#else
+  ctp = thp->tp;
+#endif
+  if ((ctp != NULL) && (ctp->gen == thp->gen)) {
+    reg_add_ref(ctp);
+  }
+  else {
+    ctp = NULL;
+  }
+  chSysUnlock();
+
+  return ctp;
+}
+
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Adds a thread to the registry hash index.
+ * @note    Not an API, use the @p REG_INSERT() macro.
+ *
+ * @param[in] rp        pointer to the registry
+ * @param[in] tp        pointer to the thread
+ *
+ * @notapi
+ */
+void __reg_hash_insert(registry_t *rp, thread_t *tp) {
+  thread_t **tpp = reg_pointer_chain(rp, tp);
+
+  tp->hnptr = *tpp;
+  *tpp = tp;
+  reg_name_link(rp, tp);
+}
+
+/**
+ * @brief   Removes a thread from the registry hash index.
+ * @note    Not an API, use the @p REG_REMOVE() macro.
+ *
+ * @param[in] rp        pointer to the registry
+ * @param[in] tp        pointer to the thread
+ *
+ * @notapi
+ */
+void __reg_hash_remove(registry_t *rp, thread_t *tp) {
+  thread_t **tpp = reg_pointer_chain(rp, tp);
+
+  while (*tpp != tp) {
+    tpp = &(*tpp)->hnptr;
+  }
+  *tpp = tp->hnptr;
+  (void) reg_name_unlink(rp, tp);
+}
+
+/**
+ * @brief   Changes the name of a thread.
+ * @details The thread is moved in the name hash chain of the new name if it
+ *          is in the registry.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] name      thread name as a zero terminated string
+ *
+ * @xclass
+ */
+void __reg_set_name(thread_t *tp, const char *name) {
+  registry_t *rp = REG_REGISTRY(tp->owner);
+  syssts_t sts;
+
+  sts = chSysGetStatusAndLockX();
+  if (reg_name_unlink(rp, tp)) {
+    tp->name = name;
+    reg_name_link(rp, tp);
+  }
+  else {
+    tp->name = name;
+  }
+  chSysRestoreStatusX(sts);
+}
+#endif /* CH_CFG_REGISTRY_HASH_SIZE > 0 */
+
 #endif /* CH_CFG_USE_REGISTRY == TRUE */
 
 /** @} */
@@ -0,0 +1,559 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/src/chrwlock.c
+ * @brief   Readers-Writer Locks code.
+ *
+ * @addtogroup rwlocks
+ * @details Readers-Writer Locks related APIs and services.
+ *          <h2>Operation mode</h2>
+ *          A readers-writer lock is a threads synchronization object that
+ *          can be in three distinct states:
+ *          - Not owned (unlocked).
+ *          - Owned by one or more readers.
+ *          - Owned by a single writer.
+ *          .
+ *          Threads waiting for the lock, both readers and writers, are
+ *          queued in a single list ordered by priority and, within the
+ *          same priority, in FIFO order.<br>
+ *          The lock has writer preference, a reader is not admitted while
+ *          a writer is owning or waiting for the lock. Reader starvation is
+ *          bounded because readers queued before a writer are admitted
+ *          before it, a continuous flow of writers cannot overtake readers
+ *          already waiting with equal or higher priority.
+ *
+ *          <h2>The priority inversion problem</h2>
+ *          A writer owning the lock inherits the priority of the threads
+ *          waiting for the lock, the inheritance is integrated with the
+ *          mutexes one and propagates through nested mutexes and locks.<br>
+ *          Readers do not inherit priority because the lock does not keep
+ *          track of the individual readers.
+ * @pre     In order to use the readers-writer locks APIs the
+ *          @p CH_CFG_USE_RWLOCKS option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_RWLOCKS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Makes a thread the writer owning the lock.
+ * @details The embedded mutex is inserted in the thread owned mutexes list.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @param[in] tp        pointer to the new owner thread
+ */
+static void rw_set_writer(rwlock_t *rwp, thread_t *tp) {
+
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+  rwp->mtx.cnt = (cnt_t)1;
+#endif
+  rwp->mtx.owner = tp;
+  rwp->mtx.next  = tp->mtxlist;
+  tp->mtxlist    = &rwp->mtx;
+}
+
+/**
+ * @brief   Admits the waiting threads that can own the lock.
+ * @details Readers are admitted from the head of the queue until a writer
+ *          is found, a writer is admitted only if the lock is free.
+ * @note    This function does not reschedule.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ */
+static void rw_wakeup(rwlock_t *rwp) {
+
+  while (ch_queue_notempty(&rwp->mtx.queue) && (rwp->mtx.owner == NULL)) {
+    thread_t *tp = threadref(rwp->mtx.queue.next);
+
+    if (tp->state == CH_STATE_WTRWWR) {
+      if (rwp->readers == (cnt_t)0) {
+        (void) ch_queue_fifo_remove(&rwp->mtx.queue);
+        rw_set_writer(rwp, tp);
+        tp->u.rdymsg = MSG_OK;
+        (void) chSchReadyI(tp);
+      }
+
+      /* Readers queued after a writer keep waiting.*/
+      return;
+    }
+
+    (void) ch_queue_fifo_remove(&rwp->mtx.queue);
+    rwp->readers++;
+    tp->u.rdymsg = MSG_OK;
+    (void) chSchReadyI(tp);
+  }
+}
+
+/**
+ * @brief   Recalculates the priority of a lock owner.
+ * @details The owner priority is lowered to the highest priority among its
+ *          base priority and the threads waiting on its owned mutexes and
+ *          locks, this undoes a boost made by a waiter that gave up.
+ * @note    This function does not reschedule.
+ *
+ * @param[in] tp        pointer to the owner thread
+ */
+static void rw_prio_restore(thread_t *tp) {
+  tprio_t newprio = __mtx_base_prio(tp);
+  mutex_t *lmp = tp->mtxlist;
+
+  while (lmp != NULL) {
+    if (ch_queue_notempty(&lmp->queue) &&
+        ((threadref(lmp->queue.next))->hdr.pqueue.prio > newprio)) {
+      newprio = (threadref(lmp->queue.next))->hdr.pqueue.prio;
+    }
+    lmp = lmp->next;
+  }
+
+  if (newprio < tp->hdr.pqueue.prio) {
+    tp->hdr.pqueue.prio = newprio;
+    if (tp->state == CH_STATE_READY) {
+#if CH_DBG_ENABLE_ASSERTS == TRUE
+      /* Prevents an assertion in chSchReadyI().*/
+      tp->state = CH_STATE_CURRENT;
+#endif
+      /* Re-enqueues tp with its new priority on the ready list.*/
+      (void) chSchReadyI(threadref(ch_queue_dequeue(&tp->hdr.queue)));
+    }
+  }
+}
+
+/**
+ * @brief   Enqueues the current thread on the lock.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @param[in] newstate  the waiting state, @p CH_STATE_WTRWRD or
+ *                      @p CH_STATE_WTRWWR
+ * @param[in] timeout   the number of ticks before the operation timeouts
+ * @return              The wakeup message.
+ */
+static msg_t rw_wait(rwlock_t *rwp, tstate_t newstate, sysinterval_t timeout) {
+  thread_t *currtp = chThdGetSelfX();
+  msg_t msg;
+
+  /* Priority inheritance, a writer owning the lock inherits the priority
+     of the waiting thread.*/
+  if (rwp->mtx.owner != NULL) {
+    __mtx_prio_boost(rwp->mtx.owner, currtp->hdr.pqueue.prio);
+  }
+
+  ch_sch_prio_insert(&rwp->mtx.queue, &currtp->hdr.queue);
+  currtp->u.wtrwlp = rwp;
+
+  msg = chSchGoSleepTimeoutS(newstate, timeout);
+  if ((msg != MSG_OK) && (rwp->mtx.owner != NULL)) {
+    /* The thread gave up, the boost it gave to the writer must be undone.*/
+    rw_prio_restore(rwp->mtx.owner);
+  }
+
+  return msg;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Releases a lock owned for writing.
+ * @details The lock is marked as not owned and the waiting threads that can
+ *          own it are admitted.
+ * @pre     The lock must have already been removed from the owner thread
+ *          mutexes list.
+ * @note    This function does not reschedule.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ *
+ * @notapi
+ */
+void __rwlock_release(rwlock_t *rwp) {
+
+  rwp->mtx.owner = NULL;
+#if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
+  rwp->mtx.cnt = (cnt_t)0;
+#endif
+  rw_wakeup(rwp);
+}
+
+/**
+ * @brief   Initializes s @p rwlock_t structure.
+ *
+ * @param[out] rwp      pointer to a @p rwlock_t structure
+ *
+ * @init
+ */
+void chRWLockObjectInit(rwlock_t *rwp) {
+
+  chDbgCheck(rwp != NULL);
+
+  chMtxObjectInit(&rwp->mtx);
+  rwp->readers = (cnt_t)0;
+}
+
+/**
+ * @brief   Locks the specified readers-writer lock for reading.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the lock has been acquired.
+ * @retval MSG_TIMEOUT  if the lock has not been acquired within the
+ *                      specified timeout.
+ *
+ * @sclass
+ */
+msg_t chRWLockReadLockTimeoutS(rwlock_t *rwp, sysinterval_t timeout) {
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL);
+
+  if (chRWLockTryReadLockS(rwp)) {
+    return MSG_OK;
+  }
+
+  if (TIME_IMMEDIATE == timeout) {
+    return MSG_TIMEOUT;
+  }
+
+  return rw_wait(rwp, CH_STATE_WTRWRD, timeout);
+}
+
+/**
+ * @brief   Locks the specified readers-writer lock for reading.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the lock has been acquired.
+ * @retval MSG_TIMEOUT  if the lock has not been acquired within the
+ *                      specified timeout.
+ *
+ * @api
+ */
+msg_t chRWLockReadLockTimeout(rwlock_t *rwp, sysinterval_t timeout) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chRWLockReadLockTimeoutS(rwp, timeout);
+  chSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Tries to lock the specified readers-writer lock for reading.
+ * @details The lock is acquired only if it is not owned by a writer and
+ *          there are no threads waiting for it.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @return              The operation status.
+ * @retval true         if the lock has been successfully acquired
+ * @retval false        if the lock attempt failed.
+ *
+ * @sclass
+ */
+bool chRWLockTryReadLockS(rwlock_t *rwp) {
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL);
+
+  /* Writer preference, readers are not admitted if there are waiting
+     writers.*/
+  if ((rwp->mtx.owner != NULL) || ch_queue_notempty(&rwp->mtx.queue)) {
+    return false;
+  }
+
+  rwp->readers++;
+
+  return true;
+}
+
+/**
+ * @brief   Tries to lock the specified readers-writer lock for reading.
+ * @details The lock is acquired only if it is not owned by a writer and
+ *          there are no threads waiting for it.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @return              The operation status.
+ * @retval true         if the lock has been successfully acquired
+ * @retval false        if the lock attempt failed.
+ *
+ * @api
+ */
+bool chRWLockTryReadLock(rwlock_t *rwp) {
+  bool b;
+
+  chSysLock();
+  b = chRWLockTryReadLockS(rwp);
+  chSysUnlock();
+
+  return b;
+}
+
+/**
+ * @brief   Unlocks the specified readers-writer lock owned for reading.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ *
+ * @sclass
+ */
+void chRWLockReadUnlockS(rwlock_t *rwp) {
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL);
+  chDbgAssert(rwp->readers > (cnt_t)0, "not locked for reading");
+
+  /* The last reader leaving makes the lock available to writers.*/
+  if (--rwp->readers == (cnt_t)0) {
+    rw_wakeup(rwp);
+  }
+}
+
+/**
+ * @brief   Unlocks the specified readers-writer lock owned for reading.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ *
+ * @api
+ */
+void chRWLockReadUnlock(rwlock_t *rwp) {
+
+  chSysLock();
+  chRWLockReadUnlockS(rwp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Locks the specified readers-writer lock for writing.
+ * @post    The lock is inserted in the per-thread stack of owned mutexes,
+ *          it must be unlocked in lock-reverse order with respect to the
+ *          other owned mutexes and locks.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the lock has been acquired.
+ * @retval MSG_TIMEOUT  if the lock has not been acquired within the
+ *                      specified timeout.
+ *
+ * @sclass
+ */
+msg_t chRWLockWriteLockTimeoutS(rwlock_t *rwp, sysinterval_t timeout) {
+  msg_t msg;
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL);
+  chDbgAssert(rwp->mtx.owner != chThdGetSelfX(), "already owned");
+
+  if (chRWLockTryWriteLockS(rwp)) {
+    return MSG_OK;
+  }
+
+  if (TIME_IMMEDIATE == timeout) {
+    return MSG_TIMEOUT;
+  }
+
+  msg = rw_wait(rwp, CH_STATE_WTRWWR, timeout);
+  if (msg != MSG_OK) {
+    /* Readers queued after this writer could be admissible now.*/
+    rw_wakeup(rwp);
+  }
+
+  return msg;
+}
+
+/**
+ * @brief   Locks the specified readers-writer lock for writing.
+ * @post    The lock is inserted in the per-thread stack of owned mutexes,
+ *          it must be unlocked in lock-reverse order with respect to the
+ *          other owned mutexes and locks.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the lock has been acquired.
+ * @retval MSG_TIMEOUT  if the lock has not been acquired within the
+ *                      specified timeout.
+ *
+ * @api
+ */
+msg_t chRWLockWriteLockTimeout(rwlock_t *rwp, sysinterval_t timeout) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chRWLockWriteLockTimeoutS(rwp, timeout);
+  chSchRescheduleS();
+  chSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Tries to lock the specified readers-writer lock for writing.
+ * @details The lock is acquired only if it is not owned.
+ * @post    The lock is inserted in the per-thread stack of owned mutexes.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @return              The operation status.
+ * @retval true         if the lock has been successfully acquired
+ * @retval false        if the lock attempt failed.
+ *
+ * @sclass
+ */
+bool chRWLockTryWriteLockS(rwlock_t *rwp) {
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL);
+
+  if ((rwp->mtx.owner != NULL) || (rwp->readers > (cnt_t)0)) {
+    return false;
+  }
+
+  chDbgAssert(ch_queue_isempty(&rwp->mtx.queue), "queue not empty");
+
+  rw_set_writer(rwp, chThdGetSelfX());
+
+  return true;
+}
+
+/**
+ * @brief   Tries to lock the specified readers-writer lock for writing.
+ * @details The lock is acquired only if it is not owned.
+ * @post    The lock is inserted in the per-thread stack of owned mutexes.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ * @return              The operation status.
+ * @retval true         if the lock has been successfully acquired
+ * @retval false        if the lock attempt failed.
+ *
+ * @api
+ */
+bool chRWLockTryWriteLock(rwlock_t *rwp) {
+  bool b;
+
+  chSysLock();
+  b = chRWLockTryWriteLockS(rwp);
+  chSysUnlock();
+
+  return b;
+}
+
+/**
+ * @brief   Unlocks the specified readers-writer lock owned for writing.
+ * @details The priority inherited through the lock is released, then the
+ *          waiting threads that can own the lock are resumed.
+ * @pre     The lock must be the last mutex or lock acquired by the invoking
+ *          thread.
+ * @post    This function does not reschedule so a call to a rescheduling
+ *          function must be performed before unlocking the kernel.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ *
+ * @sclass
+ */
+void chRWLockWriteUnlockS(rwlock_t *rwp) {
+  thread_t *currtp = chThdGetSelfX();
+  tprio_t newprio;
+  mutex_t *lmp;
+
+  chDbgCheckClassS();
+  chDbgCheck(rwp != NULL);
+  chDbgAssert(rwp->mtx.owner == currtp, "not owner");
+  chDbgAssert(currtp->mtxlist == &rwp->mtx, "not next in list");
+
+  /* Removes the lock from the thread's owned mutexes list.*/
+  currtp->mtxlist = rwp->mtx.next;
+
+  /* Recalculates the optimal thread priority by scanning the owned
+     mutexes list.*/
+  newprio = __mtx_base_prio(currtp);
+  lmp = currtp->mtxlist;
+  while (lmp != NULL) {
+    if (chMtxQueueNotEmptyS(lmp) &&
+        ((threadref(lmp->queue.next))->hdr.pqueue.prio > newprio)) {
+      newprio = (threadref(lmp->queue.next))->hdr.pqueue.prio;
+    }
+    lmp = lmp->next;
+  }
+  currtp->hdr.pqueue.prio = newprio;
+
+  __rwlock_release(rwp);
+}
+
+/**
+ * @brief   Unlocks the specified readers-writer lock owned for writing.
+ * @details The priority inherited through the lock is released, then the
+ *          waiting threads that can own the lock are resumed.
+ * @pre     The lock must be the last mutex or lock acquired by the invoking
+ *          thread.
+ *
+ * @param[in] rwp       pointer to the @p rwlock_t structure
+ *
+ * @api
+ */
+void chRWLockWriteUnlock(rwlock_t *rwp) {
+
+  chSysLock();
+  chRWLockWriteUnlockS(rwp);
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+#endif /* CH_CFG_USE_RWLOCKS == TRUE */
+
+/** @} */
@@ -32,6 +32,28 @@
 /* Module local definitions.                                                 */
 /*===========================================================================*/
 
+/**
+ * @brief   Returns the first thread in the ready list.
+ * @note    If the ready list is empty then the list header is returned, only
+ *          its priority field can be accessed.
+ */
+#define __sch_first(oip) threadref((oip)->rlist.pqueue.next)
+
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Determines if a thread must run before another thread.
+ * @details Threads are compared by priority then, within the same priority,
+ *          by EDF order.
+ */
+#define __sch_precedes(atp, btp)                                            \
+  (((atp)->hdr.pqueue.prio > (btp)->hdr.pqueue.prio) ||                     \
+   (((atp)->hdr.pqueue.prio == (btp)->hdr.pqueue.prio) &&                   \
+    __edf_precedes(atp, btp)))
+#else
+#define __sch_precedes(atp, btp)                                            \
+  ((atp)->hdr.pqueue.prio > (btp)->hdr.pqueue.prio)
+#endif
+
 /*===========================================================================*/
 /* Module exported variables.                                                */
 /*===========================================================================*/
@@ -48,6 +70,62 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Inserts a thread in the ready list behind its peers.
+ * @details The thread is positioned behind all threads with higher priority
+ *          and behind the threads of the same priority it does not precede
+ *          in EDF order.
+ *
+ * @param[in] pqp       pointer to the ready list header
+ * @param[in] tp        the thread to be inserted
+ * @return              The thread pointer.
+ */
+static thread_t *__sch_edf_insert_behind(ch_priority_queue_t *pqp,
+                                         thread_t *tp) {
+  ch_priority_queue_t *p = &tp->hdr.pqueue;
+
+  do {
+    pqp = pqp->next;
+  } while ((pqp->prio > p->prio) ||
+           ((pqp->prio == p->prio) && !__edf_precedes(tp, threadref(pqp))));
+
+  p->next       = pqp;
+  p->prev       = pqp->prev;
+  p->prev->next = p;
+  pqp->prev     = p;
+
+  return tp;
+}
+
+/**
+ * @brief   Inserts a thread in the ready list ahead of its peers.
+ * @details The thread is positioned behind all threads with higher priority
+ *          and behind the threads of the same priority preceding it in EDF
+ *          order.
+ *
+ * @param[in] pqp       pointer to the ready list header
+ * @param[in] tp        the thread to be inserted
+ * @return              The thread pointer.
+ */
+static thread_t *__sch_edf_insert_ahead(ch_priority_queue_t *pqp,
+                                        thread_t *tp) {
+  ch_priority_queue_t *p = &tp->hdr.pqueue;
+
+  do {
+    pqp = pqp->next;
+  } while ((pqp->prio > p->prio) ||
+           ((pqp->prio == p->prio) && __edf_precedes(threadref(pqp), tp)));
+
+  p->next       = pqp;
+  p->prev       = pqp->prev;
+  p->prev->next = p;
+  pqp->prev     = p;
+
+  return tp;
+}
+#endif /* CH_CFG_USE_EDF == TRUE */
+
 /**
  * @brief   Inserts a thread in the Ready List placing it behind its peers.
  * @details The thread is positioned behind all threads with higher or equal
@@ -72,13 +150,18 @@ static thread_t *__sch_ready_behind(thread_t *tp) {
 
   /* Tracing the event.*/
   __trace_ready(tp, tp->u.rdymsg);
+  __rec_ready(tp);
 
   /* The thread is marked ready.*/
   tp->state = CH_STATE_READY;
 
   /* Insertion in the priority queue.*/
+#if CH_CFG_USE_EDF == TRUE
+  return __sch_edf_insert_behind(&tp->owner->rlist.pqueue, tp);
+#else
   return threadref(ch_pqueue_insert_behind(&tp->owner->rlist.pqueue,
                                            &tp->hdr.pqueue));
+#endif
 }
 
 /**
@@ -105,13 +188,18 @@ static thread_t *__sch_ready_ahead(thread_t *tp) {
 
   /* Tracing the event.*/
   __trace_ready(tp, tp->u.rdymsg);
+  __rec_ready(tp);
 
   /* The thread is marked ready.*/
   tp->state = CH_STATE_READY;
 
   /* Insertion in the priority queue.*/
+#if CH_CFG_USE_EDF == TRUE
+  return __sch_edf_insert_ahead(&tp->owner->rlist.pqueue, tp);
+#else
   return threadref(ch_pqueue_insert_ahead(&tp->owner->rlist.pqueue,
                                           &tp->hdr.pqueue));
+#endif
 }
 
 /**
@@ -141,7 +229,7 @@ static void __sch_reschedule_behind(void) {
 
 #if CH_CFG_TIME_QUANTUM > 0
   /* It went behind peers so it gets a new time quantum.*/
-  otp->ticks = (tslices_t)CH_CFG_TIME_QUANTUM;
+  otp->ticks = otp->quantum;
 #endif
 
   /* Placing in ready list behind peers.*/
@@ -213,6 +301,12 @@ static void __sch_wakeup(virtual_timer_t *vtp, void *p) {
 #endif
 #if (CH_CFG_USE_CONDVARS == TRUE) && (CH_CFG_USE_CONDVARS_TIMEOUT == TRUE)
   case CH_STATE_WTCOND:
+    /* Falls through.*/
+#endif
+#if CH_CFG_USE_RWLOCKS == TRUE
+  case CH_STATE_WTRWRD:
+    /* Falls through.*/
+  case CH_STATE_WTRWWR:
 #endif
     /* States requiring dequeuing.*/
     (void) ch_queue_dequeue(&tp->hdr.queue);
@@ -318,7 +412,7 @@ void chSchGoSleepS(tstate_t newstate) {
 #if CH_CFG_TIME_QUANTUM > 0
   /* The thread is renouncing its remaining time slices so it will have a new
      time quantum when it will wakeup.*/
-  otp->ticks = (tslices_t)CH_CFG_TIME_QUANTUM;
+  otp->ticks = otp->quantum;
 #endif
 
   /* Next thread in ready list becomes current.*/
@@ -424,7 +518,7 @@ void chSchWakeupS(thread_t *ntp, msg_t msg) {
      list instead.
      Note, we are favoring the path where the woken thread has higher
      priority.*/
-  if (unlikely(ntp->hdr.pqueue.prio <= otp->hdr.pqueue.prio)) {
+  if (unlikely(!__sch_precedes(ntp, otp))) {
     (void) __sch_ready_behind(ntp);
   }
   else {
@@ -463,7 +557,7 @@ void chSchRescheduleS(void) {
 
   /* Note, we are favoring the path where the reschedule is necessary
      because higher priority threads are ready.*/
-  if (likely(firstprio(&oip->rlist.pqueue) > tp->hdr.pqueue.prio)) {
+  if (likely(__sch_precedes(__sch_first(oip), tp))) {
     __sch_reschedule_ahead();
   }
 }
@@ -485,20 +579,19 @@ void chSchRescheduleS(void) {
 bool chSchIsPreemptionRequired(void) {
   os_instance_t *oip = currcore;
   thread_t *tp = __instance_get_currthread(oip);
-
-  tprio_t p1 = firstprio(&oip->rlist.pqueue);
-  tprio_t p2 = tp->hdr.pqueue.prio;
+  thread_t *ftp = __sch_first(oip);
 
 #if CH_CFG_TIME_QUANTUM > 0
   /* If the running thread has not reached its time quantum, reschedule only
      if the first thread on the ready queue has a higher priority.
      Otherwise, if the running thread has used up its time quantum, reschedule
      if the first thread on the ready queue has equal or higher priority.*/
-  return (tp->ticks > (tslices_t)0) ? (p1 > p2) : (p1 >= p2);
+  return (tp->ticks > (tslices_t)0) ? __sch_precedes(ftp, tp) :
+                                      !__sch_precedes(tp, ftp);
 #else
   /* If the round robin preemption feature is not enabled then performs a
      simpler comparison.*/
-  return p1 > p2;
+  return __sch_precedes(ftp, tp);
 #endif
 }
 #endif /* !defined(CH_SCH_IS_PREEMPTION_REQUIRED_HOOKED) */
@@ -537,9 +630,10 @@ void chSchDoPreemption(void) {
     /* The thread consumed its time quantum so it is enqueued behind threads
        with same priority level, however, it acquires a new time quantum.*/
     otp = __sch_ready_behind(otp);
+    __stats_rrswc(otp);
 
     /* The thread being swapped out receives a new time quantum.*/
-    otp->ticks = (tslices_t)CH_CFG_TIME_QUANTUM;
+    otp->ticks = otp->quantum;
   }
   else {
     /* The thread didn't consume all its time quantum so it is put ahead of
@@ -568,24 +662,24 @@ void chSchDoPreemption(void) {
 void chSchPreemption(void) {
   os_instance_t *oip = currcore;
   thread_t *tp = __instance_get_currthread(oip);
-  tprio_t p1 = firstprio(&oip->rlist.pqueue);
-  tprio_t p2 = tp->hdr.pqueue.prio;
+  thread_t *ftp = __sch_first(oip);
 
   /* Note, we are favoring the path where preemption is necessary
      because higher priority threads are ready.*/
 #if CH_CFG_TIME_QUANTUM > 0
   if (tp->ticks > (tslices_t)0) {
-    if (likely(p1 > p2)) {
+    if (likely(__sch_precedes(ftp, tp))) {
       __sch_reschedule_ahead();
     }
   }
   else {
-    if (likely(p1 >= p2)) {
+    if (likely(!__sch_precedes(tp, ftp))) {
+      __stats_rrswc(tp);
       __sch_reschedule_behind();
     }
   }
 #else /* CH_CFG_TIME_QUANTUM == 0 */
-  if (likely(p1 > p2)) {
+  if (likely(__sch_precedes(ftp, tp))) {
     __sch_reschedule_ahead();
   }
 #endif /* CH_CFG_TIME_QUANTUM == 0 */
@@ -607,7 +701,7 @@ void chSchDoYieldS(void) {
 
   /* If this function has been called then it is likely there are threads
      at same priority level.*/
-  if (likely(firstprio(&oip->rlist.pqueue) >= tp->hdr.pqueue.prio)) {
+  if (likely(!__sch_precedes(tp, __sch_first(oip)))) {
     __sch_reschedule_behind();
   }
 }
@@ -76,6 +76,17 @@ void __stats_ctxswc(thread_t *ntp, thread_t *otp) {
   chTMChainMeasurementToX(&otp->stats, &ntp->stats);
 }
 
+/**
+ * @brief   Updates round robin related statistics.
+ *
+ * @param[in] tp        the thread put behind its peers
+ */
+void __stats_rrswc(thread_t *tp) {
+
+  currcore->kernel_stats.n_rrswc++;
+  tp->rrswc++;
+}
+
 /**
  * @brief   Starts the measurement of a thread critical zone.
  */
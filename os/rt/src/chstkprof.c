@@ -0,0 +1,265 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/src/chstkprof.c
+ * @brief   Stack profiler code.
+ *
+ * @addtogroup stack_profiler
+ * @details Runtime measurement of the threads peak stack usage.
+ *          <h2>Operation mode</h2>
+ *          Thread stacks are filled with @p CH_DBG_STACK_FILL_VALUE when
+ *          threads are created, the profiler finds the lowest stack byte
+ *          no longer holding the fill value, the part of the stack below
+ *          it has never been used.<br>
+ *          The scan is incremental, each sample checks at most
+ *          @p CH_DBG_STACK_PROFILER_STEP bytes of a single thread stack
+ *          inside a critical zone and resumes from there on the next
+ *          sample. A scan pass ends on the lowest used byte found so far,
+ *          the peak usage can only grow so the following passes only need
+ *          to check the still unused part of the stack.<br>
+ *          Calling @p chStkProfSample() periodically from a low priority
+ *          thread keeps the results of all the threads in the registry up
+ *          to date with a bounded impact on the system latency.
+ *
+ *          <h2>Headroom warning</h2>
+ *          When a pass finds that the never used part of a stack is smaller
+ *          than the configured margin then the profiler event source is
+ *          broadcasted, this happens once for each thread.
+ * @note    Threads created without filling their stack, for example using
+ *          @p chThdCreateI(), are reported as using their whole stack. The
+ *          main thread is only profiled if its stack limits are known and
+ *          its stack has been filled by the startup code.
+ * @pre     In order to use the stack profiler the @p CH_DBG_STACK_PROFILER
+ *          option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_DBG_STACK_PROFILER == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Stack profiler state.
+ */
+static struct {
+  /**
+   * @brief   Handle of the thread being sampled by @p chStkProfSample().
+   */
+  thread_handle_t               th;
+  /**
+   * @brief   Headroom warning margin.
+   */
+  size_t                        margin;
+#if (CH_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Headroom warning event source.
+   */
+  event_source_t                es;
+#endif
+} stkprof = {
+  .th       = {NULL, (ucnt_t)0},
+  .margin   = (size_t)CH_DBG_STACK_PROFILER_MARGIN,
+#if CH_CFG_USE_EVENTS == TRUE
+  .es       = __EVENTSOURCE_DATA(stkprof.es)
+#endif
+};
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Performs a profiler sample on a thread.
+ * @details At most @p CH_DBG_STACK_PROFILER_STEP stack bytes are checked,
+ *          the scan resumes from there on the next call.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The scan pass state.
+ * @retval false        if the scan pass is still in progress.
+ * @retval true         if the scan pass completed, the peak usage of the
+ *                      thread is up to date.
+ *
+ * @api
+ */
+bool chStkProfSampleThread(thread_t *tp) {
+  uint8_t *p;
+  size_t n;
+  bool done;
+
+  chDbgCheck(tp != NULL);
+
+  chSysLock();
+
+  /* Threads with unknown stack limits are skipped.*/
+  if (tp->wabase == NULL) {
+    chSysUnlock();
+    return true;
+  }
+
+  /* First sample of this thread, no used bytes known yet.*/
+  if (tp->stkprof.mark == NULL) {
+    tp->stkprof.mark = chStkProfGetStackEndX(tp);
+    tp->stkprof.scan = (uint8_t *)tp->wabase;
+  }
+
+  /* Bounded scan toward the lowest used byte found so far.*/
+  p = tp->stkprof.scan;
+  n = (size_t)(tp->stkprof.mark - p);
+  if (n > (size_t)CH_DBG_STACK_PROFILER_STEP) {
+    n = (size_t)CH_DBG_STACK_PROFILER_STEP;
+  }
+  while ((n > (size_t)0) && (*p == (uint8_t)CH_DBG_STACK_FILL_VALUE)) {
+    p++;
+    n--;
+  }
+
+  if (n > (size_t)0) {
+    /* A deeper used byte has been found.*/
+    tp->stkprof.mark = p;
+    done = true;
+  }
+  else {
+    done = (bool)(p >= tp->stkprof.mark);
+  }
+
+  if (done) {
+    /* Next pass restarts from the stack base.*/
+    tp->stkprof.scan = (uint8_t *)tp->wabase;
+
+    /* Headroom check.*/
+    if (!tp->stkprof.warned &&
+        ((size_t)(tp->stkprof.mark - (uint8_t *)tp->wabase) <
+         stkprof.margin)) {
+      tp->stkprof.warned = true;
+#if CH_CFG_USE_EVENTS == TRUE
+      chEvtBroadcastFlagsI(&stkprof.es, (eventflags_t)0);
+      chSchRescheduleS();
+#endif
+    }
+  }
+  else {
+    tp->stkprof.scan = p;
+  }
+
+  chSysUnlock();
+
+  return done;
+}
+
+/**
+ * @brief   Performs a profiler sample.
+ * @details The threads in the registry are sampled in turn, each call
+ *          performs a single bounded sample.
+ * @note    The profiler keeps a handle of the thread being sampled, not a
+ *          reference, so threads terminate and are released normally. If
+ *          the thread is removed from the registry then the profiler
+ *          restarts from the first thread.
+ * @note    This function must be called from a single thread, not from
+ *          the idle thread because it can release dynamic threads.
+ *
+ * @api
+ */
+void chStkProfSample(void) {
+  thread_t *tp;
+
+  tp = chRegFindThreadByHandle(&stkprof.th);
+  if (tp == NULL) {
+    tp = chRegFirstThread();
+  }
+
+  if (chStkProfSampleThread(tp)) {
+    tp = chRegNextThread(tp);
+    if (tp == NULL) {
+      stkprof.th.tp = NULL;
+      return;
+    }
+  }
+
+  stkprof.th = chRegGetHandleX(tp);
+#if CH_CFG_USE_DYNAMIC == TRUE
+  chThdRelease(tp);
+#endif
+}
+
+/**
+ * @brief   Updates the peak stack usage of a thread.
+ * @details The current scan pass of the thread is completed, each step of
+ *          the scan is performed in a separate critical zone.
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @api
+ */
+void chStkProfUpdate(thread_t *tp) {
+
+  while (!chStkProfSampleThread(tp)) {
+  }
+}
+
+/**
+ * @brief   Changes the headroom warning margin.
+ * @note    Threads already signaled are not signaled again.
+ *
+ * @param[in] margin    the new margin in bytes
+ *
+ * @api
+ */
+void chStkProfSetMargin(size_t margin) {
+
+  chSysLock();
+  stkprof.margin = margin;
+  chSysUnlock();
+}
+
+#if (CH_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the headroom warning event source.
+ * @details The event source is broadcasted when a thread is found having
+ *          a stack headroom smaller than the margin.
+ *
+ * @return              Pointer to the event source.
+ *
+ * @xclass
+ */
+event_source_t *chStkProfGetEventSourceX(void) {
+
+  return &stkprof.es;
+}
+#endif
+
+#endif /* CH_DBG_STACK_PROFILER == TRUE */
+
+/** @} */
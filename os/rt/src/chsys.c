@@ -57,6 +57,14 @@ static CH_SYS_CORE0_MEMORY THD_WORKING_AREA(ch_c0_idle_thread_wa,
                                             PORT_IDLE_THREAD_STACK_SIZE);
 #endif
 
+#if (CH_CFG_USE_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Working area for core 0 timers thread.
+ */
+static CH_SYS_CORE0_MEMORY THD_WORKING_AREA(ch_c0_timer_thread_wa,
+                                            CH_CFG_VT_THREAD_STACK_SIZE);
+#endif
+
 #if CH_DBG_ENABLE_STACK_CHECK == TRUE
 extern stkalign_t __main_thread_stack_base__, __main_thread_stack_end__;
 #endif
@@ -69,13 +77,17 @@ const os_instance_config_t ch_core0_cfg = {
 #if CH_DBG_ENABLE_STACK_CHECK == TRUE
   .mainthread_base  = &__main_thread_stack_base__,
   .mainthread_end   = &__main_thread_stack_end__,
-#elif CH_CFG_USE_DYNAMIC == TRUE
+#elif (CH_CFG_USE_DYNAMIC == TRUE) || (CH_DBG_STACK_PROFILER == TRUE)
   .mainthread_base  = NULL,
   .mainthread_end   = NULL,
 #endif
 #if CH_CFG_NO_IDLE_THREAD == FALSE
   .idlethread_base  = THD_WORKING_AREA_BASE(ch_c0_idle_thread_wa),
-  .idlethread_end   = THD_WORKING_AREA_END(ch_c0_idle_thread_wa)
+  .idlethread_end   = THD_WORKING_AREA_END(ch_c0_idle_thread_wa),
+#endif
+#if CH_CFG_USE_VT_DEFERRED == TRUE
+  .timerthread_base = THD_WORKING_AREA_BASE(ch_c0_timer_thread_wa),
+  .timerthread_end  = THD_WORKING_AREA_END(ch_c0_timer_thread_wa)
 #endif
 };
 
@@ -93,6 +105,14 @@ static CH_SYS_CORE1_MEMORY THD_WORKING_AREA(ch_c1_idle_thread_wa,
                                             PORT_IDLE_THREAD_STACK_SIZE);
 #endif
 
+#if (CH_CFG_USE_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Working area for core 1 timers thread.
+ */
+static CH_SYS_CORE1_MEMORY THD_WORKING_AREA(ch_c1_timer_thread_wa,
+                                            CH_CFG_VT_THREAD_STACK_SIZE);
+#endif
+
 #if CH_DBG_ENABLE_STACK_CHECK == TRUE
 extern stkalign_t __c1_main_thread_stack_base__, __c1_main_thread_stack_end__;
 #endif
@@ -105,13 +125,17 @@ const os_instance_config_t ch_core1_cfg = {
 #if CH_DBG_ENABLE_STACK_CHECK == TRUE
   .mainthread_base  = &__c1_main_thread_stack_base__,
   .mainthread_end   = &__c1_main_thread_stack_end__,
-#elif CH_CFG_USE_DYNAMIC == TRUE
+#elif (CH_CFG_USE_DYNAMIC == TRUE) || (CH_DBG_STACK_PROFILER == TRUE)
   .mainthread_base  = NULL,
   .mainthread_end   = NULL,
 #endif
 #if CH_CFG_NO_IDLE_THREAD == FALSE
   .idlethread_base  = THD_WORKING_AREA_BASE(ch_c1_idle_thread_wa),
-  .idlethread_end   = THD_WORKING_AREA_END(ch_c1_idle_thread_wa)
+  .idlethread_end   = THD_WORKING_AREA_END(ch_c1_idle_thread_wa),
+#endif
+#if CH_CFG_USE_VT_DEFERRED == TRUE
+  .timerthread_base = THD_WORKING_AREA_BASE(ch_c1_timer_thread_wa),
+  .timerthread_end  = THD_WORKING_AREA_END(ch_c1_timer_thread_wa)
 #endif
 };
 #endif /* PORT_CORES_NUMBER > 1 */
@@ -165,6 +189,12 @@ void chSysInit(void) {
     ch_system.instances[i] = NULL;
   }
 
+#if CH_DBG_RECORDER == TRUE
+  /* Flight recorder initialization, the history written before the reset
+     is preserved.*/
+  __rec_object_init();
+#endif
+
 #if CH_CFG_USE_TM == TRUE
   /* Time Measurement calibration.*/
   __tm_calibration_object_init(&ch_system.tmc);
@@ -212,6 +242,7 @@ void chSysHalt(const char *reason) {
 
   /* Logging the event.*/
   __trace_halt(reason);
+  __rec_halt(reason);
 
   /* Pointing to the passed message.*/
   currcore->dbg.panic_msg = reason;
@@ -75,39 +75,73 @@
 /*===========================================================================*/
 
 /**
- * @brief   Initializes a thread structure.
- * @note    This is an internal functions, do not use it in application code.
+ * @brief   Resets the run state of a thread structure.
+ * @details Initializes the priority and the fields a thread must have
+ *          cleared when it starts running a function, this is done when a
+ *          thread is initialized and when a parked pooled thread is
+ *          restarted.
+ * @note    This is an internal function, do not use it in application code.
  *
- * @param[in] oip       pointer to the OS instance
  * @param[in] tp        pointer to the thread
- * @param[in] name      thread name
- * @param[in] prio      the priority level for the new thread
- * @return              The same thread pointer passed as parameter.
+ * @param[in] prio      the priority level for the thread
  *
  * @notapi
  */
-thread_t *__thd_object_init(os_instance_t *oip,
-                            thread_t *tp,
-                            const char *name,
-                            tprio_t prio) {
+void __thd_object_reset(thread_t *tp, tprio_t prio) {
 
   tp->hdr.pqueue.prio   = prio;
-  tp->state             = CH_STATE_WTSTART;
-  tp->flags             = CH_FLAG_MODE_STATIC;
-  tp->owner             = oip;
 #if CH_CFG_TIME_QUANTUM > 0
   tp->ticks             = (tslices_t)CH_CFG_TIME_QUANTUM;
+  tp->quantum           = (tslices_t)CH_CFG_TIME_QUANTUM;
 #endif
 #if CH_CFG_USE_MUTEXES == TRUE
   tp->realprio          = prio;
   tp->mtxlist           = NULL;
 #endif
+#if CH_CFG_USE_PCMUTEXES == TRUE
+  tp->pcmtxlist         = NULL;
+#endif
 #if CH_CFG_USE_EVENTS == TRUE
   tp->epending          = (eventmask_t)0;
 #endif
 #if CH_DBG_THREADS_PROFILING == TRUE
   tp->time              = (systime_t)0;
 #endif
+#if (CH_CFG_USE_MESSAGES == TRUE) && (CH_CFG_USE_MESSAGES_ASYNC == TRUE)
+  tp->msgsnd.state      = CH_MSG_ASYNC_NONE;
+#endif
+#if CH_DBG_STATISTICS == TRUE
+  chTMObjectInit(&tp->stats);
+  tp->rrswc             = (ucnt_t)0;
+#endif
+#if CH_DBG_STACK_PROFILER == TRUE
+  tp->stkprof.scan      = NULL;
+  tp->stkprof.mark      = NULL;
+  tp->stkprof.warned    = false;
+#endif
+}
+
+/**
+ * @brief   Initializes a thread structure.
+ * @note    This is an internal functions, do not use it in application code.
+ *
+ * @param[in] oip       pointer to the OS instance
+ * @param[in] tp        pointer to the thread
+ * @param[in] name      thread name
+ * @param[in] prio      the priority level for the new thread
+ * @return              The same thread pointer passed as parameter.
+ *
+ * @notapi
+ */
+thread_t *__thd_object_init(os_instance_t *oip,
+                            thread_t *tp,
+                            const char *name,
+                            tprio_t prio) {
+
+  __thd_object_reset(tp, prio);
+  tp->state             = CH_STATE_WTSTART;
+  tp->flags             = CH_FLAG_MODE_STATIC;
+  tp->owner             = oip;
 #if CH_CFG_USE_REGISTRY == TRUE
   tp->refs              = (trefs_t)1;
   tp->name              = name;
@@ -120,9 +154,6 @@ thread_t *__thd_object_init(os_instance_t *oip,
 #endif
 #if CH_CFG_USE_MESSAGES == TRUE
   ch_queue_init(&tp->msgqueue);
-#endif
-#if CH_DBG_STATISTICS == TRUE
-  chTMObjectInit(&tp->stats);
 #endif
   CH_CFG_THREAD_INIT_HOOK(tp);
   return tp;
@@ -169,6 +200,7 @@ void __thd_stackfill(uint8_t *startp, uint8_t *endp) {
  * @iclass
  */
 thread_t *chThdCreateSuspendedI(const thread_descriptor_t *tdp) {
+  os_instance_t *oip = currcore;
   thread_t *tp;
 
   chDbgCheckClassI();
@@ -185,7 +217,8 @@ thread_t *chThdCreateSuspendedI(const thread_descriptor_t *tdp) {
   tp = threadref(((uint8_t *)tdp->wend -
                  MEM_ALIGN_NEXT(sizeof (thread_t), PORT_STACK_ALIGN)));
 
-#if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE)
+#if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE) ||  \
+    (CH_DBG_STACK_PROFILER == TRUE)
   /* Stack boundary.*/
   tp->wabase = tdp->wbase;
 #endif
@@ -196,11 +229,20 @@ thread_t *chThdCreateSuspendedI(const thread_descriptor_t *tdp) {
   /* The thread object is initialized but not started.*/
 #if CH_CFG_SMP_MODE != FALSE
   if (tdp->instance != NULL) {
-    return __thd_object_init(tdp->instance, tp, tdp->name, tdp->prio);
+    oip = tdp->instance;
   }
 #endif
+  tp = __thd_object_init(oip, tp, tdp->name, tdp->prio);
 
-  return __thd_object_init(currcore, tp, tdp->name, tdp->prio);
+#if CH_CFG_TIME_QUANTUM > 0
+  /* Time quantum specified in the descriptor, if any.*/
+  if (tdp->quantum > (tslices_t)0) {
+    tp->ticks   = tdp->quantum;
+    tp->quantum = tdp->quantum;
+  }
+#endif
+
+  return tp;
 }
 
 /**
@@ -354,7 +396,8 @@ thread_t *chThdCreateStatic(void *wsp, size_t size,
   tp = threadref(((uint8_t *)wsp + size -
                  MEM_ALIGN_NEXT(sizeof (thread_t), PORT_STACK_ALIGN)));
 
-#if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE)
+#if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE) ||  \
+    (CH_DBG_STACK_PROFILER == TRUE)
   /* Stack boundary.*/
   tp->wabase = (stkalign_t *)wsp;
 #endif
@@ -505,6 +548,11 @@ void chThdExit(msg_t msg) {
 void chThdExitS(msg_t msg) {
   thread_t *currtp = chThdGetSelfX();
 
+#if (CH_CFG_USE_MESSAGES == TRUE) && (CH_CFG_USE_MESSAGES_ASYNC == TRUE)
+  chDbgAssert(currtp->msgsnd.state == CH_MSG_ASYNC_NONE,
+              "asynchronous message pending");
+#endif
+
   /* Storing exit message.*/
   currtp->u.exitcode = msg;
 
@@ -602,17 +650,23 @@ msg_t chThdWait(thread_t *tp) {
 tprio_t chThdSetPriority(tprio_t newprio) {
   thread_t *currtp = chThdGetSelfX();
   tprio_t oldprio;
+#if CH_CFG_USE_MUTEXES == TRUE
+  tprio_t oldbase;
+#endif
 
   chDbgCheck(newprio <= HIGHPRIO);
 
   chSysLock();
 #if CH_CFG_USE_MUTEXES == TRUE
+  /* The base priority includes the ceiling of the owned priority ceiling
+     mutexes, if any, an inherited priority is only raised.*/
   oldprio = currtp->realprio;
-  if ((currtp->hdr.pqueue.prio == currtp->realprio) ||
-      (newprio > currtp->hdr.pqueue.prio)) {
-    currtp->hdr.pqueue.prio = newprio;
-  }
+  oldbase = __mtx_base_prio(currtp);
   currtp->realprio = newprio;
+  if ((currtp->hdr.pqueue.prio == oldbase) ||
+      (__mtx_base_prio(currtp) > currtp->hdr.pqueue.prio)) {
+    currtp->hdr.pqueue.prio = __mtx_base_prio(currtp);
+  }
 #else
   oldprio = currtp->hdr.pqueue.prio;
   currtp->hdr.pqueue.prio = newprio;
@@ -623,6 +677,38 @@ tprio_t chThdSetPriority(tprio_t newprio) {
   return oldprio;
 }
 
+#if (CH_CFG_TIME_QUANTUM > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Changes the running thread time quantum.
+ * @details The new quantum is used starting from the next time slice, the
+ *          current time slice is shortened if it exceeds the new quantum.
+ * @note    Threads with long quanta delay the threads with the same
+ *          priority, higher priority threads can preempt them anyway.
+ *
+ * @param[in] quantum   the new time quantum in system ticks, it must be
+ *                      greater than zero
+ * @return              The old time quantum.
+ *
+ * @api
+ */
+tslices_t chThdSetQuantum(tslices_t quantum) {
+  thread_t *currtp = chThdGetSelfX();
+  tslices_t oldquantum;
+
+  chDbgCheck(quantum > (tslices_t)0);
+
+  chSysLock();
+  oldquantum = currtp->quantum;
+  currtp->quantum = quantum;
+  if (currtp->ticks > quantum) {
+    currtp->ticks = quantum;
+  }
+  chSysUnlock();
+
+  return oldquantum;
+}
+#endif
+
 /**
  * @brief   Requests a thread termination.
  * @pre     The target thread must be written to invoke periodically
@@ -23,6 +23,15 @@
  *
  * @addtogroup time
  * @details Time and Virtual Timers related APIs and services.
+ *          <h2>Deferred callbacks</h2>
+ *          Timers armed using @p chVTDoSetDeferredI() or
+ *          @p chVTDoSetContinuousDeferredI() do not invoke their callback
+ *          from the system timer interrupt, the expired timer is appended
+ *          to a list served by a high priority timers thread. Only short
+ *          callbacks should be left in interrupt context, long ones would
+ *          delay all the other interrupts.<br>
+ *          The latency between the timer expiration and the callback
+ *          invocation is measured using the realtime counter.
  * @{
  */
 
@@ -56,6 +65,92 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Appends an expired timer to the deferred callbacks list.
+ * @details The timers thread is resumed if the list was empty. If the
+ *          timer callback is already pending then the expiration is merged
+ *          with the pending one.
+ *
+ * @param[in] vtlp      pointer to the @p virtual_timers_list_t structure
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ *
+ * @notapi
+ */
+static void vt_defer(virtual_timers_list_t *vtlp, virtual_timer_t *vtp) {
+
+  if (vtp->dnext == NULL) {
+    vtp->dnext  = vtp;
+    vtp->dstamp = chSysGetRealtimeCounterX();
+    if (vtlp->deferred.first == NULL) {
+      vtp->dprev = NULL;
+      vtlp->deferred.first = vtp;
+      chThdResumeI(&vtlp->deferred.thread, MSG_OK);
+    }
+    else {
+      vtp->dprev = vtlp->deferred.last;
+      vtlp->deferred.last->dnext = vtp;
+    }
+    vtlp->deferred.last = vtp;
+  }
+}
+
+/**
+ * @brief   Removes a timer from the deferred callbacks list.
+ * @details Nothing is done if the timer callback is not pending.
+ *
+ * @param[in] vtlp      pointer to the @p virtual_timers_list_t structure
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ *
+ * @notapi
+ */
+static void vt_undefer(virtual_timers_list_t *vtlp, virtual_timer_t *vtp) {
+
+  if (vtp->dnext != NULL) {
+    bool last = (bool)(vtp->dnext == vtp);
+
+    if (vtp->dprev == NULL) {
+      vtlp->deferred.first = last ? NULL : vtp->dnext;
+    }
+    else {
+      vtp->dprev->dnext = last ? vtp->dprev : vtp->dnext;
+    }
+    if (last) {
+      vtlp->deferred.last = vtp->dprev;
+    }
+    else {
+      vtp->dnext->dprev = vtp->dprev;
+    }
+    vtp->dnext = NULL;
+  }
+}
+
+/**
+ * @brief   Cancels the pending deferred callback of a timer being armed.
+ * @details The timer is searched in the deferred callbacks list because
+ *          the fields of a timer armed without a previous
+ *          @p chVTObjectInit() cannot be trusted, the list is empty unless
+ *          the timers thread is late.
+ *
+ * @param[in] vtlp      pointer to the @p virtual_timers_list_t structure
+ * @param[in] vtp       the @p virtual_timer_t structure pointer
+ *
+ * @notapi
+ */
+static void vt_undefer_rearmed(virtual_timers_list_t *vtlp,
+                               virtual_timer_t *vtp) {
+  virtual_timer_t *dvtp = vtlp->deferred.first;
+
+  while (dvtp != NULL) {
+    if (dvtp == vtp) {
+      vt_undefer(vtlp, vtp);
+      return;
+    }
+    dvtp = dvtp->dnext == dvtp ? NULL : dvtp->dnext;
+  }
+}
+#endif /* CH_CFG_USE_VT_DEFERRED == TRUE */
+
 #if (CH_CFG_ST_TIMEDELTA > 0) || defined(__DOXYGEN__)
 /**
  * @brief   Alarm time setup.
@@ -258,6 +353,7 @@ static void vt_enqueue(virtual_timers_list_t *vtlp,
  *          specified as parameter.
  * @pre     The timer must not be already armed before calling this function.
  * @note    The callback function is invoked from interrupt context.
+ * @note    A deferred callback still pending for the timer is cancelled.
  *
  * @param[out] vtp      pointer to a @p virtual_timer_t structure
  * @param[in] delay     the number of ticks before the operation timeouts, the
@@ -285,6 +381,11 @@ void chVTDoSetI(virtual_timer_t *vtp, sysinterval_t delay,
   vtp->par     = par;
   vtp->func    = vtfunc;
   vtp->reload  = (sysinterval_t)0;
+#if CH_CFG_USE_VT_DEFERRED == TRUE
+  /* Re-arming a timer cancels its deferred callback, if pending.*/
+  vt_undefer_rearmed(vtlp, vtp);
+  vtp->deferred = false;
+#endif
 
   /* Inserting the timer in the delta list.*/
   vt_enqueue(vtlp, vtp, delay);
@@ -296,6 +397,7 @@ void chVTDoSetI(virtual_timer_t *vtp, sysinterval_t delay,
  *          specified as parameter.
  * @pre     The timer must not be already armed before calling this function.
  * @note    The callback function is invoked from interrupt context.
+ * @note    A deferred callback still pending for the timer is cancelled.
  *
  * @param[out] vtp      pointer to a @p virtual_timer_t structure
  * @param[in] delay     the number of ticks before the operation timeouts, the
@@ -322,14 +424,139 @@ void chVTDoSetContinuousI(virtual_timer_t *vtp, sysinterval_t delay,
   vtp->par     = par;
   vtp->func    = vtfunc;
   vtp->reload  = delay;
+#if CH_CFG_USE_VT_DEFERRED == TRUE
+  /* Re-arming a timer cancels its deferred callback, if pending.*/
+  vt_undefer_rearmed(vtlp, vtp);
+  vtp->deferred = false;
+#endif
 
   /* Inserting the timer in the delta list.*/
   vt_enqueue(vtlp, vtp, delay);
 }
 
+#if (CH_CFG_USE_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Enables a one-shot virtual timer with deferred callback.
+ * @details The timer is enabled and programmed to trigger after the delay
+ *          specified as parameter, on expiration the callback is invoked
+ *          by the timers thread.
+ * @pre     The timer must have been initialized using @p chVTObjectInit().
+ * @pre     The timer must not be already armed before calling this function.
+ * @note    The callback function is invoked from thread context, it must
+ *          use @p chSysLock() and @p chSysUnlock() in order to call I-class
+ *          functions.
+ * @note    Resetting the timer also cancels a callback already pending
+ *          in the timers thread.
+ *
+ * @param[out] vtp      pointer to a @p virtual_timer_t structure
+ * @param[in] delay     the number of ticks before the operation timeouts, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] vtfunc    the timer callback function. After invoking the
+ *                      callback the timer is disabled and the structure can
+ *                      be disposed or reused.
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @iclass
+ */
+void chVTDoSetDeferredI(virtual_timer_t *vtp, sysinterval_t delay,
+                        vtfunc_t vtfunc, void *par) {
+
+  chVTDoSetI(vtp, delay, vtfunc, par);
+  vtp->deferred = true;
+}
+
+/**
+ * @brief   Enables a continuous virtual timer with deferred callback.
+ * @details The timer is enabled and programmed to trigger after the delay
+ *          specified as parameter, on expiration the callback is invoked
+ *          by the timers thread.
+ * @pre     The timer must have been initialized using @p chVTObjectInit().
+ * @pre     The timer must not be already armed before calling this function.
+ * @note    The callback function is invoked from thread context, it must
+ *          use @p chSysLock() and @p chSysUnlock() in order to call I-class
+ *          functions.
+ * @note    The timer is restarted on expiration, not after the callback
+ *          execution. Expirations happening while the callback is still
+ *          pending are merged into a single invocation.
+ *
+ * @param[out] vtp      pointer to a @p virtual_timer_t structure
+ * @param[in] delay     the number of ticks before the operation timeouts, the
+ *                      special values are handled as follow:
+ *                      - @a TIME_INFINITE is allowed but interpreted as a
+ *                        normal time specification.
+ *                      - @a TIME_IMMEDIATE this value is not allowed.
+ *                      .
+ * @param[in] vtfunc    the timer callback function. After invoking the
+ *                      callback the timer is restarted.
+ * @param[in] par       a parameter that will be passed to the callback
+ *                      function
+ *
+ * @iclass
+ */
+void chVTDoSetContinuousDeferredI(virtual_timer_t *vtp, sysinterval_t delay,
+                                  vtfunc_t vtfunc, void *par) {
+
+  chVTDoSetContinuousI(vtp, delay, vtfunc, par);
+  vtp->deferred = true;
+}
+
+/**
+ * @brief   Timers thread function.
+ * @details The thread invokes the deferred callbacks in expiration order
+ *          and updates the deferral latency statistics.
+ *
+ * @param[in] p         pointer to the @p virtual_timers_list_t structure
+ *                      of the instance
+ *
+ * @notapi
+ */
+void __vt_deferred_thread(void *p) {
+  virtual_timers_list_t *vtlp = (virtual_timers_list_t *)p;
+
+  chSysLock();
+  while (true) {
+    virtual_timer_t *vtp;
+    rtcnt_t latency;
+
+    /* Timers can be removed from the list by a reset after the thread
+       has been resumed, checking again.*/
+    while (vtlp->deferred.first == NULL) {
+      (void) chThdSuspendS(&vtlp->deferred.thread);
+    }
+
+    /* Removing the first timer from the list, its callback can arm it
+       again.*/
+    vtp = vtlp->deferred.first;
+    vt_undefer(vtlp, vtp);
+
+    /* Latency accounting.*/
+    latency = chSysGetRealtimeCounterX() - vtp->dstamp;
+    if (latency < vtlp->deferred.stats.best) {
+      vtlp->deferred.stats.best = latency;
+    }
+    if (latency > vtlp->deferred.stats.worst) {
+      vtlp->deferred.stats.worst = latency;
+    }
+    vtlp->deferred.stats.n++;
+    vtlp->deferred.stats.cumulative += (rttime_t)latency;
+
+    chSysUnlock();
+    vtp->func(vtp, vtp->par);
+    chSysLock();
+  }
+}
+#endif /* CH_CFG_USE_VT_DEFERRED == TRUE */
+
 /**
  * @brief   Disables a Virtual Timer.
  * @pre     The timer must be in armed state before calling this function.
+ * @note    A deferred callback pending in the timers thread is cancelled,
+ *          in this case the timer can also be already expired.
  *
  * @param[in] vtp       pointer to a @p virtual_timer_t structure
  *
@@ -340,7 +567,21 @@ void chVTDoResetI(virtual_timer_t *vtp) {
 
   chDbgCheckClassI();
   chDbgCheck(vtp != NULL);
+#if CH_CFG_USE_VT_DEFERRED == TRUE
+  chDbgAssert(chVTIsArmedI(vtp) || (vtp->deferred && (vtp->dnext != NULL)),
+              "timer not armed");
+
+  /* Cancelling a pending callback, an expired one-shot timer is no more in
+     the delta list.*/
+  if (vtp->deferred) {
+    vt_undefer(vtlp, vtp);
+    if (!chVTIsArmedI(vtp)) {
+      return;
+    }
+  }
+#else
   chDbgAssert(chVTIsArmedI(vtp), "timer not armed");
+#endif
 
 #if CH_CFG_ST_TIMEDELTA == 0
 
@@ -481,9 +722,17 @@ void chVTDoTickI(void) {
       (void) ch_dlist_dequeue(&vtp->dlist);
       vtp->dlist.next = NULL;
 
-      chSysUnlockFromISR();
-      vtp->func(vtp, vtp->par);
-      chSysLockFromISR();
+#if CH_CFG_USE_VT_DEFERRED == TRUE
+      if (vtp->deferred) {
+        vt_defer(vtlp, vtp);
+      }
+      else
+#endif
+      {
+        chSysUnlockFromISR();
+        vtp->func(vtp, vtp->par);
+        chSysLockFromISR();
+      }
 
       /* If a reload is defined the timer needs to be restarted.*/
       if (vtp->reload > (sysinterval_t)0) {
@@ -529,14 +778,22 @@ void chVTDoTickI(void) {
       port_timer_stop_alarm();
     }
 
-    /* The callback is invoked outside the kernel critical section, it
-       is re-entered on the callback return. Note that "lasttime" can be
-       modified within the callback if some timer function is called.*/
-    chSysUnlockFromISR();
+#if CH_CFG_USE_VT_DEFERRED == TRUE
+    if (vtp->deferred) {
+      vt_defer(vtlp, vtp);
+    }
+    else
+#endif
+    {
+      /* The callback is invoked outside the kernel critical section, it
+         is re-entered on the callback return. Note that "lasttime" can be
+         modified within the callback if some timer function is called.*/
+      chSysUnlockFromISR();
 
-    vtp->func(vtp, vtp->par);
+      vtp->func(vtp, vtp->par);
 
-    chSysLockFromISR();
+      chSysLockFromISR();
+    }
 
     /* If a reload is defined the timer needs to be restarted.*/
     if (unlikely(vtp->reload > (sysinterval_t)0)) {
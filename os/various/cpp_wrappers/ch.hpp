@@ -27,6 +27,26 @@
 #ifndef _CH_HPP_
 #define _CH_HPP_
 
+/**
+ * @brief   C++20 coroutines support.
+ * @details Enabled by default if the compiler supports coroutines and the
+ *          kernel includes memory pools and events with timeout.
+ */
+#if !defined(CH_CPP_USE_COROUTINES) || defined(__DOXYGEN__)
+#if defined(__cpp_impl_coroutine) && (CH_CFG_USE_MEMPOOLS == TRUE) &&      \
+    (CH_CFG_USE_EVENTS_TIMEOUT == TRUE)
+#define CH_CPP_USE_COROUTINES               TRUE
+#else
+#define CH_CPP_USE_COROUTINES               FALSE
+#endif
+#endif
+
+#include <new>
+
+#if CH_CPP_USE_COROUTINES == TRUE
+#include <coroutine>
+#endif
+
 /**
  * @brief   ChibiOS-RT kernel-related classes and interfaces.
  */
@@ -988,6 +1008,21 @@ namespace chibios_rt {
       return chThdGetPriorityX();
     }
 
+#if (CH_CFG_TIME_QUANTUM > 0) || defined(__DOXYGEN__)
+    /**
+     * @brief   Changes the running thread time quantum.
+     *
+     * @param[in] quantum   the new time quantum in system ticks
+     * @return              The old time quantum.
+     *
+     * @api
+     */
+    static tslices_t setQuantum(tslices_t quantum) {
+
+      return chThdSetQuantum(quantum);
+    }
+#endif
+
     /**
      * @brief   Terminates the current thread.
      * @details The thread goes in the @p THD_STATE_FINAL state holding the
@@ -1444,263 +1479,1106 @@ namespace chibios_rt {
     }
   };
 
-  /*------------------------------------------------------------------------*
-   * chibios_rt::SynchronizationObject                                      *
-   *------------------------------------------------------------------------*/
-  /**
-   * @brief     Base class for all synchronization objects.
-   * @note      No other uses.
-   */
-  class SynchronizationObject {
-  };
+#if (CH_CPP_USE_COROUTINES == TRUE) || defined(__DOXYGEN__)
+  /* Forward declaration of the coroutines classes.*/
+  class BaseCoroutineScheduler;
+  class CoroutineAwaiter;
+  class Coroutine;
+  class MemoryPool;
 
   /*------------------------------------------------------------------------*
-   * chibios_rt::ThreadsQueue                                               *
+   * chibios_rt::CoroutinePromise                                           *
    *------------------------------------------------------------------------*/
   /**
-   * @brief     Threads queue class.
-   * @details   This class encapsulates a queue of threads.
+   * @brief   Promise of a coroutine.
+   * @details The coroutine frame is allocated from the frames pool of the
+   *          scheduler passed as first argument of the coroutine function,
+   *          or as second argument for member functions.
    */
-  class ThreadsQueue : public SynchronizationObject {
+  class CoroutinePromise {
+  public:
     /**
-     * @brief   Pointer to the system thread.
+     * @brief   Next coroutine in the scheduler lists.
      */
-    threads_queue_t threads_queue;
+    CoroutinePromise *next = nullptr;
+    /**
+     * @brief   Scheduler running the coroutine.
+     */
+    BaseCoroutineScheduler *scheduler;
+    /**
+     * @brief   Awaiter the coroutine is suspended on.
+     */
+    CoroutineAwaiter *awaiter = nullptr;
 
-  public:
     /**
-     * @brief   Threads queue constructor.
+     * @brief   Promise constructor for coroutine functions.
+     *
+     * @param[in] sched     the scheduler running the coroutine
      *
      * @init
      */
-    ThreadsQueue() {
+    template <typename... Args>
+    CoroutinePromise(BaseCoroutineScheduler &sched, Args &...) noexcept :
+      scheduler(&sched) {
+    }
 
-      chThdQueueObjectInit(&threads_queue);
+    /**
+     * @brief   Promise constructor for coroutine member functions.
+     *
+     * @param[in] sched     the scheduler running the coroutine
+     *
+     * @init
+     */
+    template <typename T, typename... Args>
+    CoroutinePromise(T &, BaseCoroutineScheduler &sched, Args &...) noexcept :
+      scheduler(&sched) {
     }
 
-    /* Prohibit copy construction and assignment.*/
-    ThreadsQueue(const ThreadsQueue &) = delete;
-    ThreadsQueue &operator=(const ThreadsQueue &) = delete;
+    /**
+     * @brief   Allocates a coroutine frame from the scheduler frames pool.
+     *
+     * @param[in] size      size of the coroutine frame
+     * @param[in] sched     the scheduler running the coroutine
+     * @return              The pointer to the frame.
+     * @retval nullptr      if the pool is empty or the frame is too large.
+     *
+     * @notapi
+     */
+    template <typename... Args>
+    static void *operator new(size_t size, BaseCoroutineScheduler &sched,
+                              Args &...) noexcept;
 
     /**
-     * @brief   Enqueues the caller thread on a threads queue object.
-     * @details The caller thread is enqueued and put to sleep until it is
-     *          dequeued or the specified timeouts expires.
+     * @brief   Allocates a coroutine frame from the scheduler frames pool.
      *
-     * @param[in] timeout   the timeout in system ticks, the special values are
-     *                      handled as follow:
-     *                      - @a TIME_INFINITE the thread enters an infinite sleep
-     *                        state.
-     *                      - @a TIME_IMMEDIATE the thread is not enqueued and
-     *                        the function returns @p MSG_TIMEOUT as if a timeout
-     *                        occurred.
-     *                      .
-     * @return              The message from @p osalQueueWakeupOneI() or
-     *                      @p osalQueueWakeupAllI() functions.
-     * @retval MSG_TIMEOUT  if the thread has not been dequeued within the
-     *                      specified timeout or if the function has been
-     *                      invoked with @p TIME_IMMEDIATE as timeout
-     *                      specification.
+     * @param[in] size      size of the coroutine frame
+     * @param[in] sched     the scheduler running the coroutine
+     * @return              The pointer to the frame.
+     * @retval nullptr      if the pool is empty or the frame is too large.
      *
-     * @sclass
+     * @notapi
      */
-    msg_t enqueueSelfS(sysinterval_t timeout) {
+    template <typename T, typename... Args>
+    static void *operator new(size_t size, T &, BaseCoroutineScheduler &sched,
+                              Args &...) noexcept;
 
-      return chThdEnqueueTimeoutS(&threads_queue, timeout);
-    }
+    /**
+     * @brief   Returns a coroutine frame to its pool.
+     *
+     * @param[in] p         pointer to the frame
+     *
+     * @notapi
+     */
+    static void operator delete(void *p) noexcept;
 
     /**
-     * @brief   Dequeues and wakes up one thread from the threads queue object,
-     *          if any.
+     * @brief   Returned by the coroutine function if the frame allocation
+     *          failed.
      *
-     * @param[in] msg       the message code
+     * @notapi
+     */
+    static Coroutine get_return_object_on_allocation_failure(void) noexcept;
+
+    /**
+     * @brief   Returned by the coroutine function.
      *
-     * @iclass
+     * @notapi
      */
-    void dequeueNextI(msg_t msg) {
+    Coroutine get_return_object(void) noexcept;
 
-      chThdDequeueNextI(&threads_queue, msg);
+    /**
+     * @brief   Coroutines start suspended, they are started by the
+     *          scheduler.
+     *
+     * @notapi
+     */
+    std::suspend_always initial_suspend(void) noexcept {
+
+      return {};
     }
 
     /**
-     * @brief   Dequeues and wakes up all threads from the threads queue object.
+     * @brief   The coroutine frame is released on termination.
      *
-     * @param[in] msg       the message code
+     * @notapi
+     */
+    std::suspend_never final_suspend(void) noexcept {
+
+      return {};
+    }
+
+    /**
+     * @brief   Coroutine termination.
      *
-     * @iclass
+     * @notapi
      */
-    void chdequeueAllI(msg_t msg) {
+    void return_void(void) noexcept;
 
-      chThdDequeueAllI(&threads_queue, msg);
+    /**
+     * @brief   Exceptions are not supported in coroutines.
+     *
+     * @notapi
+     */
+    void unhandled_exception(void) noexcept {
+
+      chSysHalt("coroutine exception");
     }
-};
+  };
 
-#if (CH_CFG_USE_SEMAPHORES == TRUE) || defined(__DOXYGEN__)
   /*------------------------------------------------------------------------*
-   * chibios_rt::CounterSemaphore                                           *
+   * chibios_rt::CoroutineAwaiter                                           *
    *------------------------------------------------------------------------*/
   /**
-   * @brief   Class encapsulating a semaphore.
+   * @brief   Base class of the coroutines awaitable operations.
+   * @details A suspended coroutine is resumed when the poll function
+   *          succeeds, when any of the awaited events is received or when
+   *          the timeout expires.
    */
-  class CounterSemaphore : public SynchronizationObject {
+  class CoroutineAwaiter {
+    friend class BaseCoroutineScheduler;
+
+  protected:
     /**
-     * @brief   Embedded @p semaphore_t structure.
+     * @brief   Poll function or @p nullptr.
+     * @details The function returns @p MSG_TIMEOUT while the operation
+     *          cannot be completed without waiting.
      */
-    semaphore_t sem;
+    msg_t (*pollfn)(void *obj, void *arg);
+    /**
+     * @brief   Poll function object.
+     */
+    void *obj;
+    /**
+     * @brief   Poll function argument.
+     */
+    void *arg;
+    /**
+     * @brief   Awaited events mask.
+     */
+    eventmask_t ewmask;
+    /**
+     * @brief   Received events.
+     */
+    eventmask_t events;
+    /**
+     * @brief   Timeout of the operation.
+     */
+    sysinterval_t timeout;
+    /**
+     * @brief   Absolute time of the timeout expiration.
+     */
+    systime_t deadline;
+    /**
+     * @brief   Operation result.
+     */
+    msg_t msg;
 
-  public:
     /**
-     * @brief   CounterSemaphore constructor.
-     * @details The embedded @p Semaphore structure is initialized.
-     *
-     * @param[in] n             the semaphore counter value, must be greater
-     *                          or equal to zero
+     * @brief   CoroutineAwaiter constructor.
      *
      * @init
      */
-    CounterSemaphore(cnt_t n) {
-
-      chSemObjectInit(&sem, n);
+    CoroutineAwaiter(msg_t (*pf)(void *, void *), void *o, void *a,
+                     eventmask_t mask, sysinterval_t interval) :
+      pollfn(pf), obj(o), arg(a), ewmask(mask), events((eventmask_t)0),
+      timeout(interval), deadline((systime_t)0), msg(MSG_OK) {
     }
 
+  public:
     /**
-     * @brief   Performs a reset operation on the semaphore.
-     * @post    After invoking this function all the threads waiting on the
-     *          semaphore, if any, are released and the semaphore counter is
-     *          set to the specified, non negative, value.
-     * @note    The released threads can recognize they were waked up by a
-     *          reset rather than a signal because the @p chSemWait() will
-     *          return @p MSG_RESET instead of @p MSG_OK.
+     * @brief   Suspends the coroutine on its scheduler.
      *
-     * @param[in] n         the new value of the semaphore counter. The value
-     *                      must be non-negative.
+     * @param[in] h         handle of the awaiting coroutine
      *
-     * @api
+     * @notapi
      */
-    void reset(cnt_t n) {
+    void await_suspend(std::coroutine_handle<CoroutinePromise> h) noexcept;
+  };
 
-      chSemReset(&sem, n);
+  /**
+   * @brief   Awaitable timed suspension.
+   */
+  class SleepAwaiter : public CoroutineAwaiter {
+  public:
+    /**
+     * @brief   SleepAwaiter constructor.
+     *
+     * @param[in] interval  the suspension time
+     *
+     * @init
+     */
+    SleepAwaiter(sysinterval_t interval) :
+      CoroutineAwaiter(nullptr, nullptr, nullptr, (eventmask_t)0, interval) {
     }
 
     /**
-     * @brief   Performs a reset operation on the semaphore.
-     * @post    After invoking this function all the threads waiting on the
-     *          semaphore, if any, are released and the semaphore counter is
-     *          set to the specified, non negative, value.
-     * @post    This function does not reschedule so a call to a rescheduling
-     *          function must be performed before unlocking the kernel. Note
-     *          that interrupt handlers always reschedule on exit so an
-     *          explicit reschedule must not be performed in ISRs.
-     * @note    The released threads can recognize they were waked up by a
-     *          reset rather than a signal because the @p chSemWait() will
-     *          return @p MSG_RESET instead of @p MSG_OK.
-     *
-     * @param[in] n         the new value of the semaphore counter. The value
-     *                      must be non-negative.
+     * @brief   A zero interval does not suspend.
      *
-     * @iclass
+     * @notapi
      */
-    void resetI(cnt_t n) {
+    bool await_ready(void) const noexcept {
 
-      chSemResetI(&sem, n);
+      return timeout == TIME_IMMEDIATE;
     }
 
     /**
-     * @brief   Performs a wait operation on a semaphore.
+     * @brief   Resumption after the interval.
      *
-     * @return              A message specifying how the invoking thread has
-     *                      been released from the semaphore.
-     * @retval MSG_OK       if the thread has not stopped on the semaphore or
-     *                      the semaphore has been signaled.
-     * @retval MSG_RESET    if the semaphore has been reset using
-     *                      @p chSemReset().
-     *
-     * @api
+     * @notapi
      */
-    msg_t wait(void) {
-
-      return chSemWait(&sem);
+    void await_resume(void) const noexcept {
     }
+  };
 
+  /**
+   * @brief   Awaitable events wait.
+   * @details The events are signaled to the scheduler thread.
+   */
+  class EventsAwaiter : public CoroutineAwaiter {
+  public:
     /**
-     * @brief   Performs a wait operation on a semaphore.
+     * @brief   EventsAwaiter constructor.
      *
-     * @return              A message specifying how the invoking thread has
-     *                      been released from the semaphore.
-     * @retval MSG_OK       if the thread has not stopped on the semaphore or
-     *                      the semaphore has been signaled.
-     * @retval MSG_RESET    if the semaphore has been reset using
-     *                      @p chSemReset().
+     * @param[in] mask      mask of the events to wait for
+     * @param[in] interval  the timeout
      *
-     * @sclass
+     * @init
      */
-    msg_t waitS(void) {
+    EventsAwaiter(eventmask_t mask, sysinterval_t interval) :
+      CoroutineAwaiter(nullptr, nullptr, nullptr, mask, interval) {
+    }
 
-      return chSemWaitS(&sem);
+    /**
+     * @brief   The pending events are checked by the scheduler.
+     *
+     * @notapi
+     */
+    bool await_ready(void) const noexcept {
+
+      return false;
     }
 
     /**
-     * @brief   Performs a wait operation on a semaphore with timeout
-     *          specification.
+     * @brief   Returns the received events.
      *
-     * @param[in] timeout   the number of ticks before the operation timeouts,
-     *                      the following special values are allowed:
-     *                      - @a TIME_IMMEDIATE immediate timeout.
-     *                      - @a TIME_INFINITE no timeout.
-     *                      .
-     * @return              A message specifying how the invoking thread has
-     *                      been released from the semaphore.
-     * @retval MSG_OK       if the thread has not stopped on the semaphore or
-     *                      the semaphore has been signaled.
-     * @retval MSG_RESET    if the semaphore has been reset using
-     *                      @p chSemReset().
-     * @retval MSG_TIMEOUT  if the semaphore has not been signaled or reset
-     *                      within the specified timeout.
+     * @return              The received events, the events are cleared.
+     * @retval 0            if the operation has timed out.
      *
-     * @api
+     * @notapi
      */
-    msg_t wait(sysinterval_t timeout) {
+    eventmask_t await_resume(void) const noexcept {
 
-      return chSemWaitTimeout(&sem, timeout);
+      return events;
     }
+  };
 
+  /**
+   * @brief   Awaitable polled operation.
+   * @details Operations on kernel objects without a completion callback are
+   *          attempted again after each coroutine step, after each
+   *          scheduler notification and periodically.
+   */
+  class PollAwaiter : public CoroutineAwaiter {
+  public:
     /**
-     * @brief   Performs a wait operation on a semaphore with timeout
-     *          specification.
+     * @brief   PollAwaiter constructor.
      *
-     * @param[in] timeout   the number of ticks before the operation timeouts,
-     *                      the following special values are allowed:
-     *                      - @a TIME_IMMEDIATE immediate timeout.
-     *                      - @a TIME_INFINITE no timeout.
-     *                      .
-     * @return              A message specifying how the invoking thread has
-     *                      been released from the semaphore.
-     * @retval MSG_OK       if the thread has not stopped on the semaphore or
-     *                      the semaphore has been signaled.
-     * @retval MSG_RESET    if the semaphore has been reset using
-     *                      @p chSemReset().
-     * @retval MSG_TIMEOUT  if the semaphore has not been signaled or reset
-     *                      within the specified timeout.
+     * @param[in] pf        the non-blocking operation function
+     * @param[in] o         the operation object
+     * @param[in] a         the operation argument
+     * @param[in] interval  the timeout
      *
-     * @sclass
+     * @init
      */
-    msg_t waitS(sysinterval_t timeout) {
-
-      return chSemWaitTimeoutS(&sem, timeout);
+    PollAwaiter(msg_t (*pf)(void *, void *), void *o, void *a,
+                sysinterval_t interval) :
+      CoroutineAwaiter(pf, o, a, (eventmask_t)0, interval) {
     }
 
     /**
-     * @brief   Performs a signal operation on a semaphore.
+     * @brief   The operation is attempted before suspending.
      *
-     * @api
+     * @notapi
      */
-    void signal(void) {
+    bool await_ready(void) noexcept {
 
-      chSemSignal(&sem);
+      msg = pollfn(obj, arg);
+      if (msg != MSG_TIMEOUT) {
+        return true;
+      }
+
+      return timeout == TIME_IMMEDIATE;
     }
 
     /**
-     * @brief   Performs a signal operation on a semaphore.
+     * @brief   Returns the operation result.
+     *
+     * @return              The operation result.
+     *
+     * @notapi
+     */
+    msg_t await_resume(void) const noexcept {
+
+      return msg;
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::Coroutine                                                  *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Coroutine object.
+   * @details Return type of the coroutine functions, the object is passed
+   *          to a scheduler in order to start the coroutine.
+   */
+  class Coroutine {
+    friend class CoroutinePromise;
+    friend class BaseCoroutineScheduler;
+
+    /**
+     * @brief   Handle of the coroutine, @p nullptr if not allocated.
+     */
+    std::coroutine_handle<CoroutinePromise> handle;
+
+    /**
+     * @brief   Coroutine constructor.
+     *
+     * @init
+     */
+    explicit Coroutine(std::coroutine_handle<CoroutinePromise> h) noexcept :
+      handle(h) {
+    }
+
+  public:
+    /**
+     * @brief   Promise type of the coroutine functions.
+     */
+    using promise_type = CoroutinePromise;
+
+    /**
+     * @brief   Coroutine constructor.
+     * @details An invalid coroutine is created.
+     *
+     * @init
+     */
+    Coroutine(void) noexcept : handle(nullptr) {
+
+    }
+
+    /* Prohibit copy construction and assignment, but allow move.*/
+    Coroutine(const Coroutine &) = delete;
+    Coroutine &operator=(const Coroutine &) = delete;
+    Coroutine(Coroutine &&other) noexcept : handle(other.handle) {
+
+      other.handle = nullptr;
+    }
+
+    /**
+     * @brief   Coroutine destructor.
+     * @details A coroutine not passed to a scheduler is destroyed.
+     */
+    ~Coroutine() {
+
+      if (handle) {
+        handle.destroy();
+      }
+    }
+
+    /**
+     * @brief   Returns @p true if the coroutine frame has been allocated.
+     *
+     * @xclass
+     */
+    bool isValidX(void) const {
+
+      return (bool)handle;
+    }
+
+    /**
+     * @brief   Awaitable suspension of the current coroutine.
+     * @note    Only usable in coroutines using @p co_await.
+     *
+     * @param[in] interval  the suspension time
+     * @return              The awaitable object.
+     *
+     * @api
+     */
+    static SleepAwaiter sleep(sysinterval_t interval) {
+
+      return SleepAwaiter(interval);
+    }
+
+    /**
+     * @brief   Awaitable wait for any of the specified events.
+     * @details The events must be signaled to the scheduler thread, the
+     *          received events are cleared.
+     * @note    Only usable in coroutines using @p co_await.
+     *
+     * @param[in] mask      mask of the events to wait for
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The awaitable object.
+     *
+     * @api
+     */
+    static EventsAwaiter waitEvents(eventmask_t mask,
+                                    sysinterval_t timeout = TIME_INFINITE) {
+
+      return EventsAwaiter(mask, timeout);
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::BaseCoroutineScheduler                                     *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Base class of the coroutines schedulers.
+   * @details Coroutines are resumed in FIFO order by the scheduler thread.
+   *          Suspended coroutines are checked after each coroutine step,
+   *          when the scheduler thread receives events and each poll
+   *          interval if there are polled operations pending.
+   */
+  class BaseCoroutineScheduler {
+    friend class CoroutinePromise;
+    friend class CoroutineAwaiter;
+
+  public:
+    /**
+     * @brief   Event reserved to the scheduler notification.
+     */
+    static constexpr eventmask_t notifyEvent =
+      EVENT_MASK(sizeof (eventmask_t) * 8U - 1U);
+
+    /**
+     * @brief   Alignment of the coroutine frames.
+     */
+    static constexpr size_t frameAlign = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+  protected:
+    /**
+     * @brief   Frames pool.
+     */
+    MemoryPool *frames;
+    /**
+     * @brief   Maximum frame size.
+     */
+    size_t frame_size;
+    /**
+     * @brief   Interval between checks of the polled operations.
+     */
+    sysinterval_t poll_interval;
+    /**
+     * @brief   Scheduler thread or @p nullptr if not started.
+     */
+    thread_t *thread = nullptr;
+    /**
+     * @brief   First ready coroutine.
+     */
+    CoroutinePromise *ready_head = nullptr;
+    /**
+     * @brief   Last ready coroutine.
+     */
+    CoroutinePromise *ready_tail = nullptr;
+    /**
+     * @brief   Suspended coroutines.
+     */
+    CoroutinePromise *waiting = nullptr;
+    /**
+     * @brief   Events received and not yet awaited.
+     */
+    eventmask_t epending = (eventmask_t)0;
+    /**
+     * @brief   Number of started coroutines not yet terminated.
+     */
+    ucnt_t ncoroutines = (ucnt_t)0;
+
+    /**
+     * @brief   BaseCoroutineScheduler constructor.
+     *
+     * @param[in] mp        the frames pool
+     * @param[in] size      the maximum frame size
+     * @param[in] poll      the interval between checks of the polled
+     *                      operations
+     *
+     * @init
+     */
+    BaseCoroutineScheduler(MemoryPool *mp, size_t size, sysinterval_t poll) :
+      frames(mp), frame_size(size), poll_interval(poll) {
+
+    }
+
+    /**
+     * @brief   Allocates a coroutine frame.
+     *
+     * @param[in] size      size of the coroutine frame
+     * @return              The pointer to the frame.
+     * @retval nullptr      if the pool is empty or the frame is too large.
+     *
+     * @api
+     */
+    void *allocFrame(size_t size);
+
+    /**
+     * @brief   Returns a coroutine frame to its pool.
+     *
+     * @param[in] p         pointer to the frame
+     *
+     * @api
+     */
+    static void freeFrame(void *p);
+
+    /**
+     * @brief   Appends a coroutine to the ready list.
+     *
+     * @param[in] pp        pointer to the coroutine promise
+     *
+     * @iclass
+     */
+    void readyI(CoroutinePromise *pp) {
+
+      pp->next = nullptr;
+      if (ready_head == nullptr) {
+        ready_head = pp;
+      }
+      else {
+        ready_tail->next = pp;
+      }
+      ready_tail = pp;
+    }
+
+    /**
+     * @brief   Removes the first coroutine from the ready list.
+     *
+     * @return              The coroutine promise.
+     * @retval nullptr      if there are no ready coroutines.
+     *
+     * @api
+     */
+    CoroutinePromise *takeReady(void) {
+      CoroutinePromise *pp;
+
+      chSysLock();
+      pp = ready_head;
+      if (pp != nullptr) {
+        ready_head = pp->next;
+      }
+      chSysUnlock();
+
+      return pp;
+    }
+
+    /**
+     * @brief   Resumes the suspended coroutines whose operation completed.
+     *
+     * @return              The time to wait for the next check.
+     *
+     * @api
+     */
+    sysinterval_t checkWaiting(void) {
+      systime_t now = chVTGetSystemTimeX();
+      sysinterval_t next = TIME_INFINITE;
+      CoroutinePromise **ppp = &waiting;
+
+      while (*ppp != nullptr) {
+        CoroutinePromise *pp = *ppp;
+        CoroutineAwaiter *ap = pp->awaiter;
+        bool done = false;
+
+        if (ap->pollfn != nullptr) {
+          ap->msg = ap->pollfn(ap->obj, ap->arg);
+          if (ap->msg != MSG_TIMEOUT) {
+            done = true;
+          }
+          else if (poll_interval < next) {
+            next = poll_interval;
+          }
+        }
+        if (!done && ((ap->ewmask & epending) != (eventmask_t)0)) {
+          ap->events = ap->ewmask & epending;
+          ap->msg    = MSG_OK;
+          epending  &= ~ap->events;
+          done = true;
+        }
+        if (!done && (ap->timeout != TIME_INFINITE)) {
+          sysinterval_t remaining = chTimeDiffX(now, ap->deadline);
+
+          /* Deadlines already past are considered expired.*/
+          if ((remaining == (sysinterval_t)0) ||
+              (remaining > (sysinterval_t)(TIME_MAX_SYSTIME /
+                                           (systime_t)2))) {
+            ap->msg = MSG_TIMEOUT;
+            done = true;
+          }
+          else if (remaining < next) {
+            next = remaining;
+          }
+        }
+
+        if (done) {
+          *ppp = pp->next;
+          chSysLock();
+          readyI(pp);
+          chSysUnlock();
+        }
+        else {
+          ppp = &pp->next;
+        }
+      }
+
+      if (ready_head != nullptr) {
+        return TIME_IMMEDIATE;
+      }
+
+      return next;
+    }
+
+    /**
+     * @brief   Scheduler loop.
+     * @note    It must be invoked by the scheduler thread, it never returns.
+     *
+     * @api
+     */
+    void run(void) {
+
+      thread = chThdGetSelfX();
+
+      while (true) {
+        CoroutinePromise *pp;
+        sysinterval_t timeout;
+
+        /* Resuming the next ready coroutine until its next suspension.*/
+        pp = takeReady();
+        if (pp != nullptr) {
+          std::coroutine_handle<CoroutinePromise>::from_promise(*pp).resume();
+        }
+
+        /* Checking the suspended coroutines then collecting the events,
+           the scheduler thread sleeps only if there are no ready
+           coroutines.*/
+        timeout = checkWaiting();
+        epending |= chEvtWaitAnyTimeout(ALL_EVENTS, timeout) &
+                    ~notifyEvent;
+      }
+    }
+
+  public:
+    /* Prohibit copy construction and assignment.*/
+    BaseCoroutineScheduler(const BaseCoroutineScheduler &) = delete;
+    BaseCoroutineScheduler &operator=(const BaseCoroutineScheduler &) = delete;
+
+    /**
+     * @brief   Starts a coroutine on the scheduler.
+     * @details The coroutine is resumed by the scheduler thread, the
+     *          coroutine frame is released when the coroutine terminates.
+     *
+     * @param[in] co        the coroutine object
+     * @return              The operation status.
+     * @retval false        if the coroutine frame allocation failed.
+     * @retval true         if the coroutine has been started.
+     *
+     * @api
+     */
+    bool spawn(Coroutine &&co) {
+      CoroutinePromise *pp;
+
+      if (!co.handle) {
+        return false;
+      }
+
+      pp = &co.handle.promise();
+      co.handle = nullptr;
+
+      chDbgAssert(pp->scheduler == this, "wrong scheduler");
+
+      chSysLock();
+      ncoroutines++;
+      readyI(pp);
+      if (thread != nullptr) {
+        chEvtSignalI(thread, notifyEvent);
+        chSchRescheduleS();
+      }
+      chSysUnlock();
+
+      return true;
+    }
+
+    /**
+     * @brief   Notifies the scheduler that polled operations could be
+     *          completed.
+     * @details Polled operations are attempted again immediately instead
+     *          of waiting for the poll interval.
+     *
+     * @iclass
+     */
+    void notifyI(void) {
+
+      if (thread != nullptr) {
+        chEvtSignalI(thread, notifyEvent);
+      }
+    }
+
+    /**
+     * @brief   Notifies the scheduler that polled operations could be
+     *          completed.
+     * @details Polled operations are attempted again immediately instead
+     *          of waiting for the poll interval.
+     *
+     * @api
+     */
+    void notify(void) {
+
+      chSysLock();
+      notifyI();
+      chSchRescheduleS();
+      chSysUnlock();
+    }
+
+    /**
+     * @brief   Returns the scheduler thread.
+     * @details Events awaited by coroutines must be signaled to this
+     *          thread.
+     *
+     * @return              The scheduler thread.
+     * @retval nullptr      if the scheduler has not been started.
+     *
+     * @xclass
+     */
+    thread_t *getThreadX(void) const {
+
+      return thread;
+    }
+
+    /**
+     * @brief   Returns the number of started coroutines not yet terminated.
+     *
+     * @return              The number of coroutines.
+     *
+     * @xclass
+     */
+    ucnt_t getCoroutinesX(void) const {
+
+      return ncoroutines;
+    }
+  };
+
+  inline Coroutine
+  CoroutinePromise::get_return_object_on_allocation_failure(void) noexcept {
+
+    return Coroutine();
+  }
+
+  inline Coroutine CoroutinePromise::get_return_object(void) noexcept {
+
+    return Coroutine(
+             std::coroutine_handle<CoroutinePromise>::from_promise(*this));
+  }
+
+  inline void CoroutinePromise::return_void(void) noexcept {
+
+    chSysLock();
+    scheduler->ncoroutines--;
+    chSysUnlock();
+  }
+
+  inline void CoroutineAwaiter::await_suspend(
+                std::coroutine_handle<CoroutinePromise> h) noexcept {
+    CoroutinePromise *pp = &h.promise();
+    BaseCoroutineScheduler *sp = pp->scheduler;
+
+    deadline    = chTimeAddX(chVTGetSystemTimeX(), timeout);
+    pp->awaiter = this;
+    pp->next    = sp->waiting;
+    sp->waiting = pp;
+  }
+#endif /* CH_CPP_USE_COROUTINES == TRUE */
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::SynchronizationObject                                      *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief     Base class for all synchronization objects.
+   * @note      No other uses.
+   */
+  class SynchronizationObject {
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::ThreadsQueue                                               *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief     Threads queue class.
+   * @details   This class encapsulates a queue of threads.
+   */
+  class ThreadsQueue : public SynchronizationObject {
+    /**
+     * @brief   Pointer to the system thread.
+     */
+    threads_queue_t threads_queue;
+
+  public:
+    /**
+     * @brief   Threads queue constructor.
+     *
+     * @init
+     */
+    ThreadsQueue() {
+
+      chThdQueueObjectInit(&threads_queue);
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    ThreadsQueue(const ThreadsQueue &) = delete;
+    ThreadsQueue &operator=(const ThreadsQueue &) = delete;
+
+    /**
+     * @brief   Enqueues the caller thread on a threads queue object.
+     * @details The caller thread is enqueued and put to sleep until it is
+     *          dequeued or the specified timeouts expires.
+     *
+     * @param[in] timeout   the timeout in system ticks, the special values are
+     *                      handled as follow:
+     *                      - @a TIME_INFINITE the thread enters an infinite sleep
+     *                        state.
+     *                      - @a TIME_IMMEDIATE the thread is not enqueued and
+     *                        the function returns @p MSG_TIMEOUT as if a timeout
+     *                        occurred.
+     *                      .
+     * @return              The message from @p osalQueueWakeupOneI() or
+     *                      @p osalQueueWakeupAllI() functions.
+     * @retval MSG_TIMEOUT  if the thread has not been dequeued within the
+     *                      specified timeout or if the function has been
+     *                      invoked with @p TIME_IMMEDIATE as timeout
+     *                      specification.
+     *
+     * @sclass
+     */
+    msg_t enqueueSelfS(sysinterval_t timeout) {
+
+      return chThdEnqueueTimeoutS(&threads_queue, timeout);
+    }
+
+    /**
+     * @brief   Dequeues and wakes up one thread from the threads queue object,
+     *          if any.
+     *
+     * @param[in] msg       the message code
+     *
+     * @iclass
+     */
+    void dequeueNextI(msg_t msg) {
+
+      chThdDequeueNextI(&threads_queue, msg);
+    }
+
+    /**
+     * @brief   Dequeues and wakes up all threads from the threads queue object.
+     *
+     * @param[in] msg       the message code
+     *
+     * @iclass
+     */
+    void chdequeueAllI(msg_t msg) {
+
+      chThdDequeueAllI(&threads_queue, msg);
+    }
+};
+
+#if (CH_CFG_USE_SEMAPHORES == TRUE) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CounterSemaphore                                           *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Class encapsulating a semaphore.
+   */
+  class CounterSemaphore : public SynchronizationObject {
+    /**
+     * @brief   Embedded @p semaphore_t structure.
+     */
+    semaphore_t sem;
+
+  public:
+    /**
+     * @brief   CounterSemaphore constructor.
+     * @details The embedded @p Semaphore structure is initialized.
+     *
+     * @param[in] n             the semaphore counter value, must be greater
+     *                          or equal to zero
+     *
+     * @init
+     */
+    CounterSemaphore(cnt_t n) {
+
+      chSemObjectInit(&sem, n);
+    }
+
+    /**
+     * @brief   Performs a reset operation on the semaphore.
+     * @post    After invoking this function all the threads waiting on the
+     *          semaphore, if any, are released and the semaphore counter is
+     *          set to the specified, non negative, value.
+     * @note    The released threads can recognize they were waked up by a
+     *          reset rather than a signal because the @p chSemWait() will
+     *          return @p MSG_RESET instead of @p MSG_OK.
+     *
+     * @param[in] n         the new value of the semaphore counter. The value
+     *                      must be non-negative.
+     *
+     * @api
+     */
+    void reset(cnt_t n) {
+
+      chSemReset(&sem, n);
+    }
+
+    /**
+     * @brief   Performs a reset operation on the semaphore.
+     * @post    After invoking this function all the threads waiting on the
+     *          semaphore, if any, are released and the semaphore counter is
+     *          set to the specified, non negative, value.
+     * @post    This function does not reschedule so a call to a rescheduling
+     *          function must be performed before unlocking the kernel. Note
+     *          that interrupt handlers always reschedule on exit so an
+     *          explicit reschedule must not be performed in ISRs.
+     * @note    The released threads can recognize they were waked up by a
+     *          reset rather than a signal because the @p chSemWait() will
+     *          return @p MSG_RESET instead of @p MSG_OK.
+     *
+     * @param[in] n         the new value of the semaphore counter. The value
+     *                      must be non-negative.
+     *
+     * @iclass
+     */
+    void resetI(cnt_t n) {
+
+      chSemResetI(&sem, n);
+    }
+
+    /**
+     * @brief   Performs a wait operation on a semaphore.
+     *
+     * @return              A message specifying how the invoking thread has
+     *                      been released from the semaphore.
+     * @retval MSG_OK       if the thread has not stopped on the semaphore or
+     *                      the semaphore has been signaled.
+     * @retval MSG_RESET    if the semaphore has been reset using
+     *                      @p chSemReset().
+     *
+     * @api
+     */
+    msg_t wait(void) {
+
+      return chSemWait(&sem);
+    }
+
+    /**
+     * @brief   Performs a wait operation on a semaphore.
+     *
+     * @return              A message specifying how the invoking thread has
+     *                      been released from the semaphore.
+     * @retval MSG_OK       if the thread has not stopped on the semaphore or
+     *                      the semaphore has been signaled.
+     * @retval MSG_RESET    if the semaphore has been reset using
+     *                      @p chSemReset().
+     *
+     * @sclass
+     */
+    msg_t waitS(void) {
+
+      return chSemWaitS(&sem);
+    }
+
+    /**
+     * @brief   Performs a wait operation on a semaphore with timeout
+     *          specification.
+     *
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              A message specifying how the invoking thread has
+     *                      been released from the semaphore.
+     * @retval MSG_OK       if the thread has not stopped on the semaphore or
+     *                      the semaphore has been signaled.
+     * @retval MSG_RESET    if the semaphore has been reset using
+     *                      @p chSemReset().
+     * @retval MSG_TIMEOUT  if the semaphore has not been signaled or reset
+     *                      within the specified timeout.
+     *
+     * @api
+     */
+    msg_t wait(sysinterval_t timeout) {
+
+      return chSemWaitTimeout(&sem, timeout);
+    }
+
+#if (CH_CPP_USE_COROUTINES == TRUE) || defined(__DOXYGEN__)
+    /**
+     * @brief   Awaitable wait operation on the semaphore.
+     * @note    Only usable in coroutines using @p co_await, the operation
+     *          is polled by the coroutines scheduler.
+     *
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The awaitable object, the @p co_await expression
+     *                      returns the operation status.
+     *
+     * @api
+     */
+    PollAwaiter waitAsync(sysinterval_t timeout = TIME_INFINITE) {
+
+      return PollAwaiter([](void *obj, void *arg) -> msg_t {
+                           (void)arg;
+                           return chSemWaitTimeout(
+                                    static_cast<semaphore_t *>(obj),
+                                    TIME_IMMEDIATE);
+                         }, &sem, nullptr, timeout);
+    }
+#endif /* CH_CPP_USE_COROUTINES == TRUE */
+
+    /**
+     * @brief   Performs a wait operation on a semaphore with timeout
+     *          specification.
+     *
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              A message specifying how the invoking thread has
+     *                      been released from the semaphore.
+     * @retval MSG_OK       if the thread has not stopped on the semaphore or
+     *                      the semaphore has been signaled.
+     * @retval MSG_RESET    if the semaphore has been reset using
+     *                      @p chSemReset().
+     * @retval MSG_TIMEOUT  if the semaphore has not been signaled or reset
+     *                      within the specified timeout.
+     *
+     * @sclass
+     */
+    msg_t waitS(sysinterval_t timeout) {
+
+      return chSemWaitTimeoutS(&sem, timeout);
+    }
+
+    /**
+     * @brief   Performs a signal operation on a semaphore.
+     *
+     * @api
+     */
+    void signal(void) {
+
+      chSemSignal(&sem);
+    }
+
+    /**
+     * @brief   Performs a signal operation on a semaphore.
      * @post    This function does not reschedule so a call to a rescheduling
      *          function must be performed before unlocking the kernel. Note
      *          that interrupt handlers always reschedule on exit so an
@@ -1850,6 +2728,33 @@ namespace chibios_rt {
       return chBSemWaitTimeout(&bsem, timeout);
     }
 
+#if (CH_CPP_USE_COROUTINES == TRUE) || defined(__DOXYGEN__)
+    /**
+     * @brief   Awaitable wait operation on the binary semaphore.
+     * @note    Only usable in coroutines using @p co_await, the operation
+     *          is polled by the coroutines scheduler.
+     *
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The awaitable object, the @p co_await expression
+     *                      returns the operation status.
+     *
+     * @api
+     */
+    PollAwaiter waitAsync(sysinterval_t timeout = TIME_INFINITE) {
+
+      return PollAwaiter([](void *obj, void *arg) -> msg_t {
+                           (void)arg;
+                           return chBSemWaitTimeout(
+                                    static_cast<binary_semaphore_t *>(obj),
+                                    TIME_IMMEDIATE);
+                         }, &bsem, nullptr, timeout);
+    }
+#endif /* CH_CPP_USE_COROUTINES == TRUE */
+
     /**
      * @brief   Wait operation on the binary semaphore.
      *
@@ -2218,89 +3123,411 @@ namespace chibios_rt {
 
       chDbgCheck(var < N);
 
-      return chCondWaitTimeoutS(&condvars[var], timeout);
+      return chCondWaitTimeoutS(&condvars[var], timeout);
+    }
+#endif /* CH_CFG_USE_CONDVARS_TIMEOUT == TRUE */
+
+  public:
+    /**
+     * @brief   Monitor object constructor.
+     *
+     * @init
+     */
+    Monitor(void) : Mutex() {
+
+      for (unsigned i = 0; i < N; i++) {
+        chCondObjectInit(&condvars[i]);
+      }
+    }
+
+    /**
+     * @brief   Signals one thread that is waiting on the condition variable.
+     *
+     * @param[in] var       the condition variable index
+     *
+     * @api
+     */
+    void signal(unsigned var) {
+
+      chDbgCheck(var < N);
+
+      chCondSignal(&condvars[var]);
+    }
+
+    /**
+     * @brief   Signals one thread that is waiting on the condition variable.
+     * @post    This function does not reschedule so a call to a rescheduling
+     *          function must be performed before unlocking the kernel. Note
+     *          that interrupt handlers always reschedule on exit so an
+     *          explicit reschedule must not be performed in ISRs.
+     *
+     * @param[in] var       the condition variable index
+     *
+     * @iclass
+     */
+    void signalI(unsigned var) {
+
+      chDbgCheck(var < N);
+
+      chCondSignalI(&condvars[var]);
+    }
+
+    /**
+     * @brief   Signals all threads that are waiting on the condition variable.
+     *
+     * @param[in] var       the condition variable index
+     *
+     * @api
+     */
+    void broadcast(unsigned var) {
+
+      chDbgCheck(var < N);
+
+      chCondBroadcast(&condvars[var]);
+    }
+
+    /**
+     * @brief   Signals all threads that are waiting on the condition variable.
+     * @post    This function does not reschedule so a call to a rescheduling
+     *          function must be performed before unlocking the kernel. Note
+     *          that interrupt handlers always reschedule on exit so an
+     *          explicit reschedule must not be performed in ISRs.
+     *
+     * @param[in] var       the condition variable index
+     *
+     * @iclass
+     */
+    void broadcastI(unsigned var) {
+
+      chDbgCheck(var < N);
+
+      chCondBroadcastI(&condvars[var]);
+    }
+  };
+
+#endif /* CH_CFG_USE_CONDVARS == TRUE */
+
+#if (CH_CFG_USE_RWLOCKS == TRUE) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::RWLock                                                     *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Class encapsulating a readers-writer lock.
+   */
+  class RWLock {
+    /**
+     * @brief   Embedded @p rwlock_t structure.
+     */
+    rwlock_t rwlock;
+
+  public:
+    /**
+     * @brief   RWLock object constructor.
+     * @details The embedded @p rwlock_t structure is initialized.
+     *
+     * @init
+     */
+    RWLock(void) {
+
+      chRWLockObjectInit(&rwlock);
+    }
+
+    /**
+     * @brief   Tries to lock the readers-writer lock for reading.
+     *
+     * @return              The operation status.
+     * @retval true         if the lock has been successfully acquired
+     * @retval false        if the lock attempt failed.
+     *
+     * @api
+     */
+    bool tryReadLock(void) {
+
+      return chRWLockTryReadLock(&rwlock);
+    }
+
+    /**
+     * @brief   Locks the readers-writer lock for reading.
+     *
+     * @api
+     */
+    void readLock(void) {
+
+      chRWLockReadLock(&rwlock);
+    }
+
+    /**
+     * @brief   Locks the readers-writer lock for reading.
+     *
+     * @param[in] timeout   the number of ticks before the operation timeouts
+     * @return              The operation status.
+     * @retval MSG_OK       if the lock has been acquired.
+     * @retval MSG_TIMEOUT  if the lock has not been acquired within the
+     *                      specified timeout.
+     *
+     * @api
+     */
+    msg_t readLock(sysinterval_t timeout) {
+
+      return chRWLockReadLockTimeout(&rwlock, timeout);
+    }
+
+    /**
+     * @brief   Unlocks the readers-writer lock owned for reading.
+     *
+     * @api
+     */
+    void readUnlock(void) {
+
+      chRWLockReadUnlock(&rwlock);
+    }
+
+    /**
+     * @brief   Tries to lock the readers-writer lock for writing.
+     *
+     * @return              The operation status.
+     * @retval true         if the lock has been successfully acquired
+     * @retval false        if the lock attempt failed.
+     *
+     * @api
+     */
+    bool tryWriteLock(void) {
+
+      return chRWLockTryWriteLock(&rwlock);
+    }
+
+    /**
+     * @brief   Locks the readers-writer lock for writing.
+     * @post    The lock is inserted in the per-thread stack of owned
+     *          mutexes.
+     *
+     * @api
+     */
+    void writeLock(void) {
+
+      chRWLockWriteLock(&rwlock);
+    }
+
+    /**
+     * @brief   Locks the readers-writer lock for writing.
+     * @post    The lock is inserted in the per-thread stack of owned
+     *          mutexes.
+     *
+     * @param[in] timeout   the number of ticks before the operation timeouts
+     * @return              The operation status.
+     * @retval MSG_OK       if the lock has been acquired.
+     * @retval MSG_TIMEOUT  if the lock has not been acquired within the
+     *                      specified timeout.
+     *
+     * @api
+     */
+    msg_t writeLock(sysinterval_t timeout) {
+
+      return chRWLockWriteLockTimeout(&rwlock, timeout);
+    }
+
+    /**
+     * @brief   Unlocks the readers-writer lock owned for writing.
+     * @pre     The lock must be the last mutex or lock acquired by the
+     *          invoking thread.
+     *
+     * @api
+     */
+    void writeUnlock(void) {
+
+      chRWLockWriteUnlock(&rwlock);
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::ReadLocker                                                 *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   RAII helper for readers-writer locks, read side.
+   */
+  class ReadLocker
+  {
+    RWLock& rwlock;
+
+  public:
+      ReadLocker(RWLock& l) : rwlock(l) {
+
+        rwlock.readLock();
+      }
+
+      ~ReadLocker() {
+
+        rwlock.readUnlock();
+      }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::WriteLocker                                                *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   RAII helper for readers-writer locks, write side.
+   */
+  class WriteLocker
+  {
+    RWLock& rwlock;
+
+  public:
+      WriteLocker(RWLock& l) : rwlock(l) {
+
+        rwlock.writeLock();
+      }
+
+      ~WriteLocker() {
+
+        rwlock.writeUnlock();
+      }
+  };
+#endif /* CH_CFG_USE_RWLOCKS == TRUE */
+
+#if (CH_CFG_USE_PCMUTEXES == TRUE) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::PCMutex                                                    *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Class encapsulating a priority ceiling mutex.
+   */
+  class PCMutex {
+    /**
+     * @brief   Embedded @p pcmutex_t structure.
+     */
+    pcmutex_t pcmutex;
+
+  public:
+    /**
+     * @brief   PCMutex object constructor.
+     * @details The embedded @p pcmutex_t structure is initialized.
+     *
+     * @param[in] ceiling   the priority ceiling
+     *
+     * @init
+     */
+    PCMutex(tprio_t ceiling) {
+
+      chPCMtxObjectInit(&pcmutex, ceiling);
+    }
+
+    /**
+     * @brief   Tries to lock the mutex.
+     * @post    The mutex is locked and the thread priority is raised to the
+     *          mutex ceiling.
+     *
+     * @return              The operation status.
+     * @retval true         if the mutex has been successfully acquired
+     * @retval false        if the lock attempt failed.
+     *
+     * @api
+     */
+    bool tryLock(void) {
+
+      return chPCMtxTryLock(&pcmutex);
     }
-#endif /* CH_CFG_USE_CONDVARS_TIMEOUT == TRUE */
 
-  public:
     /**
-     * @brief   Monitor object constructor.
+     * @brief   Tries to lock the mutex.
+     * @post    The mutex is locked and the thread priority is raised to the
+     *          mutex ceiling.
      *
-     * @init
+     * @return              The operation status.
+     * @retval true         if the mutex has been successfully acquired
+     * @retval false        if the lock attempt failed.
+     *
+     * @sclass
      */
-    Monitor(void) : Mutex() {
+    bool tryLockS(void) {
 
-      for (unsigned i = 0; i < N; i++) {
-        chCondObjectInit(&condvars[i]);
-      }
+      return chPCMtxTryLockS(&pcmutex);
     }
 
     /**
-     * @brief   Signals one thread that is waiting on the condition variable.
-     *
-     * @param[in] var       the condition variable index
+     * @brief   Locks the mutex.
+     * @post    The mutex is locked and the thread priority is raised to the
+     *          mutex ceiling.
      *
      * @api
      */
-    void signal(unsigned var) {
-
-      chDbgCheck(var < N);
+    void lock(void) {
 
-      chCondSignal(&condvars[var]);
+      chPCMtxLock(&pcmutex);
     }
 
     /**
-     * @brief   Signals one thread that is waiting on the condition variable.
-     * @post    This function does not reschedule so a call to a rescheduling
-     *          function must be performed before unlocking the kernel. Note
-     *          that interrupt handlers always reschedule on exit so an
-     *          explicit reschedule must not be performed in ISRs.
-     *
-     * @param[in] var       the condition variable index
+     * @brief   Locks the mutex.
+     * @post    The mutex is locked and the thread priority is raised to the
+     *          mutex ceiling.
      *
-     * @iclass
+     * @sclass
      */
-    void signalI(unsigned var) {
-
-      chDbgCheck(var < N);
+    void lockS(void) {
 
-      chCondSignalI(&condvars[var]);
+      chPCMtxLockS(&pcmutex);
     }
 
     /**
-     * @brief   Signals all threads that are waiting on the condition variable.
-     *
-     * @param[in] var       the condition variable index
+     * @brief   Unlocks the mutex.
+     * @post    The mutex is unlocked and the thread returns to the priority
+     *          it had before locking the mutex.
      *
      * @api
      */
-    void broadcast(unsigned var) {
-
-      chDbgCheck(var < N);
+    void unlock(void) {
 
-      chCondBroadcast(&condvars[var]);
+      chPCMtxUnlock(&pcmutex);
     }
 
     /**
-     * @brief   Signals all threads that are waiting on the condition variable.
+     * @brief   Unlocks the mutex.
+     * @post    The mutex is unlocked and the thread returns to the priority
+     *          it had before locking the mutex.
      * @post    This function does not reschedule so a call to a rescheduling
-     *          function must be performed before unlocking the kernel. Note
-     *          that interrupt handlers always reschedule on exit so an
-     *          explicit reschedule must not be performed in ISRs.
-     *
-     * @param[in] var       the condition variable index
+     *          function must be performed before unlocking the kernel.
      *
-     * @iclass
+     * @sclass
      */
-    void broadcastI(unsigned var) {
+    void unlockS(void) {
 
-      chDbgCheck(var < N);
+      chPCMtxUnlockS(&pcmutex);
+    }
 
-      chCondBroadcastI(&condvars[var]);
+    /**
+     * @brief   Returns the priority ceiling of the mutex.
+     *
+     * @return              The priority ceiling.
+     *
+     * @xclass
+     */
+    tprio_t getCeilingX(void) {
+
+      return chPCMtxGetCeilingX(&pcmutex);
     }
   };
 
-#endif /* CH_CFG_USE_CONDVARS == TRUE */
+  /*------------------------------------------------------------------------*
+   * chibios_rt::PCMutexLocker                                              *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   RAII helper for priority ceiling mutexes.
+   */
+  class PCMutexLocker
+  {
+    PCMutex& pcmutex;
+
+  public:
+      PCMutexLocker(PCMutex& m) : pcmutex(m) {
+
+        pcmutex.lock();
+      }
+
+      ~PCMutexLocker() {
+
+        pcmutex.unlock();
+      }
+  };
+#endif /* CH_CFG_USE_PCMUTEXES == TRUE */
 #endif /* CH_CFG_USE_MUTEXES == TRUE */
 
 #if (CH_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
@@ -2653,6 +3880,35 @@ namespace chibios_rt {
       return chMBFetchTimeout(&mb, reinterpret_cast<msg_t*>(msgp), timeout);
     }
 
+#if (CH_CPP_USE_COROUTINES == TRUE) || defined(__DOXYGEN__)
+    /**
+     * @brief   Awaitable retrieval of a message from a mailbox.
+     * @note    Only usable in coroutines using @p co_await, the operation
+     *          is polled by the coroutines scheduler.
+     *
+     * @param[out] msgp     pointer to a message variable for the received
+     *                      message
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The awaitable object, the @p co_await expression
+     *                      returns the operation status.
+     *
+     * @api
+     */
+    PollAwaiter fetchAsync(T *msgp, sysinterval_t timeout = TIME_INFINITE) {
+
+      return PollAwaiter([](void *obj, void *arg) -> msg_t {
+                           return chMBFetchTimeout(
+                                    static_cast<mailbox_t *>(obj),
+                                    static_cast<msg_t *>(arg),
+                                    TIME_IMMEDIATE);
+                         }, &mb, reinterpret_cast<msg_t *>(msgp), timeout);
+    }
+#endif /* CH_CPP_USE_COROUTINES == TRUE */
+
     /**
      * @brief   Retrieves a message from a mailbox.
      * @details The invoking thread waits until a message is posted in the
@@ -2981,8 +4237,397 @@ namespace chibios_rt {
                                                        this));
      }
    };
+
+#if (CH_CPP_USE_COROUTINES == TRUE) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineScheduler                                         *
+   *------------------------------------------------------------------------*/
+  template <typename... Args>
+  inline void *CoroutinePromise::operator new(size_t size,
+                                              BaseCoroutineScheduler &sched,
+                                              Args &...) noexcept {
+
+    return sched.allocFrame(size);
+  }
+
+  template <typename T, typename... Args>
+  inline void *CoroutinePromise::operator new(size_t size, T &,
+                                              BaseCoroutineScheduler &sched,
+                                              Args &...) noexcept {
+
+    return sched.allocFrame(size);
+  }
+
+  inline void CoroutinePromise::operator delete(void *p) noexcept {
+
+    BaseCoroutineScheduler::freeFrame(p);
+  }
+
+  inline void *BaseCoroutineScheduler::allocFrame(size_t size) {
+    uint8_t *p;
+
+    if (size > frame_size) {
+      return nullptr;
+    }
+
+    p = static_cast<uint8_t *>(frames->alloc());
+    if (p == nullptr) {
+      return nullptr;
+    }
+
+    /* The pool is recorded in front of the frame for the release.*/
+    *reinterpret_cast<MemoryPool **>(p) = frames;
+
+    return p + frameAlign;
+  }
+
+  inline void BaseCoroutineScheduler::freeFrame(void *p) {
+    uint8_t *bp = static_cast<uint8_t *>(p) - frameAlign;
+
+    (*reinterpret_cast<MemoryPool **>(bp))->free(bp);
+  }
+
+  /**
+   * @brief   Template class encapsulating a coroutines scheduler, its
+   *          thread and its frames pool.
+   *
+   * @param W               the working area size of the scheduler thread
+   * @param S               the maximum size of a coroutine frame
+   * @param N               the number of coroutine frames
+   */
+  template <int W, size_t S, size_t N>
+  class CoroutineScheduler : public BaseStaticThread<W>,
+                             public BaseCoroutineScheduler {
+    static constexpr size_t frame_stride =
+      ((S + frameAlign + frameAlign - 1U) / frameAlign) * frameAlign;
+
+    alignas(frameAlign) uint8_t frames_buf[N][frame_stride];
+    MemoryPool frames_pool;
+
+  public:
+    /**
+     * @brief   CoroutineScheduler constructor.
+     *
+     * @param[in] poll      the interval between checks of the polled
+     *                      operations
+     *
+     * @init
+     */
+    CoroutineScheduler(sysinterval_t poll = TIME_MS2I(10)) :
+      BaseCoroutineScheduler(&frames_pool, S, poll),
+      frames_pool(frame_stride, frames_buf, N) {
+    }
+
+    /**
+     * @brief   Scheduler thread body.
+     *
+     * @api
+     */
+    void main(void) override {
+
+      BaseThread::setName("coroutines");
+      run();
+    }
+  };
+#endif /* CH_CPP_USE_COROUTINES == TRUE */
 #endif /* CH_CFG_USE_MEMPOOLS == TRUE */
 
+#if (CH_CFG_USE_OBJ_FIFOS == TRUE) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::Channel                                                    *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Template class encapsulating a channel of objects.
+   * @details Objects are constructed into the channel storage on send and
+   *          destroyed when the receiver releases them, the storage is
+   *          returned to the channel automatically.
+   *
+   * @param T               type of the objects
+   * @param N               capacity of the channel
+   */
+  template <typename T, size_t N>
+  class Channel {
+    static_assert(N > 0U, "Channel capacity must be non-zero");
+
+    static constexpr size_t obj_align = alignof (T) > PORT_NATURAL_ALIGN ?
+                                        alignof (T) : PORT_NATURAL_ALIGN;
+    static constexpr size_t obj_size =
+      (((sizeof (T) > sizeof (void *) ? sizeof (T) : sizeof (void *)) +
+        obj_align - 1U) / obj_align) * obj_align;
+
+    alignas(obj_align) uint8_t obj_buf[N][obj_size];
+    msg_t msg_buf[N];
+
+    /**
+     * @brief   Embedded @p objects_fifo_t structure.
+     */
+    objects_fifo_t fifo;
+
+    /**
+     * @brief   Destroys an object and returns its storage to the channel.
+     *
+     * @param[in] objp      pointer to the object
+     *
+     * @api
+     */
+    void dispose(T *objp) {
+
+      objp->~T();
+      chFifoReturnObject(&fifo, static_cast<void *>(objp));
+    }
+
+  public:
+    /*----------------------------------------------------------------------*
+     * chibios_rt::Channel::Message                                         *
+     *----------------------------------------------------------------------*/
+    /**
+     * @brief   Handle of a received object.
+     * @details The object is destroyed and its storage returned to the
+     *          channel when the handle goes out of scope.
+     */
+    class Message {
+      friend class Channel;
+
+      /**
+       * @brief   Channel owning the object storage.
+       */
+      Channel *channel;
+      /**
+       * @brief   Pointer to the object or @p nullptr.
+       */
+      T *objp;
+
+      /**
+       * @brief   Message constructor.
+       *
+       * @init
+       */
+      Message(Channel *cp, T *p) : channel(cp), objp(p) {
+
+      }
+
+    public:
+      /**
+       * @brief   Message constructor.
+       * @details An empty handle is created.
+       *
+       * @init
+       */
+      Message(void) : channel(nullptr), objp(nullptr) {
+
+      }
+
+      /* Prohibit copy construction and assignment, but allow move.*/
+      Message(const Message &) = delete;
+      Message &operator=(const Message &) = delete;
+      Message(Message &&other) : channel(other.channel), objp(other.objp) {
+
+        other.objp = nullptr;
+      }
+      Message &operator=(Message &&other) {
+
+        if (this != &other) {
+          reset();
+          channel    = other.channel;
+          objp       = other.objp;
+          other.objp = nullptr;
+        }
+        return *this;
+      }
+
+      /**
+       * @brief   Message destructor.
+       * @details The object, if any, is returned to the channel.
+       */
+      ~Message() {
+
+        reset();
+      }
+
+      /**
+       * @brief   Returns the object to the channel.
+       * @post    The handle is empty.
+       *
+       * @api
+       */
+      void reset(void) {
+
+        if (objp != nullptr) {
+          channel->dispose(objp);
+          objp = nullptr;
+        }
+      }
+
+      /**
+       * @brief   Returns @p true if the handle contains an object.
+       *
+       * @xclass
+       */
+      explicit operator bool() const {
+
+        return objp != nullptr;
+      }
+
+      /**
+       * @brief   Returns a pointer to the object.
+       *
+       * @xclass
+       */
+      T *get(void) const {
+
+        return objp;
+      }
+
+      /**
+       * @brief   Object access.
+       *
+       * @xclass
+       */
+      T &operator*(void) const {
+
+        return *objp;
+      }
+
+      /**
+       * @brief   Object access.
+       *
+       * @xclass
+       */
+      T *operator->(void) const {
+
+        return objp;
+      }
+    };
+
+    /**
+     * @brief   Channel constructor.
+     *
+     * @init
+     */
+    Channel(void) {
+
+      chFifoObjectInitAligned(&fifo, obj_size, N, (unsigned)obj_align,
+                              obj_buf, msg_buf);
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    Channel(const Channel &) = delete;
+    Channel &operator=(const Channel &) = delete;
+
+    /**
+     * @brief   Returns the channel capacity.
+     *
+     * @xclass
+     */
+    static constexpr size_t getCapacityX(void) {
+
+      return N;
+    }
+
+    /**
+     * @brief   Constructs an object into the channel and sends it.
+     * @details The invoking thread waits until a free object becomes
+     *          available or the specified time runs out.
+     *
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @param[in] args      the object constructor arguments
+     * @return              The operation status.
+     * @retval MSG_OK       if the object has been sent.
+     * @retval MSG_TIMEOUT  if the operation has timed out.
+     *
+     * @api
+     */
+    template <typename... Args>
+    msg_t emplace(sysinterval_t timeout, Args &&... args) {
+      void *p;
+
+      p = chFifoTakeObjectTimeout(&fifo, timeout);
+      if (p == nullptr) {
+        return MSG_TIMEOUT;
+      }
+
+      new (p) T(static_cast<Args &&>(args)...);
+      chFifoSendObject(&fifo, p);
+
+      return MSG_OK;
+    }
+
+    /**
+     * @brief   Moves an object into the channel and sends it.
+     * @details The invoking thread waits until a free object becomes
+     *          available or the specified time runs out.
+     *
+     * @param[in] obj       the object to be sent
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval MSG_OK       if the object has been sent.
+     * @retval MSG_TIMEOUT  if the operation has timed out, the object is
+     *                      not moved.
+     *
+     * @api
+     */
+    msg_t send(T &&obj, sysinterval_t timeout = TIME_INFINITE) {
+
+      return emplace(timeout, static_cast<T &&>(obj));
+    }
+
+    /**
+     * @brief   Copies an object into the channel and sends it.
+     * @details The invoking thread waits until a free object becomes
+     *          available or the specified time runs out.
+     *
+     * @param[in] obj       the object to be sent
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval MSG_OK       if the object has been sent.
+     * @retval MSG_TIMEOUT  if the operation has timed out.
+     *
+     * @api
+     */
+    msg_t send(const T &obj, sysinterval_t timeout = TIME_INFINITE) {
+
+      return emplace(timeout, obj);
+    }
+
+    /**
+     * @brief   Receives an object from the channel.
+     * @details The invoking thread waits until an object is sent or the
+     *          specified time runs out.
+     *
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The handle of the received object, the handle
+     *                      is empty if the operation has timed out.
+     *
+     * @api
+     */
+    Message receive(sysinterval_t timeout = TIME_INFINITE) {
+      void *p = nullptr;
+
+      if (chFifoReceiveObjectTimeout(&fifo, &p, timeout) != MSG_OK) {
+        return Message();
+      }
+
+      return Message(this, static_cast<T *>(p));
+    }
+  };
+#endif /* CH_CFG_USE_OBJ_FIFOS == TRUE */
+
 #if (CH_CFG_USE_HEAP == TRUE) || defined(__DOXYGEN__)
   /*------------------------------------------------------------------------*
    * chibios_rt::Heap                                                       *
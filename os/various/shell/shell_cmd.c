@@ -164,7 +164,8 @@ static void cmd_threads(BaseSequentialStream *chp, int argc, char *argv[]) {
 #else
     core_id = 0U;
 #endif
-#if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE)
+#if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE) ||  \
+    (CH_DBG_STACK_PROFILER == TRUE)
     uint32_t stklimit = (uint32_t)tp->wabase;
 #else
     uint32_t stklimit = 0U;
@@ -183,6 +184,126 @@ static void cmd_threads(BaseSequentialStream *chp, int argc, char *argv[]) {
 }
 #endif
 
+#if ((SHELL_CMD_STACK_ENABLED == TRUE) && (CH_DBG_STACK_PROFILER == TRUE)) || \
+    defined(__DOXYGEN__)
+static void cmd_stack(BaseSequentialStream *chp, int argc, char *argv[]) {
+  thread_t *tp;
+
+  (void)argv;
+  if (argc > 0) {
+    shellUsage(chp, "stack");
+    return;
+  }
+  chprintf(chp, "    addr     size     peak   unused         name" SHELL_NEWLINE_STR);
+  tp = chRegFirstThread();
+  do {
+    uint32_t peak, unused;
+
+    chStkProfUpdate(tp);
+    peak   = (uint32_t)chStkProfGetPeakX(tp);
+    unused = (uint32_t)chStkProfGetUnusedX(tp);
+    chprintf(chp, "%08lx %8lu %8lu %8lu %12s" SHELL_NEWLINE_STR,
+             (uint32_t)tp,
+             peak + unused,
+             peak,
+             unused,
+             tp->name == NULL ? "" : tp->name);
+    tp = chRegNextThread(tp);
+  } while (tp != NULL);
+}
+#endif
+
+#if ((SHELL_CMD_RECORDER_ENABLED == TRUE) && (CH_DBG_RECORDER == TRUE)) ||   \
+    defined(__DOXYGEN__)
+static void cmd_recorder(BaseSequentialStream *chp, int argc, char *argv[]) {
+  static const char *types[] = {"", "ready", "switch", "isr-in", "isr-out",
+                                "halt", "user", ""};
+  rec_history_t h;
+  rec_event_t e;
+  size_t i, n;
+
+  if ((argc == 0) || ((argc == 1) && !strcmp(argv[0], "previous"))) {
+    h = CH_REC_PREVIOUS;
+  }
+  else if ((argc == 1) && !strcmp(argv[0], "current")) {
+    h = CH_REC_CURRENT;
+  }
+  else {
+    shellUsage(chp, "recorder [previous|current]");
+    return;
+  }
+  chSysLock();
+  n = chRecGetSizeI(h);
+  chSysUnlock();
+  chprintf(chp, "boots: %lu, events: %lu" SHELL_NEWLINE_STR,
+           chRecGetBootsX(), (uint32_t)n);
+  chprintf(chp, "   n    stamp    type state    value" SHELL_NEWLINE_STR);
+  for (i = 0U; i < n; i++) {
+    bool b;
+
+    chSysLock();
+    b = chRecGetEventI(h, i, &e);
+    chSysUnlock();
+    if (b) {
+      break;
+    }
+    chprintf(chp, "%4lu %08lx %7s %5lu %08lx" SHELL_NEWLINE_STR,
+             (uint32_t)i,
+             (uint32_t)CH_REC_EVENT_STAMP(&e),
+             types[CH_REC_EVENT_TYPE(&e)],
+             (uint32_t)CH_REC_EVENT_STATE(&e),
+             e.value);
+  }
+}
+#endif
+
+#if ((SHELL_CMD_CRITICAL_ENABLED == TRUE) && (CH_DBG_CS_PROFILER == TRUE)) ||  \
+    defined(__DOXYGEN__)
+static void cmd_critical(BaseSequentialStream *chp, int argc, char *argv[]) {
+  csprof_record_t r;
+  csprof_site_t s;
+  unsigned i, j;
+  bool b;
+
+  if ((argc == 1) && !strcmp(argv[0], "reset")) {
+    chCSProfReset();
+    return;
+  }
+  if (argc > 0) {
+    shellUsage(chp, "critical [reset]");
+    return;
+  }
+  chprintf(chp, "    site   cycles" SHELL_NEWLINE_STR);
+  for (i = 0U; i < (unsigned)CH_DBG_CS_PROFILER_TOP; i++) {
+    chSysLock();
+    b = chCSProfGetTopI(i, &r);
+    chSysUnlock();
+    if (b) {
+      break;
+    }
+    chprintf(chp, "%08lx %8lu" SHELL_NEWLINE_STR,
+             (uint32_t)(uintptr_t)r.site, (uint32_t)r.duration);
+  }
+  chprintf(chp, SHELL_NEWLINE_STR "    site        n    worst histogram"
+                SHELL_NEWLINE_STR);
+  for (i = 0U; i < (unsigned)CH_DBG_CS_PROFILER_SITES; i++) {
+    chSysLock();
+    b = chCSProfGetSiteI(i, &s);
+    chSysUnlock();
+    if (b) {
+      continue;
+    }
+    chprintf(chp, "%08lx %8lu %8lu",
+             (uint32_t)(uintptr_t)s.site, (uint32_t)s.n, (uint32_t)s.worst);
+    for (j = 0U; j < (unsigned)CH_DBG_CS_PROFILER_BUCKETS; j++) {
+      chprintf(chp, " %lu", (uint32_t)s.hist[j]);
+    }
+    chprintf(chp, SHELL_NEWLINE_STR);
+  }
+  chprintf(chp, "lost: %lu" SHELL_NEWLINE_STR, (uint32_t)currcore->csprof.lost);
+}
+#endif
+
 #if (SHELL_CMD_TEST_ENABLED == TRUE) || defined(__DOXYGEN__)
 static THD_FUNCTION(test_rt, arg) {
   BaseSequentialStream *chp = (BaseSequentialStream *)arg;
@@ -250,6 +371,15 @@ const ShellCommand shell_local_commands[] = {
 #if SHELL_CMD_THREADS_ENABLED == TRUE
   {"threads", cmd_threads},
 #endif
+#if (SHELL_CMD_STACK_ENABLED == TRUE) && (CH_DBG_STACK_PROFILER == TRUE)
+  {"stack", cmd_stack},
+#endif
+#if (SHELL_CMD_RECORDER_ENABLED == TRUE) && (CH_DBG_RECORDER == TRUE)
+  {"recorder", cmd_recorder},
+#endif
+#if (SHELL_CMD_CRITICAL_ENABLED == TRUE) && (CH_DBG_CS_PROFILER == TRUE)
+  {"critical", cmd_critical},
+#endif
 #if SHELL_CMD_TEST_ENABLED == TRUE
   {"test", cmd_test},
 #endif
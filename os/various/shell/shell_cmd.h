@@ -57,6 +57,18 @@
 #define SHELL_CMD_THREADS_ENABLED           TRUE
 #endif
 
+#if !defined(SHELL_CMD_STACK_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_STACK_ENABLED             TRUE
+#endif
+
+#if !defined(SHELL_CMD_RECORDER_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_RECORDER_ENABLED          TRUE
+#endif
+
+#if !defined(SHELL_CMD_CRITICAL_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_CRITICAL_ENABLED          TRUE
+#endif
+
 #if !defined(SHELL_CMD_TEST_ENABLED) || defined(__DOXYGEN__)
 #define SHELL_CMD_TEST_ENABLED              TRUE
 #endif
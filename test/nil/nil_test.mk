@@ -7,7 +7,8 @@ TESTSRC += ${CHIBIOS}/test/nil/source/test/nil_test_root.c \
            ${CHIBIOS}/test/nil/source/test/nil_test_sequence_005.c \
            ${CHIBIOS}/test/nil/source/test/nil_test_sequence_006.c \
            ${CHIBIOS}/test/nil/source/test/nil_test_sequence_007.c \
-           ${CHIBIOS}/test/nil/source/test/nil_test_sequence_008.c
+           ${CHIBIOS}/test/nil/source/test/nil_test_sequence_008.c \
+           ${CHIBIOS}/test/nil/source/test/nil_test_sequence_009.c
 
 # Required include directories
 TESTINC += ${CHIBIOS}/test/nil/source/test
@@ -29,6 +29,7 @@
  * - @subpage nil_test_sequence_006
  * - @subpage nil_test_sequence_007
  * - @subpage nil_test_sequence_008
+ * - @subpage nil_test_sequence_009
  * .
  */
 
@@ -64,6 +65,7 @@ const testsequence_t * const nil_test_suite_array[] = {
   &nil_test_sequence_007,
 #endif
   &nil_test_sequence_008,
+  &nil_test_sequence_009,
   NULL
 };
 
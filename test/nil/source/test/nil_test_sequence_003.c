@@ -31,6 +31,7 @@
  *
  * <h2>Test Cases</h2>
  * - @subpage nil_test_003_001
+ * - @subpage nil_test_003_002
  * .
  */
 
@@ -40,6 +41,28 @@
 
 #include "ch.h"
 
+static THD_WORKING_AREA(wa_sleeper, 128);
+static thread_reference_t tr1;
+
+static THD_FUNCTION(waiter, p) {
+  msg_t msg;
+
+  (void)p;
+  chSysLock();
+  msg = chThdSuspendTimeoutS(&tr1, TIME_MS2I(100));
+  chSysUnlock();
+  test_emit_token(msg == MSG_OK ? 'C' : 'X');
+}
+
+static THD_FUNCTION(sleeper, p) {
+
+  (void)p;
+  chThdSleepMilliseconds(10);
+  test_emit_token('A');
+  chThdSleepMilliseconds(30);
+  test_emit_token('D');
+}
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -141,6 +164,94 @@ static const testcase_t nil_test_003_001 = {
   nil_test_003_001_execute
 };
 
+/**
+ * @page nil_test_003_002 [3.2] Concurrent timeouts
+ *
+ * <h2>Description</h2>
+ * Three threads wait with different timeouts at the same time, one of the
+ * waits is terminated before its timeout. The threads must be woken up in
+ * deadline order and the terminated wait must not time out later.
+ *
+ * <h2>Test Steps</h2>
+ * - [3.2.1] Starting a higher priority thread waiting for a resume with a
+ *   100 milliseconds timeout and a lower priority thread sleeping for 10
+ *   then 30 milliseconds.
+ * - [3.2.2] Sleeping for 20 milliseconds then resuming the waiting thread
+ *   before its timeout.
+ * - [3.2.3] Waiting for the threads to terminate, the tokens must be
+ *   emitted in deadline order and the last wakeup must happen after 40
+ *   milliseconds.
+ * .
+ */
+
+static void nil_test_003_002_setup(void) {
+  tr1 = NULL;
+}
+
+static void nil_test_003_002_execute(void) {
+  thread_t *tp1, *tp2;
+  systime_t time;
+
+  /* [3.2.1] Starting a higher priority thread waiting for a resume with a
+     100 milliseconds timeout and a lower priority thread sleeping for 10
+     then 30 milliseconds.*/
+  test_set_step(1);
+  {
+    thread_descriptor_t td1 = {
+      .name  = "waiter",
+      .wbase = wa_common,
+      .wend  = THD_WORKING_AREA_END(wa_common),
+      .prio  = chThdGetPriorityX() - 1,
+      .funcp = waiter,
+      .arg   = NULL
+    };
+    thread_descriptor_t td2 = {
+      .name  = "sleeper",
+      .wbase = wa_sleeper,
+      .wend  = THD_WORKING_AREA_END(wa_sleeper),
+      .prio  = (tprio_t)(CH_CFG_MAX_THREADS - 1),
+      .funcp = sleeper,
+      .arg   = NULL
+    };
+
+    time = test_wait_tick();
+    tp1 = chThdCreate(&td1);
+    tp2 = chThdCreate(&td2);
+  }
+  test_end_step(1);
+
+  /* [3.2.2] Sleeping for 20 milliseconds then resuming the waiting thread
+     before its timeout.*/
+  test_set_step(2);
+  {
+    chThdSleepMilliseconds(20);
+    test_emit_token('B');
+    chThdResume(&tr1, MSG_OK);
+  }
+  test_end_step(2);
+
+  /* [3.2.3] Waiting for the threads to terminate, the tokens must be
+     emitted in deadline order and the last wakeup must happen after 40
+     milliseconds.*/
+  test_set_step(3);
+  {
+    (void) chThdWait(tp1);
+    (void) chThdWait(tp2);
+    test_assert_sequence("ABCD", "invalid sequence");
+    test_assert_time_window(chTimeAddX(time, TIME_MS2I(40)),
+                            chTimeAddX(time, TIME_MS2I(40) + 1),
+                            "out of time window");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t nil_test_003_002 = {
+  "Concurrent timeouts",
+  nil_test_003_002_setup,
+  NULL,
+  nil_test_003_002_execute
+};
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -150,6 +261,7 @@ static const testcase_t nil_test_003_001 = {
  */
 const testcase_t * const nil_test_sequence_003_array[] = {
   &nil_test_003_001,
+  &nil_test_003_002,
   NULL
 };
 
@@ -0,0 +1,305 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "nil_test_root.h"
+
+/**
+ * @file    nil_test_sequence_009.c
+ * @brief   Test Sequence 009 code.
+ *
+ * @page nil_test_sequence_009 [9] Scheduler Benchmarks
+ *
+ * File: @ref nil_test_sequence_009.c
+ *
+ * <h2>Description</h2>
+ * This module implements a series of scheduler benchmarks involving threads
+ * in distant priority slots. The scores depend on the number of threads and
+ * are meant to evaluate the cost of searching the ready and waiting
+ * threads.
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage nil_test_009_001
+ * - @subpage nil_test_009_002
+ * .
+ */
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static THD_WORKING_AREA(wa_bmk[CH_CFG_MAX_THREADS], 128);
+static threads_queue_t tq1, tq2;
+static semaphore_t sem1;
+
+static THD_FUNCTION(bmk_thread1, p) {
+  msg_t msg;
+
+  (void)p;
+  chSysLock();
+  do {
+    chThdDequeueNextI(&tq2, MSG_OK);
+    msg = chThdEnqueueTimeoutS(&tq1, TIME_INFINITE);
+  } while (msg == MSG_OK);
+  chSysUnlock();
+}
+
+static THD_FUNCTION(bmk_thread2, p) {
+  msg_t msg;
+
+  (void)p;
+  chSysLock();
+  do {
+    chSemSignalI(&sem1);
+    msg = chThdEnqueueTimeoutS(&tq1, TIME_INFINITE);
+  } while (msg == MSG_OK);
+  chSysUnlock();
+}
+
+static thread_t *bmk_create(tprio_t prio, tfunc_t funcp) {
+  thread_descriptor_t td = {
+    .name  = "worker",
+    .wbase = wa_bmk[prio],
+    .wend  = THD_WORKING_AREA_END(wa_bmk[prio]),
+    .prio  = prio,
+    .funcp = funcp,
+    .arg   = NULL
+  };
+
+  return chThdCreate(&td);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page nil_test_009_001 [9.1] Threads queue ping-pong performance
+ *
+ * <h2>Description</h2>
+ * A thread is created in the lowest priority slot, the test thread and the
+ * created thread wake up each other using two threads queues. Both the
+ * waiting thread and the next ready thread are searched at every wakeup,
+ * the search cost grows with the distance between the priority slots.
+ *
+ * <h2>Test Steps</h2>
+ * - [9.1.1] Starting the thread in the lowest priority slot and waiting for
+ *   it to be enqueued.
+ * - [9.1.2] Waking up the thread and waiting for its answer, the operation
+ *   is repeated continuously in a one-second time window.
+ * - [9.1.3] Stopping the thread.
+ * - [9.1.4] The score is printed.
+ * .
+ */
+
+static void nil_test_009_001_setup(void) {
+  chThdQueueObjectInit(&tq1);
+  chThdQueueObjectInit(&tq2);
+}
+
+static void nil_test_009_001_execute(void) {
+  thread_t *tp;
+  uint32_t n;
+
+  /* [9.1.1] Starting the thread in the lowest priority slot and waiting for
+     it to be enqueued.*/
+  test_set_step(1);
+  {
+    tp = bmk_create((tprio_t)(CH_CFG_MAX_THREADS - 1), bmk_thread1);
+    chSysLock();
+    (void) chThdEnqueueTimeoutS(&tq2, TIME_INFINITE);
+    chSysUnlock();
+  }
+  test_end_step(1);
+
+  /* [9.1.2] Waking up the thread and waiting for its answer, the operation
+     is repeated continuously in a one-second time window.*/
+  test_set_step(2);
+  {
+    systime_t start, end;
+
+    n = 0;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      chSysLock();
+      chThdDoDequeueNextI(&tq1, MSG_OK);
+      (void) chThdEnqueueTimeoutS(&tq2, TIME_INFINITE);
+      chSysUnlock();
+      n++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+  test_end_step(2);
+
+  /* [9.1.3] Stopping the thread.*/
+  test_set_step(3);
+  {
+    chSysLock();
+    chThdDoDequeueNextI(&tq1, MSG_RESET);
+    chSysUnlock();
+    chThdWait(tp);
+  }
+  test_end_step(3);
+
+  /* [9.1.4] The score is printed.*/
+  test_set_step(4);
+  {
+    test_print("--- Score : ");
+    test_printn(n * 2);
+    test_println(" ctxswc/S");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t nil_test_009_001 = {
+  "Threads queue ping-pong performance",
+  nil_test_009_001_setup,
+  NULL,
+  nil_test_009_001_execute
+};
+
+#if (CH_CFG_USE_SEMAPHORES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page nil_test_009_002 [9.2] Threads queue broadcast performance
+ *
+ * <h2>Description</h2>
+ * Threads are created in all the priority slots below the test thread and
+ * enqueued on the same threads queue, the test thread wakes up all of them
+ * and waits for them to be enqueued again. The operation is repeated
+ * continuously in a one-second time window.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_SEMAPHORES == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [9.2.1] Starting a thread in each lower priority slot and waiting for
+ *   all of them to be enqueued.
+ * - [9.2.2] Waking up all the threads and waiting for them to be enqueued
+ *   again, the operation is repeated continuously in a one-second time
+ *   window.
+ * - [9.2.3] Stopping the threads.
+ * - [9.2.4] The score is printed.
+ * .
+ */
+
+static void nil_test_009_002_setup(void) {
+  chThdQueueObjectInit(&tq1);
+  chSemObjectInit(&sem1, 0);
+}
+
+static void nil_test_009_002_execute(void) {
+  thread_t *tps[CH_CFG_MAX_THREADS];
+  tprio_t prio, first;
+  uint32_t i, nthreads, n;
+
+  /* [9.2.1] Starting a thread in each lower priority slot and waiting for
+     all of them to be enqueued.*/
+  test_set_step(1);
+  {
+    first = chThdGetPriorityX() + (tprio_t)1;
+    nthreads = (uint32_t)(CH_CFG_MAX_THREADS - first);
+    for (prio = first; prio < (tprio_t)CH_CFG_MAX_THREADS; prio++) {
+      tps[prio] = bmk_create(prio, bmk_thread2);
+    }
+    for (i = 0; i < nthreads; i++) {
+      chSemWait(&sem1);
+    }
+  }
+  test_end_step(1);
+
+  /* [9.2.2] Waking up all the threads and waiting for them to be enqueued
+     again, the operation is repeated continuously in a one-second time
+     window.*/
+  test_set_step(2);
+  {
+    systime_t start, end;
+
+    n = 0;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      chSysLock();
+      chThdDequeueAllI(&tq1, MSG_OK);
+      chSysUnlock();
+      for (i = 0; i < nthreads; i++) {
+        chSemWait(&sem1);
+      }
+      n += nthreads;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+  test_end_step(2);
+
+  /* [9.2.3] Stopping the threads.*/
+  test_set_step(3);
+  {
+    chSysLock();
+    chThdDequeueAllI(&tq1, MSG_RESET);
+    chSysUnlock();
+    for (prio = first; prio < (tprio_t)CH_CFG_MAX_THREADS; prio++) {
+      chThdWait(tps[prio]);
+    }
+  }
+  test_end_step(3);
+
+  /* [9.2.4] The score is printed.*/
+  test_set_step(4);
+  {
+    test_print("--- Score : ");
+    test_printn(n);
+    test_println(" wakeups/S");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t nil_test_009_002 = {
+  "Threads queue broadcast performance",
+  nil_test_009_002_setup,
+  NULL,
+  nil_test_009_002_execute
+};
+#endif /* CH_CFG_USE_SEMAPHORES == TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const nil_test_sequence_009_array[] = {
+  &nil_test_009_001,
+#if (CH_CFG_USE_SEMAPHORES == TRUE) || defined(__DOXYGEN__)
+  &nil_test_009_002,
+#endif
+  NULL
+};
+
+/**
+ * @brief   Scheduler Benchmarks.
+ */
+const testsequence_t nil_test_sequence_009 = {
+  "Scheduler Benchmarks",
+  nil_test_sequence_009_array
+};
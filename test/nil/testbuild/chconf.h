@@ -58,6 +58,31 @@
 #define CH_CFG_AUTOSTART_THREADS            TRUE
 #endif
 
+/**
+ * @brief   Threads bitmaps.
+ * @details If enabled then the ready threads and the threads waiting on
+ *          threads queues and semaphores are tracked using bitmaps, the
+ *          highest priority thread is found with a single count leading
+ *          zeros operation instead of scanning the threads array.
+ * @note    Enable it on cores with a count leading zeros instruction
+ *          when the number of threads is close to the maximum.
+ */
+#if !defined(CH_CFG_USE_THREADS_BITMAPS)
+#define CH_CFG_USE_THREADS_BITMAPS          TRUE
+#endif
+
+/**
+ * @brief   Timeouts heap.
+ * @details If enabled then the threads waiting with a timeout are kept in
+ *          a min-heap ordered by deadline, the system timer handler only
+ *          processes the expired threads instead of scanning the threads
+ *          array.
+ * @note    Enable it when few threads use timeouts at the same time.
+ */
+#if !defined(CH_CFG_USE_TIMEOUTS_HEAP)
+#define CH_CFG_USE_TIMEOUTS_HEAP            TRUE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -293,6 +318,37 @@
 #define CH_CFG_USE_JOBS                     TRUE
 #endif
 
+/**
+ * @brief   Delayed and periodic jobs APIs.
+ * @note    Not available on NIL, it must be set to @p FALSE.
+ */
+#if !defined(CH_CFG_USE_DELAYED_JOBS)
+#define CH_CFG_USE_DELAYED_JOBS             FALSE
+#endif
+
+/**
+ * @brief   Publish/Subscribe Topics APIs.
+ * @details If enabled then the zero-copy publish/subscribe topics APIs are
+ *          included in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMPOOLS.
+ */
+#if !defined(CH_CFG_USE_TOPICS)
+#define CH_CFG_USE_TOPICS                   FALSE
+#endif
+
+/**
+ * @brief   Stackless Tasks APIs.
+ * @details If enabled then the cooperative stackless tasks APIs are
+ *          included in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_TASKS)
+#define CH_CFG_USE_TASKS                    FALSE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
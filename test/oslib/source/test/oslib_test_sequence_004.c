@@ -37,6 +37,7 @@
  *
  * <h2>Test Cases</h2>
  * - @subpage oslib_test_004_001
+ * - @subpage oslib_test_004_002
  * .
  */
 
@@ -58,6 +59,16 @@ static void job_slow(void *arg) {
   chThdSleepMilliseconds(10);
 }
 
+#if CH_CFG_USE_DELAYED_JOBS == TRUE
+static jobs_timer_t jt;
+static delayed_job_t djobs[4];
+
+static void job_fast(void *arg) {
+
+  test_emit_token((int)arg);
+}
+#endif
+
 static THD_WORKING_AREA(wa1Thread1, 256);
 static THD_WORKING_AREA(wa2Thread1, 256);
 static THD_FUNCTION(Thread1, arg) {
@@ -165,6 +176,119 @@ static const testcase_t oslib_test_004_001 = {
   oslib_test_004_001_execute
 };
 
+#if (CH_CFG_USE_DELAYED_JOBS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_004_002 [4.2] Delayed jobs test
+ *
+ * <h2>Description</h2>
+ * The delayed and periodic jobs API is tested for functionality.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_DELAYED_JOBS == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [4.2.1] Initializing the Jobs Queue and Jobs Timer objects and
+ *   starting a dispatcher thread.
+ * - [4.2.2] Scheduling one-shot jobs out of order and cancelling one of
+ *   them, the jobs must be executed in deadline order.
+ * - [4.2.3] Scheduling identical jobs for the same tick, they must be
+ *   coalesced into a single execution.
+ * - [4.2.4] Scheduling a periodic job then cancelling it.
+ * - [4.2.5] Sending a null job to make the thread exit.
+ * .
+ */
+
+static void oslib_test_004_002_execute(void) {
+  thread_t *tp;
+
+  /* [4.2.1] Initializing the Jobs Queue and Jobs Timer objects and
+     starting a dispatcher thread.*/
+  test_set_step(1);
+  {
+    chJobObjectInit(&jq, JOBS_QUEUE_SIZE, jobs, msg_queue);
+    chJobTimerObjectInit(&jt, &jq);
+
+    thread_descriptor_t td = {
+      .name  = "dispatcher",
+      .wbase = wa1Thread1,
+      .wend  = THD_WORKING_AREA_END(wa1Thread1),
+      .prio  = chThdGetPriorityX() + 1,
+      .funcp = Thread1,
+      .arg   = NULL
+    };
+    tp = chThdCreate(&td);
+  }
+  test_end_step(1);
+
+  /* [4.2.2] Scheduling one-shot jobs out of order and cancelling one of
+     them, the jobs must be executed in deadline order.*/
+  test_set_step(2);
+  {
+    chJobPostDelayed(&jt, &djobs[0], TIME_MS2I(30), 0, job_fast, (void *)'c');
+    chJobPostDelayed(&jt, &djobs[1], TIME_MS2I(10), 0, job_fast, (void *)'a');
+    chJobPostDelayed(&jt, &djobs[2], TIME_MS2I(20), 0, job_fast, (void *)'b');
+    chJobPostDelayed(&jt, &djobs[3], TIME_MS2I(15), 0, job_fast, (void *)'x');
+    test_assert(chJobCancel(&jt, &djobs[3]) == true, "not cancelled");
+    test_assert(chJobCancel(&jt, &djobs[3]) == false, "cancelled twice");
+    chThdSleepMilliseconds(50);
+    test_assert_sequence("abc", "unexpected tokens");
+    test_assert(jt.posted == 3U, "wrong posted counter");
+  }
+  test_end_step(2);
+
+  /* [4.2.3] Scheduling identical jobs for the same tick, they must be
+     coalesced into a single execution.*/
+  test_set_step(3);
+  {
+    chSysLock();
+    chJobPostDelayedI(&jt, &djobs[0], TIME_MS2I(10), 0, job_fast, (void *)'d');
+    chJobPostDelayedI(&jt, &djobs[1], TIME_MS2I(10), 0, job_fast, (void *)'d');
+    chJobPostDelayedI(&jt, &djobs[2], TIME_MS2I(10), 0, job_fast, (void *)'e');
+    chSysUnlock();
+    chThdSleepMilliseconds(20);
+    test_assert_sequence("ed", "unexpected tokens");
+    test_assert(jt.coalesced == 1U, "not coalesced");
+  }
+  test_end_step(3);
+
+  /* [4.2.4] Scheduling a periodic job then cancelling it.*/
+  test_set_step(4);
+  {
+    chJobPostDelayed(&jt, &djobs[0], TIME_MS2I(10), TIME_MS2I(10),
+                     job_fast, (void *)'p');
+    chThdSleepMilliseconds(45);
+    test_assert(chJobCancel(&jt, &djobs[0]) == true, "not scheduled");
+    chThdSleepMilliseconds(20);
+    test_assert_sequence("pppp", "unexpected tokens");
+    test_assert(jt.missed == 0U, "jobs missed");
+  }
+  test_end_step(4);
+
+  /* [4.2.5] Sending a null job to make the thread exit.*/
+  test_set_step(5);
+  {
+    job_descriptor_t *jdp;
+
+    jdp = chJobGet(&jq);
+    jdp->jobfunc = NULL;
+    jdp->jobarg  = NULL;
+    chJobPost(&jq, jdp);
+    (void) chThdWait(tp);
+  }
+  test_end_step(5);
+}
+
+static const testcase_t oslib_test_004_002 = {
+  "Delayed jobs test",
+  NULL,
+  NULL,
+  oslib_test_004_002_execute
+};
+#endif /* CH_CFG_USE_DELAYED_JOBS == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -174,6 +298,9 @@ static const testcase_t oslib_test_004_001 = {
  */
 const testcase_t * const oslib_test_sequence_004_array[] = {
   &oslib_test_004_001,
+#if (CH_CFG_USE_DELAYED_JOBS == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_004_002,
+#endif
   NULL
 };
 
@@ -0,0 +1,382 @@
+/*
+    ChibiOS - Copyright (C) 2006..2017 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "oslib_test_root.h"
+
+/**
+ * @file    oslib_test_sequence_010.c
+ * @brief   Test Sequence 010 code.
+ *
+ * @page oslib_test_sequence_010 [10] Publish/Subscribe Topics
+ *
+ * File: @ref oslib_test_sequence_010.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS library functionalities related to
+ * Publish/Subscribe Topics.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_TOPICS == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage oslib_test_010_001
+ * - @subpage oslib_test_010_002
+ * - @subpage oslib_test_010_003
+ * .
+ */
+
+#if (CH_CFG_USE_TOPICS == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define TOPIC_SIZE      4
+#define QUEUE_SIZE      2
+
+static topic_t topic;
+static union {
+  topic_message_t       hdr;
+  uint8_t               buf[TOPIC_MESSAGE_SIZE(sizeof (char))];
+} msgbuf[TOPIC_SIZE];
+static topic_subscriber_t sub1, sub2, sub3;
+static topic_message_t *queue1[QUEUE_SIZE], *queue2[QUEUE_SIZE];
+
+static void publish_token(char c) {
+  topic_message_t *tmp;
+
+  tmp = chTopicAlloc(&topic);
+  if (tmp != NULL) {
+    *(char *)chTopicGetPayloadX(tmp) = c;
+    chTopicPublish(tmp);
+  }
+}
+
+static void fetch_tokens(topic_subscriber_t *sp) {
+  topic_message_t *tmp;
+
+  while (chTopicFetchTimeout(sp, &tmp, TIME_IMMEDIATE) == MSG_OK) {
+    test_emit_token(*(char *)chTopicGetPayloadX(tmp));
+    chTopicRelease(tmp);
+  }
+}
+
+static THD_WORKING_AREA(waThread1, 256);
+static THD_FUNCTION(Thread1, arg) {
+  topic_subscriber_t *sp = (topic_subscriber_t *)arg;
+  topic_message_t *tmp;
+  msg_t msg;
+
+  while (true) {
+    msg = chTopicFetchTimeout(sp, &tmp, TIME_INFINITE);
+    if (msg != MSG_OK) {
+      break;
+    }
+    test_emit_token(*(char *)chTopicGetPayloadX(tmp));
+    chTopicRelease(tmp);
+  }
+
+  chThdExit(msg);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page oslib_test_010_001 [10.1] Fan-out and reference counting
+ *
+ * <h2>Description</h2>
+ * A message is published to two subscribers, both subscribers must receive
+ * the same message, the message must return to the topic pool after the
+ * last reference is released.
+ *
+ * <h2>Test Steps</h2>
+ * - [10.1.1] Publishing with no subscribers, the message must return
+ *   immediately to the pool.
+ * - [10.1.2] Subscribing two subscribers then publishing a message, both
+ *   subscribers must receive the same message.
+ * - [10.1.3] Releasing the references, the message must return to the pool
+ *   after the last release.
+ * - [10.1.4] Unsubscribing, the subscribers queues must be empty.
+ * .
+ */
+
+static void oslib_test_010_001_setup(void) {
+  chTopicObjectInit(&topic, "test", sizeof (char), msgbuf, TOPIC_SIZE);
+}
+
+static void oslib_test_010_001_execute(void) {
+  topic_message_t *tmp1, *tmp2;
+  topic_stats_t stats;
+  unsigned i;
+
+  /* [10.1.1] Publishing with no subscribers, the message must return
+     immediately to the pool.*/
+  test_set_step(1);
+  {
+    for (i = 0; i < TOPIC_SIZE * 2; i++) {
+      publish_token('x');
+    }
+    chTopicGetStats(&topic, &stats);
+    test_assert(stats.published == TOPIC_SIZE * 2, "wrong published counter");
+    test_assert(stats.nomem == 0, "wrong nomem counter");
+  }
+  test_end_step(1);
+
+  /* [10.1.2] Subscribing two subscribers then publishing a message, both
+     subscribers must receive the same message.*/
+  test_set_step(2);
+  {
+    chTopicSubscribe(&topic, &sub1, queue1, QUEUE_SIZE, TOPIC_POLICY_DROP_NEWEST);
+    chTopicSubscribe(&topic, &sub2, queue2, QUEUE_SIZE, TOPIC_POLICY_DROP_NEWEST);
+    publish_token('A');
+
+    test_assert(chTopicFetchTimeout(&sub1, &tmp1, TIME_IMMEDIATE) == MSG_OK,
+                "fetch failed");
+    test_assert(chTopicFetchTimeout(&sub2, &tmp2, TIME_IMMEDIATE) == MSG_OK,
+                "fetch failed");
+    test_assert(tmp1 == tmp2, "message copied");
+    test_assert(*(char *)chTopicGetPayloadX(tmp1) == 'A', "wrong payload");
+    test_assert(tmp1->refs == 2, "wrong references count");
+  }
+  test_end_step(2);
+
+  /* [10.1.3] Releasing the references, the message must return to the pool
+     after the last release.*/
+  test_set_step(3);
+  {
+    chTopicRelease(tmp1);
+    test_assert(tmp2->refs == 1, "wrong references count");
+    chTopicRelease(tmp2);
+
+    for (i = 0; i < TOPIC_SIZE; i++) {
+      test_assert(chTopicAlloc(&topic) != NULL, "message not returned");
+    }
+    test_assert(chTopicAlloc(&topic) == NULL, "pool not empty");
+    chTopicGetStats(&topic, &stats);
+    test_assert(stats.nomem == 1, "wrong nomem counter");
+  }
+  test_end_step(3);
+
+  /* [10.1.4] Unsubscribing, the subscribers queues must be empty.*/
+  test_set_step(4);
+  {
+    chTopicUnsubscribe(&sub1);
+    chTopicUnsubscribe(&sub2);
+    test_assert(topic.subscribers == NULL, "still subscribed");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_010_001 = {
+  "Fan-out and reference counting",
+  oslib_test_010_001_setup,
+  NULL,
+  oslib_test_010_001_execute
+};
+
+/**
+ * @page oslib_test_010_002 [10.2] Overflow policies
+ *
+ * <h2>Description</h2>
+ * Three subscribers with different overflow policies are overflowed, the
+ * retained messages and the counters are checked.
+ *
+ * <h2>Test Steps</h2>
+ * - [10.2.1] Subscribing with the drop-newest, drop-oldest and last-value
+ *   policies.
+ * - [10.2.2] Publishing three messages, the queues overflow.
+ * - [10.2.3] Fetching from each subscriber, the retained messages must
+ *   match the subscriber policy.
+ * - [10.2.4] Checking the topic counters.
+ * - [10.2.5] Unsubscribing, all messages must be back in the pool.
+ * .
+ */
+
+static void oslib_test_010_002_setup(void) {
+  chTopicObjectInit(&topic, "test", sizeof (char), msgbuf, TOPIC_SIZE);
+}
+
+static void oslib_test_010_002_execute(void) {
+  topic_stats_t stats;
+
+  /* [10.2.1] Subscribing with the drop-newest, drop-oldest and last-value
+     policies.*/
+  test_set_step(1);
+  {
+    chTopicSubscribe(&topic, &sub1, queue1, QUEUE_SIZE, TOPIC_POLICY_DROP_NEWEST);
+    chTopicSubscribe(&topic, &sub2, queue2, QUEUE_SIZE, TOPIC_POLICY_DROP_OLDEST);
+    chTopicSubscribe(&topic, &sub3, NULL, 0, TOPIC_POLICY_LAST_VALUE);
+  }
+  test_end_step(1);
+
+  /* [10.2.2] Publishing three messages, the queues overflow.*/
+  test_set_step(2);
+  {
+    publish_token('a');
+    publish_token('b');
+    publish_token('c');
+  }
+  test_end_step(2);
+
+  /* [10.2.3] Fetching from each subscriber, the retained messages must
+     match the subscriber policy.*/
+  test_set_step(3);
+  {
+    fetch_tokens(&sub1);
+    fetch_tokens(&sub2);
+    fetch_tokens(&sub3);
+    test_assert_sequence("abbcc", "unexpected tokens");
+    test_assert(sub1.dropped == 1, "wrong dropped counter");
+    test_assert(sub2.dropped == 1, "wrong dropped counter");
+    test_assert(sub3.dropped == 2, "wrong dropped counter");
+  }
+  test_end_step(3);
+
+  /* [10.2.4] Checking the topic counters.*/
+  test_set_step(4);
+  {
+    chTopicGetStats(&topic, &stats);
+    test_assert(stats.published == 3, "wrong published counter");
+    test_assert(stats.delivered == 8, "wrong delivered counter");
+    test_assert(stats.dropped == 4, "wrong dropped counter");
+    test_assert(stats.nomem == 0, "wrong nomem counter");
+  }
+  test_end_step(4);
+
+  /* [10.2.5] Unsubscribing, all messages must be back in the pool.*/
+  test_set_step(5);
+  {
+    unsigned i;
+
+    chTopicUnsubscribe(&sub1);
+    chTopicUnsubscribe(&sub2);
+    chTopicUnsubscribe(&sub3);
+    for (i = 0; i < TOPIC_SIZE; i++) {
+      test_assert(chTopicAlloc(&topic) != NULL, "message not returned");
+    }
+  }
+  test_end_step(5);
+}
+
+static const testcase_t oslib_test_010_002 = {
+  "Overflow policies",
+  oslib_test_010_002_setup,
+  NULL,
+  oslib_test_010_002_execute
+};
+
+/**
+ * @page oslib_test_010_003 [10.3] Blocking fetch
+ *
+ * <h2>Description</h2>
+ * A thread waits for messages on a subscriber queue, published messages
+ * must wake it, unsubscribing must make it exit.
+ *
+ * <h2>Test Steps</h2>
+ * - [10.3.1] Fetching from an empty queue, a timeout is expected.
+ * - [10.3.2] Starting a higher priority reader thread.
+ * - [10.3.3] Publishing messages, the reader must receive them in order.
+ * - [10.3.4] Unsubscribing, the reader must exit with MSG_RESET.
+ * .
+ */
+
+static void oslib_test_010_003_setup(void) {
+  chTopicObjectInit(&topic, "test", sizeof (char), msgbuf, TOPIC_SIZE);
+}
+
+static void oslib_test_010_003_execute(void) {
+  thread_t *tp;
+  topic_message_t *tmp;
+
+  /* [10.3.1] Fetching from an empty queue, a timeout is expected.*/
+  test_set_step(1);
+  {
+    chTopicSubscribe(&topic, &sub1, queue1, QUEUE_SIZE, TOPIC_POLICY_DROP_NEWEST);
+    test_assert(chTopicFetchTimeout(&sub1, &tmp, TIME_IMMEDIATE) == MSG_TIMEOUT,
+                "not empty");
+  }
+  test_end_step(1);
+
+  /* [10.3.2] Starting a higher priority reader thread.*/
+  test_set_step(2);
+  {
+    thread_descriptor_t td = {
+      .name  = "reader",
+      .wbase = waThread1,
+      .wend  = THD_WORKING_AREA_END(waThread1),
+      .prio  = chThdGetPriorityX() + 1,
+      .funcp = Thread1,
+      .arg   = (void *)&sub1
+    };
+    tp = chThdCreate(&td);
+  }
+  test_end_step(2);
+
+  /* [10.3.3] Publishing messages, the reader must receive them in order.*/
+  test_set_step(3);
+  {
+    publish_token('A');
+    publish_token('B');
+    publish_token('C');
+    test_assert_sequence("ABC", "unexpected tokens");
+  }
+  test_end_step(3);
+
+  /* [10.3.4] Unsubscribing, the reader must exit with MSG_RESET.*/
+  test_set_step(4);
+  {
+    chTopicUnsubscribe(&sub1);
+    test_assert(chThdWait(tp) == MSG_RESET, "invalid exit code");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_010_003 = {
+  "Blocking fetch",
+  oslib_test_010_003_setup,
+  NULL,
+  oslib_test_010_003_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const oslib_test_sequence_010_array[] = {
+  &oslib_test_010_001,
+  &oslib_test_010_002,
+  &oslib_test_010_003,
+  NULL
+};
+
+/**
+ * @brief   Publish/Subscribe Topics.
+ */
+const testsequence_t oslib_test_sequence_010 = {
+  "Publish/Subscribe Topics",
+  oslib_test_sequence_010_array
+};
+
+#endif /* CH_CFG_USE_TOPICS == TRUE */
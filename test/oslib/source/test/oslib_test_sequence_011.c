@@ -0,0 +1,470 @@
+/*
+    ChibiOS - Copyright (C) 2006..2017 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "oslib_test_root.h"
+
+/**
+ * @file    oslib_test_sequence_011.c
+ * @brief   Test Sequence 011 code.
+ *
+ * @page oslib_test_sequence_011 [11] Stackless Tasks
+ *
+ * File: @ref oslib_test_sequence_011.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS library functionalities related to
+ * Stackless Tasks.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_TASKS == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage oslib_test_011_001
+ * - @subpage oslib_test_011_002
+ * - @subpage oslib_test_011_003
+ * - @subpage oslib_test_011_004
+ * .
+ */
+
+#if (CH_CFG_USE_TASKS == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define MB_SIZE         4
+#define TEST_EVENT      ((eventmask_t)1)
+
+typedef struct {
+  char                  token;
+  sysinterval_t         delay;
+} sleep_params_t;
+
+static task_executor_t executor;
+static task_t tasks[3];
+static systime_t bmk_start, bmk_end;
+
+static const sleep_params_t sleep_params[3] = {
+  {'C', TIME_MS2I(30)},
+  {'A', TIME_MS2I(10)},
+  {'B', TIME_MS2I(20)}
+};
+
+static TASK_FUNCTION(yield_task, tp) {
+  const char *tokens = (const char *)chTaskGetArgX(tp);
+
+  TASK_BEGIN(tp);
+  test_emit_token(tokens[0]);
+  TASK_YIELD(tp);
+  test_emit_token(tokens[1]);
+  TASK_END(tp);
+}
+
+static TASK_FUNCTION(sleep_task, tp) {
+  const sleep_params_t *spp = (const sleep_params_t *)chTaskGetArgX(tp);
+
+  TASK_BEGIN(tp);
+  TASK_SLEEP(tp, spp->delay);
+  test_emit_token(spp->token);
+  TASK_END(tp);
+}
+
+#if CH_CFG_USE_MAILBOXES == TRUE
+static mailbox_t mb;
+static msg_t mb_buffer[MB_SIZE];
+static msg_t fetched;
+
+static TASK_FUNCTION(events_task, tp) {
+
+  TASK_BEGIN(tp);
+  TASK_WAIT_EVENTS(tp, TEST_EVENT);
+  if (chTaskGetAndClearEvents(tp, TEST_EVENT) == TEST_EVENT) {
+    test_emit_token('A');
+  }
+  TASK_END(tp);
+}
+
+static TASK_FUNCTION(fetch_task, tp) {
+
+  TASK_BEGIN(tp);
+  TASK_MB_FETCH(tp, &mb, &fetched);
+  test_emit_token((char)fetched);
+  TASK_END(tp);
+}
+
+static THD_FUNCTION(Thread1, arg) {
+
+  (void)arg;
+
+  chTaskSignal(&tasks[0], TEST_EVENT);
+  (void) chMBPostTimeout(&mb, (msg_t)'B', TIME_INFINITE);
+  chTaskExecutorNotify(&executor);
+}
+#endif
+
+static TASK_FUNCTION(bmk_task, tp) {
+
+  TASK_BEGIN(tp);
+  while (chVTIsSystemTimeWithinX(bmk_start, bmk_end)) {
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+    TASK_YIELD(tp);
+  }
+  TASK_END(tp);
+}
+
+static THD_WORKING_AREA(waThread1, 256);
+
+static THD_FUNCTION(Thread2, arg) {
+  msg_t n = 0;
+
+  (void)arg;
+
+  while (chVTIsSystemTimeWithinX(bmk_start, bmk_end)) {
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+    chThdYield();
+    n++;
+  }
+
+  chThdExit(n);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page oslib_test_011_001 [11.1] Yield ordering
+ *
+ * <h2>Description</h2>
+ * Three tasks emit a token, yield and emit a second token, the tasks must
+ * be executed in FIFO order and the executor must return after the last
+ * task terminated.
+ *
+ * <h2>Test Steps</h2>
+ * - [11.1.1] Initializing and starting the tasks.
+ * - [11.1.2] Running the executor, the tokens must be emitted in round
+ *   robin order.
+ * - [11.1.3] Restarting a terminated task, it must run again from its
+ *   beginning.
+ * .
+ */
+
+static void oslib_test_011_001_setup(void) {
+  chTaskExecutorObjectInit(&executor);
+}
+
+static void oslib_test_011_001_execute(void) {
+
+  /* [11.1.1] Initializing and starting the tasks.*/
+  test_set_step(1);
+  {
+    chTaskObjectInit(&tasks[0], yield_task, (void *)"AD");
+    chTaskObjectInit(&tasks[1], yield_task, (void *)"BE");
+    chTaskObjectInit(&tasks[2], yield_task, (void *)"CF");
+    chTaskStart(&executor, &tasks[0]);
+    chTaskStart(&executor, &tasks[1]);
+    chTaskStart(&executor, &tasks[2]);
+    test_assert(chTaskGetStateX(&tasks[0]) == TASK_STATE_READY, "not ready");
+  }
+  test_end_step(1);
+
+  /* [11.1.2] Running the executor, the tokens must be emitted in round
+     robin order.*/
+  test_set_step(2);
+  {
+    chTaskExecutorRun(&executor);
+    test_assert_sequence("ABCDEF", "unexpected tokens");
+    test_assert(chTaskExecutorGetSwitchesX(&executor) == 6, "wrong switches counter");
+    test_assert(chTaskGetStateX(&tasks[0]) == TASK_STATE_FINAL, "not terminated");
+    test_assert(chTaskGetStateX(&tasks[1]) == TASK_STATE_FINAL, "not terminated");
+    test_assert(chTaskGetStateX(&tasks[2]) == TASK_STATE_FINAL, "not terminated");
+  }
+  test_end_step(2);
+
+  /* [11.1.3] Restarting a terminated task, it must run again from its
+     beginning.*/
+  test_set_step(3);
+  {
+    chTaskStart(&executor, &tasks[0]);
+    chTaskExecutorRun(&executor);
+    test_assert_sequence("AD", "unexpected tokens");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t oslib_test_011_001 = {
+  "Yield ordering",
+  oslib_test_011_001_setup,
+  NULL,
+  oslib_test_011_001_execute
+};
+
+/**
+ * @page oslib_test_011_002 [11.2] Sleep ordering
+ *
+ * <h2>Description</h2>
+ * Three tasks sleep for different intervals then emit a token, the tokens
+ * must be emitted in wakeup order and the executor must wait for the
+ * longest interval.
+ *
+ * <h2>Test Steps</h2>
+ * - [11.2.1] Starting three tasks with different sleep intervals.
+ * - [11.2.2] Running the executor, the tokens must be emitted in wakeup
+ *   order after the longest interval.
+ * .
+ */
+
+static void oslib_test_011_002_setup(void) {
+  chTaskExecutorObjectInit(&executor);
+}
+
+static void oslib_test_011_002_execute(void) {
+  systime_t start;
+  unsigned i;
+
+  /* [11.2.1] Starting three tasks with different sleep intervals.*/
+  test_set_step(1);
+  {
+    for (i = 0; i < 3; i++) {
+      chTaskObjectInit(&tasks[i], sleep_task, (void *)&sleep_params[i]);
+      chTaskStart(&executor, &tasks[i]);
+    }
+  }
+  test_end_step(1);
+
+  /* [11.2.2] Running the executor, the tokens must be emitted in wakeup
+     order after the longest interval.*/
+  test_set_step(2);
+  {
+    start = chVTGetSystemTimeX();
+    chTaskExecutorRun(&executor);
+    test_assert(chVTTimeElapsedSinceX(start) >= TIME_MS2I(30), "too early");
+    test_assert_sequence("ABC", "unexpected tokens");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t oslib_test_011_002 = {
+  "Sleep ordering",
+  oslib_test_011_002_setup,
+  NULL,
+  oslib_test_011_002_execute
+};
+
+#if (CH_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_011_003 [11.3] Events and polling
+ *
+ * <h2>Description</h2>
+ * A task waits for an event and another task waits for a mailbox message, a
+ * lower priority thread signals the event and posts the message, both tasks
+ * must be resumed.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_MAILBOXES == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [11.3.1] Starting the tasks.
+ * - [11.3.2] Starting a lower priority thread, it runs when the executor
+ *   has no ready tasks.
+ * - [11.3.3] Running the executor, the event must be received first then
+ *   the message.
+ * .
+ */
+
+static void oslib_test_011_003_setup(void) {
+  chTaskExecutorObjectInit(&executor);
+  chMBObjectInit(&mb, mb_buffer, MB_SIZE);
+}
+
+static void oslib_test_011_003_execute(void) {
+  thread_t *tp;
+
+  /* [11.3.1] Starting the tasks.*/
+  test_set_step(1);
+  {
+    chTaskObjectInit(&tasks[0], events_task, NULL);
+    chTaskObjectInit(&tasks[1], fetch_task, NULL);
+    chTaskStart(&executor, &tasks[0]);
+    chTaskStart(&executor, &tasks[1]);
+  }
+  test_end_step(1);
+
+  /* [11.3.2] Starting a lower priority thread, it runs when the executor
+     has no ready tasks.*/
+  test_set_step(2);
+  {
+    thread_descriptor_t td = {
+      .name  = "notifier",
+      .wbase = waThread1,
+      .wend  = THD_WORKING_AREA_END(waThread1),
+      .prio  = chThdGetPriorityX() - 1,
+      .funcp = Thread1,
+      .arg   = NULL
+    };
+    tp = chThdCreate(&td);
+  }
+  test_end_step(2);
+
+  /* [11.3.3] Running the executor, the event must be received first then
+     the message.*/
+  test_set_step(3);
+  {
+    chTaskExecutorRun(&executor);
+    test_assert_sequence("AB", "unexpected tokens");
+    test_assert_lock(chMBGetUsedCountI(&mb) == 0, "mailbox not empty");
+    (void) chThdWait(tp);
+  }
+  test_end_step(3);
+}
+
+static const testcase_t oslib_test_011_003 = {
+  "Events and polling",
+  oslib_test_011_003_setup,
+  NULL,
+  oslib_test_011_003_execute
+};
+#endif /* CH_CFG_USE_MAILBOXES == TRUE */
+
+/**
+ * @page oslib_test_011_004 [11.4] Tasks switch performance
+ *
+ * <h2>Description</h2>
+ * Two tasks yield to each other for one second, the number of task switches
+ * is compared with the number of context switches of two threads yielding
+ * to each other for one second.
+ *
+ * <h2>Test Steps</h2>
+ * - [11.4.1] Two tasks are started and executed for one second.
+ * - [11.4.2] The tasks score is printed.
+ * - [11.4.3] A thread with the same priority is created, both threads call
+ *   chThdYield() for one second.
+ * - [11.4.4] The threads score is printed.
+ * .
+ */
+
+static void oslib_test_011_004_setup(void) {
+  chTaskExecutorObjectInit(&executor);
+}
+
+static void oslib_test_011_004_execute(void) {
+  thread_t *tp;
+  uint32_t n;
+
+  /* [11.4.1] Two tasks are started and executed for one second.*/
+  test_set_step(1);
+  {
+    chTaskObjectInit(&tasks[0], bmk_task, NULL);
+    chTaskObjectInit(&tasks[1], bmk_task, NULL);
+    chTaskStart(&executor, &tasks[0]);
+    chTaskStart(&executor, &tasks[1]);
+    bmk_start = chVTGetSystemTimeX();
+    bmk_end = chTimeAddX(bmk_start, TIME_MS2I(1000));
+    chTaskExecutorRun(&executor);
+  }
+  test_end_step(1);
+
+  /* [11.4.2] The tasks score is printed.*/
+  test_set_step(2);
+  {
+    test_print("--- Tasks: ");
+    test_printn(chTaskExecutorGetSwitchesX(&executor));
+    test_println(" switches/S");
+  }
+  test_end_step(2);
+
+  /* [11.4.3] A thread with the same priority is created, both threads call
+     chThdYield() for one second.*/
+  test_set_step(3);
+  {
+    thread_descriptor_t td = {
+      .name  = "yielder",
+      .wbase = waThread1,
+      .wend  = THD_WORKING_AREA_END(waThread1),
+      .prio  = chThdGetPriorityX(),
+      .funcp = Thread2,
+      .arg   = NULL
+    };
+
+    bmk_start = chVTGetSystemTimeX();
+    bmk_end = chTimeAddX(bmk_start, TIME_MS2I(1000));
+    tp = chThdCreate(&td);
+    n = 0;
+    while (chVTIsSystemTimeWithinX(bmk_start, bmk_end)) {
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+      chThdYield();
+      n++;
+    }
+    n += (uint32_t)chThdWait(tp);
+  }
+  test_end_step(3);
+
+  /* [11.4.4] The threads score is printed.*/
+  test_set_step(4);
+  {
+    test_print("--- Threads: ");
+    test_printn(n);
+    test_println(" switches/S");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_011_004 = {
+  "Tasks switch performance",
+  oslib_test_011_004_setup,
+  NULL,
+  oslib_test_011_004_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const oslib_test_sequence_011_array[] = {
+  &oslib_test_011_001,
+  &oslib_test_011_002,
+#if (CH_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_011_003,
+#endif
+  &oslib_test_011_004,
+  NULL
+};
+
+/**
+ * @brief   Stackless Tasks.
+ */
+const testsequence_t oslib_test_sequence_011 = {
+  "Stackless Tasks",
+  oslib_test_sequence_011_array
+};
+
+#endif /* CH_CFG_USE_TASKS == TRUE */
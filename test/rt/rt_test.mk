@@ -11,7 +11,10 @@ TESTSRC += ${CHIBIOS}/test/rt/source/test/rt_test_root.c \
            ${CHIBIOS}/test/rt/source/test/rt_test_sequence_009.c \
            ${CHIBIOS}/test/rt/source/test/rt_test_sequence_010.c \
            ${CHIBIOS}/test/rt/source/test/rt_test_sequence_011.c \
-           ${CHIBIOS}/test/rt/source/test/rt_test_sequence_012.c
+           ${CHIBIOS}/test/rt/source/test/rt_test_sequence_012.c \
+           ${CHIBIOS}/test/rt/source/test/rt_test_sequence_013.c \
+           ${CHIBIOS}/test/rt/source/test/rt_test_sequence_014.c \
+           ${CHIBIOS}/test/rt/source/test/rt_test_sequence_015.c
 
 # Required include directories
 TESTINC += ${CHIBIOS}/test/rt/source/test
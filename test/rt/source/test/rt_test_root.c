@@ -33,6 +33,9 @@
  * - @subpage rt_test_sequence_010
  * - @subpage rt_test_sequence_011
  * - @subpage rt_test_sequence_012
+ * - @subpage rt_test_sequence_013
+ * - @subpage rt_test_sequence_014
+ * - @subpage rt_test_sequence_015
  * .
  */
 
@@ -78,6 +81,15 @@ const testsequence_t * const rt_test_suite_array[] = {
   &rt_test_sequence_011,
 #endif
   &rt_test_sequence_012,
+#if (CH_CFG_USE_RWLOCKS == TRUE) || defined(__DOXYGEN__)
+  &rt_test_sequence_013,
+#endif
+#if (CH_CFG_USE_PCMUTEXES == TRUE) || defined(__DOXYGEN__)
+  &rt_test_sequence_014,
+#endif
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+  &rt_test_sequence_015,
+#endif
   NULL
 };
 
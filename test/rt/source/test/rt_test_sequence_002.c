@@ -36,6 +36,9 @@
  * - @subpage rt_test_002_001
  * - @subpage rt_test_002_002
  * - @subpage rt_test_002_003
+ * - @subpage rt_test_002_004
+ * - @subpage rt_test_002_005
+ * - @subpage rt_test_002_006
  * .
  */
 
@@ -61,6 +64,55 @@ static void vtcb(virtual_timer_t *vtp, void *p) {
   chSysUnlockFromISR();
 }
 
+#if CH_CFG_USE_VT_DEFERRED == TRUE
+/* Deferred timer callback, it records the priority of the invoking
+   thread.*/
+static void vtdcb(virtual_timer_t *vtp, void *p) {
+
+  (void)vtp;
+  *(tprio_t *)p = chThdGetPriorityX();
+}
+
+/* Deferred timer callback, it counts the invocations.*/
+static void vtccb(virtual_timer_t *vtp, void *p) {
+
+  (void)vtp;
+  (*(unsigned *)p)++;
+}
+
+/* Deferred timer callback, it waits for the expiration of the timer
+   passed as parameter then resets it while its callback is pending.*/
+static void vtrcb(virtual_timer_t *vtp, void *p) {
+  systime_t start = chVTGetSystemTimeX();
+
+  (void)vtp;
+  while (chTimeDiffX(start, chVTGetSystemTimeX()) < (sysinterval_t)5) {
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+  chVTReset((virtual_timer_t *)p);
+}
+
+/* Deferred timer callback, it waits for the expiration of the timer
+   passed as parameter then re-arms it as a normal timer while its
+   callback is pending.*/
+static void vtscb(virtual_timer_t *vtp, void *p) {
+  virtual_timer_t *vt2p = (virtual_timer_t *)p;
+  systime_t start = chVTGetSystemTimeX();
+
+  (void)vtp;
+  while (chTimeDiffX(start, chVTGetSystemTimeX()) < (sysinterval_t)5) {
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+  chSysLock();
+  chVTDoSetI(vt2p, 20, vtccb, vt2p->par);
+  chSysUnlock();
+}
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -241,6 +293,357 @@ static const testcase_t rt_test_002_003 = {
   rt_test_002_003_execute
 };
 
+#if (CH_CFG_USE_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_002_004 [2.4] Deferred timer callbacks
+ *
+ * <h2>Description</h2>
+ * Virtual timers with deferred callbacks are tested, the callbacks must be
+ * invoked by the timers thread and the deferral latency must be accounted.
+ * Resetting or re-arming a timer must cancel its pending callback.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_VT_DEFERRED == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.4.1] Starting a one-shot deferred timer, the callback must be
+ *   invoked by the timers thread.
+ * - [2.4.2] Reading the deferral statistics, one more callback must have
+ *   been accounted.
+ * - [2.4.3] Starting a continuous deferred timer with a 10 ticks period,
+ *   the callback must be invoked ten times in 105 ticks.
+ * - [2.4.4] Starting a deferred timer whose callback resets a second
+ *   deferred timer after its expiration, the callback of the second timer
+ *   must not be invoked.
+ * - [2.4.5] Starting a deferred timer whose callback re-arms a second
+ *   deferred timer as a normal timer after its expiration, only the
+ *   callback of the re-armed timer must be invoked.
+ * .
+ */
+
+static void rt_test_002_004_execute(void) {
+  virtual_timer_t vt, vt2;
+  vt_deferred_stats_t ds1, ds2;
+  tprio_t prio;
+  unsigned n;
+
+  /* [2.4.1] Starting a one-shot deferred timer, the callback must be
+     invoked by the timers thread.*/
+  test_set_step(1);
+  {
+    chSysLock();
+    chVTGetDeferredStatsI(&ds1);
+    chSysUnlock();
+    prio = (tprio_t)0;
+    chVTObjectInit(&vt);
+    chVTSetDeferred(&vt, 1, vtdcb, &prio);
+    chThdSleep(10);
+    test_assert(chVTIsArmed(&vt) == false, "timer still armed");
+    test_assert(prio == CH_CFG_VT_THREAD_PRIO, "not invoked by the timers thread");
+  }
+  test_end_step(1);
+
+  /* [2.4.2] Reading the deferral statistics, one more callback must have
+     been accounted.*/
+  test_set_step(2);
+  {
+    chSysLock();
+    chVTGetDeferredStatsI(&ds2);
+    chSysUnlock();
+    test_assert(ds2.n == ds1.n + (ucnt_t)1, "callback not accounted");
+    test_assert(ds2.best <= ds2.worst, "inconsistent latencies");
+  }
+  test_end_step(2);
+
+  /* [2.4.3] Starting a continuous deferred timer with a 10 ticks period,
+     the callback must be invoked ten times in 105 ticks.*/
+  test_set_step(3);
+  {
+    n = 0U;
+    chVTSetContinuousDeferred(&vt, 10, vtccb, &n);
+    chThdSleep(105);
+    chVTReset(&vt);
+    test_assert(n == 10U, "wrong number of invocations");
+  }
+  test_end_step(3);
+
+  /* [2.4.4] Starting a deferred timer whose callback resets a second
+     deferred timer after its expiration, the callback of the second timer
+     must not be invoked.*/
+  test_set_step(4);
+  {
+    n = 0U;
+    chVTObjectInit(&vt2);
+    chSysLock();
+    chVTDoSetDeferredI(&vt, 1, vtrcb, &vt2);
+    chVTDoSetDeferredI(&vt2, 2, vtccb, &n);
+    chSysUnlock();
+    chThdSleep(20);
+    test_assert(n == 0U, "pending callback not cancelled");
+  }
+  test_end_step(4);
+
+  /* [2.4.5] Starting a deferred timer whose callback re-arms a second
+     deferred timer as a normal timer after its expiration, only the
+     callback of the re-armed timer must be invoked.*/
+  test_set_step(5);
+  {
+    n = 0U;
+    chVTObjectInit(&vt2);
+    chSysLock();
+    chVTDoSetDeferredI(&vt, 1, vtscb, &vt2);
+    chVTDoSetDeferredI(&vt2, 2, vtccb, &n);
+    chSysUnlock();
+    chThdSleep(10);
+    test_assert(n == 0U, "pending callback not cancelled");
+    chThdSleep(30);
+    test_assert(n == 1U, "re-armed timer not invoked once");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t rt_test_002_004 = {
+  "Deferred timer callbacks",
+  NULL,
+  NULL,
+  rt_test_002_004_execute
+};
+#endif /* CH_CFG_USE_VT_DEFERRED == TRUE */
+
+#if (CH_DBG_RECORDER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_002_005 [2.5] Flight recorder
+ *
+ * <h2>Description</h2>
+ * The flight recorder is tested, user events and context switches must be
+ * recorded in the current history in the expected order and the history
+ * must saturate at its size.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_DBG_RECORDER == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.5.1] Writing four user events, the events must be the last four
+ *   events of the current history.
+ * - [2.5.2] Reading beyond the available events, the read must fail in both
+ *   histories.
+ * - [2.5.3] Sleeping for one tick, the last event must be the switch back
+ *   to this thread.
+ * - [2.5.4] Writing more user events than the history size, the history
+ *   must be full and the oldest event must be the first one not
+ *   overwritten.
+ * .
+ */
+
+static void rt_test_002_005_execute(void) {
+  rec_event_t e;
+  size_t i, n;
+
+  /* [2.5.1] Writing four user events, the events must be the last four
+     events of the current history.*/
+  test_set_step(1);
+  {
+#if (CH_DBG_RECORDER_MASK & CH_DBG_TRACE_MASK_USER) != 0
+    for (i = 0U; i < 4U; i++) {
+      chRecWrite(5U, 0x5A00U + (uint32_t)i);
+    }
+    chSysLock();
+    n = chRecGetSizeI(CH_REC_CURRENT);
+    chSysUnlock();
+    test_assert(n >= 4U, "events missing");
+    for (i = 0U; i < 4U; i++) {
+      test_assert_lock(!chRecGetEventI(CH_REC_CURRENT, n - 4U + i, &e),
+                       "event not available");
+      test_assert(CH_REC_EVENT_TYPE(&e) == CH_TRACE_TYPE_USER, "wrong type");
+      test_assert(CH_REC_EVENT_STATE(&e) == 5U, "wrong code");
+      test_assert(e.value == 0x5A00U + (uint32_t)i, "wrong value");
+    }
+#endif
+  }
+  test_end_step(1);
+
+  /* [2.5.2] Reading beyond the available events, the read must fail in both
+     histories.*/
+  test_set_step(2);
+  {
+    chSysLock();
+    n = chRecGetSizeI(CH_REC_CURRENT);
+    chSysUnlock();
+    test_assert(n <= (size_t)CH_DBG_RECORDER_SIZE, "too many events");
+    test_assert_lock(chRecGetEventI(CH_REC_CURRENT, n, &e), "event available");
+    chSysLock();
+    n = chRecGetSizeI(CH_REC_PREVIOUS);
+    chSysUnlock();
+    test_assert(n <= (size_t)CH_DBG_RECORDER_SIZE, "too many events");
+    test_assert_lock(chRecGetEventI(CH_REC_PREVIOUS, n, &e), "event available");
+  }
+  test_end_step(2);
+
+  /* [2.5.3] Sleeping for one tick, the last event must be the switch back
+     to this thread.*/
+  test_set_step(3);
+  {
+#if (CH_DBG_RECORDER_MASK & CH_DBG_TRACE_MASK_SWITCH) != 0
+    chThdSleep(1);
+    chSysLock();
+    n = chRecGetSizeI(CH_REC_CURRENT);
+    (void)chRecGetEventI(CH_REC_CURRENT, n - 1U, &e);
+    chSysUnlock();
+    test_assert(CH_REC_EVENT_TYPE(&e) == CH_TRACE_TYPE_SWITCH, "wrong type");
+    test_assert(e.value == __rec_ptr(chThdGetSelfX()), "wrong thread");
+#endif
+  }
+  test_end_step(3);
+
+  /* [2.5.4] Writing more user events than the history size, the history
+     must be full and the oldest event must be the first one not
+     overwritten.*/
+  test_set_step(4);
+  {
+#if (CH_DBG_RECORDER_MASK & CH_DBG_TRACE_MASK_USER) != 0
+    for (i = 0U; i <= (size_t)CH_DBG_RECORDER_SIZE; i++) {
+      chRecWrite(7U, (uint32_t)i);
+    }
+    chSysLock();
+    n = chRecGetSizeI(CH_REC_CURRENT);
+    (void)chRecGetEventI(CH_REC_CURRENT, 0U, &e);
+    chSysUnlock();
+    test_assert(n == (size_t)CH_DBG_RECORDER_SIZE, "history not full");
+    test_assert(CH_REC_EVENT_TYPE(&e) == CH_TRACE_TYPE_USER, "wrong type");
+    test_assert(e.value == 1U, "wrong oldest event");
+#endif
+  }
+  test_end_step(4);
+}
+
+static const testcase_t rt_test_002_005 = {
+  "Flight recorder",
+  NULL,
+  NULL,
+  rt_test_002_005_execute
+};
+#endif /* CH_DBG_RECORDER == TRUE */
+
+#if (CH_DBG_CS_PROFILER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_002_006 [2.6] Critical zones profiler
+ *
+ * <h2>Description</h2>
+ * A tagged critical zone of known duration is executed several times, the
+ * zone must appear in the longest zones list and the tag entry in the sites
+ * table must account all the executions.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_DBG_CS_PROFILER == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [2.6.1] Resetting the profiler then executing a tagged critical zone
+ *   lasting at least 10000 realtime counter cycles, the zone must be in the
+ *   longest zones list.
+ * - [2.6.2] Checking that the longest zones list is in decreasing duration
+ *   order.
+ * - [2.6.3] Executing the tagged zone four more times, the tag entry must
+ *   count five zones and its histogram must account all of them.
+ * .
+ */
+
+static void rt_test_002_006_execute(void) {
+  static const char tag[] = "test";
+  csprof_record_t r;
+  csprof_site_t s;
+  unsigned i, j;
+  ucnt_t n;
+  bool b;
+
+  /* [2.6.1] Resetting the profiler then executing a tagged critical zone
+     lasting at least 10000 realtime counter cycles, the zone must be in the
+     longest zones list.*/
+  test_set_step(1);
+  {
+    chCSProfReset();
+    chSysLock();
+    chCSProfSetTagI(tag);
+    chSysPolledDelayX((rtcnt_t)10000);
+    chSysUnlock();
+    for (i = 0U; i < (unsigned)CH_DBG_CS_PROFILER_TOP; i++) {
+      chSysLock();
+      b = chCSProfGetTopI(i, &r);
+      chSysUnlock();
+      if (b || (r.site == (const void *)tag)) {
+        break;
+      }
+    }
+    test_assert(!b && (r.site == (const void *)tag), "zone not found");
+    test_assert(r.duration >= (rtcnt_t)10000, "duration too short");
+  }
+  test_end_step(1);
+
+  /* [2.6.2] Checking that the longest zones list is in decreasing duration
+     order.*/
+  test_set_step(2);
+  {
+    for (i = 1U; i < (unsigned)CH_DBG_CS_PROFILER_TOP; i++) {
+      csprof_record_t prev;
+
+      chSysLock();
+      (void)chCSProfGetTopI(i - 1U, &prev);
+      b = chCSProfGetTopI(i, &r);
+      chSysUnlock();
+      if (b) {
+        break;
+      }
+      test_assert(r.duration <= prev.duration, "wrong order");
+    }
+  }
+  test_end_step(2);
+
+  /* [2.6.3] Executing the tagged zone four more times, the tag entry must
+     count five zones and its histogram must account all of them.*/
+  test_set_step(3);
+  {
+    for (i = 0U; i < 4U; i++) {
+      chSysLock();
+      chCSProfSetTagI(tag);
+      chSysPolledDelayX((rtcnt_t)10000);
+      chSysUnlock();
+    }
+    for (i = 0U; i < (unsigned)CH_DBG_CS_PROFILER_SITES; i++) {
+      chSysLock();
+      b = chCSProfGetSiteI(i, &s);
+      chSysUnlock();
+      if (!b && (s.site == (const void *)tag)) {
+        break;
+      }
+    }
+    test_assert(i < (unsigned)CH_DBG_CS_PROFILER_SITES, "site not found");
+    test_assert(s.n == (ucnt_t)5, "wrong count");
+    test_assert(s.worst >= (rtcnt_t)10000, "worst too short");
+    n = (ucnt_t)0;
+    for (j = 0U; j < (unsigned)CH_DBG_CS_PROFILER_BUCKETS; j++) {
+      n += s.hist[j];
+    }
+    test_assert(n == s.n, "histogram mismatch");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_002_006 = {
+  "Critical zones profiler",
+  NULL,
+  NULL,
+  rt_test_002_006_execute
+};
+#endif /* CH_DBG_CS_PROFILER == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -252,6 +655,15 @@ const testcase_t * const rt_test_sequence_002_array[] = {
   &rt_test_002_001,
   &rt_test_002_002,
   &rt_test_002_003,
+#if (CH_CFG_USE_VT_DEFERRED == TRUE) || defined(__DOXYGEN__)
+  &rt_test_002_004,
+#endif
+#if (CH_DBG_RECORDER == TRUE) || defined(__DOXYGEN__)
+  &rt_test_002_005,
+#endif
+#if (CH_DBG_CS_PROFILER == TRUE) || defined(__DOXYGEN__)
+  &rt_test_002_006,
+#endif
   NULL
 };
 
@@ -34,6 +34,9 @@
  * - @subpage rt_test_005_002
  * - @subpage rt_test_005_003
  * - @subpage rt_test_005_004
+ * - @subpage rt_test_005_005
+ * - @subpage rt_test_005_006
+ * - @subpage rt_test_005_007
  * .
  */
 
@@ -46,6 +49,59 @@ static THD_FUNCTION(thread, p) {
   test_emit_token(*(char *)p);
 }
 
+#if (CH_CFG_USE_REGISTRY == TRUE) || defined(__DOXYGEN__)
+static void reg_release(thread_t *tp) {
+
+#if CH_CFG_USE_DYNAMIC == TRUE
+  if (tp != NULL) {
+    chThdRelease(tp);
+  }
+#else
+  (void)tp;
+#endif
+}
+#endif
+
+#if (CH_DBG_STACK_PROFILER == TRUE) || defined(__DOXYGEN__)
+static THD_FUNCTION(stk_thread, p) {
+  volatile uint8_t buf[32];
+  unsigned i;
+
+  for (i = 0; i < sizeof buf; i++) {
+    buf[i] = 0U;
+  }
+  test_emit_token(*(char *)p);
+  while (!chThdShouldTerminateX()) {
+    chThdSleepMilliseconds(10);
+  }
+}
+#endif
+
+#if (CH_CFG_TIME_QUANTUM > 0) || defined(__DOXYGEN__)
+static uint32_t rr_counters[2];
+
+static THD_FUNCTION(rr_thread, p) {
+  uint32_t *cntp = (uint32_t *)p;
+
+  while (!chThdShouldTerminateX()) {
+    (*cntp)++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+}
+
+static thread_t *rr_create(unsigned i, tprio_t prio, tslices_t quantum) {
+  stkalign_t *wbase = THD_WORKING_AREA_BASE(wa[i]);
+  stkalign_t *wend = wbase + (WA_SIZE / sizeof (stkalign_t));
+  thread_descriptor_t td = THD_DESCRIPTOR_QUANTUM("rr", wbase, wend, prio,
+                                                  rr_thread, &rr_counters[i],
+                                                  quantum);
+
+  return chThdCreate(&td);
+}
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -339,6 +395,316 @@ static const testcase_t rt_test_005_004 = {
 };
 #endif /* CH_CFG_USE_MUTEXES == TRUE */
 
+#if (CH_CFG_TIME_QUANTUM > 0) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_005_005 [5.5] Time quantum functionality
+ *
+ * <h2>Description</h2>
+ * The per-thread time quantum is tested, two threads at the same priority
+ * spin for half a second, the thread with the longer quantum must get more
+ * execution time.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_TIME_QUANTUM > 0
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [5.5.1] Checking the default quantum then changing it at runtime.
+ * - [5.5.2] Creating two spinning threads at the same priority, the first
+ *   has a quantum four times longer than the second. The test thread runs
+ *   above them.
+ * - [5.5.3] Letting the threads spin for half a second, the thread with the
+ *   longer quantum must have executed more iterations.
+ * .
+ */
+
+static void rt_test_005_005_setup(void) {
+  rr_counters[0] = 0U;
+  rr_counters[1] = 0U;
+}
+
+static void rt_test_005_005_execute(void) {
+  tprio_t prio;
+
+  /* [5.5.1] Checking the default quantum then changing it at runtime.*/
+  test_set_step(1);
+  {
+    tslices_t quantum = chThdGetQuantumX(chThdGetSelfX());
+
+    test_assert(quantum == (tslices_t)CH_CFG_TIME_QUANTUM,
+                "wrong default quantum");
+    test_assert(chThdSetQuantum((tslices_t)5) == quantum, "wrong old quantum");
+    test_assert(chThdGetQuantumX(chThdGetSelfX()) == (tslices_t)5,
+                "quantum not changed");
+    (void) chThdSetQuantum(quantum);
+  }
+  test_end_step(1);
+
+  /* [5.5.2] Creating two spinning threads at the same priority, the first
+     has a quantum four times longer than the second. The test thread runs
+     above them.*/
+  test_set_step(2);
+  {
+    prio = chThdSetPriority(chThdGetPriorityX() + 2);
+    threads[0] = rr_create(0U, prio + 1, (tslices_t)20);
+    threads[1] = rr_create(1U, prio + 1, (tslices_t)5);
+    test_assert(chThdGetQuantumX(threads[0]) == (tslices_t)20, "wrong quantum");
+    test_assert(chThdGetQuantumX(threads[1]) == (tslices_t)5, "wrong quantum");
+  }
+  test_end_step(2);
+
+  /* [5.5.3] Letting the threads spin for half a second, the thread with the
+     longer quantum must have executed more iterations.*/
+  test_set_step(3);
+  {
+    chThdSleepMilliseconds(500);
+    test_terminate_threads();
+#if CH_DBG_STATISTICS == TRUE
+    test_assert((chThdGetRRSwitchesX(threads[0]) > (ucnt_t)0) &&
+                (chThdGetRRSwitchesX(threads[1]) > (ucnt_t)0),
+                "no round robin switches");
+#endif
+    (void) chThdSetPriority(prio);
+    test_wait_threads();
+    test_assert(rr_counters[0] > rr_counters[1], "quantum not effective");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_005_005 = {
+  "Time quantum functionality",
+  rt_test_005_005_setup,
+  NULL,
+  rt_test_005_005_execute
+};
+#endif /* CH_CFG_TIME_QUANTUM > 0 */
+
+#if (CH_CFG_USE_REGISTRY == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_005_006 [5.6] Registry lookups and handles
+ *
+ * <h2>Description</h2>
+ * A thread is searched in the registry by name, by pointer and by handle,
+ * the handle must become stale when the thread is removed from the registry
+ * and must not match a newer thread created in the same working area.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_REGISTRY == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [5.6.1] Creating a thread at lower priority and assigning it a name.
+ * - [5.6.2] Searching the thread by name, by pointer and by handle.
+ * - [5.6.3] Renaming the thread, the old name must not be found anymore.
+ * - [5.6.4] Letting the thread terminate, the handle must become stale.
+ * - [5.6.5] Creating a new thread in the same working area, the old handle
+ *   must not match it while a new handle must.
+ * .
+ */
+
+static void rt_test_005_006_execute(void) {
+  thread_t *tp;
+  thread_handle_t th1, th2;
+
+  /* [5.6.1] Creating a thread at lower priority and assigning it a name.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() - 1,
+                                   thread, "A");
+    chRegSetThreadNameX(threads[0], "regtest");
+  }
+  test_end_step(1);
+
+  /* [5.6.2] Searching the thread by name, by pointer and by handle.*/
+  test_set_step(2);
+  {
+    th1 = chRegGetHandleX(threads[0]);
+    tp = chRegFindThreadByName("regtest");
+    test_assert(tp == threads[0], "not found by name");
+    reg_release(tp);
+    tp = chRegFindThreadByPointer(threads[0]);
+    test_assert(tp == threads[0], "not found by pointer");
+    reg_release(tp);
+    tp = chRegFindThreadByHandle(&th1);
+    test_assert(tp == threads[0], "not found by handle");
+    reg_release(tp);
+  }
+  test_end_step(2);
+
+  /* [5.6.3] Renaming the thread, the old name must not be found anymore.*/
+  test_set_step(3);
+  {
+    chRegSetThreadNameX(threads[0], "regtest2");
+    tp = chRegFindThreadByName("regtest");
+    test_assert(tp == NULL, "found by old name");
+    tp = chRegFindThreadByName("regtest2");
+    test_assert(tp == threads[0], "not found by new name");
+    reg_release(tp);
+  }
+  test_end_step(3);
+
+  /* [5.6.4] Letting the thread terminate, the handle must become stale.*/
+  test_set_step(4);
+  {
+    tp = threads[0];
+    test_wait_threads();
+    test_assert_sequence("A", "invalid sequence");
+    test_assert(chRegFindThreadByHandle(&th1) == NULL, "stale handle matched");
+    test_assert(chRegFindThreadByPointer(tp) == NULL, "found by pointer");
+    test_assert(chRegFindThreadByName("regtest2") == NULL, "found by name");
+  }
+  test_end_step(4);
+
+  /* [5.6.5] Creating a new thread in the same working area, the old handle
+     must not match it while a new handle must.*/
+  test_set_step(5);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() - 1,
+                                   thread, "B");
+    test_assert(threads[0] == tp, "different thread pointer");
+    th2 = chRegGetHandleX(threads[0]);
+    test_assert(chRegFindThreadByHandle(&th1) == NULL, "stale handle matched");
+    tp = chRegFindThreadByHandle(&th2);
+    test_assert(tp == threads[0], "not found by handle");
+    reg_release(tp);
+    test_wait_threads();
+    test_assert_sequence("B", "invalid sequence");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t rt_test_005_006 = {
+  "Registry lookups and handles",
+  NULL,
+  NULL,
+  rt_test_005_006_execute
+};
+#endif /* CH_CFG_USE_REGISTRY == TRUE */
+
+#if (CH_DBG_STACK_PROFILER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_005_007 [5.7] Stack profiler
+ *
+ * <h2>Description</h2>
+ * A thread using a known amount of stack is profiled, the measured peak
+ * usage and headroom must be consistent with the stack size. The headroom
+ * warning event is tested by raising the warning margin above the thread
+ * headroom.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_DBG_STACK_PROFILER == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [5.7.1] Creating a thread at higher priority, the thread uses a local
+ *   buffer then waits for termination.
+ * - [5.7.2] Updating the thread profile, the peak usage must include the
+ *   local buffer and the sum of peak usage and headroom must be the stack
+ *   size.
+ * - [5.7.3] Sampling the thread step by step, the scan pass must complete
+ *   within the expected number of samples and the results must not change.
+ * - [5.7.4] Raising the warning margin above the thread headroom, the
+ *   warning must be raised once.
+ * - [5.7.5] Terminating the thread.
+ * .
+ */
+
+static void rt_test_005_007_teardown(void) {
+  chStkProfSetMargin((size_t)CH_DBG_STACK_PROFILER_MARGIN);
+}
+
+static void rt_test_005_007_execute(void) {
+  size_t peak, unused;
+  unsigned n;
+
+  /* [5.7.1] Creating a thread at higher priority, the thread uses a local
+     buffer then waits for termination.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() + 1,
+                                   stk_thread, "A");
+    test_assert_sequence("A", "invalid sequence");
+  }
+  test_end_step(1);
+
+  /* [5.7.2] Updating the thread profile, the peak usage must include the
+     local buffer and the sum of peak usage and headroom must be the stack
+     size.*/
+  test_set_step(2);
+  {
+    chStkProfUpdate(threads[0]);
+    peak   = chStkProfGetPeakX(threads[0]);
+    unused = chStkProfGetUnusedX(threads[0]);
+    test_assert(peak >= (size_t)32, "peak too small");
+    test_assert(peak + unused ==
+                (size_t)((uint8_t *)threads[0] -
+                         (uint8_t *)chThdGetWorkingAreaX(threads[0])),
+                "inconsistent stack size");
+  }
+  test_end_step(2);
+
+  /* [5.7.3] Sampling the thread step by step, the scan pass must complete
+     within the expected number of samples and the results must not
+     change.*/
+  test_set_step(3);
+  {
+    n = 1;
+    while (!chStkProfSampleThread(threads[0])) {
+      n++;
+    }
+    test_assert(n <= (unused / (size_t)CH_DBG_STACK_PROFILER_STEP) + 1U,
+                "too many samples");
+    test_assert(chStkProfGetPeakX(threads[0]) == peak, "peak changed");
+    test_assert(chStkProfGetUnusedX(threads[0]) == unused, "headroom changed");
+  }
+  test_end_step(3);
+
+  /* [5.7.4] Raising the warning margin above the thread headroom, the
+     warning must be raised once.*/
+  test_set_step(4);
+  {
+#if CH_CFG_USE_EVENTS == TRUE
+    event_listener_t el;
+
+    chEvtGetAndClearEvents(ALL_EVENTS);
+    chEvtRegisterMask(chStkProfGetEventSourceX(), &el, EVENT_MASK(0));
+#endif
+    chStkProfSetMargin(unused + 1U);
+    chStkProfUpdate(threads[0]);
+#if CH_CFG_USE_EVENTS == TRUE
+    test_assert(chEvtGetAndClearEvents(ALL_EVENTS) == EVENT_MASK(0),
+                "warning not raised");
+    chStkProfUpdate(threads[0]);
+    test_assert(chEvtGetAndClearEvents(ALL_EVENTS) == (eventmask_t)0,
+                "warning raised again");
+    chEvtUnregister(chStkProfGetEventSourceX(), &el);
+#endif
+  }
+  test_end_step(4);
+
+  /* [5.7.5] Terminating the thread.*/
+  test_set_step(5);
+  {
+    test_terminate_threads();
+    test_wait_threads();
+  }
+  test_end_step(5);
+}
+
+static const testcase_t rt_test_005_007 = {
+  "Stack profiler",
+  NULL,
+  rt_test_005_007_teardown,
+  rt_test_005_007_execute
+};
+#endif /* CH_DBG_STACK_PROFILER == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -352,6 +718,15 @@ const testcase_t * const rt_test_sequence_005_array[] = {
   &rt_test_005_003,
 #if (CH_CFG_USE_MUTEXES == TRUE) || defined(__DOXYGEN__)
   &rt_test_005_004,
+#endif
+#if (CH_CFG_TIME_QUANTUM > 0) || defined(__DOXYGEN__)
+  &rt_test_005_005,
+#endif
+#if (CH_CFG_USE_REGISTRY == TRUE) || defined(__DOXYGEN__)
+  &rt_test_005_006,
+#endif
+#if (CH_DBG_STACK_PROFILER == TRUE) || defined(__DOXYGEN__)
+  &rt_test_005_007,
 #endif
   NULL
 };
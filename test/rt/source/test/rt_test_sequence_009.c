@@ -37,6 +37,9 @@
  *
  * <h2>Test Cases</h2>
  * - @subpage rt_test_009_001
+ * - @subpage rt_test_009_002
+ * - @subpage rt_test_009_003
+ * - @subpage rt_test_009_004
  * .
  */
 
@@ -54,6 +57,47 @@ static THD_FUNCTION(msg_thread1, p) {
   chMsgSend(p, 'D');
 }
 
+static thread_t *msg_server;
+
+static THD_FUNCTION(msg_thread2, p) {
+
+  test_emit_token((char)chMsgSend(msg_server, *(char *)p));
+}
+
+#if CH_CFG_USE_MESSAGES_ASYNC == TRUE
+static THD_FUNCTION(msg_thread3, p) {
+  thread_t *tp;
+  msg_t msg;
+  unsigned i;
+
+  (void)p;
+  for (i = 0; i < 2; i++) {
+    tp = chMsgWait();
+    msg = chMsgGet(tp);
+    test_emit_token((char)msg);
+    chMsgRelease(tp, msg + ('a' - 'A'));
+  }
+}
+#endif
+
+#if (CH_CFG_USE_MESSAGES_PRIORITY == TRUE) && (CH_CFG_USE_MUTEXES == TRUE)
+static MUTEX_DECL(msg_mtx);
+
+static THD_FUNCTION(msg_thread4, p) {
+
+  chMtxLock(&msg_mtx);
+  (void) chMsgSend(msg_server, *(char *)p);
+  chMtxUnlock(&msg_mtx);
+}
+
+static THD_FUNCTION(msg_thread5, p) {
+
+  chMtxLock(&msg_mtx);
+  test_emit_token(*(char *)p);
+  chMtxUnlock(&msg_mtx);
+}
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -109,6 +153,248 @@ static const testcase_t rt_test_009_001 = {
   rt_test_009_001_execute
 };
 
+/**
+ * @page rt_test_009_002 [9.2] Messages batch receive
+ *
+ * <h2>Description</h2>
+ * Three messenger threads are spawned, the messages are received in batches
+ * and released together, the test expects the messages and the answers in
+ * the correct sequence.
+ *
+ * <h2>Test Steps</h2>
+ * - [9.2.1] Starting three messenger threads, all are queued on the tester
+ *   thread.
+ * - [9.2.2] Receiving a batch of two messages then releasing both, the
+ *   first two messengers must be returned in order.
+ * - [9.2.3] Receiving with TIME_IMMEDIATE timeout, only the third message
+ *   must be returned.
+ * - [9.2.4] Receiving again with TIME_IMMEDIATE timeout, no message must be
+ *   returned.
+ * .
+ */
+
+static void rt_test_009_002_setup(void) {
+  msg_server = chThdGetSelfX();
+}
+
+static void rt_test_009_002_execute(void) {
+  thread_t *tps[2];
+  msg_t msgs[2];
+  cnt_t n;
+
+  /* [9.2.1] Starting three messenger threads, all are queued on the tester
+     thread.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() + 1,
+                                   msg_thread2, "A");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, chThdGetPriorityX() + 1,
+                                   msg_thread2, "B");
+    threads[2] = chThdCreateStatic(wa[2], WA_SIZE, chThdGetPriorityX() + 1,
+                                   msg_thread2, "C");
+  }
+  test_end_step(1);
+
+  /* [9.2.2] Receiving a batch of two messages then releasing both, the
+     first two messengers must be returned in order.*/
+  test_set_step(2);
+  {
+    n = chMsgWaitBatch(tps, 2);
+    test_assert(n == 2, "wrong number of messages");
+    test_emit_token((char)chMsgGet(tps[0]));
+    test_emit_token((char)chMsgGet(tps[1]));
+    msgs[0] = 'a';
+    msgs[1] = 'b';
+    chMsgReleaseBatch(tps, msgs, n);
+  }
+  test_end_step(2);
+
+  /* [9.2.3] Receiving with TIME_IMMEDIATE timeout, only the third message
+     must be returned.*/
+  test_set_step(3);
+  {
+    n = chMsgWaitBatchTimeout(tps, 2, TIME_IMMEDIATE);
+    test_assert(n == 1, "wrong number of messages");
+    test_emit_token((char)chMsgGet(tps[0]));
+    chMsgRelease(tps[0], 'c');
+  }
+  test_end_step(3);
+
+  /* [9.2.4] Receiving again with TIME_IMMEDIATE timeout, no message must be
+     returned.*/
+  test_set_step(4);
+  {
+    n = chMsgWaitBatchTimeout(tps, 2, TIME_IMMEDIATE);
+    test_assert(n == 0, "spurious message");
+    test_wait_threads();
+    test_assert_sequence("ABabCc", "invalid sequence");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t rt_test_009_002 = {
+  "Messages batch receive",
+  rt_test_009_002_setup,
+  NULL,
+  rt_test_009_002_execute
+};
+
+#if (CH_CFG_USE_MESSAGES_ASYNC == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_009_003 [9.3] Asynchronous messages
+ *
+ * <h2>Description</h2>
+ * A lower priority server thread is spawned, the tester thread sends two
+ * asynchronous messages and collects the answers both before and after the
+ * server has processed them.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_MESSAGES_ASYNC == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [9.3.1] Starting the server thread.
+ * - [9.3.2] Sending a message without waiting then waiting for the answer,
+ *   the server must process the message while the tester thread is waiting.
+ * - [9.3.3] Sending a message then sleeping, the answer must be available
+ *   before waiting for it.
+ * .
+ */
+
+static void rt_test_009_003_execute(void) {
+
+  /* [9.3.1] Starting the server thread.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() - 1,
+                                   msg_thread3, NULL);
+  }
+  test_end_step(1);
+
+  /* [9.3.2] Sending a message without waiting then waiting for the answer,
+     the server must process the message while the tester thread is
+     waiting.*/
+  test_set_step(2);
+  {
+    msg_t msg;
+
+    chMsgSendAsync(threads[0], 'A');
+    test_emit_token('1');
+    msg = chMsgWaitAnswer();
+    test_emit_token((char)msg);
+  }
+  test_end_step(2);
+
+  /* [9.3.3] Sending a message then sleeping, the answer must be available
+     before waiting for it.*/
+  test_set_step(3);
+  {
+    msg_t msg;
+
+    chMsgSendAsync(threads[0], 'B');
+    chThdSleepMilliseconds(10);
+    test_assert(chMsgIsAnsweredX(), "not answered");
+    test_emit_token('2');
+    msg = chMsgWaitAnswer();
+    test_assert(!chMsgIsAnsweredX(), "still answered");
+    test_emit_token((char)msg);
+    test_wait_threads();
+    test_assert_sequence("1AaB2b", "invalid sequence");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_009_003 = {
+  "Asynchronous messages",
+  NULL,
+  NULL,
+  rt_test_009_003_execute
+};
+#endif /* CH_CFG_USE_MESSAGES_ASYNC == TRUE */
+
+#if ((CH_CFG_USE_MESSAGES_PRIORITY == TRUE) && (CH_CFG_USE_MUTEXES == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_009_004 [9.4] Boosted messages sender
+ *
+ * <h2>Description</h2>
+ * A messenger thread owning a mutex and a messenger thread with higher
+ * priority are queued on the tester thread, then a thread with even higher
+ * priority waits on the mutex. The priority of the mutex owner is boosted
+ * and its message must be received first.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_USE_MESSAGES_PRIORITY == TRUE) && (CH_CFG_USE_MUTEXES == TRUE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [9.4.1] Starting a messenger thread owning a mutex and a messenger
+ *   thread with higher priority, both are queued on the tester thread.
+ * - [9.4.2] Starting a thread with higher priority waiting on the mutex,
+ *   the first messenger thread priority is boosted.
+ * - [9.4.3] Receiving the messages, the message of the boosted thread must
+ *   be received first.
+ * .
+ */
+
+static void rt_test_009_004_setup(void) {
+  msg_server = chThdGetSelfX();
+}
+
+static void rt_test_009_004_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+  thread_t *tp;
+  msg_t msg;
+
+  /* [9.4.1] Starting a messenger thread owning a mutex and a messenger
+     thread with higher priority, both are queued on the tester thread.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio + 1,
+                                   msg_thread4, "B");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio + 2,
+                                   msg_thread2, "C");
+  }
+  test_end_step(1);
+
+  /* [9.4.2] Starting a thread with higher priority waiting on the mutex,
+     the first messenger thread priority is boosted.*/
+  test_set_step(2);
+  {
+    threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio + 3,
+                                   msg_thread5, "A");
+  }
+  test_end_step(2);
+
+  /* [9.4.3] Receiving the messages, the message of the boosted thread must
+     be received first.*/
+  test_set_step(3);
+  {
+    unsigned i;
+
+    for (i = 0; i < 2; i++) {
+      tp = chMsgWait();
+      msg = chMsgGet(tp);
+      test_emit_token((char)msg);
+      chMsgRelease(tp, msg + ('a' - 'A'));
+    }
+    test_wait_threads();
+    test_assert_sequence("BACc", "invalid sequence");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_009_004 = {
+  "Boosted messages sender",
+  rt_test_009_004_setup,
+  NULL,
+  rt_test_009_004_execute
+};
+#endif /* (CH_CFG_USE_MESSAGES_PRIORITY == TRUE) && (CH_CFG_USE_MUTEXES == TRUE) */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -118,6 +404,13 @@ static const testcase_t rt_test_009_001 = {
  */
 const testcase_t * const rt_test_sequence_009_array[] = {
   &rt_test_009_001,
+  &rt_test_009_002,
+#if (CH_CFG_USE_MESSAGES_ASYNC == TRUE) || defined(__DOXYGEN__)
+  &rt_test_009_003,
+#endif
+#if ((CH_CFG_USE_MESSAGES_PRIORITY == TRUE) && (CH_CFG_USE_MUTEXES == TRUE)) || defined(__DOXYGEN__)
+  &rt_test_009_004,
+#endif
   NULL
 };
 
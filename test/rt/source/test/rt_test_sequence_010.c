@@ -42,6 +42,7 @@
  * - @subpage rt_test_010_005
  * - @subpage rt_test_010_006
  * - @subpage rt_test_010_007
+ * - @subpage rt_test_010_008
  * .
  */
 
@@ -73,6 +74,15 @@ static THD_FUNCTION(evt_thread7, p) {
   chEvtBroadcast(&es2);
 }
 
+#if CH_CFG_USE_EVENTS_POLL == TRUE
+static THD_FUNCTION(evt_thread8, p) {
+
+  (void)p;
+  chThdSleepMilliseconds(50);
+  chEvtBroadcastFlags(&es2, 2);
+}
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -573,6 +583,128 @@ static const testcase_t rt_test_010_007 = {
   rt_test_010_007_execute
 };
 
+#if (CH_CFG_USE_EVENTS_POLL == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_010_008 [10.8] Events Poll Sets
+ *
+ * <h2>Description</h2>
+ * Functionality of poll sets is tested, only the listeners whose sources
+ * have been broadcasted must be returned.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_EVENTS_POLL == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [10.8.1] Initializing a poll set and registering on two event sources,
+ *   the second listener is only interested in flag 2.
+ * - [10.8.2] Waiting with TIME_IMMEDIATE timeout, no listener must be
+ *   returned.
+ * - [10.8.3] Broadcasting the second source with flag 1 then the first
+ *   source twice, only the first listener must be returned and no events
+ *   must be signaled.
+ * - [10.8.4] Starting a broadcaster thread, the thread broadcasts the
+ *   second source with flag 2 after 50mS, the poll set wait must return the
+ *   second listener.
+ * - [10.8.5] Broadcasting both sources then unregistering the first
+ *   listener, only the second listener must be returned.
+ * .
+ */
+
+static void rt_test_010_008_setup(void) {
+  chEvtGetAndClearEvents(ALL_EVENTS);
+  chEvtObjectInit(&es1);
+  chEvtObjectInit(&es2);
+}
+
+static void rt_test_010_008_execute(void) {
+  event_poll_t ep;
+  event_listener_t el1, el2;
+  event_listener_t *elps[2];
+  systime_t target_time;
+  cnt_t n;
+
+  /* [10.8.1] Initializing a poll set and registering on two event sources,
+     the second listener is only interested in flag 2.*/
+  test_set_step(1);
+  {
+    chEvtPollObjectInit(&ep);
+    chEvtPollRegister(&ep, &es1, &el1);
+    chEvtPollRegisterWithFlags(&ep, &es2, &el2, 2);
+  }
+  test_end_step(1);
+
+  /* [10.8.2] Waiting with TIME_IMMEDIATE timeout, no listener must be
+     returned.*/
+  test_set_step(2);
+  {
+    n = chEvtPollWaitTimeout(&ep, elps, 2, TIME_IMMEDIATE);
+    test_assert(n == 0, "spurious listener");
+  }
+  test_end_step(2);
+
+  /* [10.8.3] Broadcasting the second source with flag 1 then the first
+     source twice, only the first listener must be returned and no events
+     must be signaled.*/
+  test_set_step(3);
+  {
+    chEvtBroadcastFlags(&es2, 1);
+    chEvtBroadcastFlags(&es1, 1);
+    chEvtBroadcastFlags(&es1, 4);
+    n = chEvtPollWaitTimeout(&ep, elps, 2, TIME_IMMEDIATE);
+    test_assert(n == 1, "wrong number of listeners");
+    test_assert(elps[0] == &el1, "wrong listener");
+    test_assert(chEvtGetAndClearFlags(&el1) == 5, "wrong flags");
+    test_assert(chEvtGetAndClearEvents(ALL_EVENTS) == 0, "spurious event");
+  }
+  test_end_step(3);
+
+  /* [10.8.4] Starting a broadcaster thread, the thread broadcasts the
+     second source with flag 2 after 50mS, the poll set wait must return the
+     second listener.*/
+  test_set_step(4);
+  {
+    target_time = chTimeAddX(test_wait_tick(), TIME_MS2I(50));
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() - 1,
+                                   evt_thread8, NULL);
+    n = chEvtPollWaitTimeout(&ep, elps, 2, TIME_INFINITE);
+    test_assert_time_window(target_time,
+                            chTimeAddX(target_time, ALLOWED_DELAY),
+                            "out of time window");
+    test_assert(n == 1, "wrong number of listeners");
+    test_assert(elps[0] == &el2, "wrong listener");
+    test_assert(chEvtGetAndClearFlags(&el2) == 2, "wrong flags");
+    test_wait_threads();
+  }
+  test_end_step(4);
+
+  /* [10.8.5] Broadcasting both sources then unregistering the first
+     listener, only the second listener must be returned.*/
+  test_set_step(5);
+  {
+    chEvtBroadcast(&es1);
+    chEvtBroadcast(&es2);
+    chEvtUnregister(&es1, &el1);
+    n = chEvtPollWaitTimeout(&ep, elps, 2, TIME_IMMEDIATE);
+    test_assert(n == 1, "wrong number of listeners");
+    test_assert(elps[0] == &el2, "wrong listener");
+    chEvtUnregister(&es2, &el2);
+    test_assert(!chEvtIsListeningI(&es1), "stuck listener");
+    test_assert(!chEvtIsListeningI(&es2), "stuck listener");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t rt_test_010_008 = {
+  "Events Poll Sets",
+  rt_test_010_008_setup,
+  NULL,
+  rt_test_010_008_execute
+};
+#endif /* CH_CFG_USE_EVENTS_POLL == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -590,6 +722,9 @@ const testcase_t * const rt_test_sequence_010_array[] = {
   &rt_test_010_006,
 #endif
   &rt_test_010_007,
+#if (CH_CFG_USE_EVENTS_POLL == TRUE) || defined(__DOXYGEN__)
+  &rt_test_010_008,
+#endif
   NULL
 };
 
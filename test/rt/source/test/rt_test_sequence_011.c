@@ -38,6 +38,7 @@
  * <h2>Test Cases</h2>
  * - @subpage rt_test_011_001
  * - @subpage rt_test_011_002
+ * - @subpage rt_test_011_003
  * .
  */
 
@@ -52,6 +53,7 @@ static memory_heap_t heap1;
 #endif
 #if CH_CFG_USE_MEMPOOLS
 static memory_pool_t mp1;
+static thread_pool_t tpool1;
 #endif
 
 static THD_FUNCTION(dyn_thread1, p) {
@@ -276,6 +278,123 @@ static const testcase_t rt_test_011_002 = {
 };
 #endif /* CH_CFG_USE_MEMPOOLS == TRUE */
 
+#if (CH_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_011_003 [11.3] Threads creation from Thread Pool
+ *
+ * <h2>Description</h2>
+ * Two threads are started from a thread pool backed by a memory pool
+ * containing two elements, a third creation is expected to fail.<br> After
+ * the threads returned, two more threads are created, the parked threads
+ * are expected to be reused without allocating memory. Flushing the thread
+ * pool is expected to return the working areas to the memory pool.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_MEMPOOLS == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [11.3.1] Adding two working areas to the memory pool.
+ * - [11.3.2] Getting base priority for threads.
+ * - [11.3.3] Creating three threads, the third creation is expected to
+ *   fail.
+ * - [11.3.4] Lowering priority in order to let the threads run and park,
+ *   then checking the execution sequence.
+ * - [11.3.5] Creating two more threads, the parked threads are expected to
+ *   be reused, last parked first.
+ * - [11.3.6] Flushing the thread pool then testing that the memory pool
+ *   contains two elements again.
+ * .
+ */
+
+static void rt_test_011_003_setup(void) {
+  chPoolObjectInit(&mp1, THD_WORKING_AREA_SIZE(THREADS_STACK_SIZE), NULL);
+  chThdPoolObjectInit(&tpool1, &mp1);
+}
+
+static void rt_test_011_003_execute(void) {
+  unsigned i;
+  tprio_t prio;
+  thread_t *ptp[4];
+
+  /* [11.3.1] Adding two working areas to the memory pool.*/
+  test_set_step(1);
+  {
+    for (i = 0; i < 2; i++)
+      chPoolFree(&mp1, wa[i]);
+  }
+  test_end_step(1);
+
+  /* [11.3.2] Getting base priority for threads.*/
+  test_set_step(2);
+  {
+    prio = chThdGetPriorityX();
+  }
+  test_end_step(2);
+
+  /* [11.3.3] Creating three threads, the third creation is expected to
+     fail.*/
+  test_set_step(3);
+  {
+    ptp[0] = chThdCreateFromThreadPool(&tpool1, "pool1", prio-1, dyn_thread1, "A");
+    ptp[1] = chThdCreateFromThreadPool(&tpool1, "pool2", prio-2, dyn_thread1, "B");
+    ptp[2] = chThdCreateFromThreadPool(&tpool1, "pool3", prio-3, dyn_thread1, "C");
+    test_assert((ptp[0] != NULL) && (ptp[1] != NULL),
+                "thread creation failed");
+    test_assert(ptp[2] == NULL, "thread creation not failed");
+    test_assert(chThdPoolGetCreatedX(&tpool1) == 2, "wrong created count");
+    test_assert(chThdPoolGetReusedX(&tpool1) == 0, "wrong reused count");
+  }
+  test_end_step(3);
+
+  /* [11.3.4] Lowering priority in order to let the threads run and park,
+     then checking the execution sequence.*/
+  test_set_step(4);
+  {
+    chThdSetPriority(prio-3);
+    chThdSetPriority(prio);
+    test_assert_sequence("AB", "invalid sequence");
+  }
+  test_end_step(4);
+
+  /* [11.3.5] Creating two more threads, the parked threads are expected to
+     be reused, last parked first.*/
+  test_set_step(5);
+  {
+    ptp[2] = chThdCreateFromThreadPool(&tpool1, "pool3", prio-1, dyn_thread1, "C");
+    ptp[3] = chThdCreateFromThreadPool(&tpool1, "pool4", prio-2, dyn_thread1, "D");
+    test_assert(ptp[2] == ptp[1], "parked thread not reused");
+    test_assert(ptp[3] == ptp[0], "parked thread not reused");
+    test_assert(chThdPoolGetCreatedX(&tpool1) == 2, "wrong created count");
+    test_assert(chThdPoolGetReusedX(&tpool1) == 2, "wrong reused count");
+    chThdSetPriority(prio-3);
+    chThdSetPriority(prio);
+    test_assert_sequence("CD", "invalid sequence");
+  }
+  test_end_step(5);
+
+  /* [11.3.6] Flushing the thread pool then testing that the memory pool
+     contains two elements again.*/
+  test_set_step(6);
+  {
+    chThdPoolFlush(&tpool1);
+    for (i = 0; i < 2; i++)
+      test_assert(chPoolAlloc(&mp1) != NULL, "pool list empty");
+    test_assert(chPoolAlloc(&mp1) == NULL, "pool list not empty");
+  }
+  test_end_step(6);
+}
+
+static const testcase_t rt_test_011_003 = {
+  "Threads creation from Thread Pool",
+  rt_test_011_003_setup,
+  NULL,
+  rt_test_011_003_execute
+};
+#endif /* CH_CFG_USE_MEMPOOLS == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -289,6 +408,9 @@ const testcase_t * const rt_test_sequence_011_array[] = {
 #endif
 #if (CH_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
   &rt_test_011_002,
+#endif
+#if (CH_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
+  &rt_test_011_003,
 #endif
   NULL
 };
@@ -46,6 +46,9 @@
  * - @subpage rt_test_012_010
  * - @subpage rt_test_012_011
  * - @subpage rt_test_012_012
+ * - @subpage rt_test_012_013
+ * - @subpage rt_test_012_014
+ * - @subpage rt_test_012_015
  * .
  */
 
@@ -59,6 +62,30 @@ static semaphore_t sem1;
 #if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
 static mutex_t mtx1;
 #endif
+#if CH_CFG_USE_CONDVARS || defined(__DOXYGEN__)
+static condition_variable_t cv1;
+
+static THD_FUNCTION(bmk_thread9, p) {
+
+  (void)p;
+  chMtxLock(&mtx1);
+  while (!chThdShouldTerminateX()) {
+    (void) chCondWait(&cv1);
+  }
+  chMtxUnlock(&mtx1);
+}
+#endif
+#if (CH_CFG_USE_MUTEXES && CH_CFG_USE_SEMAPHORES) || defined(__DOXYGEN__)
+static THD_FUNCTION(bmk_thread10, p) {
+
+  (void)p;
+  while (!chThdShouldTerminateX()) {
+    chSemWait(&sem1);
+    chMtxLock(&mtx1);
+    chMtxUnlock(&mtx1);
+  }
+}
+#endif
 
 static void tmo(virtual_timer_t *vtp, void *param) {
 
@@ -138,6 +165,22 @@ static THD_FUNCTION(bmk_thread8, p) {
   } while(!chThdShouldTerminateX());
 }
 
+NOINLINE static uint32_t cache_sweep(void) {
+  const volatile void *base = &test_buffer[WA_SIZE];
+  const volatile uint32_t *p, *end;
+  uint32_t acc = 0U;
+
+  /* Reading one word every 16 bytes from the unused working areas.*/
+  p   = (const volatile uint32_t *)base;
+  end = p + ((WA_SIZE * 4U) / sizeof (uint32_t));
+  while (p < end) {
+    acc += *p;
+    p += 4;
+  }
+
+  return acc;
+}
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -916,28 +959,343 @@ static const testcase_t rt_test_012_011 = {
 };
 #endif /* CH_CFG_USE_MUTEXES ==TRUE */
 
+#if (CH_CFG_USE_CONDVARS == TRUE) || defined(__DOXYGEN__)
 /**
- * @page rt_test_012_012 [12.12] RAM Footprint
+ * @page rt_test_012_012 [12.12] Condition variables broadcast performance
  *
  * <h2>Description</h2>
- * The memory size of the various kernel objects is printed.
+ * Four threads wait on a condition variable, a lower priority thread locks
+ * the mutex, broadcasts the condition variable and unlocks the mutex into a
+ * continuous loop. The released threads are moved on the mutex queue and
+ * acquire it in turn without further context switches.<br>
+ * The performance is calculated by measuring the number of iterations
+ * after a second of continuous operations, the number of context switches
+ * per broadcast is also printed if the kernel statistics are enabled.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_CONDVARS == TRUE
+ * .
  *
  * <h2>Test Steps</h2>
- * - [12.12.1] The size of the system area is printed.
- * - [12.12.2] The size of a thread structure is printed.
- * - [12.12.3] The size of a virtual timer structure is printed.
- * - [12.12.4] The size of a semaphore structure is printed.
- * - [12.12.5] The size of a mutex is printed.
- * - [12.12.6] The size of a condition variable is printed.
- * - [12.12.7] The size of an event source is printed.
- * - [12.12.8] The size of an event listener is printed.
- * - [12.12.9] The size of a mailbox is printed.
+ * - [12.12.1] Four threads are created at higher priority that wait on the
+ *   condition variable.
+ * - [12.12.2] The mutex is locked, the condition variable is broadcast and
+ *   the mutex is unlocked. The operation is repeated continuously in a
+ *   one-second time window.
+ * - [12.12.3] The four threads are terminated.
+ * - [12.12.4] The score is printed.
  * .
  */
 
+static void rt_test_012_012_setup(void) {
+  chMtxObjectInit(&mtx1);
+  chCondObjectInit(&cv1);
+}
+
 static void rt_test_012_012_execute(void) {
+  uint32_t n;
+#if CH_DBG_STATISTICS == TRUE
+  ucnt_t ctxswc;
+#endif
+
+  /* [12.12.1] Four threads are created at higher priority that wait on the
+     condition variable.*/
+  test_set_step(1);
+  {
+    tprio_t prio = chThdGetPriorityX() + 1;
+
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio, bmk_thread9, NULL);
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio, bmk_thread9, NULL);
+    threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio, bmk_thread9, NULL);
+    threads[3] = chThdCreateStatic(wa[3], WA_SIZE, prio, bmk_thread9, NULL);
+  }
+  test_end_step(1);
+
+  /* [12.12.2] The mutex is locked, the condition variable is broadcast and
+     the mutex is unlocked. The operation is repeated continuously in a
+     one-second time window.*/
+  test_set_step(2);
+  {
+    systime_t start, end;
+
+    n = 0;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+#if CH_DBG_STATISTICS == TRUE
+    ctxswc = currcore->kernel_stats.n_ctxswc;
+#endif
+    do {
+      chMtxLock(&mtx1);
+      chCondBroadcast(&cv1);
+      chMtxUnlock(&mtx1);
+      n++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+#if CH_DBG_STATISTICS == TRUE
+    ctxswc = currcore->kernel_stats.n_ctxswc - ctxswc;
+#endif
+  }
+  test_end_step(2);
+
+  /* [12.12.3] The four threads are terminated.*/
+  test_set_step(3);
+  {
+    test_terminate_threads();
+    chMtxLock(&mtx1);
+    chCondBroadcast(&cv1);
+    chMtxUnlock(&mtx1);
+    test_wait_threads();
+  }
+  test_end_step(3);
+
+  /* [12.12.4] The score is printed.*/
+  test_set_step(4);
+  {
+    test_print("--- Score : ");
+    test_printn(n);
+    test_println(" broadcasts/S");
+#if CH_DBG_STATISTICS == TRUE
+    test_print("--- CtxSw : ");
+    test_printn((ctxswc + (n / 2U)) / n);
+    test_println(" ctxswc/broadcast");
+#endif
+  }
+  test_end_step(4);
+}
+
+static const testcase_t rt_test_012_012 = {
+  "Condition variables broadcast performance",
+  rt_test_012_012_setup,
+  NULL,
+  rt_test_012_012_execute
+};
+#endif /* CH_CFG_USE_CONDVARS == TRUE */
+
+#if ((CH_CFG_USE_MUTEXES == TRUE) && (CH_CFG_USE_SEMAPHORES == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_012_013 [12.13] Mutexes contended lock/unlock performance
+ *
+ * <h2>Description</h2>
+ * A thread locks a mutex and wakes a higher priority thread that blocks on
+ * the same mutex, the mutex is then unlocked and handed over to the waiting
+ * thread, the sequence is repeated into a continuous loop.<br> The
+ * performance is calculated by measuring the number of iterations after a
+ * second of continuous operations. This is the contended counterpart of the
+ * lock/unlock benchmark.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_USE_MUTEXES == TRUE) && (CH_CFG_USE_SEMAPHORES == TRUE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [12.13.1] A thread is created at higher priority, it waits on a
+ *   semaphore then locks and unlocks the mutex.
+ * - [12.13.2] The mutex is locked, the semaphore is signaled and the mutex
+ *   is unlocked. The operation is repeated continuously in a one-second
+ *   time window.
+ * - [12.13.3] The thread is terminated.
+ * - [12.13.4] The score is printed.
+ * .
+ */
+
+static void rt_test_012_013_setup(void) {
+  chMtxObjectInit(&mtx1);
+  chSemObjectInit(&sem1, 0);
+}
+
+static void rt_test_012_013_execute(void) {
+  uint32_t n;
+
+  /* [12.13.1] A thread is created at higher priority, it waits on a
+     semaphore then locks and unlocks the mutex.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX() + 1,
+                                   bmk_thread10, NULL);
+  }
+  test_end_step(1);
+
+  /* [12.13.2] The mutex is locked, the semaphore is signaled and the mutex
+     is unlocked. The operation is repeated continuously in a one-second
+     time window.*/
+  test_set_step(2);
+  {
+    systime_t start, end;
+
+    n = 0;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      chMtxLock(&mtx1);
+      chSemSignal(&sem1);
+      chMtxUnlock(&mtx1);
+      n++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+  test_end_step(2);
+
+  /* [12.13.3] The thread is terminated.*/
+  test_set_step(3);
+  {
+    test_terminate_threads();
+    chSemSignal(&sem1);
+    test_wait_threads();
+  }
+  test_end_step(3);
+
+  /* [12.13.4] The score is printed.*/
+  test_set_step(4);
+  {
+    test_print("--- Score : ");
+    test_printn(n);
+    test_println(" lock+unlock/S");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t rt_test_012_013 = {
+  "Mutexes contended lock/unlock performance",
+  rt_test_012_013_setup,
+  NULL,
+  rt_test_012_013_execute
+};
+#endif /* (CH_CFG_USE_MUTEXES == TRUE) && (CH_CFG_USE_SEMAPHORES == TRUE) */
+
+/**
+ * @page rt_test_012_014 [12.14] Context Switch performance, cold cache
+ *
+ * <h2>Description</h2>
+ * The context switch benchmark is repeated sweeping the unused test working
+ * areas between switches in order to evict the thread structures from the
+ * data cache, the sweep alone is measured first.<br> The difference with
+ * the plain context switch score shows the cost of the cache misses on the
+ * context switch path.
+ *
+ * <h2>Test Steps</h2>
+ * - [12.14.1] Starting the target thread at an higher priority level.
+ * - [12.14.2] Sweeping the working areas as fast as possible in a one
+ *   second time window.
+ * - [12.14.3] Waking up the thread after each sweep in a one second time
+ *   window.
+ * - [12.14.4] Stopping the target thread.
+ * - [12.14.5] Score is printed.
+ * .
+ */
 
-  /* [12.12.1] The size of the system area is printed.*/
+static void rt_test_012_014_execute(void) {
+  thread_t *tp;
+  uint32_t n, nsweep;
+
+  /* [12.14.1] Starting the target thread at an higher priority level.*/
+  test_set_step(1);
+  {
+    tp = threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1,
+                                        bmk_thread4, NULL);
+  }
+  test_end_step(1);
+
+  /* [12.14.2] Sweeping the working areas as fast as possible in a one
+     second time window.*/
+  test_set_step(2);
+  {
+    systime_t start, end;
+
+    nsweep = 0;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      (void)cache_sweep();
+      nsweep++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+  test_end_step(2);
+
+  /* [12.14.3] Waking up the thread after each sweep in a one second time
+     window.*/
+  test_set_step(3);
+  {
+    systime_t start, end;
+
+    n = 0;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      (void)cache_sweep();
+      chSysLock();
+      chSchWakeupS(tp, MSG_OK);
+      chSysUnlock();
+      n++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+  test_end_step(3);
+
+  /* [12.14.4] Stopping the target thread.*/
+  test_set_step(4);
+  {
+    chSysLock();
+    chSchWakeupS(tp, MSG_TIMEOUT);
+    chSysUnlock();
+    test_wait_threads();
+  }
+  test_end_step(4);
+
+  /* [12.14.5] Score is printed.*/
+  test_set_step(5);
+  {
+    test_print("--- Sweeps: ");
+    test_printn(nsweep);
+    test_println(" sweeps/S");
+    test_print("--- Score : ");
+    test_printn(n * 2);
+    test_println(" ctxswc/S");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t rt_test_012_014 = {
+  "Context Switch performance, cold cache",
+  NULL,
+  NULL,
+  rt_test_012_014_execute
+};
+
+/**
+ * @page rt_test_012_015 [12.15] RAM Footprint
+ *
+ * <h2>Description</h2>
+ * The memory size of the various kernel objects is printed.
+ *
+ * <h2>Test Steps</h2>
+ * - [12.15.1] The size of the system area is printed.
+ * - [12.15.2] The size of a thread structure is printed.
+ * - [12.15.3] The size of a virtual timer structure is printed.
+ * - [12.15.4] The size of a semaphore structure is printed.
+ * - [12.15.5] The size of a mutex is printed.
+ * - [12.15.6] The size of a condition variable is printed.
+ * - [12.15.7] The size of an event source is printed.
+ * - [12.15.8] The size of an event listener is printed.
+ * - [12.15.9] The size of a mailbox is printed.
+ * .
+ */
+
+static void rt_test_012_015_execute(void) {
+
+  /* [12.15.1] The size of the system area is printed.*/
   test_set_step(1);
   {
     test_print("--- OS    : ");
@@ -946,7 +1304,7 @@ static void rt_test_012_012_execute(void) {
   }
   test_end_step(1);
 
-  /* [12.12.2] The size of a thread structure is printed.*/
+  /* [12.15.2] The size of a thread structure is printed.*/
   test_set_step(2);
   {
     test_print("--- Thread: ");
@@ -955,7 +1313,7 @@ static void rt_test_012_012_execute(void) {
   }
   test_end_step(2);
 
-  /* [12.12.3] The size of a virtual timer structure is printed.*/
+  /* [12.15.3] The size of a virtual timer structure is printed.*/
   test_set_step(3);
   {
     test_print("--- Timer : ");
@@ -964,7 +1322,7 @@ static void rt_test_012_012_execute(void) {
   }
   test_end_step(3);
 
-  /* [12.12.4] The size of a semaphore structure is printed.*/
+  /* [12.15.4] The size of a semaphore structure is printed.*/
   test_set_step(4);
   {
 #if CH_CFG_USE_SEMAPHORES || defined(__DOXYGEN__)
@@ -975,7 +1333,7 @@ static void rt_test_012_012_execute(void) {
   }
   test_end_step(4);
 
-  /* [12.12.5] The size of a mutex is printed.*/
+  /* [12.15.5] The size of a mutex is printed.*/
   test_set_step(5);
   {
 #if CH_CFG_USE_MUTEXES || defined(__DOXYGEN__)
@@ -986,7 +1344,7 @@ static void rt_test_012_012_execute(void) {
   }
   test_end_step(5);
 
-  /* [12.12.6] The size of a condition variable is printed.*/
+  /* [12.15.6] The size of a condition variable is printed.*/
   test_set_step(6);
   {
 #if CH_CFG_USE_CONDVARS || defined(__DOXYGEN__)
@@ -997,7 +1355,7 @@ static void rt_test_012_012_execute(void) {
   }
   test_end_step(6);
 
-  /* [12.12.7] The size of an event source is printed.*/
+  /* [12.15.7] The size of an event source is printed.*/
   test_set_step(7);
   {
 #if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
@@ -1008,7 +1366,7 @@ static void rt_test_012_012_execute(void) {
   }
   test_end_step(7);
 
-  /* [12.12.8] The size of an event listener is printed.*/
+  /* [12.15.8] The size of an event listener is printed.*/
   test_set_step(8);
   {
 #if CH_CFG_USE_EVENTS || defined(__DOXYGEN__)
@@ -1019,7 +1377,7 @@ static void rt_test_012_012_execute(void) {
   }
   test_end_step(8);
 
-  /* [12.12.9] The size of a mailbox is printed.*/
+  /* [12.15.9] The size of a mailbox is printed.*/
   test_set_step(9);
   {
 #if CH_CFG_USE_MAILBOXES || defined(__DOXYGEN__)
@@ -1031,11 +1389,11 @@ static void rt_test_012_012_execute(void) {
   test_end_step(9);
 }
 
-static const testcase_t rt_test_012_012 = {
+static const testcase_t rt_test_012_015 = {
   "RAM Footprint",
   NULL,
   NULL,
-  rt_test_012_012_execute
+  rt_test_012_015_execute
 };
 
 /****************************************************************************
@@ -1069,7 +1427,14 @@ const testcase_t * const rt_test_sequence_012_array[] = {
 #if (CH_CFG_USE_MUTEXES ==TRUE) || defined(__DOXYGEN__)
   &rt_test_012_011,
 #endif
+#if (CH_CFG_USE_CONDVARS == TRUE) || defined(__DOXYGEN__)
   &rt_test_012_012,
+#endif
+#if ((CH_CFG_USE_MUTEXES == TRUE) && (CH_CFG_USE_SEMAPHORES == TRUE)) || defined(__DOXYGEN__)
+  &rt_test_012_013,
+#endif
+  &rt_test_012_014,
+  &rt_test_012_015,
   NULL
 };
 
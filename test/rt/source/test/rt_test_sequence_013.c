@@ -0,0 +1,633 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "rt_test_root.h"
+
+/**
+ * @file    rt_test_sequence_013.c
+ * @brief   Test Sequence 013 code.
+ *
+ * @page rt_test_sequence_013 [13] Readers-Writer Locks
+ *
+ * File: @ref rt_test_sequence_013.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS/RT functionalities related to readers-
+ * writer locks.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_RWLOCKS == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage rt_test_013_001
+ * - @subpage rt_test_013_002
+ * - @subpage rt_test_013_003
+ * - @subpage rt_test_013_004
+ * - @subpage rt_test_013_005
+ * - @subpage rt_test_013_006
+ * - @subpage rt_test_013_007
+ * .
+ */
+
+#if (CH_CFG_USE_RWLOCKS == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static RWLOCK_DECL(rw1);
+static MUTEX_DECL(mtx1);
+static systime_t bmk_start, bmk_end;
+static uint32_t bmk_counts[MAX_THREADS];
+
+static THD_FUNCTION(reader1, p) {
+
+  chRWLockReadLock(&rw1);
+  test_emit_token(*(char *)p);
+  chRWLockReadUnlock(&rw1);
+}
+
+static THD_FUNCTION(writer1, p) {
+
+  chRWLockWriteLock(&rw1);
+  test_emit_token(*(char *)p);
+  chRWLockWriteUnlock(&rw1);
+}
+
+static THD_FUNCTION(reader2, p) {
+
+  if (chRWLockReadLockTimeout(&rw1, TIME_MS2I(50)) == MSG_OK) {
+    test_emit_token(*(char *)p);
+    chRWLockReadUnlock(&rw1);
+  }
+  else {
+    test_emit_token('T');
+  }
+}
+
+static THD_FUNCTION(writer2, p) {
+
+  if (chRWLockWriteLockTimeout(&rw1, TIME_MS2I(50)) == MSG_OK) {
+    test_emit_token(*(char *)p);
+    chRWLockWriteUnlock(&rw1);
+  }
+  else {
+    test_emit_token('T');
+  }
+}
+
+static THD_FUNCTION(bmk_reader, p) {
+  uint32_t *cntp = (uint32_t *)p;
+
+  while (chVTIsSystemTimeWithinX(bmk_start, bmk_end)) {
+    chRWLockReadLock(&rw1);
+    chThdYield();
+    chRWLockReadUnlock(&rw1);
+    (*cntp)++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+}
+
+static THD_FUNCTION(bmk_writer, p) {
+  uint32_t *cntp = (uint32_t *)p;
+
+  while (chVTIsSystemTimeWithinX(bmk_start, bmk_end)) {
+    chRWLockWriteLock(&rw1);
+    chThdYield();
+    chRWLockWriteUnlock(&rw1);
+    (*cntp)++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+}
+
+static THD_FUNCTION(bmk_locker, p) {
+  uint32_t *cntp = (uint32_t *)p;
+
+  while (chVTIsSystemTimeWithinX(bmk_start, bmk_end)) {
+    chMtxLock(&mtx1);
+    chThdYield();
+    chMtxUnlock(&mtx1);
+    (*cntp)++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+}
+
+static void bmk_run(tfunc_t rfunc, tfunc_t wfunc) {
+  tprio_t prio;
+  unsigned i;
+
+  /* The threads are started together when the priority is restored.*/
+  prio = chThdSetPriority(chThdGetPriorityX() + 2);
+  bmk_start = test_wait_tick();
+  bmk_end = chTimeAddX(bmk_start, TIME_MS2I(1000));
+  for (i = 0; i < MAX_THREADS; i++) {
+    bmk_counts[i] = 0;
+    threads[i] = chThdCreateStatic(wa[i], WA_SIZE, prio + 1,
+                                   i == 0 ? wfunc : rfunc,
+                                   (void *)&bmk_counts[i]);
+  }
+  chThdSetPriority(prio);
+  test_wait_threads();
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page rt_test_013_001 [13.1] Readers and writer exclusion
+ *
+ * <h2>Description</h2>
+ * The try-lock functions are used to verify that readers share the lock
+ * while a writer owns it exclusively.
+ *
+ * <h2>Test Steps</h2>
+ * - [13.1.1] Locking for reading twice, both attempts must succeed and a
+ *   write lock attempt must fail.
+ * - [13.1.2] Unlocking the readers, a write lock attempt must succeed.
+ * - [13.1.3] Both read and write lock attempts must fail while the lock is
+ *   owned by the writer, also immediate timeouts must fail.
+ * - [13.1.4] Unlocking the writer, the lock must be free.
+ * .
+ */
+
+static void rt_test_013_001_setup(void) {
+  chRWLockObjectInit(&rw1);
+}
+
+static void rt_test_013_001_execute(void) {
+
+  /* [13.1.1] Locking for reading twice, both attempts must succeed and a
+     write lock attempt must fail.*/
+  test_set_step(1);
+  {
+    test_assert(chRWLockTryReadLock(&rw1), "read lock failed");
+    test_assert(chRWLockTryReadLock(&rw1), "read lock failed");
+    test_assert(!chRWLockTryWriteLock(&rw1), "write lock not failed");
+    test_assert_lock(chRWLockGetReadersI(&rw1) == 2, "wrong readers count");
+  }
+  test_end_step(1);
+
+  /* [13.1.2] Unlocking the readers, a write lock attempt must succeed.*/
+  test_set_step(2);
+  {
+    chRWLockReadUnlock(&rw1);
+    test_assert(!chRWLockTryWriteLock(&rw1), "write lock not failed");
+    chRWLockReadUnlock(&rw1);
+    test_assert(chRWLockTryWriteLock(&rw1), "write lock failed");
+    test_assert_lock(chRWLockGetWriterI(&rw1) == chThdGetSelfX(), "not owner");
+  }
+  test_end_step(2);
+
+  /* [13.1.3] Both read and write lock attempts must fail while the lock is
+     owned by the writer, also immediate timeouts must fail.*/
+  test_set_step(3);
+  {
+    test_assert(!chRWLockTryReadLock(&rw1), "read lock not failed");
+    test_assert(!chRWLockTryWriteLock(&rw1), "write lock not failed");
+    test_assert(chRWLockReadLockTimeout(&rw1, TIME_IMMEDIATE) == MSG_TIMEOUT,
+                "not timed out");
+  }
+  test_end_step(3);
+
+  /* [13.1.4] Unlocking the writer, the lock must be free.*/
+  test_set_step(4);
+  {
+    chRWLockWriteUnlock(&rw1);
+    test_assert_lock(chRWLockGetWriterI(&rw1) == NULL, "still owned");
+    test_assert_lock(chRWLockGetReadersI(&rw1) == 0, "wrong readers count");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t rt_test_013_001 = {
+  "Readers and writer exclusion",
+  rt_test_013_001_setup,
+  NULL,
+  rt_test_013_001_execute
+};
+
+/**
+ * @page rt_test_013_002 [13.2] Writer preference
+ *
+ * <h2>Description</h2>
+ * A writer waits for the lock owned by a reader, a reader arriving after
+ * the writer must not be admitted before it.
+ *
+ * <h2>Test Steps</h2>
+ * - [13.2.1] Locking for reading then starting a writer and a reader at
+ *   higher priority, both must wait.
+ * - [13.2.2] Unlocking, the writer must own the lock before the reader.
+ * .
+ */
+
+static void rt_test_013_002_setup(void) {
+  chRWLockObjectInit(&rw1);
+}
+
+static void rt_test_013_002_execute(void) {
+
+  /* [13.2.1] Locking for reading then starting a writer and a reader at
+     higher priority, both must wait.*/
+  test_set_step(1);
+  {
+    tprio_t prio = chThdGetPriorityX();
+
+    chRWLockReadLock(&rw1);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, writer1, "A");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+1, reader1, "B");
+    test_assert(!chRWLockTryReadLock(&rw1), "read lock not failed");
+    test_assert_sequence("", "unexpected tokens");
+  }
+  test_end_step(1);
+
+  /* [13.2.2] Unlocking, the writer must own the lock before the reader.*/
+  test_set_step(2);
+  {
+    chRWLockReadUnlock(&rw1);
+    test_wait_threads();
+    test_assert_sequence("AB", "invalid sequence");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t rt_test_013_002 = {
+  "Writer preference",
+  rt_test_013_002_setup,
+  NULL,
+  rt_test_013_002_execute
+};
+
+/**
+ * @page rt_test_013_003 [13.3] Priority order
+ *
+ * <h2>Description</h2>
+ * Readers and writers with different priorities wait for the lock owned by
+ * a writer, the lock must be acquired in priority order.
+ *
+ * <h2>Test Steps</h2>
+ * - [13.3.1] Locking for writing then starting readers and a writer with
+ *   increasing priority.
+ * - [13.3.2] Unlocking, the lock must be acquired in priority order.
+ * .
+ */
+
+static void rt_test_013_003_setup(void) {
+  chRWLockObjectInit(&rw1);
+}
+
+static void rt_test_013_003_execute(void) {
+
+  /* [13.3.1] Locking for writing then starting readers and a writer with
+     increasing priority.*/
+  test_set_step(1);
+  {
+    tprio_t prio = chThdGetPriorityX();
+
+    chRWLockWriteLock(&rw1);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, reader1, "D");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+2, reader1, "C");
+    threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio+3, writer1, "B");
+    threads[3] = chThdCreateStatic(wa[3], WA_SIZE, prio+4, reader1, "A");
+  }
+  test_end_step(1);
+
+  /* [13.3.2] Unlocking, the lock must be acquired in priority order.*/
+  test_set_step(2);
+  {
+    chRWLockWriteUnlock(&rw1);
+    test_wait_threads();
+    test_assert_sequence("ABCD", "invalid sequence");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t rt_test_013_003 = {
+  "Priority order",
+  rt_test_013_003_setup,
+  NULL,
+  rt_test_013_003_execute
+};
+
+/**
+ * @page rt_test_013_004 [13.4] Timeouts
+ *
+ * <h2>Description</h2>
+ * A writer times out while waiting for a lock owned by a reader, a reader
+ * queued after the writer must then be admitted.
+ *
+ * <h2>Test Steps</h2>
+ * - [13.4.1] Locking for reading then starting a writer with timeout and a
+ *   reader without timeout.
+ * - [13.4.2] Waiting the writer, it must time out and the reader must be
+ *   admitted.
+ * - [13.4.3] Locking for writing then starting a reader with timeout, it
+ *   must time out.
+ * .
+ */
+
+static void rt_test_013_004_setup(void) {
+  chRWLockObjectInit(&rw1);
+}
+
+static void rt_test_013_004_execute(void) {
+
+  /* [13.4.1] Locking for reading then starting a writer with timeout and a
+     reader without timeout.*/
+  test_set_step(1);
+  {
+    tprio_t prio = chThdGetPriorityX();
+
+    chRWLockReadLock(&rw1);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, writer2, "A");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+1, reader1, "B");
+  }
+  test_end_step(1);
+
+  /* [13.4.2] Waiting the writer, it must time out and the reader must be
+     admitted.*/
+  test_set_step(2);
+  {
+    test_wait_threads();
+    test_assert_sequence("TB", "invalid sequence");
+  }
+  test_end_step(2);
+
+  /* [13.4.3] Locking for writing then starting a reader with timeout, it
+     must time out.*/
+  test_set_step(3);
+  {
+    chRWLockReadUnlock(&rw1);
+    chRWLockWriteLock(&rw1);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()+1,
+                                   reader2, "A");
+    test_wait_threads();
+    test_assert_sequence("T", "invalid sequence");
+    chRWLockWriteUnlock(&rw1);
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_013_004 = {
+  "Timeouts",
+  rt_test_013_004_setup,
+  NULL,
+  rt_test_013_004_execute
+};
+
+/**
+ * @page rt_test_013_005 [13.5] Priority inheritance
+ *
+ * <h2>Description</h2>
+ * The writer owning the lock must inherit the priority of the waiting
+ * threads and return to its base priority when the lock is released or when
+ * the waiting threads time out.
+ *
+ * <h2>Test Steps</h2>
+ * - [13.5.1] Locking for writing then starting a writer and a reader at
+ *   higher priorities, the priority must be inherited.
+ * - [13.5.2] Unlocking, the priority must return to the base level.
+ * - [13.5.3] Locking for writing then starting a writer with timeout at
+ *   higher priority, the priority must return to the base level after the
+ *   timeout.
+ * .
+ */
+
+static void rt_test_013_005_setup(void) {
+  chRWLockObjectInit(&rw1);
+}
+
+static void rt_test_013_005_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+
+  /* [13.5.1] Locking for writing then starting a writer and a reader at
+     higher priorities, the priority must be inherited.*/
+  test_set_step(1);
+  {
+    chRWLockWriteLock(&rw1);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+2, writer1, "B");
+    test_assert(chThdGetPriorityX() == prio + 2, "wrong priority level");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+3, reader1, "A");
+    test_assert(chThdGetPriorityX() == prio + 3, "wrong priority level");
+  }
+  test_end_step(1);
+
+  /* [13.5.2] Unlocking, the priority must return to the base level.*/
+  test_set_step(2);
+  {
+    chRWLockWriteUnlock(&rw1);
+    test_assert(chThdGetPriorityX() == prio, "wrong priority level");
+    test_wait_threads();
+    test_assert_sequence("AB", "invalid sequence");
+  }
+  test_end_step(2);
+
+  /* [13.5.3] Locking for writing then starting a writer with timeout at
+     higher priority, the priority must return to the base level after the
+     timeout.*/
+  test_set_step(3);
+  {
+    chRWLockWriteLock(&rw1);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, writer2, "A");
+    test_assert(chThdGetPriorityX() == prio + 1, "wrong priority level");
+    test_wait_threads();
+    test_assert(chThdGetPriorityX() == prio, "wrong priority level");
+    chRWLockWriteUnlock(&rw1);
+    test_assert_sequence("T", "invalid sequence");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_013_005 = {
+  "Priority inheritance",
+  rt_test_013_005_setup,
+  NULL,
+  rt_test_013_005_execute
+};
+
+/**
+ * @page rt_test_013_006 [13.6] Unlock all
+ *
+ * <h2>Description</h2>
+ * A lock owned for writing together with a mutex is released by
+ * chMtxUnlockAll(), the waiting readers must be admitted and the priority
+ * must return to the base level.
+ *
+ * <h2>Test Steps</h2>
+ * - [13.6.1] Locking a mutex and the lock for writing then starting two
+ *   readers at higher priorities, the priority must be inherited.
+ * - [13.6.2] Unlocking everything, the readers must own the lock and the
+ *   priority must return to the base level.
+ * - [13.6.3] Checking that both the lock and the mutex are free.
+ * .
+ */
+
+static void rt_test_013_006_setup(void) {
+  chRWLockObjectInit(&rw1);
+}
+
+static void rt_test_013_006_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+
+  /* [13.6.1] Locking a mutex and the lock for writing then starting two
+     readers at higher priorities, the priority must be inherited.*/
+  test_set_step(1);
+  {
+    chMtxLock(&mtx1);
+    chRWLockWriteLock(&rw1);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, reader1, "B");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+2, reader1, "A");
+    test_assert(chThdGetPriorityX() == prio + 2, "wrong priority level");
+    test_assert_sequence("", "unexpected tokens");
+  }
+  test_end_step(1);
+
+  /* [13.6.2] Unlocking everything, the readers must own the lock and the
+     priority must return to the base level.*/
+  test_set_step(2);
+  {
+    chMtxUnlockAll();
+    test_assert(chThdGetPriorityX() == prio, "wrong priority level");
+    test_wait_threads();
+    test_assert_sequence("AB", "invalid sequence");
+  }
+  test_end_step(2);
+
+  /* [13.6.3] Checking that both the lock and the mutex are free.*/
+  test_set_step(3);
+  {
+    test_assert(chRWLockTryWriteLock(&rw1), "lock not free");
+    chRWLockWriteUnlock(&rw1);
+    test_assert(chMtxTryLock(&mtx1), "mutex not free");
+    chMtxUnlock(&mtx1);
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_013_006 = {
+  "Unlock all",
+  rt_test_013_006_setup,
+  NULL,
+  rt_test_013_006_execute
+};
+
+/**
+ * @page rt_test_013_007 [13.7] Contention performance
+ *
+ * <h2>Description</h2>
+ * Four readers and one writer contend the lock for one second, each thread
+ * yields while owning the lock. The same workload is then repeated using a
+ * mutex for comparison.
+ *
+ * <h2>Test Steps</h2>
+ * - [13.7.1] Running the readers and the writer on the lock.
+ * - [13.7.2] Running the same workload on a mutex.
+ * - [13.7.3] The score is printed.
+ * .
+ */
+
+static void rt_test_013_007_setup(void) {
+  chRWLockObjectInit(&rw1);
+}
+
+static void rt_test_013_007_execute(void) {
+  uint32_t reads, writes, locks;
+  unsigned i;
+
+  /* [13.7.1] Running the readers and the writer on the lock.*/
+  test_set_step(1);
+  {
+    bmk_run(bmk_reader, bmk_writer);
+    writes = bmk_counts[0];
+    reads = 0;
+    for (i = 1; i < MAX_THREADS; i++) {
+      reads += bmk_counts[i];
+    }
+    test_assert(writes > 0, "writer starved");
+    test_assert(reads > 0, "readers starved");
+  }
+  test_end_step(1);
+
+  /* [13.7.2] Running the same workload on a mutex.*/
+  test_set_step(2);
+  {
+    bmk_run(bmk_locker, bmk_locker);
+    locks = 0;
+    for (i = 0; i < MAX_THREADS; i++) {
+      locks += bmk_counts[i];
+    }
+  }
+  test_end_step(2);
+
+  /* [13.7.3] The score is printed.*/
+  test_set_step(3);
+  {
+    test_print("--- RWLock: ");
+    test_printn(reads);
+    test_print(" reads/S, ");
+    test_printn(writes);
+    test_println(" writes/S");
+    test_print("--- Mutex : ");
+    test_printn(locks);
+    test_println(" locks/S");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_013_007 = {
+  "Contention performance",
+  rt_test_013_007_setup,
+  NULL,
+  rt_test_013_007_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const rt_test_sequence_013_array[] = {
+  &rt_test_013_001,
+  &rt_test_013_002,
+  &rt_test_013_003,
+  &rt_test_013_004,
+  &rt_test_013_005,
+  &rt_test_013_006,
+  &rt_test_013_007,
+  NULL
+};
+
+/**
+ * @brief   Readers-Writer Locks.
+ */
+const testsequence_t rt_test_sequence_013 = {
+  "Readers-Writer Locks",
+  rt_test_sequence_013_array
+};
+
+#endif /* CH_CFG_USE_RWLOCKS == TRUE */
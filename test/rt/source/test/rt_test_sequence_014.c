@@ -0,0 +1,462 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "rt_test_root.h"
+
+/**
+ * @file    rt_test_sequence_014.c
+ * @brief   Test Sequence 014 code.
+ *
+ * @page rt_test_sequence_014 [14] Priority Ceiling Mutexes
+ *
+ * File: @ref rt_test_sequence_014.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS/RT functionalities related to priority
+ * ceiling mutexes.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_PCMUTEXES == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage rt_test_014_001
+ * - @subpage rt_test_014_002
+ * - @subpage rt_test_014_003
+ * - @subpage rt_test_014_004
+ * - @subpage rt_test_014_005
+ * .
+ */
+
+#if (CH_CFG_USE_PCMUTEXES == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+static PCMUTEX_DECL(pcm1, NORMALPRIO + 3);
+static PCMUTEX_DECL(pcm2, NORMALPRIO + 4);
+static MUTEX_DECL(mtx1);
+
+static THD_FUNCTION(thread1, p) {
+
+  test_emit_token(*(char *)p);
+}
+
+static THD_FUNCTION(thread2, p) {
+
+  chPCMtxLock(&pcm1);
+  test_assert(chThdGetPriorityX() == chPCMtxGetCeilingX(&pcm1),
+              "not at ceiling");
+  test_emit_token(*(char *)p);
+  chPCMtxUnlock(&pcm1);
+}
+
+static THD_FUNCTION(thread3, p) {
+
+  chMtxLock(&mtx1);
+  test_emit_token(*(char *)p);
+  chMtxUnlock(&mtx1);
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page rt_test_014_001 [14.1] Priority ceiling
+ *
+ * <h2>Description</h2>
+ * The owner priority must be raised to the ceiling on lock and restored on
+ * unlock, also when mutexes are nested or when the priority is changed
+ * while owning a mutex.
+ *
+ * <h2>Test Steps</h2>
+ * - [14.1.1] Locking the first mutex, the priority must be raised to its
+ *   ceiling.
+ * - [14.1.2] Locking the second mutex, the priority must be raised to its
+ *   ceiling, a try-lock on an owned mutex must fail.
+ * - [14.1.3] Unlocking in reverse order, the priority must be restored at
+ *   each step.
+ * - [14.1.4] Changing the priority while owning the mutex, the ceiling must
+ *   be kept and the new priority must be effective after unlocking.
+ * .
+ */
+
+static void rt_test_014_001_setup(void) {
+  chPCMtxObjectInit(&pcm1, NORMALPRIO + 3);
+  chPCMtxObjectInit(&pcm2, NORMALPRIO + 4);
+  chMtxObjectInit(&mtx1);
+}
+
+static void rt_test_014_001_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+
+  /* [14.1.1] Locking the first mutex, the priority must be raised to its
+     ceiling.*/
+  test_set_step(1);
+  {
+    chPCMtxLock(&pcm1);
+    test_assert(chThdGetPriorityX() == NORMALPRIO + 3, "not at ceiling");
+    test_assert_lock(chPCMtxGetOwnerI(&pcm1) == chThdGetSelfX(), "not owner");
+  }
+  test_end_step(1);
+
+  /* [14.1.2] Locking the second mutex, the priority must be raised to its
+     ceiling, a try-lock on an owned mutex must fail.*/
+  test_set_step(2);
+  {
+    test_assert(chPCMtxTryLock(&pcm2), "lock failed");
+    test_assert(chThdGetPriorityX() == NORMALPRIO + 4, "not at ceiling");
+    test_assert(chPCMtxGetNextMutexX() == &pcm2, "wrong mutex on top");
+    test_assert(!chPCMtxTryLock(&pcm1), "lock not failed");
+  }
+  test_end_step(2);
+
+  /* [14.1.3] Unlocking in reverse order, the priority must be restored at
+     each step.*/
+  test_set_step(3);
+  {
+    chPCMtxUnlock(&pcm2);
+    test_assert(chThdGetPriorityX() == NORMALPRIO + 3, "wrong priority level");
+    chPCMtxUnlock(&pcm1);
+    test_assert(chThdGetPriorityX() == prio, "wrong priority level");
+    test_assert(chPCMtxGetNextMutexX() == NULL, "still owned");
+    test_assert_lock(chPCMtxGetOwnerI(&pcm1) == NULL, "still owned");
+  }
+  test_end_step(3);
+
+  /* [14.1.4] Changing the priority while owning the mutex, the ceiling must
+     be kept and the new priority must be effective after unlocking.*/
+  test_set_step(4);
+  {
+    chPCMtxLock(&pcm1);
+    test_assert(chThdSetPriority(prio - 1) == prio, "wrong old priority");
+    test_assert(chThdGetPriorityX() == NORMALPRIO + 3, "not at ceiling");
+    chPCMtxUnlock(&pcm1);
+    test_assert(chThdGetPriorityX() == prio - 1, "wrong priority level");
+    (void) chThdSetPriority(prio);
+  }
+  test_end_step(4);
+}
+
+static const testcase_t rt_test_014_001 = {
+  "Priority ceiling",
+  rt_test_014_001_setup,
+  NULL,
+  rt_test_014_001_execute
+};
+
+/**
+ * @page rt_test_014_002 [14.2] Preemption avoidance
+ *
+ * <h2>Description</h2>
+ * A thread with priority lower than the ceiling is started while the mutex
+ * is owned, the thread must not preempt the owner until the mutex is
+ * released.
+ *
+ * <h2>Test Steps</h2>
+ * - [14.2.1] Locking the mutex then starting a thread at higher priority
+ *   than the owner base priority.
+ * - [14.2.2] Unlocking, the thread must preempt the owner.
+ * .
+ */
+
+static void rt_test_014_002_setup(void) {
+  chPCMtxObjectInit(&pcm1, NORMALPRIO + 3);
+  chPCMtxObjectInit(&pcm2, NORMALPRIO + 4);
+  chMtxObjectInit(&mtx1);
+}
+
+static void rt_test_014_002_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+
+  /* [14.2.1] Locking the mutex then starting a thread at higher priority
+     than the owner base priority.*/
+  test_set_step(1);
+  {
+    chPCMtxLock(&pcm1);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio + 1, thread1, "B");
+    test_emit_token('A');
+  }
+  test_end_step(1);
+
+  /* [14.2.2] Unlocking, the thread must preempt the owner.*/
+  test_set_step(2);
+  {
+    chPCMtxUnlock(&pcm1);
+    test_emit_token('C');
+    test_wait_threads();
+    test_assert_sequence("ABC", "invalid sequence");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t rt_test_014_002 = {
+  "Preemption avoidance",
+  rt_test_014_002_setup,
+  NULL,
+  rt_test_014_002_execute
+};
+
+/**
+ * @page rt_test_014_003 [14.3] Owner blocking
+ *
+ * <h2>Description</h2>
+ * The owner sleeps while owning the mutex, the threads finding the mutex
+ * owned must be queued and acquire it in priority order.
+ *
+ * <h2>Test Steps</h2>
+ * - [14.3.1] Locking the mutex then starting threads with increasing
+ *   priority, the threads must not run while the owner is running.
+ * - [14.3.2] Sleeping while owning the mutex, the threads must block on it.
+ * - [14.3.3] Unlocking, the threads must acquire the mutex in priority
+ *   order.
+ * .
+ */
+
+static void rt_test_014_003_setup(void) {
+  chPCMtxObjectInit(&pcm1, NORMALPRIO + 3);
+  chPCMtxObjectInit(&pcm2, NORMALPRIO + 4);
+  chMtxObjectInit(&mtx1);
+}
+
+static void rt_test_014_003_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+
+  /* [14.3.1] Locking the mutex then starting threads with increasing
+     priority, the threads must not run while the owner is running.*/
+  test_set_step(1);
+  {
+    chPCMtxLock(&pcm1);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio+1, thread2, "C");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio+2, thread2, "B");
+    threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio+3, thread2, "A");
+    test_assert_sequence("", "unexpected tokens");
+  }
+  test_end_step(1);
+
+  /* [14.3.2] Sleeping while owning the mutex, the threads must block on
+     it.*/
+  test_set_step(2);
+  {
+    chThdSleepMilliseconds(10);
+    test_assert_sequence("", "unexpected tokens");
+    test_assert(chThdGetPriorityX() == NORMALPRIO + 3, "not at ceiling");
+  }
+  test_end_step(2);
+
+  /* [14.3.3] Unlocking, the threads must acquire the mutex in priority
+     order.*/
+  test_set_step(3);
+  {
+    chPCMtxUnlock(&pcm1);
+    test_assert(chThdGetPriorityX() == prio, "wrong priority level");
+    test_wait_threads();
+    test_assert_sequence("ABC", "invalid sequence");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_014_003 = {
+  "Owner blocking",
+  rt_test_014_003_setup,
+  NULL,
+  rt_test_014_003_execute
+};
+
+/**
+ * @page rt_test_014_004 [14.4] Nesting with normal mutexes
+ *
+ * <h2>Description</h2>
+ * A normal mutex and a priority ceiling mutex are nested, the priority
+ * inherited through the normal mutex must be preserved when the priority
+ * ceiling mutex is released.
+ *
+ * <h2>Test Steps</h2>
+ * - [14.4.1] Locking the normal mutex then the priority ceiling mutex.
+ * - [14.4.2] Starting a thread above the ceiling that locks the normal
+ *   mutex, the priority must be inherited.
+ * - [14.4.3] Unlocking the priority ceiling mutex, the inherited priority
+ *   must be preserved.
+ * - [14.4.4] Unlocking the normal mutex, the priority must return to the
+ *   base level.
+ * .
+ */
+
+static void rt_test_014_004_setup(void) {
+  chPCMtxObjectInit(&pcm1, NORMALPRIO + 3);
+  chPCMtxObjectInit(&pcm2, NORMALPRIO + 4);
+  chMtxObjectInit(&mtx1);
+}
+
+static void rt_test_014_004_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+
+  /* [14.4.1] Locking the normal mutex then the priority ceiling mutex.*/
+  test_set_step(1);
+  {
+    chMtxLock(&mtx1);
+    chPCMtxLock(&pcm1);
+    test_assert(chThdGetPriorityX() == NORMALPRIO + 3, "not at ceiling");
+  }
+  test_end_step(1);
+
+  /* [14.4.2] Starting a thread above the ceiling that locks the normal
+     mutex, the priority must be inherited.*/
+  test_set_step(2);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, NORMALPRIO + 5,
+                                   thread3, "A");
+    test_assert(chThdGetPriorityX() == NORMALPRIO + 5, "not inherited");
+  }
+  test_end_step(2);
+
+  /* [14.4.3] Unlocking the priority ceiling mutex, the inherited priority
+     must be preserved.*/
+  test_set_step(3);
+  {
+    chPCMtxUnlock(&pcm1);
+    test_assert(chThdGetPriorityX() == NORMALPRIO + 5, "wrong priority level");
+  }
+  test_end_step(3);
+
+  /* [14.4.4] Unlocking the normal mutex, the priority must return to the
+     base level.*/
+  test_set_step(4);
+  {
+    chMtxUnlock(&mtx1);
+    test_assert(chThdGetPriorityX() == prio, "wrong priority level");
+    test_wait_threads();
+    test_assert_sequence("A", "invalid sequence");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t rt_test_014_004 = {
+  "Nesting with normal mutexes",
+  rt_test_014_004_setup,
+  NULL,
+  rt_test_014_004_execute
+};
+
+/**
+ * @page rt_test_014_005 [14.5] Lock/unlock performance
+ *
+ * <h2>Description</h2>
+ * A priority ceiling mutex is locked and unlocked into a continuous loop
+ * for one second, the same is then repeated using a normal mutex for
+ * comparison.
+ *
+ * <h2>Test Steps</h2>
+ * - [14.5.1] Locking and unlocking the priority ceiling mutex.
+ * - [14.5.2] Locking and unlocking the normal mutex.
+ * - [14.5.3] The score is printed.
+ * .
+ */
+
+static void rt_test_014_005_setup(void) {
+  chPCMtxObjectInit(&pcm1, NORMALPRIO + 3);
+  chPCMtxObjectInit(&pcm2, NORMALPRIO + 4);
+  chMtxObjectInit(&mtx1);
+}
+
+static void rt_test_014_005_execute(void) {
+  systime_t start, end;
+  uint32_t npc, nmtx;
+
+  /* [14.5.1] Locking and unlocking the priority ceiling mutex.*/
+  test_set_step(1);
+  {
+    npc = 0;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      chPCMtxLock(&pcm1);
+      chPCMtxUnlock(&pcm1);
+      npc++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+  test_end_step(1);
+
+  /* [14.5.2] Locking and unlocking the normal mutex.*/
+  test_set_step(2);
+  {
+    nmtx = 0;
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      chMtxLock(&mtx1);
+      chMtxUnlock(&mtx1);
+      nmtx++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+  }
+  test_end_step(2);
+
+  /* [14.5.3] The score is printed.*/
+  test_set_step(3);
+  {
+    test_print("--- PCMutex: ");
+    test_printn(npc);
+    test_println(" lock+unlock/S");
+    test_print("--- Mutex  : ");
+    test_printn(nmtx);
+    test_println(" lock+unlock/S");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_014_005 = {
+  "Lock/unlock performance",
+  rt_test_014_005_setup,
+  NULL,
+  rt_test_014_005_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const rt_test_sequence_014_array[] = {
+  &rt_test_014_001,
+  &rt_test_014_002,
+  &rt_test_014_003,
+  &rt_test_014_004,
+  &rt_test_014_005,
+  NULL
+};
+
+/**
+ * @brief   Priority Ceiling Mutexes.
+ */
+const testsequence_t rt_test_sequence_014 = {
+  "Priority Ceiling Mutexes",
+  rt_test_sequence_014_array
+};
+
+#endif /* CH_CFG_USE_PCMUTEXES == TRUE */
@@ -0,0 +1,482 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "rt_test_root.h"
+
+/**
+ * @file    rt_test_sequence_015.c
+ * @brief   Test Sequence 015 code.
+ *
+ * @page rt_test_sequence_015 [15] EDF Scheduling
+ *
+ * File: @ref rt_test_sequence_015.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS/RT functionalities related to EDF
+ * scheduling.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_EDF == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage rt_test_015_001
+ * - @subpage rt_test_015_002
+ * - @subpage rt_test_015_003
+ * - @subpage rt_test_015_004
+ * .
+ */
+
+#if (CH_CFG_USE_EDF == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+/* Tasks used by the benchmark, execution cost in busy loop iterations.*/
+typedef struct {
+  sysinterval_t         period;
+  uint32_t              cost;
+  ucnt_t                jobs;
+  ucnt_t                misses;
+} bmk_task_t;
+
+static bmk_task_t tasks[2];
+static systime_t bmk_start;
+static volatile uint32_t bmk_dummy;
+
+#if CH_CFG_USE_SEMAPHORES == TRUE
+static semaphore_t sem1;
+
+/* Thread with a deadline depending on its token, 'A' has the earliest
+   deadline, 'D' is not an EDF thread.*/
+static THD_FUNCTION(thread1, p) {
+  char token = *(char *)p;
+
+  if (token != 'D') {
+    chEDFStart(TIME_MS2I(100), TIME_MS2I(10 * (token - 'A' + 1)));
+  }
+  chSemWait(&sem1);
+  test_emit_token(token);
+}
+
+static THD_FUNCTION(thread2, p) {
+
+  chEDFStart(TIME_MS2I(100), TIME_MS2I(10));
+  chSemWait(&sem1);
+  test_emit_token(*(char *)p);
+}
+
+static THD_FUNCTION(thread3, p) {
+
+  chEDFStart(TIME_MS2I(100), TIME_MS2I(40));
+  chSemSignal(&sem1);
+  test_emit_token(*(char *)p);
+}
+#endif
+
+static void bmk_busy(uint32_t n) {
+
+  while (n > 0U) {
+    bmk_dummy++;
+    n--;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  }
+}
+
+/* Periodic task with manual release and deadline tracking, the deadline
+   is equal to the period.*/
+static THD_FUNCTION(bmk_thread_rm, p) {
+  bmk_task_t *tskp = (bmk_task_t *)p;
+  systime_t release = bmk_start;
+
+  chThdSleepUntil(bmk_start);
+  while (!chThdShouldTerminateX()) {
+    sysinterval_t elapsed;
+
+    bmk_busy(tskp->cost);
+    tskp->jobs++;
+    elapsed = chTimeDiffX(release, chVTGetSystemTimeX());
+    if (elapsed > tskp->period) {
+      tskp->misses++;
+    }
+    release = chTimeAddX(release, tskp->period);
+    if (elapsed < tskp->period) {
+      chThdSleep(tskp->period - elapsed);
+    }
+  }
+}
+
+/* Periodic task scheduled by EDF, the deadline is equal to the period.*/
+static THD_FUNCTION(bmk_thread_edf, p) {
+  bmk_task_t *tskp = (bmk_task_t *)p;
+
+  chThdSleepUntil(bmk_start);
+  chEDFStart(tskp->period, tskp->period);
+  while (!chThdShouldTerminateX()) {
+    bmk_busy(tskp->cost);
+    (void) chEDFWaitNextJob();
+  }
+  tskp->jobs   = chEDFGetJobsX(chThdGetSelfX());
+  tskp->misses = chEDFGetMissesX(chThdGetSelfX());
+}
+
+static void bmk_tasks_init(uint32_t ipms) {
+
+  tasks[0].period = TIME_MS2I(50);
+  tasks[0].cost   = ipms * 20U;
+  tasks[0].jobs   = (ucnt_t)0;
+  tasks[0].misses = (ucnt_t)0;
+  tasks[1].period = TIME_MS2I(70);
+  tasks[1].cost   = ipms * 35U;
+  tasks[1].jobs   = (ucnt_t)0;
+  tasks[1].misses = (ucnt_t)0;
+}
+
+static void bmk_tasks_print(const char *name) {
+
+  test_print(name);
+  test_printn((uint32_t)(tasks[0].jobs + tasks[1].jobs));
+  test_print(" jobs, ");
+  test_printn((uint32_t)(tasks[0].misses + tasks[1].misses));
+  test_println(" misses");
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+#if (CH_CFG_USE_SEMAPHORES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_015_001 [15.1] Deadline ordering
+ *
+ * <h2>Description</h2>
+ * Threads with different deadlines and a thread without a deadline, all at
+ * the same priority, wait on a semaphore, the semaphore is reset and the
+ * threads must run in deadline order, the thread without a deadline must
+ * run last.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_SEMAPHORES == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [15.1.1] Starting the threads in an order not matching their deadlines.
+ * - [15.1.2] Resetting the semaphore, the threads must run in deadline
+ *   order.
+ * .
+ */
+
+static void rt_test_015_001_setup(void) {
+  chSemObjectInit(&sem1, 0);
+}
+
+static void rt_test_015_001_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+
+  /* [15.1.1] Starting the threads in an order not matching their
+     deadlines.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio + 1, thread1, "D");
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio + 1, thread1, "C");
+    threads[2] = chThdCreateStatic(wa[2], WA_SIZE, prio + 1, thread1, "A");
+    threads[3] = chThdCreateStatic(wa[3], WA_SIZE, prio + 1, thread1, "B");
+  }
+  test_end_step(1);
+
+  /* [15.1.2] Resetting the semaphore, the threads must run in deadline
+     order.*/
+  test_set_step(2);
+  {
+    chSysLock();
+    chSemResetI(&sem1, 0);
+    chSchRescheduleS();
+    chSysUnlock();
+    test_wait_threads();
+    test_assert_sequence("ABCD", "invalid sequence");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t rt_test_015_001 = {
+  "Deadline ordering",
+  rt_test_015_001_setup,
+  NULL,
+  rt_test_015_001_execute
+};
+#endif /* CH_CFG_USE_SEMAPHORES == TRUE */
+
+#if (CH_CFG_USE_SEMAPHORES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_015_002 [15.2] Preemption by deadline
+ *
+ * <h2>Description</h2>
+ * A thread with a late deadline wakes up a thread of the same priority with
+ * an earlier deadline, the woken thread must preempt the waker.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_SEMAPHORES == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [15.2.1] Starting the thread with the earlier deadline, it waits on the
+ *   semaphore.
+ * - [15.2.2] Starting the thread with the later deadline, it signals the
+ *   semaphore and must be preempted.
+ * .
+ */
+
+static void rt_test_015_002_setup(void) {
+  chSemObjectInit(&sem1, 0);
+}
+
+static void rt_test_015_002_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+
+  /* [15.2.1] Starting the thread with the earlier deadline, it waits on the
+     semaphore.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio + 1, thread2, "A");
+  }
+  test_end_step(1);
+
+  /* [15.2.2] Starting the thread with the later deadline, it signals the
+     semaphore and must be preempted.*/
+  test_set_step(2);
+  {
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio + 1, thread3, "B");
+    test_wait_threads();
+    test_assert_sequence("AB", "invalid sequence");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t rt_test_015_002 = {
+  "Preemption by deadline",
+  rt_test_015_002_setup,
+  NULL,
+  rt_test_015_002_execute
+};
+#endif /* CH_CFG_USE_SEMAPHORES == TRUE */
+
+/**
+ * @page rt_test_015_003 [15.3] Deadline misses
+ *
+ * <h2>Description</h2>
+ * The test thread becomes an EDF thread and executes jobs with different
+ * durations, jobs completed after their deadline must be counted and an
+ * overrunning job must release the next job immediately.
+ *
+ * <h2>Test Steps</h2>
+ * - [15.3.1] Entering the EDF class with a 50mS period and a 10mS deadline.
+ * - [15.3.2] Executing a 20mS job, the deadline must be missed.
+ * - [15.3.3] Executing an empty job, the deadline must be met.
+ * - [15.3.4] Executing a 60mS job, the period is overrun and the next job
+ *   must be released without waiting.
+ * - [15.3.5] Leaving the EDF class, the counters are checked.
+ * .
+ */
+
+static void rt_test_015_003_execute(void) {
+  systime_t time;
+
+  /* [15.3.1] Entering the EDF class with a 50mS period and a 10mS
+     deadline.*/
+  test_set_step(1);
+  {
+    (void) test_wait_tick();
+    chEDFStart(TIME_MS2I(50), TIME_MS2I(10));
+  }
+  test_end_step(1);
+
+  /* [15.3.2] Executing a 20mS job, the deadline must be missed.*/
+  test_set_step(2);
+  {
+    chThdSleepMilliseconds(20);
+    test_assert(chEDFWaitNextJob(), "miss not detected");
+  }
+  test_end_step(2);
+
+  /* [15.3.3] Executing an empty job, the deadline must be met.*/
+  test_set_step(3);
+  {
+    test_assert(!chEDFWaitNextJob(), "unexpected miss");
+  }
+  test_end_step(3);
+
+  /* [15.3.4] Executing a 60mS job, the period is overrun and the next job
+     must be released without waiting.*/
+  test_set_step(4);
+  {
+    chThdSleepMilliseconds(60);
+    time = chVTGetSystemTimeX();
+    test_assert(chEDFWaitNextJob(), "miss not detected");
+    test_assert(chTimeDiffX(time, chVTGetSystemTimeX()) < TIME_MS2I(5),
+                "next job not released");
+  }
+  test_end_step(4);
+
+  /* [15.3.5] Leaving the EDF class, the counters are checked.*/
+  test_set_step(5);
+  {
+    chEDFStop();
+    test_assert(chEDFGetJobsX(chThdGetSelfX()) == (ucnt_t)3, "wrong jobs count");
+    test_assert(chEDFGetMissesX(chThdGetSelfX()) == (ucnt_t)2,
+                "wrong misses count");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t rt_test_015_003 = {
+  "Deadline misses",
+  NULL,
+  NULL,
+  rt_test_015_003_execute
+};
+
+/**
+ * @page rt_test_015_004 [15.4] EDF vs rate monotonic benchmark
+ *
+ * <h2>Description</h2>
+ * Two periodic tasks, 20mS every 50mS and 35mS every 70mS, are executed for
+ * about one second first scheduled by fixed priorities assigned rate
+ * monotonically then by EDF. The utilization is 90%, the task set is not
+ * schedulable by fixed priorities while it is schedulable by EDF.<br> The
+ * test thread runs above the tasks in order to stop them on time. The
+ * numbers of jobs and deadline misses are printed, the results depend on
+ * the accuracy of the busy loop calibration.
+ *
+ * <h2>Test Steps</h2>
+ * - [15.4.1] Calibrating the busy loop, number of iterations per
+ *   millisecond.
+ * - [15.4.2] Running the task set with rate monotonic priorities.
+ * - [15.4.3] Running the task set with EDF.
+ * .
+ */
+
+static void rt_test_015_004_setup(void) {
+  bmk_dummy = 0U;
+}
+
+static void rt_test_015_004_execute(void) {
+  tprio_t prio = chThdGetPriorityX();
+  uint32_t ipms;
+
+  /* [15.4.1] Calibrating the busy loop, number of iterations per
+     millisecond.*/
+  test_set_step(1);
+  {
+    systime_t start, end;
+    uint32_t n = 0;
+
+    start = test_wait_tick();
+    end = chTimeAddX(start, TIME_MS2I(100));
+    do {
+      bmk_busy(1000U);
+      n++;
+    } while (chVTIsSystemTimeWithinX(start, end));
+    ipms = n * 10U;
+    test_assert(ipms > 0U, "calibration failed");
+  }
+  test_end_step(1);
+
+  /* [15.4.2] Running the task set with rate monotonic priorities.*/
+  test_set_step(2);
+  {
+    bmk_tasks_init(ipms);
+    bmk_start = chTimeAddX(test_wait_tick(), TIME_MS2I(10));
+    chThdSetPriority(prio + 3);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio + 2,
+                                   bmk_thread_rm, &tasks[0]);
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio + 1,
+                                   bmk_thread_rm, &tasks[1]);
+    chThdSleepUntil(chTimeAddX(bmk_start, TIME_MS2I(1050)));
+    test_terminate_threads();
+    chThdSetPriority(prio);
+    test_wait_threads();
+    test_assert((tasks[0].jobs > (ucnt_t)0) && (tasks[1].jobs > (ucnt_t)0),
+                "no jobs");
+    bmk_tasks_print("--- RM : ");
+  }
+  test_end_step(2);
+
+  /* [15.4.3] Running the task set with EDF.*/
+  test_set_step(3);
+  {
+    bmk_tasks_init(ipms);
+    bmk_start = chTimeAddX(test_wait_tick(), TIME_MS2I(10));
+    chThdSetPriority(prio + 3);
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, prio + 1,
+                                   bmk_thread_edf, &tasks[0]);
+    threads[1] = chThdCreateStatic(wa[1], WA_SIZE, prio + 1,
+                                   bmk_thread_edf, &tasks[1]);
+    chThdSleepUntil(chTimeAddX(bmk_start, TIME_MS2I(1050)));
+    test_terminate_threads();
+    chThdSetPriority(prio);
+    test_wait_threads();
+    test_assert((tasks[0].jobs > (ucnt_t)0) && (tasks[1].jobs > (ucnt_t)0),
+                "no jobs");
+    bmk_tasks_print("--- EDF: ");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_015_004 = {
+  "EDF vs rate monotonic benchmark",
+  rt_test_015_004_setup,
+  NULL,
+  rt_test_015_004_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const rt_test_sequence_015_array[] = {
+#if (CH_CFG_USE_SEMAPHORES == TRUE) || defined(__DOXYGEN__)
+  &rt_test_015_001,
+#endif
+#if (CH_CFG_USE_SEMAPHORES == TRUE) || defined(__DOXYGEN__)
+  &rt_test_015_002,
+#endif
+  &rt_test_015_003,
+  &rt_test_015_004,
+  NULL
+};
+
+/**
+ * @brief   EDF Scheduling.
+ */
+const testsequence_t rt_test_sequence_015 = {
+  "EDF Scheduling",
+  rt_test_sequence_015_array
+};
+
+#endif /* CH_CFG_USE_EDF == TRUE */
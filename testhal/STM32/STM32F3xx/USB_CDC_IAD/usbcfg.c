@@ -469,7 +469,8 @@ const SerialUSBConfig serusbcfg1 = {
   &USBD1,
   USB_DATA_REQUEST_EP_A,
   USB_DATA_AVAILABLE_EP_A,
-  USB_INTERRUPT_REQUEST_EP_A
+  USB_INTERRUPT_REQUEST_EP_A,
+  NULL
 };
 
 /*
@@ -479,5 +480,6 @@ const SerialUSBConfig serusbcfg2 = {
   &USBD1,
   USB_DATA_REQUEST_EP_B,
   USB_DATA_AVAILABLE_EP_B,
-  USB_INTERRUPT_REQUEST_EP_B
+  USB_INTERRUPT_REQUEST_EP_B,
+  NULL
 };
@@ -0,0 +1,338 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#include "chprintf.h"
+#include "memstreams.h"
+
+#include "portab.h"
+
+#define BUFFER_SIZE         16
+#define BUFFERS_NUM         4
+#define QUEUE_SIZE          2
+#define BQ_SIZE             16
+#define BQ_NUM              4
+
+static uint8_t pool_area[BUFFERS_NUM][IOB_BUFFER_SIZE(BUFFER_SIZE)]
+  __attribute__((aligned(sizeof (void *))));
+static iob_pool_t pool;
+
+static iob_t *queue_buffer[QUEUE_SIZE];
+static iob_queue_t queue;
+
+static uint8_t bq_area[BQ_BUFFER_SIZE(BQ_NUM, BQ_SIZE)]
+  __attribute__((aligned(sizeof (void *))));
+static output_buffers_queue_t obq;
+static input_buffers_queue_t ibq;
+
+static const uint8_t pattern[] = "0123456789ABCDEFGHIJKLMNOPQRSTUV";
+
+static BaseSequentialStream *out;
+static unsigned failures;
+
+/*
+ * Checks a condition and reports it if false.
+ */
+#define CHECK(c) check((c), #c, __LINE__)
+
+static bool check(bool c, const char *cond, int line) {
+
+  if (!c) {
+    chprintf(out, "    FAILED at line %d: %s\r\n", line, cond);
+    failures++;
+  }
+
+  return c;
+}
+
+/*
+ * Allocates a chain holding the specified data.
+ */
+static iob_t *make_chain(const uint8_t *bp, size_t n) {
+  iob_t *head = NULL;
+
+  while (n > 0U) {
+    iob_t *iobp = iobAllocTimeout(&pool, TIME_IMMEDIATE);
+    size_t size;
+
+    if (iobp == NULL) {
+      break;
+    }
+    size = iobAppend(iobp, bp, n);
+    bp += size;
+    n  -= size;
+    if (head == NULL) {
+      head = iobp;
+    }
+    else {
+      iobCat(head, iobp);
+    }
+  }
+
+  return head;
+}
+
+/*
+ * Pool allocation and release.
+ */
+static void test_pool(void) {
+  iob_t *iobps[BUFFERS_NUM];
+  unsigned i;
+
+  chprintf(out, "--- Buffers pool\r\n");
+
+  for (i = 0U; i < BUFFERS_NUM; i++) {
+    iobps[i] = iobAllocTimeout(&pool, TIME_IMMEDIATE);
+    CHECK(iobps[i] != NULL);
+  }
+  CHECK(iobAllocTimeout(&pool, TIME_MS2I(10)) == NULL);
+  for (i = 0U; i < BUFFERS_NUM; i++) {
+    iobRelease(iobps[i]);
+  }
+  CHECK(iobPoolGetFreeCountI(&pool) == BUFFERS_NUM);
+}
+
+/*
+ * Chains building, reading and sharing.
+ */
+static void test_chains(void) {
+  uint8_t buf[sizeof (pattern)];
+  iob_t *iobp;
+
+  chprintf(out, "--- Chains\r\n");
+
+  /* A chain spanning three buffers.*/
+  iobp = make_chain(pattern, 40U);
+  if (!CHECK(iobp != NULL)) {
+    return;
+  }
+  CHECK(iobGetChainLength(iobp) == 40U);
+  CHECK(iobPoolGetFreeCountI(&pool) == BUFFERS_NUM - 3U);
+
+  /* Reading across the buffers boundaries.*/
+  memset(buf, 0, sizeof (buf));
+  CHECK(iobRead(iobp, 10U, buf, 12U) == 12U);
+  CHECK(memcmp(buf, &pattern[10], 12U) == 0);
+  CHECK(iobRead(iobp, 36U, buf, 12U) == 4U);
+
+  /* Stripping a header.*/
+  CHECK(iobAdvance(iobp, 4U) == false);
+  CHECK(iobAdvance(iobp, BUFFER_SIZE) == true);
+  CHECK(iobGetChainLength(iobp) == 36U);
+  CHECK(iobGetDataX(iobp)[0] == pattern[4]);
+
+  /* Sharing, appending to a shared chain must fail.*/
+  iobAddRef(iobp);
+  CHECK(iobAppend(iobp, pattern, 4U) == 0U);
+  iobRelease(iobp);
+  CHECK(iobPoolGetFreeCountI(&pool) == BUFFERS_NUM - 3U);
+  CHECK(iobAppend(iobp, pattern, 4U) == 4U);
+  CHECK(iobGetChainLength(iobp) == 40U);
+
+  /* A shared tail is refused too.*/
+  iobAddRef(iobGetNextX(iobGetNextX(iobp)));
+  CHECK(iobAppend(iobp, pattern, 4U) == 0U);
+  iobRelease(iobGetNextX(iobGetNextX(iobp)));
+
+  /* Releasing the last reference frees the whole chain.*/
+  iobRelease(iobp);
+  CHECK(iobPoolGetFreeCountI(&pool) == BUFFERS_NUM);
+}
+
+/*
+ * Writing a chain on a stream.
+ */
+static void test_stream(void) {
+  uint8_t buf[sizeof (pattern)];
+  MemoryStream ms;
+  iob_t *iobp;
+
+  chprintf(out, "--- Stream write\r\n");
+
+  iobp = make_chain(pattern, 30U);
+  if (!CHECK(iobp != NULL)) {
+    return;
+  }
+  msObjectInit(&ms, buf, sizeof (buf), 0U);
+  CHECK(iobStreamWrite((BaseSequentialStream *)&ms, iobp) == 30U);
+  CHECK(memcmp(buf, pattern, 30U) == 0);
+  iobRelease(iobp);
+  CHECK(iobPoolGetFreeCountI(&pool) == BUFFERS_NUM);
+}
+
+/*
+ * Chains queue between threads.
+ */
+static THD_WORKING_AREA(waProducer, 256);
+static THD_FUNCTION(Producer, arg) {
+  unsigned i;
+
+  (void)arg;
+  for (i = 0U; i < 8U; i++) {
+    iob_t *iobp = iobAllocTimeout(&pool, TIME_INFINITE);
+
+    (void) iobAppend(iobp, &pattern[i], 1U);
+    if (iobqPostTimeout(&queue, iobp, TIME_INFINITE) != MSG_OK) {
+      iobRelease(iobp);
+    }
+  }
+}
+
+static void test_queue(void) {
+  iob_t *iobp;
+  thread_t *tp;
+  unsigned i;
+
+  chprintf(out, "--- Chains queue\r\n");
+
+  iobqObjectInit(&queue, queue_buffer, QUEUE_SIZE);
+  CHECK(iobqFetchTimeout(&queue, &iobp, TIME_MS2I(10)) == MSG_TIMEOUT);
+
+  /* The producer is blocked by the queue size and then by the pool.*/
+  tp = chThdCreateStatic(waProducer, sizeof (waProducer),
+                         chThdGetPriorityX() + 1, Producer, NULL);
+  for (i = 0U; i < 8U; i++) {
+    if (!CHECK(iobqFetchTimeout(&queue, &iobp, TIME_MS2I(100)) == MSG_OK)) {
+      break;
+    }
+    CHECK(iobGetDataX(iobp)[0] == pattern[i]);
+    iobRelease(iobp);
+  }
+  chThdWait(tp);
+
+  /* Resetting the queue releases the queued chains.*/
+  iobp = make_chain(pattern, 20U);
+  CHECK(iobqPostTimeout(&queue, iobp, TIME_IMMEDIATE) == MSG_OK);
+  osalSysLock();
+  iobqResetI(&queue);
+  osalSysUnlock();
+  CHECK(iobqGetUsedCountI(&queue) == 0U);
+  CHECK(iobPoolGetFreeCountI(&pool) == BUFFERS_NUM);
+}
+
+/*
+ * Chains passed by reference through buffers queues, the test plays the
+ * role of the driver side.
+ */
+static void test_bqueues(void) {
+  uint8_t buf[sizeof (pattern)];
+  iob_t *iobp, *rxps[2];
+  uint8_t *bp;
+  size_t n;
+
+  chprintf(out, "--- Buffers queues\r\n");
+
+  /* Output side, data already written goes first then the chain
+     segments are transmitted in place.*/
+  obqObjectInit(&obq, false, bq_area, BQ_SIZE, BQ_NUM, NULL, NULL);
+  iobp = make_chain(pattern, 20U);
+  if (!CHECK(iobp != NULL)) {
+    return;
+  }
+  CHECK(obqWriteTimeout(&obq, pattern, 3U, TIME_IMMEDIATE) == 3U);
+  CHECK(obqPostChainTimeout(&obq, iobp, TIME_IMMEDIATE) == 20U);
+  iobRelease(iobp);
+  osalSysLock();
+  bp = obqGetFullBufferI(&obq, &n);
+  CHECK((bp != NULL) && (n == 3U));
+  obqReleaseEmptyBufferI(&obq);
+  bp = obqGetFullBufferI(&obq, &n);
+  CHECK((bp == iobGetDataX(iobp)) && (n == BUFFER_SIZE));
+  obqReleaseEmptyBufferI(&obq);
+  bp = obqGetFullBufferI(&obq, &n);
+  CHECK((bp != NULL) && (n == 4U) && (memcmp(bp, &pattern[16], 4U) == 0));
+  obqReleaseEmptyBufferI(&obq);
+  CHECK(obqIsEmptyI(&obq));
+  osalSysUnlock();
+  CHECK(iobPoolGetFreeCountI(&pool) == BUFFERS_NUM);
+
+  /* Resetting the queue releases the referenced segments.*/
+  iobp = make_chain(pattern, 20U);
+  CHECK(obqPostChainTimeout(&obq, iobp, TIME_IMMEDIATE) == 20U);
+  iobRelease(iobp);
+  osalSysLock();
+  obqResetI(&obq);
+  osalSysUnlock();
+  CHECK(iobPoolGetFreeCountI(&pool) == BUFFERS_NUM);
+
+  /* Input side, the driver receives data directly into I/O buffers.*/
+  ibqObjectInit(&ibq, false, bq_area, BQ_SIZE, BQ_NUM, NULL, NULL);
+  osalSysLock();
+  for (n = 0U; n < 2U; n++) {
+    rxps[n] = iobAllocI(&pool);
+    memcpy(iobGetDataX(rxps[n]), &pattern[n * 8U], 8U);
+    iobSetLengthX(rxps[n], 8U);
+    ibqPostFullChainI(&ibq, rxps[n]);
+  }
+  osalSysUnlock();
+  CHECK(ibqGetChainTimeout(&ibq, &iobp, TIME_IMMEDIATE) == MSG_OK);
+  CHECK(iobp == rxps[0]);
+  iobRelease(iobp);
+
+  /* The stream functions read the referenced buffers in place.*/
+  CHECK(ibqReadTimeout(&ibq, buf, 8U, TIME_IMMEDIATE) == 8U);
+  CHECK(memcmp(buf, &pattern[8], 8U) == 0);
+  CHECK(iobPoolGetFreeCountI(&pool) == BUFFERS_NUM);
+  CHECK(ibqGetChainTimeout(&ibq, &iobp, TIME_IMMEDIATE) == MSG_TIMEOUT);
+
+  /* Resetting the queue releases the referenced buffers.*/
+  iobp = make_chain(pattern, 8U);
+  osalSysLock();
+  ibqPostFullChainI(&ibq, iobp);
+  ibqResetI(&ibq);
+  osalSysUnlock();
+  CHECK(iobPoolGetFreeCountI(&pool) == BUFFERS_NUM);
+}
+
+/*
+ * Application entry point.
+ */
+int main(void) {
+
+  /*
+   * System initializations.
+   * - HAL initialization, this also initializes the configured device drivers
+   *   and performs the board-specific initializations.
+   * - Kernel initialization, the main() function becomes a thread and the
+   *   RTOS is active.
+   */
+  halInit();
+  chSysInit();
+
+  /* Board-dependent setup, output stream.*/
+  portab_setup();
+  out = (BaseSequentialStream *)&PORTAB_SD1;
+
+  iobPoolObjectInit(&pool, BUFFER_SIZE, pool_area, BUFFERS_NUM);
+
+  chprintf(out, "\r\n*** I/O buffer chains test\r\n");
+  test_pool();
+  test_chains();
+  test_stream();
+  test_queue();
+  test_bqueues();
+  chprintf(out, "\r\nFinal result: %s\r\n",
+           failures == 0U ? "SUCCESS" : "FAILURE");
+
+  /* Normal main() thread activity, nothing in this test.*/
+  while (true) {
+    chThdSleepMilliseconds(5000);
+  }
+}
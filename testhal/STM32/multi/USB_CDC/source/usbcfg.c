@@ -339,5 +339,6 @@ const SerialUSBConfig serusbcfg = {
   &PORTAB_USB1,
   USB1_DATA_REQUEST_EP,
   USB1_DATA_AVAILABLE_EP,
-  USB1_INTERRUPT_REQUEST_EP
+  USB1_INTERRUPT_REQUEST_EP,
+  NULL
 };
@@ -0,0 +1,81 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    portab.c
+ * @brief   Application portability module code.
+ *
+ * @addtogroup application_portability
+ * @{
+ */
+
+#include "hal.h"
+#include "irq_latency.h"
+
+#include "portab.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*
+ * GPT4 configuration.
+ */
+static const GPTConfig gpt4cfg = {
+  17000000,             /* 17MHz timer clock.*/
+  irq_latency_gpt_cb,   /* Timer callback.*/
+  0,
+  0
+};
+
+/*
+ * IRQ Latency configuration.
+ */
+const irq_latency_config_t portab_irq_latency_config = {
+  (BaseSequentialStream  *)&PORTAB_SD1,
+  &GPTD4,
+  &gpt4cfg,
+  STM32_SYSCLK,
+  250
+};
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+void portab_setup(void) {
+
+  /* Serial Driver for output.*/
+  sdStart(&PORTAB_SD1, NULL);
+}
+
+/** @} */
@@ -0,0 +1,383 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    irq_latency.c
+ * @brief   IRQ latency measurement code.
+ * @details A timer in continuous mode triggers periodic interrupts, two
+ *          latencies are measured for each interrupt:
+ *          - IRQ to ISR, the timer counter value on callback entry, it is
+ *            the time elapsed since the period event.
+ *          - ISR to thread, the realtime counter difference between the
+ *            callback entry and a waiting thread resuming execution.
+ *          .
+ *          Each iteration measures an idle system and a system loaded by a
+ *          low priority thread executing back to back critical zones, the
+ *          final report contains the latency histograms of all iterations.
+ *
+ * @addtogroup IRQ_LATENCY
+ * @{
+ */
+
+#include "ch.h"
+#include "hal.h"
+
+#include "chprintf.h"
+#include "irq_latency.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+#define PHASE_IDLE                      0U
+#define PHASE_LOAD                      1U
+#define PHASES                          2U
+
+#define STAGE_IRQ_ISR                   0U
+#define STAGE_ISR_THD                   1U
+#define STAGES                          2U
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/**
+ * @brief   Latency statistics.
+ */
+typedef struct {
+  unsigned              n;
+  uint32_t              min;
+  uint32_t              max;
+  uint64_t              sum;
+  unsigned              hist[IRQ_LATENCY_CFG_BUCKETS];
+} latency_stats_t;
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+static const irq_latency_config_t *config;
+
+static const char *phase_names[PHASES] = {"Idle", "Load"};
+static const char *stage_names[STAGES] = {"IRQ->ISR", "ISR->thread"};
+
+/*
+ * Sample written by the ISR for the measurement thread.
+ */
+static thread_reference_t trp;
+static gptcnt_t isr_cnt;
+static rtcnt_t isr_stamp;
+static unsigned missed;
+
+/*
+ * Statistics of the phase being measured and of all the iterations.
+ */
+static latency_stats_t current[STAGES];
+static latency_stats_t totals[PHASES][STAGES];
+
+/*
+ * Threads working areas.
+ */
+static THD_WORKING_AREA(irq_latency_thread_wa, IRQ_LATENCY_CFG_STACK_SIZE);
+static THD_WORKING_AREA(irq_latency_load_wa, IRQ_LATENCY_CFG_STACK_SIZE);
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static void stats_reset(latency_stats_t *sp) {
+  unsigned i;
+
+  sp->n   = 0U;
+  sp->min = UINT32_MAX;
+  sp->max = 0U;
+  sp->sum = 0U;
+  for (i = 0U; i < IRQ_LATENCY_CFG_BUCKETS; i++) {
+    sp->hist[i] = 0U;
+  }
+}
+
+static void stats_account(latency_stats_t *sp, uint32_t ns) {
+  uint32_t b;
+
+  b = ns / config->resolution;
+  if (b >= IRQ_LATENCY_CFG_BUCKETS) {
+    b = IRQ_LATENCY_CFG_BUCKETS - 1U;
+  }
+  sp->hist[b]++;
+  sp->n++;
+  sp->sum += ns;
+  if (ns < sp->min) {
+    sp->min = ns;
+  }
+  if (ns > sp->max) {
+    sp->max = ns;
+  }
+}
+
+static void stats_merge(latency_stats_t *dst, const latency_stats_t *src) {
+  unsigned i;
+
+  dst->n   += src->n;
+  dst->sum += src->sum;
+  if (src->min < dst->min) {
+    dst->min = src->min;
+  }
+  if (src->max > dst->max) {
+    dst->max = src->max;
+  }
+  for (i = 0U; i < IRQ_LATENCY_CFG_BUCKETS; i++) {
+    dst->hist[i] += src->hist[i];
+  }
+}
+
+static uint32_t stats_avg(const latency_stats_t *sp) {
+
+  if (sp->n == 0U) {
+    return 0U;
+  }
+  return (uint32_t)(sp->sum / sp->n);
+}
+
+static void print_summary(const latency_stats_t *sp) {
+
+  chprintf(config->out, "%u/%u/%u nS",
+           sp->n > 0U ? sp->min : 0U, stats_avg(sp), sp->max);
+}
+
+static void print_histogram(const latency_stats_t *sp) {
+  uint32_t lo;
+  unsigned i;
+
+  chprintf(config->out, "  Min/Avg/Max:  ");
+  print_summary(sp);
+  chprintf(config->out, "\r\n");
+  for (i = 0U; i < IRQ_LATENCY_CFG_BUCKETS - 1U; i++) {
+    lo = i * config->resolution;
+    chprintf(config->out, "  %6u..%6u: %u\r\n",
+             lo, lo + config->resolution - 1U, sp->hist[i]);
+  }
+  chprintf(config->out, "  %6u..      : %u\r\n",
+           i * config->resolution, sp->hist[i]);
+}
+
+static uint32_t rtc2ns(rtcnt_t n) {
+
+  return (uint32_t)(((uint64_t)n * 1000000000ULL) / config->rtcfreq);
+}
+
+static uint32_t gpt2ns(gptcnt_t n) {
+
+  return (uint32_t)(((uint64_t)n * 1000000000ULL) /
+                    config->gptcfgp->frequency);
+}
+
+/*
+ * Measurement thread, woken by the timer callback.
+ */
+static THD_FUNCTION(irq_latency_thread, arg) {
+  rtcnt_t now, stamp;
+  gptcnt_t cnt;
+  msg_t msg;
+
+  (void)arg;
+  chRegSetThreadName("irq_latency");
+
+  while (true) {
+    chSysLock();
+    msg = chThdSuspendS(&trp);
+    now   = chSysGetRealtimeCounterX();
+    stamp = isr_stamp;
+    cnt   = isr_cnt;
+    chSysUnlock();
+
+    if (msg != MSG_OK) {
+      break;
+    }
+
+    if (current[STAGE_ISR_THD].n < IRQ_LATENCY_CFG_SAMPLES) {
+      stats_account(&current[STAGE_IRQ_ISR], gpt2ns(cnt));
+      stats_account(&current[STAGE_ISR_THD], rtc2ns(now - stamp));
+    }
+  }
+}
+
+/*
+ * Load thread, back to back critical zones.
+ */
+static THD_FUNCTION(irq_latency_load, arg) {
+  rtcnt_t cycles = (rtcnt_t)(config->rtcfreq / 1000000U) *
+                   (rtcnt_t)IRQ_LATENCY_CFG_LOAD_ZONE;
+
+  (void)arg;
+  chRegSetThreadName("irq_load");
+
+  while (chThdShouldTerminateX() == false) {
+    chSysLock();
+    chSysPolledDelayX(cycles);
+    chSysUnlock();
+  }
+}
+
+/*
+ * Measures a phase and merges the results into the totals.
+ */
+static void irq_latency_phase(unsigned phase) {
+  unsigned i;
+
+  stats_reset(&current[STAGE_IRQ_ISR]);
+  stats_reset(&current[STAGE_ISR_THD]);
+  missed = 0U;
+
+  gptStartContinuous(config->gptp,
+                     config->gptcfgp->frequency / IRQ_LATENCY_CFG_RATE);
+  while (current[STAGE_ISR_THD].n < IRQ_LATENCY_CFG_SAMPLES) {
+    chThdSleepMilliseconds(10);
+  }
+  gptStopTimer(config->gptp);
+
+  chprintf(config->out, "  %s: ", phase_names[phase]);
+  for (i = 0U; i < STAGES; i++) {
+    chprintf(config->out, "%s ", stage_names[i]);
+    print_summary(&current[i]);
+    chprintf(config->out, ", ");
+    stats_merge(&totals[phase][i], &current[i]);
+  }
+  chprintf(config->out, "missed %u\r\n", missed);
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   GPT callback.
+ */
+void irq_latency_gpt_cb(GPTDriver *gptp) {
+  gptcnt_t cnt = gptGetCounterX(gptp);
+  rtcnt_t now = chSysGetRealtimeCounterX();
+
+  chSysLockFromISR();
+  if (trp != NULL) {
+    isr_cnt   = cnt;
+    isr_stamp = now;
+    chThdResumeI(&trp, MSG_OK);
+  }
+  else {
+    /* The thread did not process the previous interrupt yet.*/
+    missed++;
+  }
+  chSysUnlockFromISR();
+}
+
+/**
+ * @brief   IRQ latency execution.
+ *
+ * @param[in] cfg       pointer to the test configuration structure
+ *
+ * @api
+ */
+void irq_latency_execute(const irq_latency_config_t *cfg) {
+  thread_t *tp, *ltp;
+  unsigned i, j;
+
+  /* Global configuration pointer.*/
+  config = cfg;
+
+  /* Starting the timer using the stored configuration.*/
+  gptStart(cfg->gptp, cfg->gptcfgp);
+
+  for (i = 0U; i < PHASES; i++) {
+    for (j = 0U; j < STAGES; j++) {
+      stats_reset(&totals[i][j]);
+    }
+  }
+
+  /* Creating the measurement thread.*/
+  tp = chThdCreateStatic(irq_latency_thread_wa,
+                         sizeof irq_latency_thread_wa,
+                         IRQ_LATENCY_CFG_THREAD_PRIORITY,
+                         irq_latency_thread,
+                         NULL);
+
+  /* Printing environment information.*/
+  chprintf(cfg->out, "\r\n*** ChibiOS/RT IRQ-LATENCY test\r\n***\r\n");
+  chprintf(cfg->out, "*** Kernel:       %s\r\n", CH_KERNEL_VERSION);
+  chprintf(cfg->out, "*** Compiled:     %s\r\n", __DATE__ " - " __TIME__);
+#ifdef PORT_COMPILER_NAME
+  chprintf(cfg->out, "*** Compiler:     %s\r\n", PORT_COMPILER_NAME);
+#endif
+  chprintf(cfg->out, "*** Architecture: %s\r\n", PORT_ARCHITECTURE_NAME);
+#ifdef PORT_CORE_VARIANT_NAME
+  chprintf(cfg->out, "*** Core Variant: %s\r\n", PORT_CORE_VARIANT_NAME);
+#endif
+  chprintf(cfg->out, "*** RT Counter:   %u\r\n", cfg->rtcfreq);
+  chprintf(cfg->out, "*** Timer Clock:  %u\r\n", cfg->gptcfgp->frequency);
+#ifdef PORT_INFO
+  chprintf(cfg->out, "*** Port Info:    %s\r\n", PORT_INFO);
+#endif
+#ifdef PLATFORM_NAME
+  chprintf(cfg->out, "*** Platform:     %s\r\n", PLATFORM_NAME);
+#endif
+#ifdef BOARD_NAME
+  chprintf(cfg->out, "*** Test Board:   %s\r\n", BOARD_NAME);
+#endif
+  chprintf(cfg->out, "***\r\n");
+  chprintf(cfg->out, "*** Iterations:   %d\r\n", IRQ_LATENCY_CFG_ITERATIONS);
+  chprintf(cfg->out, "*** Samples:      %d\r\n", IRQ_LATENCY_CFG_SAMPLES);
+  chprintf(cfg->out, "*** Rate:         %d Hz\r\n", IRQ_LATENCY_CFG_RATE);
+  chprintf(cfg->out, "*** Load Zones:   %d uS\r\n\r\n", IRQ_LATENCY_CFG_LOAD_ZONE);
+
+  /* Test loop.*/
+  for (i = 1U; i <= IRQ_LATENCY_CFG_ITERATIONS; i++) {
+
+    chprintf(cfg->out, "Iteration %d\r\n", i);
+
+    /* Idle system.*/
+    irq_latency_phase(PHASE_IDLE);
+
+    /* System loaded by critical zones.*/
+    ltp = chThdCreateStatic(irq_latency_load_wa,
+                            sizeof irq_latency_load_wa,
+                            IRQ_LATENCY_CFG_LOAD_PRIORITY,
+                            irq_latency_load,
+                            NULL);
+    irq_latency_phase(PHASE_LOAD);
+    chThdTerminate(ltp);
+    chThdWait(ltp);
+  }
+
+  /* Final report.*/
+  for (i = 0U; i < PHASES; i++) {
+    for (j = 0U; j < STAGES; j++) {
+      chprintf(cfg->out, "\r\n%s %s latency histogram (nS)\r\n",
+               phase_names[i], stage_names[j]);
+      print_histogram(&totals[i][j]);
+    }
+  }
+  chprintf(cfg->out, "\r\nTest Complete\r\n");
+
+  /* Terminating the measurement thread and cleaning up.*/
+  chThdResume(&trp, MSG_RESET);
+  chThdWait(tp);
+  gptStop(cfg->gptp);
+}
+
+/** @} */
@@ -0,0 +1,164 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    irq_latency.h
+ * @brief   IRQ latency measurement header.
+ *
+ * @addtogroup IRQ_LATENCY
+ * @{
+ */
+
+#ifndef IRQ_LATENCY_H
+#define IRQ_LATENCY_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Configuration options
+ * @{
+ */
+/**
+ * @brief   Number of test iterations.
+ */
+#if !defined(IRQ_LATENCY_CFG_ITERATIONS) || defined(__DOXYGEN__)
+#define IRQ_LATENCY_CFG_ITERATIONS          10
+#endif
+
+/**
+ * @brief   Number of interrupts measured in each phase of an iteration.
+ */
+#if !defined(IRQ_LATENCY_CFG_SAMPLES) || defined(__DOXYGEN__)
+#define IRQ_LATENCY_CFG_SAMPLES             1000
+#endif
+
+/**
+ * @brief   Interrupts rate in Hz.
+ */
+#if !defined(IRQ_LATENCY_CFG_RATE) || defined(__DOXYGEN__)
+#define IRQ_LATENCY_CFG_RATE                1000
+#endif
+
+/**
+ * @brief   Number of histogram buckets.
+ * @details The last bucket counts all the samples exceeding the previous
+ *          buckets.
+ */
+#if !defined(IRQ_LATENCY_CFG_BUCKETS) || defined(__DOXYGEN__)
+#define IRQ_LATENCY_CFG_BUCKETS             16
+#endif
+
+/**
+ * @brief   Priority of the measurement thread.
+ */
+#if !defined(IRQ_LATENCY_CFG_THREAD_PRIORITY) || defined(__DOXYGEN__)
+#define IRQ_LATENCY_CFG_THREAD_PRIORITY     (tprio_t)(NORMALPRIO+10)
+#endif
+
+/**
+ * @brief   Priority of the load thread.
+ */
+#if !defined(IRQ_LATENCY_CFG_LOAD_PRIORITY) || defined(__DOXYGEN__)
+#define IRQ_LATENCY_CFG_LOAD_PRIORITY       (tprio_t)(NORMALPRIO-10)
+#endif
+
+/**
+ * @brief   Duration of the load thread critical zones in microseconds.
+ */
+#if !defined(IRQ_LATENCY_CFG_LOAD_ZONE) || defined(__DOXYGEN__)
+#define IRQ_LATENCY_CFG_LOAD_ZONE           10
+#endif
+
+/**
+ * @brief   Stack size for worker threads.
+ */
+#if !defined(IRQ_LATENCY_CFG_STACK_SIZE) || defined(__DOXYGEN__)
+#define IRQ_LATENCY_CFG_STACK_SIZE          256
+#endif
+/** @} */
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if PORT_SUPPORTS_RT == FALSE
+#error "IRQ_LATENCY requires PORT_SUPPORTS_RT"
+#endif
+
+#if IRQ_LATENCY_CFG_BUCKETS < 2
+#error "invalid IRQ_LATENCY_CFG_BUCKETS value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+typedef struct {
+  /**
+   * @brief   Stream for output.
+   */
+  BaseSequentialStream  *out;
+  /**
+   * @brief   GPT driver triggering the interrupts.
+   * @note    The timer counter must be reset on the period event, its value
+   *          on callback entry is the time elapsed since the interrupt
+   *          assertion.
+   */
+  GPTDriver             *gptp;
+  /**
+   * @brief   GPT configuration.
+   */
+  const GPTConfig       *gptcfgp;
+  /**
+   * @brief   Realtime counter frequency.
+   */
+  uint32_t              rtcfreq;
+  /**
+   * @brief   Histogram bucket width in nanoseconds.
+   */
+  uint32_t              resolution;
+} irq_latency_config_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void irq_latency_gpt_cb(GPTDriver *gptp);
+  void irq_latency_execute(const irq_latency_config_t *cfg);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* IRQ_LATENCY_H */
+
+/** @} */